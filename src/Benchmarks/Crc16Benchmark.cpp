@@ -0,0 +1,123 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Homegear.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+
+#include "../PhysicalInterfaces/Crc16.h"
+
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <random>
+
+//Compares BidCoS::CRC16 with the byte-wise implementation it replaced and measures both.
+//Run with "make bench". Returns 1 if any checksum differs.
+
+namespace
+{
+
+//The previous implementation: byte-wise with the table stored in a std::map.
+class ReferenceCrc16
+{
+public:
+	ReferenceCrc16()
+	{
+		for(uint32_t i = 0; i < 256; i++)
+		{
+			uint32_t crc = i << 8;
+			for(uint32_t j = 0; j < 8; j++)
+			{
+				uint32_t bit = crc & 0x8000;
+				crc <<= 1;
+				if(bit) crc ^= 0x8005;
+			}
+			_crcTable[i] = crc & 0xFFFF;
+		}
+	}
+
+	uint16_t calculate(const std::vector<uint8_t>& data, bool ignoreLastTwoBytes = false)
+	{
+		int32_t size = ignoreLastTwoBytes ? data.size() - 2 : data.size();
+		uint16_t crc = 0xd77f;
+		for(int32_t i = 0; i < size; i++)
+		{
+			crc = (crc << 8) ^ _crcTable[((crc >> 8) & 0xff) ^ data[i]];
+		}
+		return crc;
+	}
+private:
+	std::map<uint16_t, uint16_t> _crcTable;
+};
+
+double measure(ReferenceCrc16& reference, const std::vector<uint8_t>& data, uint32_t iterations, bool useReference)
+{
+	volatile uint16_t result = 0;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for(uint32_t i = 0; i < iterations; i++)
+	{
+		result ^= useReference ? reference.calculate(data) : BidCoS::CRC16::calculate(data);
+	}
+	(void)result;
+	return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / iterations;
+}
+
+}
+
+int main()
+{
+	ReferenceCrc16 reference;
+	std::mt19937 random(1);
+
+	uint32_t mismatches = 0;
+	for(uint32_t i = 0; i < 20000; i++)
+	{
+		std::vector<uint8_t> data(random() % 300);
+		for(std::vector<uint8_t>::iterator j = data.begin(); j != data.end(); ++j) *j = random();
+		std::vector<char> charData(data.begin(), data.end());
+		uint16_t expected = reference.calculate(data);
+		if(BidCoS::CRC16::calculate(data) != expected || BidCoS::CRC16::calculate(charData) != expected) mismatches++;
+		if(data.size() >= 2 && BidCoS::CRC16::calculate(data, true) != reference.calculate(data, true)) mismatches++;
+		//Continuing over a split buffer must give the same result as one call.
+		size_t split = data.empty() ? 0 : random() % data.size();
+		if(BidCoS::CRC16::calculate(data.data() + split, data.size() - split, BidCoS::CRC16::calculate(data.data(), split)) != expected) mismatches++;
+	}
+	std::cout << "Checksum mismatches: " << mismatches << std::endl;
+
+	//HM-LGW and HM-MOD-RPI-PCB frames are between 10 and 60 bytes long.
+	const size_t sizes[] = { 12, 40, 64, 256 };
+	std::cout << "Bytes\tPrevious (ns)\tCRC16 (ns)" << std::endl;
+	for(uint32_t i = 0; i < sizeof(sizes) / sizeof(size_t); i++)
+	{
+		std::vector<uint8_t> data(sizes[i]);
+		for(std::vector<uint8_t>::iterator j = data.begin(); j != data.end(); ++j) *j = random();
+		double previous = measure(reference, data, 200000, true);
+		double current = measure(reference, data, 200000, false);
+		std::cout << sizes[i] << "\t" << previous << "\t" << current << std::endl;
+	}
+
+	return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,336 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Homegear.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+
+#include "../GD.h"
+#include "../BidCoSPeer.h"
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+
+//Replays recorded packets through BidCoSFrameDecoder and through the generic interpretation of the device description it replaced,
+//compares the decoded values and measures both.
+//Usage: framedecoderbenchmark DEVICE_DESCRIPTION PEER_ADDRESS RECORDED_PACKETS
+//RECORDED_PACKETS contains one packet per line in the format of BidCoSPacket::hexString() as printed in the log. PEER_ADDRESS is
+//hexadecimal. Returns 1 if any packet is decoded differently.
+
+using namespace BidCoS;
+
+namespace
+{
+
+class ReplayPeer : public BidCoSPeer
+{
+public:
+	ReplayPeer(int32_t address, PHomegearDevice rpcDevice) : BidCoSPeer(1, address, "REPLAY0001", 0, nullptr)
+	{
+		_rpcDevice = rpcDevice;
+	}
+
+	using BidCoSPeer::getValuesFromPacket;
+
+	//Decodes a packet by interpreting the device description, as it was done before BidCoSFrameDecoder existed.
+	void getValuesFromPacketGeneric(std::shared_ptr<BidCoSPacket> packet, FrameValuesBuffer& frameValues)
+	{
+		try
+		{
+			frameValues.size = 0;
+			frameValues.frames.clear();
+			if(!_rpcDevice) return;
+			//equal_range returns all elements with "0" or an unknown element as argument
+			if(packet->messageType() == 0 || _rpcDevice->packetsByMessageType.find(packet->messageType()) == _rpcDevice->packetsByMessageType.end()) return;
+			std::pair<PacketsByMessageType::iterator, PacketsByMessageType::iterator> range = _rpcDevice->packetsByMessageType.equal_range((uint32_t)packet->messageType());
+			if(range.first == _rpcDevice->packetsByMessageType.end()) return;
+			PacketsByMessageType::iterator i = range.first;
+			do
+			{
+				FrameValues currentFrameValues;
+				std::map<std::string, std::pair<std::set<uint32_t>, std::vector<uint8_t>>> values;
+				PPacket frame(i->second);
+				if(!frame) continue;
+				if(frame->direction == Packet::Direction::Enum::toCentral && packet->senderAddress() != _address && (!hasTeam() || packet->senderAddress() != _team.address)) continue;
+				if(frame->direction == Packet::Direction::Enum::fromCentral && packet->destinationAddress() != _address) continue;
+				if(packet->payload()->empty()) break;
+				if(frame->subtype > -1 && frame->subtypeIndex >= 9 && (signed)packet->payload()->size() > (frame->subtypeIndex - 9) && packet->payload()->at(frame->subtypeIndex - 9) != (unsigned)frame->subtype) continue;
+				int32_t channelIndex = frame->channelIndex;
+				int32_t channel = -1;
+				if(channelIndex >= 9 && (signed)packet->payload()->size() > (channelIndex - 9)) channel = packet->payload()->at(channelIndex - 9);
+				if(channel > -1 && frame->channelSize < 1.0) channel &= (0xFF >> (8 - std::lround(frame->channelSize * 10) % 10));
+				if(frame->channel > -1) channel = frame->channel;
+				if(frame->length > 0 && packet->length() != frame->length) continue;
+				currentFrameValues.frameID = frame->id;
+
+				for(BinaryPayloads::iterator j = frame->binaryPayloads.begin(); j != frame->binaryPayloads.end(); ++j)
+				{
+					std::vector<uint8_t> data;
+					if((*j)->size > 0 && (*j)->index > 0)
+					{
+						if(((int32_t)(*j)->index) - 9 >= (signed)packet->payload()->size()) continue;
+						data = packet->getPosition((*j)->index, (*j)->size, -1);
+
+						if((*j)->constValueInteger > -1)
+						{
+							int32_t intValue = 0;
+							_bl->hf.memcpyBigEndian(intValue, data);
+							if(intValue != (*j)->constValueInteger) break; else continue;
+						}
+					}
+					else if((*j)->constValueInteger > -1)
+					{
+						_bl->hf.memcpyBigEndian(data, (*j)->constValueInteger);
+					}
+					else continue;
+					for(std::vector<PParameter>::iterator k = frame->associatedVariables.begin(); k != frame->associatedVariables.end(); ++k)
+					{
+						if((*k)->physical->groupId != (*j)->parameterId) continue;
+						currentFrameValues.parameterSetType = (*k)->parent()->type();
+						bool setValues = false;
+						if(currentFrameValues.paramsetChannels.empty()) //Fill paramsetChannels
+						{
+							int32_t startChannel = (channel < 0) ? 0 : channel;
+							int32_t endChannel;
+							//When fixedChannel is -2 (means '*') cycle through all channels
+							if(frame->channel == -2)
+							{
+								startChannel = 0;
+								endChannel = _rpcDevice->functions.rbegin()->first;
+							}
+							else endChannel = startChannel;
+							for(int32_t l = startChannel; l <= endChannel; l++)
+							{
+								PParameterGroup parameterGroup = getParameterSet(l, currentFrameValues.parameterSetType);
+								if(!parameterGroup || parameterGroup->parameters.find((*k)->id) == parameterGroup->parameters.end()) continue;
+								currentFrameValues.paramsetChannels.push_back(l);
+								values[(*k)->id].first.insert(l);
+								setValues = true;
+							}
+						}
+						else //Use paramsetChannels
+						{
+							for(std::vector<uint32_t>::const_iterator l = currentFrameValues.paramsetChannels.begin(); l != currentFrameValues.paramsetChannels.end(); ++l)
+							{
+								PParameterGroup parameterGroup = getParameterSet(*l, currentFrameValues.parameterSetType);
+								if(!parameterGroup || parameterGroup->parameters.find((*k)->id) == parameterGroup->parameters.end()) continue;
+								values[(*k)->id].first.insert(*l);
+								setValues = true;
+							}
+						}
+						if(setValues) values[(*k)->id].second = data;
+					}
+				}
+				if(values.empty()) continue;
+				for(std::map<std::string, std::pair<std::set<uint32_t>, std::vector<uint8_t>>>::iterator j = values.begin(); j != values.end(); ++j)
+				{
+					FrameValue frameValue;
+					frameValue.id = j->first;
+					frameValue.key = GD::parameterKeys.intern(j->first);
+					frameValue.channels.insert(frameValue.channels.end(), j->second.first.begin(), j->second.first.end());
+					frameValue.value = j->second.second;
+					currentFrameValues.values.push_back(frameValue);
+				}
+				currentFrameValues.valueCount = currentFrameValues.values.size();
+				frameValues.frames.push_back(currentFrameValues);
+				frameValues.size++;
+			} while(++i != range.second && i != _rpcDevice->packetsByMessageType.end());
+		}
+		catch(const std::exception& ex)
+	    {
+	    	GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	    }
+	    catch(BaseLib::Exception& ex)
+	    {
+	    	GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	    }
+	    catch(...)
+	    {
+	    	GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	    }
+	}
+
+	void BidCoSPeer::checkFrameValues(std::shared_ptr<BidCoSPacket> packet, FrameValuesBuffer& frameValues)
+	{
+		try
+		{
+			FrameValuesBuffer expectedFrameValues;
+			getValuesFromPacketGeneric(packet, expectedFrameValues);
+			std::string difference;
+			if(expectedFrameValues.size != frameValues.size) difference = "Expected " + std::to_string(expectedFrameValues.size) + " frames, got " + std::to_string(frameValues.size) + ".";
+			for(uint32_t i = 0; i < frameValues.size && difference.empty(); i++)
+			{
+				FrameValues& expected = expectedFrameValues.frames[i];
+				FrameValues& actual = frameValues.frames[i];
+				if(expected.frameID != actual.frameID || expected.paramsetChannels != actual.paramsetChannels || expected.parameterSetType != actual.parameterSetType)
+				{
+					difference = "Frame " + actual.frameID + " differs (expected frame " + expected.frameID + ").";
+					break;
+				}
+				//Unused slots of the frame decoder are skipped. Channels are compared sorted, as the generic decoder stores them in a set.
+				uint32_t expectedIndex = 0;
+				for(uint32_t j = 0; j < actual.valueCount; j++)
+				{
+					FrameValue& value = actual.values[j];
+					if(value.channels.empty()) continue;
+					std::vector<uint32_t> channels(value.channels);
+					std::sort(channels.begin(), channels.end());
+					if(expectedIndex >= expected.valueCount || expected.values[expectedIndex].id != value.id || expected.values[expectedIndex].channels != channels || expected.values[expectedIndex].value != value.value)
+					{
+						difference = "Value " + value.id + " of frame " + actual.frameID + " differs.";
+						break;
+					}
+					expectedIndex++;
+				}
+				if(difference.empty() && expectedIndex != expected.valueCount) difference = "Frame " + actual.frameID + " is missing values.";
+			}
+			if(!difference.empty()) GD::out.printWarning("Warning: Frame decoder of peer " + std::to_string(_peerID) + " decoded packet " + packet->hexString() + " differently: " + difference);
+		}
+		catch(const std::exception& ex)
+	    {
+	    	GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	    }
+	    catch(BaseLib::Exception& ex)
+	    {
+	    	GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	    }
+	    catch(...)
+	    {
+	    	GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	    }
+	}
+
+
+	/**
+	 * Compares the output of getValuesFromPacket() with the output of getValuesFromPacketGeneric().
+	 *
+	 * @return Returns an empty string when both are equal and a description of the first difference otherwise.
+	 */
+	std::string compare(FrameValuesBuffer& expectedFrameValues, FrameValuesBuffer& frameValues)
+	{
+		if(expectedFrameValues.size != frameValues.size) return "Expected " + std::to_string(expectedFrameValues.size) + " frames, got " + std::to_string(frameValues.size) + ".";
+		for(uint32_t i = 0; i < frameValues.size; i++)
+		{
+			FrameValues& expected = expectedFrameValues.frames[i];
+			FrameValues& actual = frameValues.frames[i];
+			if(expected.frameID != actual.frameID || expected.paramsetChannels != actual.paramsetChannels || expected.parameterSetType != actual.parameterSetType)
+			{
+				return "Frame " + actual.frameID + " differs (expected frame " + expected.frameID + ").";
+			}
+			//Unused slots of the frame decoder are skipped. Channels are compared sorted, as the generic decoder stores them in a set.
+			uint32_t expectedIndex = 0;
+			for(uint32_t j = 0; j < actual.valueCount; j++)
+			{
+				FrameValue& value = actual.values[j];
+				if(value.channels.empty()) continue;
+				std::vector<uint32_t> channels(value.channels);
+				std::sort(channels.begin(), channels.end());
+				if(expectedIndex >= expected.valueCount || expected.values[expectedIndex].id != value.id || expected.values[expectedIndex].channels != channels || expected.values[expectedIndex].value != value.value)
+				{
+					return "Value " + value.id + " of frame " + actual.frameID + " differs.";
+				}
+				expectedIndex++;
+			}
+			if(expectedIndex != expected.valueCount) return "Frame " + actual.frameID + " is missing values.";
+		}
+		return "";
+	}
+};
+
+}
+
+int main(int argc, char* argv[])
+{
+	if(argc != 4)
+	{
+		std::cerr << "Usage: " << argv[0] << " DEVICE_DESCRIPTION PEER_ADDRESS RECORDED_PACKETS" << std::endl;
+		return 2;
+	}
+
+	BaseLib::SharedObjects bl;
+	GD::bl = &bl;
+	GD::out.init(&bl);
+
+	bool oldFormat = false;
+	PHomegearDevice rpcDevice(new HomegearDevice(&bl, std::string(argv[1]), oldFormat));
+	if(!rpcDevice->loaded())
+	{
+		std::cerr << "Could not load device description " << argv[1] << "." << std::endl;
+		return 2;
+	}
+	std::shared_ptr<ReplayPeer> peer(new ReplayPeer(BaseLib::Math::getNumber(std::string(argv[2]), true), rpcDevice));
+
+	std::vector<std::shared_ptr<BidCoSPacket>> packets;
+	std::ifstream recordedPackets(argv[3]);
+	std::string line;
+	while(std::getline(recordedPackets, line))
+	{
+		BaseLib::HelperFunctions::trim(line);
+		if(line.empty() || line.front() == '#') continue;
+		std::shared_ptr<BidCoSPacket> packet(new BidCoSPacket(line));
+		if(packet->length() > 0) packets.push_back(packet);
+	}
+	if(packets.empty())
+	{
+		std::cerr << "No packets found in " << argv[3] << "." << std::endl;
+		return 2;
+	}
+
+	FrameValuesBuffer frameValues;
+	FrameValuesBuffer expectedFrameValues;
+	uint32_t mismatches = 0;
+	uint32_t decodedPackets = 0;
+	for(std::vector<std::shared_ptr<BidCoSPacket>>::iterator i = packets.begin(); i != packets.end(); ++i)
+	{
+		peer->getValuesFromPacket(*i, frameValues);
+		peer->getValuesFromPacketGeneric(*i, expectedFrameValues);
+		if(expectedFrameValues.size > 0) decodedPackets++;
+		std::string difference = peer->compare(expectedFrameValues, frameValues);
+		if(difference.empty()) continue;
+		mismatches++;
+		std::cout << "Packet " << (*i)->hexString() << " is decoded differently: " << difference << std::endl;
+	}
+	std::cout << packets.size() << " packets, " << decodedPackets << " with frames, " << mismatches << " decoded differently." << std::endl;
+
+	const uint32_t repetitions = 100;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for(uint32_t i = 0; i < repetitions; i++)
+	{
+		for(std::vector<std::shared_ptr<BidCoSPacket>>::iterator j = packets.begin(); j != packets.end(); ++j) peer->getValuesFromPacketGeneric(*j, expectedFrameValues);
+	}
+	double generic = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / (repetitions * packets.size());
+
+	start = std::chrono::steady_clock::now();
+	for(uint32_t i = 0; i < repetitions; i++)
+	{
+		for(std::vector<std::shared_ptr<BidCoSPacket>>::iterator j = packets.begin(); j != packets.end(); ++j) peer->getValuesFromPacket(*j, frameValues);
+	}
+	double decoder = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / (repetitions * packets.size());
+
+	std::cout << "Generic: " << generic << " ns per packet, frame decoder: " << decoder << " ns per packet" << std::endl;
+
+	return mismatches == 0 ? 0 : 1;
+}
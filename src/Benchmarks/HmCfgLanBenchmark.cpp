@@ -0,0 +1,126 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Homegear.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+
+#include "../GD.h"
+#include "../BidCoSPacket.h"
+#include "../PhysicalInterfaces/HM-CFG-LAN.h"
+
+#include <chrono>
+#include <iostream>
+#include <random>
+
+//Compares the in-place parsing of received HM-CFG-LAN lines with the string based parsing it replaced and measures both.
+//Run with "make bench". Returns 1 if any packet is decoded differently.
+
+using namespace BidCoS;
+
+namespace
+{
+
+int32_t toCc1101Rssi(int32_t rssi)
+{
+	if(rssi <= -75) return ((rssi + 74) * 2) + 256;
+	return (rssi + 74) * 2;
+}
+
+//The previous implementation of HM_CFG_LAN::parsePacket for "E" and "R" lines.
+std::shared_ptr<BidCoSPacket> parseWithStrings(BaseLib::SharedObjects& bl, std::string& line)
+{
+	std::vector<std::string> parts = BaseLib::HelperFunctions::splitAll(line, ',');
+	if(parts.size() < 6 || parts.at(5).size() <= 18) return std::shared_ptr<BidCoSPacket>();
+	volatile int32_t statusAndControlByte = BaseLib::Math::getNumber(parts.at(1), true);
+	(void)statusAndControlByte;
+	std::vector<uint8_t> binaryPacket({ (uint8_t)(parts.at(5).size() / 2) });
+	bl.hf.getUBinary(parts.at(5), parts.at(5).size() - 1, binaryPacket);
+	binaryPacket.push_back(toCc1101Rssi(BaseLib::Math::getNumber(parts.at(4), true)));
+	return std::shared_ptr<BidCoSPacket>(new BidCoSPacket(binaryPacket, true, 0));
+}
+
+//The current implementation of HM_CFG_LAN::parsePacket for "E" and "R" lines.
+std::shared_ptr<BidCoSPacket> parseInPlace(const std::string& line)
+{
+	std::array<std::pair<const char*, uint32_t>, 8> fields;
+	uint32_t fieldCount = HM_CFG_LAN::splitFields(line.data(), line.size(), fields);
+	if(fieldCount < 6 || fields[5].second < 18) return std::shared_ptr<BidCoSPacket>();
+	volatile int32_t statusAndControlByte = HM_CFG_LAN::getHexNumber(fields[1].first, fields[1].second);
+	(void)statusAndControlByte;
+	std::shared_ptr<BidCoSPacket> packet(new BidCoSPacket());
+	if(!packet->importWithoutLengthByte(fields[5].first, fields[5].second, (uint8_t)toCc1101Rssi(HM_CFG_LAN::getHexNumber(fields[4].first, fields[4].second)))) return std::shared_ptr<BidCoSPacket>();
+	return packet;
+}
+
+}
+
+int main()
+{
+	BaseLib::SharedObjects bl;
+	GD::bl = &bl;
+	GD::out.init(&bl);
+
+	//Lines look like "E1A2B3C,0000,0012AB34,FF,-4B,0A8410..." followed by "\r" as they are passed to parsePacket.
+	std::mt19937 random(1);
+	std::vector<std::string> lines;
+	lines.reserve(20000);
+	for(uint32_t i = 0; i < 20000; i++)
+	{
+		std::string packetHex = BaseLib::HelperFunctions::getHexString((int32_t)(random() & 0xFFFFFF), 6);
+		uint32_t length = 10 + (random() % 20);
+		std::vector<uint8_t> packet(length);
+		for(std::vector<uint8_t>::iterator j = packet.begin(); j != packet.end(); ++j) *j = random();
+		lines.push_back("E" + packetHex + ",0000," + BaseLib::HelperFunctions::getHexString((int32_t)random(), 8) + ",FF,-" + BaseLib::HelperFunctions::getHexString((int32_t)(random() % 120), 2) + "," + BaseLib::HelperFunctions::getHexString(packet) + "\r");
+	}
+
+	uint32_t mismatches = 0;
+	for(std::vector<std::string>::iterator i = lines.begin(); i != lines.end(); ++i)
+	{
+		std::shared_ptr<BidCoSPacket> expected = parseWithStrings(bl, *i);
+		std::shared_ptr<BidCoSPacket> actual = parseInPlace(*i);
+		if(!expected || !actual || expected->hexString() != actual->hexString() || expected->rssiDevice() != actual->rssiDevice()) mismatches++;
+	}
+	std::cout << "Decoding mismatches: " << mismatches << std::endl;
+
+	const uint32_t repetitions = 10;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for(uint32_t i = 0; i < repetitions; i++)
+	{
+		for(std::vector<std::string>::iterator j = lines.begin(); j != lines.end(); ++j) parseWithStrings(bl, *j);
+	}
+	double previous = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / (repetitions * lines.size());
+
+	start = std::chrono::steady_clock::now();
+	for(uint32_t i = 0; i < repetitions; i++)
+	{
+		for(std::vector<std::string>::iterator j = lines.begin(); j != lines.end(); ++j) parseInPlace(*j);
+	}
+	double current = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / (repetitions * lines.size());
+
+	std::cout << "Previous: " << previous << " ns per line, in place: " << current << " ns per line" << std::endl;
+
+	return mismatches == 0 ? 0 : 1;
+}
@@ -45,6 +45,8 @@ BidCoS::BidCoS(BaseLib::SharedObjects* bl, BaseLib::Systems::IFamilyEventSink* e
 	GD::out.setPrefix("Module HomeMatic BidCoS: ");
 	GD::out.printDebug("Debug: Loading module...");
 	_physicalInterfaces.reset(new Interfaces(bl, _settings->getPhysicalInterfaceSettings()));
+	GD::queueScheduler.reset(new BidCoSQueueScheduler());
+	GD::dutyCycleTimer.reset(new BidCoSDutyCycleTimer());
 }
 
 BidCoS::~BidCoS()
@@ -57,6 +59,9 @@ void BidCoS::dispose()
 	if(_disposed) return;
 	DeviceFamily::dispose();
 
+	//Not reset, as queues and virtual peers still existing call cancel() on destruction
+	GD::queueScheduler->dispose();
+	GD::dutyCycleTimer->dispose();
 	GD::physicalInterfaces.clear();
 	GD::defaultPhysicalInterface.reset();
 }
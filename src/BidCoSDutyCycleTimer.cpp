@@ -0,0 +1,502 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Homegear.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+
+#include "BidCoSDutyCycleTimer.h"
+#include "GD.h"
+
+#include <time.h>
+
+namespace BidCoS
+{
+const std::array<int64_t, 10> BidCoSDutyCycleTimer::_errorBounds{ { 10, 25, 50, 100, 250, 500, 1000, 2500, 5000, 10000 } };
+
+BidCoSDutyCycleTimer::BidCoSDutyCycleTimer()
+{
+	try
+	{
+		_disposing = false;
+		_stopTimerThread = false;
+		_tasksExecuted = 0;
+		_savesExecuted = 0;
+		_errors.fill(0);
+		_nextSaveTime = getMonotonicTime() + _saveInterval;
+		GD::bl->threadManager.start(_timerThread, true, 44, SCHED_FIFO, &BidCoSDutyCycleTimer::timerThread, this);
+		GD::bl->threadManager.start(_taskWorkerThread, true, GD::bl->settings.workerThreadPriority(), GD::bl->settings.workerThreadPolicy(), &BidCoSDutyCycleTimer::taskWorkerThread, this);
+		GD::bl->threadManager.start(_saveWorkerThread, true, &BidCoSDutyCycleTimer::saveWorkerThread, this);
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+}
+
+BidCoSDutyCycleTimer::~BidCoSDutyCycleTimer()
+{
+	try
+	{
+		dispose();
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+}
+
+void BidCoSDutyCycleTimer::dispose()
+{
+	try
+	{
+		{
+			std::lock_guard<std::mutex> tasksGuard(_tasksMutex);
+			if(_disposing) return;
+			_disposing = true;
+			_stopTimerThread = true;
+		}
+		_tasksConditionVariable.notify_all();
+		_workConditionVariable.notify_all();
+		_savesConditionVariable.notify_all();
+		GD::bl->threadManager.join(_timerThread);
+		GD::bl->threadManager.join(_taskWorkerThread);
+		GD::bl->threadManager.join(_saveWorkerThread);
+		std::unique_lock<std::mutex> tasksGuard(_tasksMutex);
+		_tasks.clear();
+		_taskIterators.clear();
+		_work.clear();
+		//Owners still existing didn't call cancel() yet, so their variables are still safe to save.
+		executeSaves(tasksGuard);
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+	_taskFinishedConditionVariable.notify_all();
+}
+
+int64_t BidCoSDutyCycleTimer::getMonotonicTime()
+{
+	struct timespec time;
+	clock_gettime(CLOCK_MONOTONIC, &time);
+	return ((int64_t)time.tv_sec * 1000000000) + time.tv_nsec;
+}
+
+bool BidCoSDutyCycleTimer::schedule(void* owner, int64_t time, std::function<void()> task)
+{
+	try
+	{
+		if(!task) return false;
+		//The deadline is converted once, so changes of the system time after scheduling don't move it.
+		int64_t now = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+		int64_t deadline = getMonotonicTime() + ((time - now) * 1000);
+		{
+			std::lock_guard<std::mutex> tasksGuard(_tasksMutex);
+			if(_disposing) return false;
+			std::unordered_map<void*, std::multimap<int64_t, Task>::iterator>::iterator taskIterator = _taskIterators.find(owner);
+			if(taskIterator != _taskIterators.end())
+			{
+				_tasks.erase(taskIterator->second);
+				_taskIterators.erase(taskIterator);
+			}
+			Task entry;
+			entry.owner = owner;
+			entry.function = std::move(task);
+			_taskIterators[owner] = _tasks.insert(std::pair<int64_t, Task>(deadline, std::move(entry)));
+		}
+		_tasksConditionVariable.notify_one();
+		return true;
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+	return false;
+}
+
+void BidCoSDutyCycleTimer::save(void* owner, std::function<void()> save)
+{
+	try
+	{
+		if(!save) return;
+		{
+			std::lock_guard<std::mutex> tasksGuard(_tasksMutex);
+			if(!_disposing)
+			{
+				_saves[owner] = std::move(save);
+				save = std::function<void()>();
+			}
+		}
+		if(save) save();
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+}
+
+void BidCoSDutyCycleTimer::cancel(void* owner)
+{
+	try
+	{
+		std::function<void()> save;
+		{
+			std::unique_lock<std::mutex> tasksGuard(_tasksMutex);
+			//Don't wait when the owner is disposed from within one of its own tasks.
+			while(isRunning(owner)) _taskFinishedConditionVariable.wait(tasksGuard);
+			//Removed after waiting, as the running task might have scheduled the next one.
+			std::unordered_map<void*, std::multimap<int64_t, Task>::iterator>::iterator taskIterator = _taskIterators.find(owner);
+			if(taskIterator != _taskIterators.end())
+			{
+				_tasks.erase(taskIterator->second);
+				_taskIterators.erase(taskIterator);
+			}
+			for(std::deque<Task>::iterator i = _work.begin(); i != _work.end();)
+			{
+				if(i->owner == owner) i = _work.erase(i);
+				else ++i;
+			}
+			std::map<void*, std::function<void()>>::iterator saveIterator = _saves.find(owner);
+			if(saveIterator != _saves.end())
+			{
+				save = std::move(saveIterator->second);
+				_saves.erase(saveIterator);
+			}
+		}
+		if(save)
+		{
+			save();
+			_savesExecuted++;
+		}
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+}
+
+BidCoSDutyCycleTimerStatistics BidCoSDutyCycleTimer::getStatistics()
+{
+	BidCoSDutyCycleTimerStatistics statistics;
+	try
+	{
+		{
+			std::lock_guard<std::mutex> tasksGuard(_tasksMutex);
+			statistics.tasksPending = _tasks.size() + _work.size();
+			statistics.variablesPending = _saves.size();
+		}
+		statistics.tasksExecuted = _tasksExecuted;
+		statistics.saves = _savesExecuted;
+
+		std::lock_guard<std::mutex> statisticsGuard(_statisticsMutex);
+		statistics.errorHistogram.reserve(_errors.size());
+		for(uint32_t i = 0; i < _errors.size(); i++)
+		{
+			statistics.errorHistogram.push_back(std::pair<int64_t, uint64_t>(i < _errorBounds.size() ? _errorBounds[i] : -1, _errors[i]));
+		}
+		statistics.maximumError = _maximumError;
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+	return statistics;
+}
+
+void BidCoSDutyCycleTimer::executeSaves(std::unique_lock<std::mutex>& tasksGuard)
+{
+	std::map<void*, std::function<void()>> saves;
+	saves.swap(_saves);
+	for(std::map<void*, std::function<void()>>::iterator i = saves.begin(); i != saves.end(); ++i)
+	{
+		_running.emplace(i->first, std::this_thread::get_id());
+	}
+	tasksGuard.unlock();
+
+	for(std::map<void*, std::function<void()>>::iterator i = saves.begin(); i != saves.end(); ++i)
+	{
+		try
+		{
+			i->second();
+		}
+		catch(const std::exception& ex)
+		{
+			GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+		}
+		catch(BaseLib::Exception& ex)
+		{
+			GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+		}
+		catch(...)
+		{
+			GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+		}
+		_savesExecuted++;
+	}
+
+	tasksGuard.lock();
+	for(std::map<void*, std::function<void()>>::iterator i = saves.begin(); i != saves.end(); ++i)
+	{
+		removeRunning(i->first);
+	}
+	_nextSaveTime = getMonotonicTime() + _saveInterval;
+	_taskFinishedConditionVariable.notify_all();
+}
+
+bool BidCoSDutyCycleTimer::isRunning(void* owner)
+{
+	std::pair<std::unordered_multimap<void*, std::thread::id>::iterator, std::unordered_multimap<void*, std::thread::id>::iterator> range = _running.equal_range(owner);
+	for(std::unordered_multimap<void*, std::thread::id>::iterator i = range.first; i != range.second; ++i)
+	{
+		if(i->second != std::this_thread::get_id()) return true;
+	}
+	return false;
+}
+
+void BidCoSDutyCycleTimer::removeRunning(void* owner)
+{
+	std::pair<std::unordered_multimap<void*, std::thread::id>::iterator, std::unordered_multimap<void*, std::thread::id>::iterator> range = _running.equal_range(owner);
+	for(std::unordered_multimap<void*, std::thread::id>::iterator i = range.first; i != range.second; ++i)
+	{
+		if(i->second == std::this_thread::get_id())
+		{
+			_running.erase(i);
+			return;
+		}
+	}
+}
+
+void BidCoSDutyCycleTimer::timerThread()
+{
+	while(!_stopTimerThread)
+	{
+		try
+		{
+			std::unique_lock<std::mutex> tasksGuard(_tasksMutex);
+			if(_stopTimerThread) break;
+			int64_t now = getMonotonicTime();
+			std::multimap<int64_t, Task>::iterator taskIterator = _tasks.begin();
+			if(taskIterator == _tasks.end())
+			{
+				_tasksConditionVariable.wait(tasksGuard);
+				continue;
+			}
+			if(taskIterator->first - now > _approachTime)
+			{
+				_tasksConditionVariable.wait_for(tasksGuard, std::chrono::nanoseconds(taskIterator->first - _approachTime - now));
+				continue;
+			}
+
+			Task task = std::move(taskIterator->second);
+			task.deadline = taskIterator->first;
+			_taskIterators.erase(task.owner);
+			_tasks.erase(taskIterator);
+			//cancel() waits until the task is passed to the worker.
+			_running.emplace(task.owner, std::this_thread::get_id());
+			tasksGuard.unlock();
+
+			//Sleep until the absolute deadline, so time spent since waking up doesn't add to the error.
+			struct timespec deadlineTime;
+			deadlineTime.tv_sec = task.deadline / 1000000000;
+			deadlineTime.tv_nsec = task.deadline % 1000000000;
+			while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadlineTime, nullptr) == EINTR);
+
+			tasksGuard.lock();
+			removeRunning(task.owner);
+			_work.push_back(std::move(task));
+			tasksGuard.unlock();
+			_workConditionVariable.notify_one();
+			_taskFinishedConditionVariable.notify_all();
+		}
+		catch(const std::exception& ex)
+		{
+			GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+		}
+		catch(BaseLib::Exception& ex)
+		{
+			GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+		}
+		catch(...)
+		{
+			GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+		}
+	}
+}
+
+void BidCoSDutyCycleTimer::taskWorkerThread()
+{
+	while(!_stopTimerThread)
+	{
+		try
+		{
+			std::unique_lock<std::mutex> tasksGuard(_tasksMutex);
+			if(_work.empty())
+			{
+				if(!_stopTimerThread) _workConditionVariable.wait(tasksGuard);
+				continue;
+			}
+			Task task = std::move(_work.front());
+			_work.pop_front();
+			_running.emplace(task.owner, std::this_thread::get_id());
+			tasksGuard.unlock();
+
+			//Measured here, so the histogram includes the time the task waited for the worker.
+			int64_t error = (getMonotonicTime() - task.deadline) / 1000;
+			if(error < 0) error = 0;
+			uint32_t bucket = 0;
+			while(bucket < _errorBounds.size() && error >= _errorBounds[bucket]) bucket++;
+			{
+				std::lock_guard<std::mutex> statisticsGuard(_statisticsMutex);
+				_errors[bucket]++;
+				if(error > _maximumError) _maximumError = error;
+			}
+
+			try
+			{
+				task.function();
+			}
+			catch(const std::exception& ex)
+			{
+				GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+			}
+			catch(BaseLib::Exception& ex)
+			{
+				GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+			}
+			catch(...)
+			{
+				GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+			}
+			_tasksExecuted++;
+
+			tasksGuard.lock();
+			removeRunning(task.owner);
+			tasksGuard.unlock();
+			_taskFinishedConditionVariable.notify_all();
+		}
+		catch(const std::exception& ex)
+		{
+			GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+		}
+		catch(BaseLib::Exception& ex)
+		{
+			GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+		}
+		catch(...)
+		{
+			GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+		}
+	}
+}
+
+void BidCoSDutyCycleTimer::saveWorkerThread()
+{
+	while(!_stopTimerThread)
+	{
+		try
+		{
+			std::unique_lock<std::mutex> tasksGuard(_tasksMutex);
+			if(_stopTimerThread) break;
+			int64_t now = getMonotonicTime();
+			if(_saves.empty() || now < _nextSaveTime)
+			{
+				_savesConditionVariable.wait_for(tasksGuard, std::chrono::nanoseconds(_saves.empty() ? _saveInterval : _nextSaveTime - now));
+				continue;
+			}
+			executeSaves(tasksGuard);
+		}
+		catch(const std::exception& ex)
+		{
+			GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+		}
+		catch(BaseLib::Exception& ex)
+		{
+			GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+		}
+		catch(...)
+		{
+			GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+		}
+	}
+}
+
+}
@@ -0,0 +1,182 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Homegear.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+
+#ifndef BIDCOSDUTYCYCLETIMER_H_
+#define BIDCOSDUTYCYCLETIMER_H_
+
+#include <homegear-base/BaseLib.h>
+
+#include <array>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+namespace BidCoS
+{
+
+class BidCoSDutyCycleTimerStatistics
+{
+public:
+	BidCoSDutyCycleTimerStatistics() {}
+	virtual ~BidCoSDutyCycleTimerStatistics() {}
+
+	uint64_t tasksPending = 0;
+	uint64_t tasksExecuted = 0;
+	uint64_t variablesPending = 0;
+	uint64_t saves = 0;
+
+	/**
+	 * Difference between the time a task was executed and the time it was scheduled for. The first element is the upper bound of the bucket
+	 * in microseconds, the last bucket's upper bound is -1.
+	 */
+	std::vector<std::pair<int64_t, uint64_t>> errorHistogram;
+	int64_t maximumError = 0;
+};
+
+/**
+ * Executes time critical tasks of virtual peers (the duty cycle packets of HM-CC-TC). A real time thread sleeps until the absolute deadline
+ * of the next task on the monotonic clock and then passes the task to a worker thread with normal priority. That way sending time doesn't
+ * depend on how long the preceding steps took, but a slow interface can't block the real time thread. Variables of the owners are saved in
+ * batches on a second worker thread, so the database doesn't delay tasks.
+ */
+class BidCoSDutyCycleTimer
+{
+public:
+	BidCoSDutyCycleTimer();
+	virtual ~BidCoSDutyCycleTimer();
+
+	/**
+	 * Stops the timer thread. Tasks scheduled afterwards are rejected.
+	 */
+	void dispose();
+
+	/**
+	 * Schedules a task. Every owner has at most one pending task, so scheduling replaces the pending task of the owner.
+	 *
+	 * @param owner The object the task belongs to.
+	 * @param time The time to execute the task at in microseconds since the epoch.
+	 * @param task The function to execute. It is executed on the task worker thread. Tasks of all owners share this thread, so it should return quickly.
+	 * @return Returns false when the timer is disposing.
+	 */
+	bool schedule(void* owner, int64_t time, std::function<void()> task);
+
+	/**
+	 * Requests saving the variables of an owner. "save" is called on the save worker thread at most once per save interval. A pending request
+	 * of the owner is replaced.
+	 */
+	void save(void* owner, std::function<void()> save);
+
+	/**
+	 * Removes the pending task of an owner and waits for a running task or save of the owner to finish. A pending save is executed on the
+	 * calling thread. Has to be called before the owner is destroyed.
+	 */
+	void cancel(void* owner);
+
+	BidCoSDutyCycleTimerStatistics getStatistics();
+protected:
+	class Task
+	{
+	public:
+		void* owner = nullptr;
+		std::function<void()> function;
+
+		/**
+		 * The deadline in nanoseconds on the monotonic clock.
+		 */
+		int64_t deadline = 0;
+	};
+
+	/**
+	 * Time in nanoseconds before a deadline the thread stops waiting for new tasks and sleeps until the deadline.
+	 */
+	static const int64_t _approachTime = 5000000;
+
+	/**
+	 * Minimum time in nanoseconds between two saves.
+	 */
+	static const int64_t _saveInterval = 60000000000;
+	static const std::array<int64_t, 10> _errorBounds;
+
+	std::atomic_bool _disposing;
+	std::atomic_bool _stopTimerThread;
+	std::thread _timerThread;
+	std::thread _taskWorkerThread;
+	std::thread _saveWorkerThread;
+	std::mutex _tasksMutex;
+	std::condition_variable _tasksConditionVariable;
+	std::condition_variable _workConditionVariable;
+	std::condition_variable _savesConditionVariable;
+	std::condition_variable _taskFinishedConditionVariable;
+
+	/**
+	 * Tasks by deadline in nanoseconds on the monotonic clock.
+	 */
+	std::multimap<int64_t, Task> _tasks;
+	std::unordered_map<void*, std::multimap<int64_t, Task>::iterator> _taskIterators;
+
+	/**
+	 * Due tasks passed to the task worker thread.
+	 */
+	std::deque<Task> _work;
+	std::map<void*, std::function<void()>> _saves;
+	int64_t _nextSaveTime = 0;
+
+	/**
+	 * The owners whose task or save is executed right now and the executing threads. The timer thread adds an owner while it sleeps until the
+	 * deadline of its task.
+	 */
+	std::unordered_multimap<void*, std::thread::id> _running;
+
+	std::atomic<uint64_t> _tasksExecuted;
+	std::atomic<uint64_t> _savesExecuted;
+	std::mutex _statisticsMutex;
+	std::array<uint64_t, 11> _errors;
+	int64_t _maximumError = 0;
+
+	static int64_t getMonotonicTime();
+	void timerThread();
+	void taskWorkerThread();
+	void saveWorkerThread();
+
+	/**
+	 * Returns true when a task or save of the owner is executed by another thread than the calling one. _tasksMutex has to be locked.
+	 */
+	bool isRunning(void* owner);
+	void removeRunning(void* owner);
+	void executeSaves(std::unique_lock<std::mutex>& tasksGuard);
+};
+
+}
+#endif
@@ -0,0 +1,250 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Homegear.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+
+#include "BidCoSFrameDecoder.h"
+#include "GD.h"
+
+using namespace BaseLib::DeviceDescription;
+
+namespace BidCoS
+{
+namespace
+{
+	//Same as BaseLib::Systems::Packet::_bitmask
+	const uint8_t bitmask[9] = {0xFF, 1, 3, 7, 15, 31, 63, 127, 255};
+}
+
+BidCoSFrameDecoder::BidCoSFrameDecoder(BaseLib::SharedObjects* bl, BaseLib::DeviceDescription::PHomegearDevice device) : _bl(bl), _device(device)
+{
+	_frameIndexByMessageType.fill(-1);
+	compile();
+}
+
+bool BidCoSFrameDecoder::compilePosition(double index, double size, Position& position)
+{
+	//Mirrors BidCoSPacket::getPosition() with mask -1. Invalid positions return 0 as getPosition() does.
+	position = Position();
+	if(size < 0 || index < 0) return false;
+	if(index < 9)
+	{
+		if(size > 0.8) return false;
+		position.source = Position::Source::header;
+		position.headerIndex = std::lround(std::floor(index));
+		position.shift = std::lround(index * 10) % 10;
+		position.mask = bitmask[std::lround(size * 10)];
+		return true;
+	}
+	index -= 9;
+	double byteIndex = std::floor(index);
+	position.byteIndex = byteIndex;
+	if(byteIndex != index || size < 0.8)
+	{
+		if(size > 1) return false;
+		uint32_t bitSize = std::lround(size * 10);
+		if(bitSize > 8) bitSize = 8;
+		position.source = Position::Source::payloadBits;
+		position.shift = std::lround(index * 10) % 10;
+		position.mask = bitmask[bitSize];
+	}
+	else
+	{
+		uint32_t bitSize = std::lround(size * 10) % 10;
+		if(bitSize > 8) bitSize = 8;
+		position.source = Position::Source::payloadBytes;
+		position.bytes = (uint32_t)std::ceil(size);
+		if(position.bytes == 0) position.bytes = 1;
+		position.mask = bitmask[bitSize];
+	}
+	return true;
+}
+
+void BidCoSFrameDecoder::compile()
+{
+	try
+	{
+		if(!_device) return;
+		_lastChannel = _device->functions.empty() ? -1 : (int32_t)_device->functions.rbegin()->first;
+
+		for(PacketsByMessageType::iterator i = _device->packetsByMessageType.begin(); i != _device->packetsByMessageType.end(); ++i)
+		{
+			PPacket packet = i->second;
+			if(!packet || i->first > 255) continue;
+
+			Frame frame;
+			frame.id = packet->id;
+			frame.direction = packet->direction;
+			if(packet->subtype > -1 && packet->subtypeIndex >= 9)
+			{
+				frame.subtypeIndex = packet->subtypeIndex - 9;
+				frame.subtype = (unsigned)packet->subtype;
+			}
+			if(packet->channelIndex >= 9) frame.channelIndex = packet->channelIndex - 9;
+			if(packet->channelSize < 1.0)
+			{
+				int32_t bits = std::lround(packet->channelSize * 10) % 10;
+				frame.maskChannel = true;
+				frame.channelMask = bits <= 8 ? (0xFF >> (8 - bits)) : 0xFF;
+			}
+			frame.fixedChannel = packet->channel;
+			frame.length = packet->length;
+
+			for(BinaryPayloads::iterator j = packet->binaryPayloads.begin(); j != packet->binaryPayloads.end(); ++j)
+			{
+				Payload payload;
+				if((*j)->size > 0 && (*j)->index > 0)
+				{
+					payload.hasPosition = true;
+					payload.payloadIndex = ((int32_t)(*j)->index) - 9;
+					if(!compilePosition((*j)->index, (*j)->size, payload.position)) GD::out.printWarning("Warning: Invalid binary payload position in frame " + packet->id + ": index " + std::to_string((*j)->index) + ", size " + std::to_string((*j)->size));
+					if((*j)->constValueInteger > -1)
+					{
+						payload.hasConstValue = true;
+						payload.constValue = (*j)->constValueInteger;
+					}
+				}
+				else if((*j)->constValueInteger > -1)
+				{
+					_bl->hf.memcpyBigEndian(payload.constData, (*j)->constValueInteger);
+				}
+				else continue;
+
+				for(std::vector<PParameter>::iterator k = packet->associatedVariables.begin(); k != packet->associatedVariables.end(); ++k)
+				{
+					if((*k)->physical->groupId != (*j)->parameterId) continue;
+					Variable variable;
+					variable.id = (*k)->id;
+					variable.key = GD::parameterKeys.intern(variable.id);
+					variable.parameterSetType = (*k)->parent()->type();
+					variable.channels.resize(_lastChannel + 1, Variable::unavailable);
+					for(Functions::iterator l = _device->functions.begin(); l != _device->functions.end(); ++l)
+					{
+						PFunction function = l->second;
+						if(!function) continue;
+						if(function->parameterGroupSelector && !function->alternativeFunctions.empty())
+						{
+							variable.channels.at(l->first) = Variable::resolveAtRuntime;
+							continue;
+						}
+						PParameterGroup parameterGroup = function->getParameterGroup(variable.parameterSetType);
+						if(parameterGroup && parameterGroup->parameters.find(variable.id) != parameterGroup->parameters.end()) variable.channels.at(l->first) = Variable::available;
+					}
+					payload.variables.push_back(variable);
+				}
+				frame.payloads.push_back(payload);
+			}
+
+			std::map<std::string, uint32_t> slots;
+			for(std::vector<Payload>::iterator j = frame.payloads.begin(); j != frame.payloads.end(); ++j)
+			{
+				for(std::vector<Variable>::iterator k = j->variables.begin(); k != j->variables.end(); ++k)
+				{
+					slots.emplace(k->id, 0);
+				}
+			}
+			for(std::map<std::string, uint32_t>::iterator j = slots.begin(); j != slots.end(); ++j)
+			{
+				j->second = frame.slotCount++;
+			}
+			for(std::vector<Payload>::iterator j = frame.payloads.begin(); j != frame.payloads.end(); ++j)
+			{
+				for(std::vector<Variable>::iterator k = j->variables.begin(); k != j->variables.end(); ++k)
+				{
+					k->slot = slots[k->id];
+				}
+			}
+
+			if(_frameIndexByMessageType[i->first] == -1)
+			{
+				_frameIndexByMessageType[i->first] = _frames.size();
+				_frames.push_back(std::vector<Frame>());
+			}
+			_frames[_frameIndexByMessageType[i->first]].push_back(frame);
+		}
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+}
+
+void BidCoSFrameDecoder::getValue(BidCoSPacket* packet, const Position& position, std::vector<uint8_t>& data)
+{
+	data.clear();
+	std::vector<uint8_t>* payload = packet->payload();
+	switch(position.source)
+	{
+	case Position::Source::header:
+		{
+			int32_t value = 0;
+			switch(position.headerIndex)
+			{
+			case 0: value = packet->messageCounter(); break;
+			case 1: value = packet->controlByte(); break;
+			case 2: value = packet->messageType(); break;
+			case 3: value = packet->senderAddress() >> 16; break;
+			case 4: value = packet->senderAddress() >> 8; break;
+			case 5: value = packet->senderAddress(); break;
+			case 6: value = packet->destinationAddress() >> 16; break;
+			case 7: value = packet->destinationAddress() >> 8; break;
+			default: value = packet->destinationAddress(); break;
+			}
+			data.push_back((value >> position.shift) & position.mask);
+		}
+		break;
+	case Position::Source::payloadBits:
+		if(position.byteIndex >= payload->size()) data.push_back(0);
+		else data.push_back((payload->at(position.byteIndex) >> position.shift) & position.mask);
+		break;
+	case Position::Source::payloadBytes:
+		if(position.byteIndex >= payload->size())
+		{
+			data.push_back(0);
+			break;
+		}
+		data.push_back(payload->at(position.byteIndex) & position.mask);
+		for(uint32_t i = 1; i < position.bytes; i++)
+		{
+			data.push_back((position.byteIndex + i) < payload->size() ? payload->at(position.byteIndex + i) : 0);
+		}
+		break;
+	default:
+		data.push_back(0);
+		break;
+	}
+}
+
+}
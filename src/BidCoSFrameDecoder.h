@@ -0,0 +1,166 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Homegear.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+
+#ifndef BIDCOSFRAMEDECODER_H_
+#define BIDCOSFRAMEDECODER_H_
+
+#include <homegear-base/BaseLib.h>
+#include "BidCoSPacket.h"
+
+#include <array>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace BidCoS
+{
+
+/**
+ * The frame descriptions of a device compiled into a form that can be applied to received packets without interpreting the device description.
+ * Byte offsets, shifts and masks of all values are calculated once with the same arithmetic BidCoSPacket::getPosition() uses. For every variable
+ * it is stored for which channels the variable exists in the parameter set. Channels with a parameter group selector depend on the peer's
+ * configuration and need to be resolved by the peer at runtime.
+ */
+class BidCoSFrameDecoder
+{
+public:
+	/**
+	 * Describes how to extract a value from a packet.
+	 */
+	class Position
+	{
+	public:
+		enum class Source { zero, header, payloadBits, payloadBytes };
+
+		Source source = Source::zero;
+		uint32_t headerIndex = 0;
+		uint32_t byteIndex = 0;
+		uint32_t shift = 0;
+		uint8_t mask = 0xFF;
+		uint32_t bytes = 1;
+	};
+
+	class Variable
+	{
+	public:
+		enum ChannelState : int8_t { unavailable = 0, available = 1, resolveAtRuntime = -1 };
+
+		std::string id;
+
+		/**
+		 * The interned ID, see BidCoSParameterKeys.
+		 */
+		uint32_t key = 0;
+
+		/**
+		 * The index of the variable's value within the values of the frame. Variables with the same ID share a slot. Slots are numbered in the
+		 * order of the IDs, so the values of a frame are processed in the same order as the values of a map.
+		 */
+		uint32_t slot = 0;
+		BaseLib::DeviceDescription::ParameterGroup::Type::Enum parameterSetType = BaseLib::DeviceDescription::ParameterGroup::Type::Enum::none;
+
+		/**
+		 * Indexed by channel.
+		 */
+		std::vector<int8_t> channels;
+	};
+
+	class Payload
+	{
+	public:
+		bool hasPosition = false;
+		int32_t payloadIndex = 0;
+		Position position;
+		bool hasConstValue = false;
+		int32_t constValue = -1;
+		std::vector<uint8_t> constData;
+		std::vector<Variable> variables;
+	};
+
+	class Frame
+	{
+	public:
+		std::string id;
+		BaseLib::DeviceDescription::Packet::Direction::Enum direction = BaseLib::DeviceDescription::Packet::Direction::Enum::none;
+		int32_t subtypeIndex = -1;
+		uint32_t subtype = 0;
+		int32_t channelIndex = -1;
+		bool maskChannel = false;
+		int32_t channelMask = 0xFF;
+		int32_t fixedChannel = -1;
+		int32_t length = 0;
+		std::vector<Payload> payloads;
+
+		/**
+		 * The number of distinct variable IDs of all payloads.
+		 */
+		uint32_t slotCount = 0;
+	};
+
+	BidCoSFrameDecoder(BaseLib::SharedObjects* bl, BaseLib::DeviceDescription::PHomegearDevice device);
+	virtual ~BidCoSFrameDecoder() {}
+
+	BaseLib::DeviceDescription::HomegearDevice* getDevice() { return _device.get(); }
+
+	/**
+	 * The highest channel of the device or -1 when the device has no functions.
+	 */
+	int32_t getLastChannel() { return _lastChannel; }
+
+	/**
+	 * Returns the frames with the given message type in the order of packetsByMessageType or nullptr.
+	 */
+	const std::vector<Frame>* getFrames(uint8_t messageType)
+	{
+		int32_t index = _frameIndexByMessageType[messageType];
+		return index == -1 ? nullptr : &_frames[index];
+	}
+
+	/**
+	 * Extracts a value from a packet. The result is identical to BidCoSPacket::getPosition(index, size, -1).
+	 *
+	 * @param packet The packet to extract the value from.
+	 * @param position The compiled position.
+	 * @param[out] data The extracted value. The vector is cleared first, so it can be reused for all values of a frame.
+	 */
+	static void getValue(BidCoSPacket* packet, const Position& position, std::vector<uint8_t>& data);
+protected:
+	BaseLib::SharedObjects* _bl = nullptr;
+	BaseLib::DeviceDescription::PHomegearDevice _device;
+	int32_t _lastChannel = -1;
+	std::array<int16_t, 256> _frameIndexByMessageType;
+	std::vector<std::vector<Frame>> _frames;
+
+	void compile();
+	bool compilePosition(double index, double size, Position& position);
+};
+
+}
+#endif
@@ -0,0 +1,208 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Homegear.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+
+#include "BidCoSFrameEncoder.h"
+#include "GD.h"
+
+using namespace BaseLib::DeviceDescription;
+
+namespace BidCoS
+{
+namespace
+{
+	//Same as BaseLib::Systems::Packet::_bitmask
+	const uint8_t bitmask[9] = {0xFF, 1, 3, 7, 15, 31, 63, 127, 255};
+}
+
+BidCoSFrameEncoder::BidCoSFrameEncoder(BaseLib::SharedObjects* bl, BaseLib::DeviceDescription::PHomegearDevice device) : _bl(bl), _device(device)
+{
+	compile();
+}
+
+bool BidCoSFrameEncoder::compileField(double index, double size, Field& field)
+{
+	//Mirrors BidCoSPacket::setPosition(). Positions setPosition() rejects are not compiled, so the generic way prints the error.
+	if(size < 0 || index < 9) return false;
+	index -= 9;
+	double byteIndex = std::floor(index);
+	field.byteIndex = byteIndex;
+	if(byteIndex != index || size < 0.8)
+	{
+		if(size > 1.0) return false;
+		field.partial = true;
+		field.shift = std::lround(index * 10) % 10;
+	}
+	else
+	{
+		uint32_t bitSize = std::lround(size * 10) % 10;
+		if(bitSize > 8) bitSize = 8;
+		field.bytes = (uint32_t)std::ceil(size);
+		//setPosition() assumes one byte for size 0 without growing the payload. Leave that to the generic way.
+		if(field.bytes == 0) return false;
+		field.mask = bitmask[bitSize];
+	}
+	return true;
+}
+
+bool BidCoSFrameEncoder::compileCommand(BaseLib::DeviceDescription::PParameter& parameter, Command& command)
+{
+	PacketsById::iterator packetIterator = _device->packetsById.find(parameter->setPackets.front()->id);
+	if(packetIterator == _device->packetsById.end() || !packetIterator->second) return false;
+	PPacket frame = packetIterator->second;
+	//Split frames (HM-Dis-WM55) result in several packets
+	if(frame->splitAfter > -1) return false;
+	command.frame = frame;
+	command.messageType = (uint8_t)frame->type;
+
+	std::vector<uint8_t>& payload = command.payload;
+	if(frame->subtype > -1 && frame->subtypeIndex >= 9)
+	{
+		payload.resize(frame->subtypeIndex - 8, 0);
+		payload.at(frame->subtypeIndex - 9) = (uint8_t)frame->subtype;
+	}
+	if(frame->channelIndex >= 9)
+	{
+		//The channel would overwrite the subtype.
+		if(frame->channelIndex == frame->subtypeIndex && frame->subtype > -1) return false;
+		if((signed)payload.size() < frame->channelIndex - 8) payload.resize(frame->channelIndex - 8, 0);
+		command.channelIndex = frame->channelIndex - 9;
+	}
+
+	ParameterGroup* parameterGroup = parameter->parent();
+	if(!parameterGroup) return false;
+	for(BinaryPayloads::iterator i = frame->binaryPayloads.begin(); i != frame->binaryPayloads.end(); ++i)
+	{
+		Field field;
+		if(!compileField((*i)->index, (*i)->size, field)) return false;
+		if((*i)->constValueInteger > -1)
+		{
+			std::vector<uint8_t> data;
+			_bl->hf.memcpyBigEndian(data, (*i)->constValueInteger);
+			setValue(payload, field, data);
+			continue;
+		}
+		else if(!(*i)->constValueString.empty())
+		{
+			std::vector<uint8_t> data((*i)->constValueString.begin(), (*i)->constValueString.end());
+			setValue(payload, field, data);
+			continue;
+		}
+
+		if((*i)->parameterId == "ON_TIME" && parameterGroup->parameters.find((*i)->parameterId) != parameterGroup->parameters.end())
+		{
+			field.source = Field::Source::onTime;
+			field.parameterId = (*i)->parameterId;
+			field.omitIfSet = (*i)->omitIfSet;
+			field.omitIf = (*i)->omitIf;
+			field.key = BidCoSParameterKeys::onTime;
+		}
+		else if((*i)->parameterId == parameter->physical->groupId) field.source = Field::Source::value;
+		else
+		{
+			field.source = Field::Source::parameter;
+			for(Parameters::iterator j = parameterGroup->parameters.begin(); j != parameterGroup->parameters.end(); ++j)
+			{
+				if(j->second && (*i)->parameterId == j->second->physical->groupId)
+				{
+					field.parameterId = j->first;
+					break;
+				}
+			}
+			if(field.parameterId.empty()) return false;
+			field.key = GD::parameterKeys.intern(field.parameterId);
+		}
+		command.fields.push_back(field);
+	}
+	return true;
+}
+
+void BidCoSFrameEncoder::compile()
+{
+	try
+	{
+		if(!_device) return;
+		for(Functions::iterator i = _device->functions.begin(); i != _device->functions.end(); ++i)
+		{
+			if(!i->second) continue;
+			PParameterGroup parameterGroup = i->second->getParameterGroup(ParameterGroup::Type::Enum::variables);
+			if(!parameterGroup) continue;
+			for(Parameters::iterator j = parameterGroup->parameters.begin(); j != parameterGroup->parameters.end(); ++j)
+			{
+				PParameter parameter = j->second;
+				//Channels of the same function share their parameters.
+				if(!parameter || parameter->setPackets.empty() || _commands.find(parameter.get()) != _commands.end()) continue;
+				if(parameter->physical->operationType != IPhysical::OperationType::Enum::command) continue;
+				Command command;
+				if(compileCommand(parameter, command)) _commands.emplace(parameter.get(), std::move(command));
+			}
+		}
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+}
+
+void BidCoSFrameEncoder::setValue(std::vector<uint8_t>& payload, const Field& field, const std::vector<uint8_t>& value)
+{
+	if(field.partial)
+	{
+		if(payload.size() <= field.byteIndex) payload.resize(field.byteIndex + 1, 0);
+		if(!value.empty()) payload[field.byteIndex] |= value.back() << field.shift;
+		return;
+	}
+	if(payload.size() < field.byteIndex + field.bytes) payload.resize(field.byteIndex + field.bytes, 0);
+	if(value.empty()) return;
+	if(field.bytes <= value.size())
+	{
+		payload[field.byteIndex] |= value[0] & field.mask;
+		for(uint32_t i = 1; i < field.bytes; i++)
+		{
+			payload[field.byteIndex + i] |= value[i];
+		}
+	}
+	else
+	{
+		uint32_t missingBytes = field.bytes - value.size();
+		for(uint32_t i = 0; i < value.size(); i++)
+		{
+			payload[field.byteIndex + missingBytes + i] |= value[i];
+		}
+	}
+}
+
+}
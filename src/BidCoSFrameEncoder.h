@@ -0,0 +1,123 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Homegear.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+
+#ifndef BIDCOSFRAMEENCODER_H_
+#define BIDCOSFRAMEENCODER_H_
+
+#include <homegear-base/BaseLib.h>
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace BidCoS
+{
+
+/**
+ * The set frames of a device's command parameters compiled into payload templates, so setValue() doesn't need to interpret the device
+ * description. The subtype and constant values are written into the template once. For all other values byte offsets, shifts and masks are
+ * calculated with the same arithmetic BidCoSPacket::setPosition() uses. Frames split into several packets are not compiled and need to be
+ * constructed the generic way.
+ */
+class BidCoSFrameEncoder
+{
+public:
+	/**
+	 * Describes where to write a value into the payload.
+	 */
+	class Field
+	{
+	public:
+		enum class Source { value, onTime, parameter };
+
+		Source source = Source::value;
+
+		/**
+		 * The ID of the parameter to write for Source::onTime and Source::parameter.
+		 */
+		std::string parameterId;
+
+		/**
+		 * The interned parameterId, see BidCoSParameterKeys.
+		 */
+		uint32_t key = 0;
+		bool partial = false;
+		uint32_t byteIndex = 0;
+		uint32_t shift = 0;
+		uint32_t bytes = 1;
+		uint8_t mask = 0xFF;
+		bool omitIfSet = false;
+		int32_t omitIf = 0;
+	};
+
+	class Command
+	{
+	public:
+		BaseLib::DeviceDescription::PPacket frame;
+		uint8_t messageType = 0;
+		int32_t channelIndex = -1;
+
+		/**
+		 * The payload with the subtype and all constant values set.
+		 */
+		std::vector<uint8_t> payload;
+		std::vector<Field> fields;
+	};
+
+	BidCoSFrameEncoder(BaseLib::SharedObjects* bl, BaseLib::DeviceDescription::PHomegearDevice device);
+	virtual ~BidCoSFrameEncoder() {}
+
+	BaseLib::DeviceDescription::HomegearDevice* getDevice() { return _device.get(); }
+
+	/**
+	 * Returns the compiled set frame of a parameter or nullptr, when the parameter has none or the packet has to be constructed the generic way.
+	 */
+	const Command* getCommand(BaseLib::DeviceDescription::Parameter* parameter)
+	{
+		std::unordered_map<BaseLib::DeviceDescription::Parameter*, Command>::const_iterator commandIterator = _commands.find(parameter);
+		return commandIterator == _commands.end() ? nullptr : &commandIterator->second;
+	}
+
+	/**
+	 * Writes a value into a payload. The result is identical to BidCoSPacket::setPosition().
+	 */
+	static void setValue(std::vector<uint8_t>& payload, const Field& field, const std::vector<uint8_t>& value);
+protected:
+	BaseLib::SharedObjects* _bl = nullptr;
+	BaseLib::DeviceDescription::PHomegearDevice _device;
+	std::unordered_map<BaseLib::DeviceDescription::Parameter*, Command> _commands;
+
+	void compile();
+	bool compileCommand(BaseLib::DeviceDescription::PParameter& parameter, Command& command);
+	bool compileField(double index, double size, Field& field);
+};
+
+}
+#endif
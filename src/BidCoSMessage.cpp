@@ -49,13 +49,12 @@ BidCoSMessage::~BidCoSMessage()
 {
 }
 
-void BidCoSMessage::invokeMessageHandler(std::shared_ptr<BidCoSPacket> packet)
+void BidCoSMessage::invokeMessageHandler(HomeMaticCentral* central, std::shared_ptr<BidCoSPacket> packet)
 {
 	try
 	{
-		std::shared_ptr<HomeMaticCentral> central(std::dynamic_pointer_cast<HomeMaticCentral>(GD::family->getCentral()));
 		if(!central || _messageHandler == nullptr || packet == nullptr) return;
-		((central.get())->*(_messageHandler))(packet->messageCounter(), packet);
+		(central->*(_messageHandler))(packet->messageCounter(), packet);
 	}
 	catch(const std::exception& ex)
 	{
@@ -160,11 +159,10 @@ bool BidCoSMessage::typeIsEqual(std::shared_ptr<BidCoSMessage> message, std::sha
 	return false;
 }
 
-bool BidCoSMessage::checkAccess(std::shared_ptr<BidCoSPacket> packet, std::shared_ptr<BidCoSQueue> queue)
+bool BidCoSMessage::checkAccess(HomeMaticCentral* central, std::shared_ptr<BidCoSPacket> packet, std::shared_ptr<BidCoSQueue> queue)
 {
 	try
 	{
-		std::shared_ptr<HomeMaticCentral> central(std::dynamic_pointer_cast<HomeMaticCentral>(GD::family->getCentral()));
 		if(!central || !packet) return false;
 
 		int32_t access = central->isInPairingMode() ? _accessPairing : _access;
@@ -60,8 +60,8 @@ class BidCoSMessage
         void setMessageAccess(int32_t access) { _access = access; }
         int32_t getMessageAccessPairing() { return _accessPairing; }
         void setMessageAccessPairing(int32_t accessPairing) { _accessPairing = accessPairing; }
-        void invokeMessageHandler(std::shared_ptr<BidCoSPacket> packet);
-        bool checkAccess(std::shared_ptr<BidCoSPacket> packet, std::shared_ptr<BidCoSQueue> queue);
+        void invokeMessageHandler(HomeMaticCentral* central, std::shared_ptr<BidCoSPacket> packet);
+        bool checkAccess(HomeMaticCentral* central, std::shared_ptr<BidCoSPacket> packet, std::shared_ptr<BidCoSQueue> queue);
         void setMessageCounter(std::shared_ptr<BidCoSPacket> packet);
         bool typeIsEqual(std::shared_ptr<BidCoSPacket> packet);
         bool typeIsEqual(std::shared_ptr<BidCoSMessage> message, std::shared_ptr<BidCoSPacket> packet);
@@ -36,7 +36,17 @@ void BidCoSMessages::add(std::shared_ptr<BidCoSMessage> message)
 {
 	try
 	{
-		_messages.push_back(message);
+		if(!message) return;
+		int32_t messageType = message->getMessageType();
+		if(messageType == -1)
+		{
+			if(!_matchAnyMessage) _matchAnyMessage = message;
+		}
+		else if(messageType >= 0 && messageType <= 255)
+		{
+			if(!_messagesByType[messageType]) _messagesByType[messageType] = message;
+		}
+		else GD::out.printError("Error: Could not register message. Message type is out of range: " + std::to_string(messageType));
 	}
 	catch(const std::exception& ex)
 	{
@@ -57,11 +67,7 @@ std::shared_ptr<BidCoSMessage> BidCoSMessages::find(std::shared_ptr<BidCoSPacket
 	try
 	{
 		if(!packet) return std::shared_ptr<BidCoSMessage>();
-		for(uint32_t i = 0; i < _messages.size(); i++)
-		{
-			if(_messages[i]->typeIsEqual(packet)) return _messages[i];
-		}
-		return std::shared_ptr<BidCoSMessage>();
+		return _messagesByType[packet->messageType()];
 	}
 	catch(const std::exception& ex)
 	{
@@ -82,10 +88,8 @@ std::shared_ptr<BidCoSMessage> BidCoSMessages::find(int32_t messageType)
 {
 	try
 	{
-		for(uint32_t i = 0; i < _messages.size(); i++)
-		{
-			if(_messages[i]->typeIsEqual(messageType)) return _messages[i];
-		}
+		if(messageType >= 0 && messageType <= 255 && _messagesByType[messageType]) return _messagesByType[messageType];
+		return _matchAnyMessage;
 	}
 	catch(const std::exception& ex)
 	{
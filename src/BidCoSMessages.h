@@ -34,7 +34,7 @@
 
 #include <iostream>
 #include <memory>
-#include <vector>
+#include <array>
 
 namespace BidCoS
 {
@@ -43,12 +43,25 @@ class BidCoSMessages
     public:
         BidCoSMessages() {}
         virtual ~BidCoSMessages() {}
+
+        /**
+         * Registers a message. Must only be called during setup, before packets are processed. The first message registered for a message type wins. Messages with message type -1 match any message type in find(int32_t).
+         */
         void add(std::shared_ptr<BidCoSMessage> message);
+
+        /**
+         * Returns the message registered for the packet's exact message type or nullptr.
+         */
         std::shared_ptr<BidCoSMessage> find(std::shared_ptr<BidCoSPacket> packet);
+
+        /**
+         * Returns the message registered for the message type. When there is none, the match-any message (message type -1) is returned if one is registered.
+         */
         std::shared_ptr<BidCoSMessage> find(int32_t messageType);
     protected:
     private:
-        std::vector<std::shared_ptr<BidCoSMessage>> _messages;
+        std::array<std::shared_ptr<BidCoSMessage>, 256> _messagesByType;
+        std::shared_ptr<BidCoSMessage> _matchAnyMessage;
 };
 }
 #endif
@@ -32,6 +32,26 @@
 
 namespace BidCoS
 {
+const int8_t BidCoSPacket::_hexDecodeTable[256] =
+{
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	 0,  1,  2,  3,  4,  5,  6,  7,  8,  9, -1, -1, -1, -1, -1, -1,
+	-1, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
+};
+
 //Properties
 std::string BidCoSPacket::hexString()
 {
@@ -226,45 +246,82 @@ void BidCoSPacket::import(std::vector<uint8_t>& packet, bool rssiByte)
 }
 
 //Packet looks like A...DATA...\r\n
-void BidCoSPacket::import(std::string& packet, bool removeFirstCharacter)
+bool BidCoSPacket::import(std::string& packet, bool removeFirstCharacter)
+{
+	return import(packet.data(), packet.size(), removeFirstCharacter);
+}
+
+bool BidCoSPacket::import(const char* packet, uint32_t size, bool removeFirstCharacter)
 {
 	try
 	{
+		if(!packet) return false;
 		uint32_t startIndex = removeFirstCharacter ? 1 : 0;
-		if(packet.size() < startIndex + 20)
+		if(size > 400)
 		{
-			GD::out.printError("Error: Packet is too short: " + packet);
-			return;
+			GD::out.printWarning("Warning: Tried to import BidCoS packet larger than 200 bytes.");
+			return false;
 		}
-		if(packet.size() > 400)
+		while(size > startIndex && (packet[size - 1] == '\n' || packet[size - 1] == '\r')) size--;
+		if(size < startIndex + 20)
 		{
-			GD::out.printWarning("Warning: Tried to import BidCoS packet larger than 200 bytes.");
-			return;
+			GD::out.printError("Error: Packet is too short: " + std::string(packet, size));
+			return false;
 		}
-		_length = getByte(packet.substr(startIndex, 2));
-		_messageCounter = getByte(packet.substr(startIndex + 2, 2));
-		_controlByte = getByte(packet.substr(startIndex + 4, 2));
-		_messageType = getByte(packet.substr(startIndex + 6, 2));
-		_senderAddress = getInt(packet.substr(startIndex + 8, 6));
-		_destinationAddress = getInt(packet.substr(startIndex + 14, 6));
+		const uint8_t* data = (const uint8_t*)packet + startIndex;
+		uint32_t dataSize = size - startIndex;
 
-		uint32_t tailLength = 0;
-		if(packet.back() == '\n') tailLength = 2;
-		uint32_t endIndex = startIndex + 2 + (_length * 2) - 1;
-		if(endIndex >= packet.size())
+		uint8_t header[10];
+		for(uint32_t i = 0; i < 10; i++)
 		{
-			GD::out.printWarning("Warning: Packet is shorter than value of packet length byte: " + packet);
-			endIndex = packet.size() - 1;
+			int32_t high = _hexDecodeTable[data[i * 2]];
+			int32_t low = _hexDecodeTable[data[(i * 2) + 1]];
+			if((high | low) < 0)
+			{
+				GD::out.printWarning("Warning: Packet contains invalid characters: " + std::string(packet, size));
+				return false;
+			}
+			header[i] = (high << 4) | low;
 		}
-		_payload.clear();
-		uint32_t i;
-		for(i = startIndex + 20; i < endIndex; i+=2)
+		_length = header[0];
+		_messageCounter = header[1];
+		_controlByte = header[2];
+		_messageType = header[3];
+		_senderAddress = (header[4] << 16) | (header[5] << 8) | header[6];
+		_destinationAddress = (header[7] << 16) | (header[8] << 8) | header[9];
+
+		uint32_t payloadEnd = 2 + (_length * 2);
+		if(payloadEnd > dataSize)
+		{
+			GD::out.printWarning("Warning: Packet is shorter than value of packet length byte: " + std::string(packet, size));
+			payloadEnd = dataSize;
+		}
+		uint32_t payloadSize = payloadEnd > 20 ? (payloadEnd - 20) / 2 : 0;
+		_payload.resize(payloadSize);
+		uint8_t* payload = _payload.data();
+		uint32_t i = 20;
+		for(uint32_t j = 0; j < payloadSize; j++, i += 2)
 		{
-			_payload.push_back(getByte(packet.substr(i, 2)));
+			int32_t high = _hexDecodeTable[data[i]];
+			int32_t low = _hexDecodeTable[data[i + 1]];
+			if((high | low) < 0)
+			{
+				_payload.clear();
+				GD::out.printWarning("Warning: Packet contains invalid characters: " + std::string(packet, size));
+				return false;
+			}
+			payload[j] = (high << 4) | low;
 		}
-		if(i < packet.size() - tailLength)
+		if(i + 1 < dataSize)
 		{
-			int32_t rssiDevice = getByte(packet.substr(i, 2));
+			int32_t high = _hexDecodeTable[data[i]];
+			int32_t low = _hexDecodeTable[data[i + 1]];
+			if((high | low) < 0)
+			{
+				GD::out.printWarning("Warning: Packet contains invalid characters: " + std::string(packet, size));
+				return false;
+			}
+			int32_t rssiDevice = (high << 4) | low;
 			//1) Read the RSSI status register
 			//2) Convert the reading from a hexadecimal
 			//number to a decimal number (RSSI_dec)
@@ -276,6 +333,7 @@ void BidCoSPacket::import(std::string& packet, bool removeFirstCharacter)
 			else rssiDevice = (rssiDevice / 2) - 74;
 			_rssiDevice = rssiDevice * -1;
 		}
+		return true;
 	}
 	catch(const std::exception& ex)
     {
@@ -289,38 +347,55 @@ void BidCoSPacket::import(std::string& packet, bool removeFirstCharacter)
     {
     	GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
     }
+    return false;
 }
 
-uint8_t BidCoSPacket::getByte(std::string hexString)
+bool BidCoSPacket::importWithoutLengthByte(const char* packet, uint32_t size, uint8_t rssiByte)
 {
 	try
 	{
-		uint8_t value = 0;
-		try	{ value = std::stoi(hexString, 0, 16); } catch(...) {}
-		return value;
-	}
-	catch(const std::exception& ex)
-    {
-    	GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
-    }
-    catch(BaseLib::Exception& ex)
-    {
-    	GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
-    }
-    catch(...)
-    {
-    	GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
-    }
-	return 0;
-}
+		if(!packet) return false;
+		if(size > 400)
+		{
+			GD::out.printWarning("Warning: Tried to import BidCoS packet larger than 200 bytes.");
+			return false;
+		}
+		if(size < 18)
+		{
+			GD::out.printError("Error: Packet is too short: " + std::string(packet, size));
+			return false;
+		}
+		const uint8_t* data = (const uint8_t*)packet;
 
-int32_t BidCoSPacket::getInt(std::string hexString)
-{
-	try
-	{
-		int32_t value = 0;
-		try	{ value = std::stoll(hexString, 0, 16); } catch(...) {}
-		return value;
+		_length = size / 2;
+		_payload.resize(_length - 9);
+		uint8_t* payload = _payload.data();
+		uint8_t header[9];
+		for(uint32_t i = 0; i < _length; i++)
+		{
+			int32_t high = _hexDecodeTable[data[i * 2]];
+			int32_t low = _hexDecodeTable[data[(i * 2) + 1]];
+			if((high | low) < 0)
+			{
+				_payload.clear();
+				GD::out.printWarning("Warning: Packet contains invalid characters: " + std::string(packet, size));
+				return false;
+			}
+			if(i < 9) header[i] = (high << 4) | low;
+			else payload[i - 9] = (high << 4) | low;
+		}
+		_messageCounter = header[0];
+		_controlByte = header[1];
+		_messageType = header[2];
+		_senderAddress = (header[3] << 16) | (header[4] << 8) | header[5];
+		_destinationAddress = (header[6] << 16) | (header[7] << 8) | header[8];
+
+		//See import(std::vector<uint8_t>&, bool)
+		int32_t rssiDevice = rssiByte;
+		if(rssiDevice >= 128) rssiDevice = ((rssiDevice - 256) / 2) - 74;
+		else rssiDevice = (rssiDevice / 2) - 74;
+		_rssiDevice = rssiDevice * -1;
+		return true;
 	}
 	catch(const std::exception& ex)
     {
@@ -334,7 +409,7 @@ int32_t BidCoSPacket::getInt(std::string hexString)
     {
     	GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
     }
-	return 0;
+    return false;
 }
 
 void BidCoSPacket::setPosition(double index, double size, std::vector<uint8_t>& value)
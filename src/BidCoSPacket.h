@@ -38,6 +38,7 @@
 #include <sstream>
 #include <iomanip>
 #include <algorithm>
+#include <atomic>
 #include <cmath>
 
 namespace BidCoS
@@ -55,6 +56,19 @@ class BidCoSPacket : public BaseLib::Systems::Packet
         bool validAesAck() { return _validAesAck; }
         void setValidAesAck(bool value) { _validAesAck = value; }
         virtual void setControlByte(uint8_t value) { _controlByte = value; }
+        void setTimeReceived(int64_t value) { _timeReceived = value; }
+
+        /**
+         * The time setValue() was called for the command this packet belongs to in microseconds (steady clock). 0 for all other packets.
+         * Atomic, as queued packets are shared between the queue and the interface threads.
+         */
+        int64_t commandTime() { return _commandTime.load(std::memory_order_relaxed); }
+        void setCommandTime(int64_t value) { _commandTime.store(value, std::memory_order_relaxed); }
+
+        /**
+         * Returns the command time and sets it to 0, so the latency of a command is only counted once when the packet is resent.
+         */
+        int64_t takeCommandTime() { return _commandTime.exchange(0, std::memory_order_relaxed); }
         virtual std::string hexString();
         virtual std::vector<uint8_t> byteArray();
         virtual std::vector<char> byteArraySigned();
@@ -64,7 +78,27 @@ class BidCoSPacket : public BaseLib::Systems::Packet
         BidCoSPacket(std::vector<uint8_t>& packet, bool rssiByte, int64_t timeReceived = 0);
         BidCoSPacket(uint8_t messageCounter, uint8_t controlByte, uint8_t messageType, int32_t senderAddress, int32_t destinationAddress, std::vector<uint8_t>& payload, bool updatePacket = false);
         virtual ~BidCoSPacket();
-        void import(std::string& packet, bool removeFirstCharacter = true);
+        bool import(std::string& packet, bool removeFirstCharacter = true);
+
+        /**
+         * Imports a packet in hexadecimal format (e. g. "A0A8E8001..." as received from a CUL). The hex string is decoded directly into the payload.
+         *
+         * @param packet Pointer to the first character of the packet. The data doesn't need to be null terminated.
+         * @param size The number of characters.
+         * @param removeFirstCharacter Set to true to skip the first character (e. g. the "A" of CUL packets).
+         * @return Returns false when the packet is too short, too long or contains characters which are no hexadecimal digits.
+         */
+        bool import(const char* packet, uint32_t size, bool removeFirstCharacter = true);
+
+        /**
+         * Imports a packet in hexadecimal format without length byte (e. g. "8E8001..." as received from a HM-CFG-LAN). The length byte is calculated from the number of characters.
+         *
+         * @param packet Pointer to the first character of the packet. The data doesn't need to be null terminated.
+         * @param size The number of characters.
+         * @param rssiByte The RSSI in TI CC1101 format.
+         * @return Returns false when the packet is too short, too long or contains characters which are no hexadecimal digits.
+         */
+        bool importWithoutLengthByte(const char* packet, uint32_t size, uint8_t rssiByte);
         void import(std::vector<uint8_t>& packet, bool rssiByte);
         virtual std::vector<uint8_t> getPosition(double index, double size, int32_t mask);
         virtual void setPosition(double index, double size, std::vector<uint8_t>& value);
@@ -77,9 +111,9 @@ class BidCoSPacket : public BaseLib::Systems::Packet
         uint8_t _rssiDevice = 0;
         bool _updatePacket = false;
         bool _validAesAck = false;
+        std::atomic<int64_t> _commandTime{0};
 
-        uint8_t getByte(std::string);
-        int32_t getInt(std::string);
+        static const int8_t _hexDecodeTable[256];
 };
 
 }
@@ -41,6 +41,7 @@ BidCoSPacketManager::BidCoSPacketManager()
 {
 	try
 	{
+		_id = 0;
 		_stopWorkerThread = false;
 		_disposing = false;
 		GD::bl->threadManager.start(_workerThread, true, GD::bl->settings.workerThreadPriority(), GD::bl->settings.workerThreadPolicy(), &BidCoSPacketManager::worker, this);
@@ -68,68 +69,85 @@ BidCoSPacketManager::~BidCoSPacketManager()
 void BidCoSPacketManager::dispose(bool wait)
 {
 	_disposing = true;
+	std::lock_guard<std::mutex> expiryGuard(_expiryMutex);
 	_stopWorkerThread = true;
+	_expiryConditionVariable.notify_all();
+}
+
+void BidCoSPacketManager::scheduleExpiry(int64_t time, int32_t address, uint32_t id)
+{
+	try
+	{
+		std::lock_guard<std::mutex> expiryGuard(_expiryMutex);
+		//Packets are usually added in order of time, so the worker rarely needs to be woken up
+		bool notify = _expiryQueue.empty() || time < std::get<0>(_expiryQueue.top());
+		_expiryQueue.push(std::tuple<int64_t, int32_t, uint32_t>(time, address, id));
+		if(notify) _expiryConditionVariable.notify_one();
+	}
+	catch(const std::exception& ex)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(BaseLib::Exception& ex)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
 }
 
 void BidCoSPacketManager::worker()
 {
 	try
 	{
-		std::chrono::milliseconds sleepingTime(1000);
-		uint32_t counter = 0;
-		int32_t lastPacket;
-		lastPacket = 0;
 		while(!_stopWorkerThread)
 		{
 			try
 			{
-				std::this_thread::sleep_for(sleepingTime);
-				if(_stopWorkerThread) return;
-				if(counter > 100)
+				std::tuple<int64_t, int32_t, uint32_t> entry;
 				{
-					counter = 0;
-					_packetMutex.lock();
-					if(_packets.size() > 0)
+					std::unique_lock<std::mutex> expiryGuard(_expiryMutex);
+					if(_stopWorkerThread) return;
+					if(_expiryQueue.empty())
 					{
-						int32_t packetsPerSecond = (_packets.size() * 1000) / sleepingTime.count();
-						if(packetsPerSecond <= 0) packetsPerSecond = 1;
-						int32_t timePerPacket = (GD::bl->settings.workerThreadWindow() * 10) / packetsPerSecond;
-						if(timePerPacket < 10) timePerPacket = 10;
-						sleepingTime = std::chrono::milliseconds(timePerPacket);
+						_expiryConditionVariable.wait(expiryGuard);
+						continue;
 					}
-					_packetMutex.unlock();
-				}
-				_packetMutex.lock();
-				if(!_packets.empty())
-				{
-					std::unordered_map<int32_t, std::shared_ptr<BidCoSPacketInfo>>::iterator nextPacket = _packets.find(lastPacket);
-					if(nextPacket != _packets.end())
+					int64_t time = BaseLib::HelperFunctions::getTime();
+					if(std::get<0>(_expiryQueue.top()) > time)
 					{
-						nextPacket++;
-						if(nextPacket == _packets.end()) nextPacket = _packets.begin();
+						_expiryConditionVariable.wait_for(expiryGuard, std::chrono::milliseconds(std::get<0>(_expiryQueue.top()) - time));
+						continue;
 					}
-					else nextPacket = _packets.begin();
-					lastPacket = nextPacket->first;
+					entry = _expiryQueue.top();
+					_expiryQueue.pop();
 				}
-				std::shared_ptr<BidCoSPacketInfo> packet;
-				if(_packets.find(lastPacket) != _packets.end()) packet = _packets.at(lastPacket);
-				_packetMutex.unlock();
-				if(packet) deletePacket(lastPacket, packet->id);
-				counter++;
+
+				int32_t address = std::get<1>(entry);
+				uint32_t id = std::get<2>(entry);
+				int64_t expiryTime = 0;
+				{
+					Shard& shard = getShard(address);
+					std::lock_guard<std::mutex> shardGuard(shard.mutex);
+					std::unordered_map<int32_t, std::shared_ptr<BidCoSPacketInfo>>::iterator packetIterator = shard.packets.find(address);
+					if(packetIterator == shard.packets.end() || !packetIterator->second || packetIterator->second->id != id) continue; //Replaced or deleted
+					expiryTime = packetIterator->second->time + _packetLifetime;
+					if(BaseLib::HelperFunctions::getTime() > expiryTime) shard.packets.erase(packetIterator);
+				}
+				if(BaseLib::HelperFunctions::getTime() <= expiryTime) scheduleExpiry(expiryTime + 1, address, id); //Kept alive
 			}
 			catch(const std::exception& ex)
 			{
-				_packetMutex.unlock();
 				GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
 			}
 			catch(BaseLib::Exception& ex)
 			{
-				_packetMutex.unlock();
 				GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
 			}
 			catch(...)
 			{
-				_packetMutex.unlock();
 				GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
 			}
 		}
@@ -153,25 +171,25 @@ bool BidCoSPacketManager::set(int32_t address, std::shared_ptr<BidCoSPacket>& pa
 	try
 	{
 		if(_disposing) return false;
-		_packetMutex.lock();
-		if(_packets.find(address) != _packets.end())
+		Shard& shard = getShard(address);
+		std::shared_ptr<BidCoSPacketInfo> info;
 		{
-			std::shared_ptr<BidCoSPacket> oldPacket = _packets.at(address)->packet;
-			if(oldPacket->equals(packet))
+			std::lock_guard<std::mutex> shardGuard(shard.mutex);
+			std::unordered_map<int32_t, std::shared_ptr<BidCoSPacketInfo>>::iterator packetIterator = shard.packets.find(address);
+			if(packetIterator != shard.packets.end())
 			{
-				_packetMutex.unlock();
-				return true;
+				if(packetIterator->second->packet->equals(packet)) return true;
+				shard.packets.erase(packetIterator);
 			}
-			_packets.erase(_packets.find(address));
-		}
-		_packetMutex.unlock();
 
-		std::shared_ptr<BidCoSPacketInfo> info(new BidCoSPacketInfo());
-		info->packet = packet;
-		info->id = _id++;
-		if(time > 0) info->time = time;
-		_packetMutex.lock();
-		_packets.insert(std::pair<int32_t, std::shared_ptr<BidCoSPacketInfo>>(address, info));
+			info.reset(new BidCoSPacketInfo());
+			info->packet = packet;
+			info->id = _id++;
+			if(time > 0) info->time = time;
+			shard.packets.insert(std::pair<int32_t, std::shared_ptr<BidCoSPacketInfo>>(address, info));
+		}
+		//Expire one millisecond late, because packets are kept up to and including "time + _packetLifetime"
+		scheduleExpiry(info->time + _packetLifetime + 1, address, info->id);
 	}
 	catch(const std::exception& ex)
     {
@@ -185,7 +203,6 @@ bool BidCoSPacketManager::set(int32_t address, std::shared_ptr<BidCoSPacket>& pa
     {
         GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
     }
-    _packetMutex.unlock();
     return false;
 }
 
@@ -194,15 +211,13 @@ void BidCoSPacketManager::deletePacket(int32_t address, uint32_t id)
 	try
 	{
 		if(_disposing) return;
-		_packetMutex.lock();
-		if(_packets.find(address) != _packets.end() && _packets.at(address) && _packets.at(address)->id == id)
+		Shard& shard = getShard(address);
+		std::lock_guard<std::mutex> shardGuard(shard.mutex);
+		std::unordered_map<int32_t, std::shared_ptr<BidCoSPacketInfo>>::iterator packetIterator = shard.packets.find(address);
+		if(packetIterator != shard.packets.end() && packetIterator->second && packetIterator->second->id == id)
 		{
-			if(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count() <= _packets.at(address)->time + 2000)
-			{
-				_packetMutex.unlock();
-				return;
-			}
-			_packets.erase(address);
+			if(BaseLib::HelperFunctions::getTime() <= packetIterator->second->time + _packetLifetime) return;
+			shard.packets.erase(packetIterator);
 		}
 	}
 	catch(const std::exception& ex)
@@ -217,7 +232,6 @@ void BidCoSPacketManager::deletePacket(int32_t address, uint32_t id)
     {
         GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
     }
-    _packetMutex.unlock();
 }
 
 std::shared_ptr<BidCoSPacket> BidCoSPacketManager::get(int32_t address)
@@ -225,11 +239,11 @@ std::shared_ptr<BidCoSPacket> BidCoSPacketManager::get(int32_t address)
 	try
 	{
 		if(_disposing) return std::shared_ptr<BidCoSPacket>();
-		_packetMutex.lock();
+		Shard& shard = getShard(address);
+		std::lock_guard<std::mutex> shardGuard(shard.mutex);
 		//Make a copy to make sure, the element exists
-		std::shared_ptr<BidCoSPacket> packet((_packets.find(address) != _packets.end()) ? _packets[address]->packet : nullptr);
-		_packetMutex.unlock();
-		return packet;
+		std::unordered_map<int32_t, std::shared_ptr<BidCoSPacketInfo>>::iterator packetIterator = shard.packets.find(address);
+		if(packetIterator != shard.packets.end()) return packetIterator->second->packet;
 	}
 	catch(const std::exception& ex)
     {
@@ -243,7 +257,6 @@ std::shared_ptr<BidCoSPacket> BidCoSPacketManager::get(int32_t address)
     {
         GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
     }
-    _packetMutex.unlock();
     return std::shared_ptr<BidCoSPacket>();
 }
 
@@ -252,11 +265,11 @@ std::shared_ptr<BidCoSPacketInfo> BidCoSPacketManager::getInfo(int32_t address)
 	try
 	{
 		if(_disposing) return std::shared_ptr<BidCoSPacketInfo>();
+		Shard& shard = getShard(address);
+		std::lock_guard<std::mutex> shardGuard(shard.mutex);
 		//Make a copy to make sure, the element exists
-		_packetMutex.lock();
-		std::shared_ptr<BidCoSPacketInfo> info((_packets.find(address) != _packets.end()) ? _packets[address] : nullptr);
-		_packetMutex.unlock();
-		return info;
+		std::unordered_map<int32_t, std::shared_ptr<BidCoSPacketInfo>>::iterator packetIterator = shard.packets.find(address);
+		if(packetIterator != shard.packets.end()) return packetIterator->second;
 	}
 	catch(const std::exception& ex)
     {
@@ -270,7 +283,6 @@ std::shared_ptr<BidCoSPacketInfo> BidCoSPacketManager::getInfo(int32_t address)
     {
         GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
     }
-    _packetMutex.unlock();
     return std::shared_ptr<BidCoSPacketInfo>();
 }
 
@@ -279,8 +291,11 @@ void BidCoSPacketManager::keepAlive(int32_t address)
 	try
 	{
 		if(_disposing) return;
-		_packetMutex.lock();
-		if(_packets.find(address) != _packets.end()) _packets[address]->time = BaseLib::HelperFunctions::getTime();
+		Shard& shard = getShard(address);
+		std::lock_guard<std::mutex> shardGuard(shard.mutex);
+		//The worker notices the new time when the old expiry time is reached and reschedules the packet
+		std::unordered_map<int32_t, std::shared_ptr<BidCoSPacketInfo>>::iterator packetIterator = shard.packets.find(address);
+		if(packetIterator != shard.packets.end()) packetIterator->second->time = BaseLib::HelperFunctions::getTime();
 	}
 	catch(const std::exception& ex)
     {
@@ -294,6 +309,5 @@ void BidCoSPacketManager::keepAlive(int32_t address)
     {
         GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
     }
-    _packetMutex.unlock();
 }
 }
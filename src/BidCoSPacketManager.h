@@ -40,6 +40,10 @@
 #include <unordered_map>
 #include <thread>
 #include <mutex>
+#include <condition_variable>
+#include <queue>
+#include <array>
+#include <tuple>
 
 namespace BidCoS
 {
@@ -67,13 +71,38 @@ public:
 	void keepAlive(int32_t address);
 	void dispose(bool wait = true);
 protected:
+	/**
+	 * Packets are removed this many milliseconds after BidCoSPacketInfo::time.
+	 */
+	static const int64_t _packetLifetime = 2000;
+
+	/**
+	 * One part of the packet map. Addresses are distributed over the shards, so get() and set() for different addresses rarely wait for each other.
+	 */
+	class Shard
+	{
+	public:
+		std::mutex mutex;
+		std::unordered_map<int32_t, std::shared_ptr<BidCoSPacketInfo>> packets;
+	};
+
 	std::atomic_bool _disposing;
 	std::atomic_bool _stopWorkerThread;
     std::thread _workerThread;
-	uint32_t _id = 0;
-	std::unordered_map<int32_t, std::shared_ptr<BidCoSPacketInfo>> _packets;
-	std::mutex _packetMutex;
+	std::atomic<uint32_t> _id;
+	std::array<Shard, 16> _shards;
+
+	// {{{ Expiry
+	std::mutex _expiryMutex;
+	std::condition_variable _expiryConditionVariable;
+	/**
+	 * Min-heap of (expiry time, address, packet ID). Entries of replaced packets are skipped. Entries of packets kept alive are pushed again with the new expiry time.
+	 */
+	std::priority_queue<std::tuple<int64_t, int32_t, uint32_t>, std::vector<std::tuple<int64_t, int32_t, uint32_t>>, std::greater<std::tuple<int64_t, int32_t, uint32_t>>> _expiryQueue;
+	// }}}
 
+	Shard& getShard(int32_t address) { return _shards[((uint32_t)address ^ ((uint32_t)address >> 8) ^ ((uint32_t)address >> 16)) & 0x0F]; }
+	void scheduleExpiry(int64_t time, int32_t address, uint32_t id);
 	void worker();
 };
 
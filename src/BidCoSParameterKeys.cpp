@@ -0,0 +1,71 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Homegear.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+
+#include "BidCoSParameterKeys.h"
+
+namespace BidCoS
+{
+
+BidCoSParameterKeys::BidCoSParameterKeys()
+{
+	//Same order as BidCoSParameterKeys::Key
+	intern("AES_ACTIVE");
+	intern("ON_TIME");
+	intern("POLLING");
+	intern("POLLING_INTERVAL");
+	intern("PRESS_LONG");
+	intern("PRESS_LONG_RELEASE");
+	intern("ROAMING");
+	intern("RSSI_DEVICE");
+}
+
+uint32_t BidCoSParameterKeys::intern(const std::string& name)
+{
+	std::lock_guard<std::mutex> keysGuard(_keysMutex);
+	std::unordered_map<std::string, uint32_t>::iterator keyIterator = _keys.find(name);
+	if(keyIterator != _keys.end()) return keyIterator->second;
+	uint32_t key = _names.size();
+	_names.push_back(name);
+	_keys.emplace(name, key);
+	return key;
+}
+
+const std::string& BidCoSParameterKeys::name(uint32_t key)
+{
+	std::lock_guard<std::mutex> keysGuard(_keysMutex);
+	return key < _names.size() ? _names[key] : _emptyName;
+}
+
+uint32_t BidCoSParameterKeys::size()
+{
+	std::lock_guard<std::mutex> keysGuard(_keysMutex);
+	return _names.size();
+}
+
+}
@@ -0,0 +1,89 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Homegear.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+
+#ifndef BIDCOSPARAMETERKEYS_H_
+#define BIDCOSPARAMETERKEYS_H_
+
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace BidCoS
+{
+
+/**
+ * Interns parameter names to small integer keys. Names are interned when device descriptions are compiled, so the receive, worker and command
+ * paths carry a key instead of a copy of the name. Keys are never removed and are only valid within one run.
+ */
+class BidCoSParameterKeys
+{
+public:
+	/**
+	 * Keys of parameters the module accesses directly. They are interned by the constructor.
+	 */
+	enum Key : uint32_t
+	{
+		aesActive = 0,
+		onTime,
+		polling,
+		pollingInterval,
+		pressLong,
+		pressLongRelease,
+		roaming,
+		rssiDevice
+	};
+
+	BidCoSParameterKeys();
+	virtual ~BidCoSParameterKeys() {}
+
+	/**
+	 * Returns the key of a parameter name. Unknown names are added.
+	 */
+	uint32_t intern(const std::string& name);
+
+	/**
+	 * Returns the name of a key or an empty string when the key is unknown. The reference stays valid, because names are never removed.
+	 */
+	const std::string& name(uint32_t key);
+	uint32_t size();
+protected:
+	std::mutex _keysMutex;
+	std::unordered_map<std::string, uint32_t> _keys;
+	std::string _emptyName;
+
+	/**
+	 * A deque, so references returned by name() stay valid when names are added.
+	 */
+	std::deque<std::string> _names;
+};
+
+}
+#endif
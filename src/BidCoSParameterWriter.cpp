@@ -0,0 +1,283 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Homegear.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+
+#include "BidCoSParameterWriter.h"
+#include "HomeMaticCentral.h"
+#include "GD.h"
+
+namespace BidCoS
+{
+BidCoSParameterWriter::BidCoSParameterWriter()
+{
+	_disposing = false;
+	_stopFlushThread = false;
+	_parametersQueued = 0;
+	_parametersCoalesced = 0;
+	_parametersWritten = 0;
+	_synchronousWrites = 0;
+}
+
+BidCoSParameterWriter::~BidCoSParameterWriter()
+{
+	try
+	{
+		dispose();
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+}
+
+void BidCoSParameterWriter::init(HomeMaticCentral* central)
+{
+	try
+	{
+		_central = central;
+
+		std::string setting = GD::settings ? GD::settings->getString("variablewriteinterval") : "";
+		_flushInterval = setting.empty() ? 1000 : BaseLib::Math::getNumber(setting);
+		if(_flushInterval < 0) _flushInterval = 0;
+		else if(_flushInterval > 60000) _flushInterval = 60000;
+
+		setting = GD::settings ? GD::settings->getString("variablewritequeuesize") : "";
+		int32_t maxPendingParameters = setting.empty() ? 10000 : BaseLib::Math::getNumber(setting);
+		_maxPendingParameters = maxPendingParameters < 1 ? 1 : maxPendingParameters;
+
+		if(_flushInterval > 0) GD::bl->threadManager.start(_flushThread, false, &BidCoSParameterWriter::flushThread, this);
+		else GD::out.printInfo("Info: Write-behind of peer variables is disabled. Variables are saved immediately.");
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+}
+
+void BidCoSParameterWriter::dispose()
+{
+	try
+	{
+		{
+			std::lock_guard<std::mutex> pendingGuard(_pendingMutex);
+			if(_disposing) return;
+			_disposing = true;
+			_stopFlushThread = true;
+		}
+		_pendingConditionVariable.notify_all();
+		GD::bl->threadManager.join(_flushThread);
+		flush();
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+}
+
+bool BidCoSParameterWriter::enqueue(uint64_t peerID, uint32_t channel, const std::string& key)
+{
+	try
+	{
+		if(_flushInterval <= 0) return false;
+		{
+			std::lock_guard<std::mutex> pendingGuard(_pendingMutex);
+			if(_disposing) return false;
+			std::map<uint64_t, std::set<ChannelKey>>::iterator peerIterator = _pending.find(peerID);
+			if(peerIterator != _pending.end() && peerIterator->second.find(ChannelKey(channel, key)) != peerIterator->second.end())
+			{
+				_parametersCoalesced++;
+				return true;
+			}
+			if(_pendingCount < _maxPendingParameters)
+			{
+				_pending[peerID].insert(ChannelKey(channel, key));
+				_pendingCount++;
+				_parametersQueued++;
+				return true;
+			}
+		}
+		//The queue is full. Wake up the flush thread and let the caller write this parameter.
+		_pendingConditionVariable.notify_one();
+		_synchronousWrites++;
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+	return false;
+}
+
+void BidCoSParameterWriter::flush()
+{
+	std::string savepointName("bidCoSParameterWriter");
+	bool savepointCreated = false;
+	try
+	{
+		std::lock_guard<std::mutex> flushGuard(_flushMutex);
+		std::map<uint64_t, std::set<ChannelKey>> pending;
+		{
+			std::lock_guard<std::mutex> pendingGuard(_pendingMutex);
+			pending.swap(_pending);
+			_pendingCount = 0;
+		}
+		if(pending.empty() || !_central) return;
+
+		std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+		GD::bl->db->createSavepointAsynchronous(savepointName);
+		savepointCreated = true;
+		for(std::map<uint64_t, std::set<ChannelKey>>::iterator i = pending.begin(); i != pending.end(); ++i)
+		{
+			//Peers deleted in the meantime are skipped.
+			std::shared_ptr<BidCoSPeer> peer = _central->getPeer(i->first);
+			if(!peer) continue;
+			_parametersWritten += peer->saveQueuedParameters(i->second);
+		}
+		GD::bl->db->releaseSavepointAsynchronous(savepointName);
+		savepointCreated = false;
+		int64_t latency = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count();
+
+		std::lock_guard<std::mutex> statisticsGuard(_statisticsMutex);
+		_flushes++;
+		_lastFlushLatency = latency;
+		if(latency > _maxFlushLatency) _maxFlushLatency = latency;
+		_totalFlushLatency += latency;
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+	if(savepointCreated) GD::bl->db->releaseSavepointAsynchronous(savepointName);
+}
+
+BidCoSParameterWriterStatistics BidCoSParameterWriter::getStatistics()
+{
+	BidCoSParameterWriterStatistics statistics;
+	try
+	{
+		statistics.enabled = _flushInterval > 0;
+		statistics.flushInterval = _flushInterval;
+		statistics.maxPendingParameters = _maxPendingParameters;
+		{
+			std::lock_guard<std::mutex> pendingGuard(_pendingMutex);
+			statistics.pendingParameters = _pendingCount;
+		}
+		statistics.parametersQueued = _parametersQueued;
+		statistics.parametersCoalesced = _parametersCoalesced;
+		statistics.parametersWritten = _parametersWritten;
+		statistics.synchronousWrites = _synchronousWrites;
+
+		std::lock_guard<std::mutex> statisticsGuard(_statisticsMutex);
+		statistics.flushes = _flushes;
+		statistics.lastFlushLatency = _lastFlushLatency;
+		statistics.maxFlushLatency = _maxFlushLatency;
+		if(_flushes > 0) statistics.averageFlushLatency = (double)_totalFlushLatency / _flushes;
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+	return statistics;
+}
+
+void BidCoSParameterWriter::flushThread()
+{
+	while(!_stopFlushThread)
+	{
+		try
+		{
+			{
+				std::unique_lock<std::mutex> pendingGuard(_pendingMutex);
+				_pendingConditionVariable.wait_for(pendingGuard, std::chrono::milliseconds(_flushInterval), [&] { return _stopFlushThread || _pendingCount >= _maxPendingParameters; });
+			}
+			if(_stopFlushThread) return;
+			flush();
+		}
+		catch(const std::exception& ex)
+		{
+			GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+		}
+		catch(BaseLib::Exception& ex)
+		{
+			GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+		}
+		catch(...)
+		{
+			GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+		}
+	}
+}
+
+}
@@ -0,0 +1,138 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Homegear.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+
+#ifndef BIDCOSPARAMETERWRITER_H_
+#define BIDCOSPARAMETERWRITER_H_
+
+#include <homegear-base/BaseLib.h>
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace BidCoS
+{
+class HomeMaticCentral;
+
+class BidCoSParameterWriterStatistics
+{
+public:
+	BidCoSParameterWriterStatistics() {}
+	virtual ~BidCoSParameterWriterStatistics() {}
+
+	bool enabled = false;
+	int64_t flushInterval = 0;
+	uint32_t maxPendingParameters = 0;
+	uint32_t pendingParameters = 0;
+	uint64_t parametersQueued = 0;
+	uint64_t parametersCoalesced = 0;
+	uint64_t parametersWritten = 0;
+	uint64_t synchronousWrites = 0;
+	uint64_t flushes = 0;
+	//Latencies are in microseconds
+	int64_t lastFlushLatency = 0;
+	int64_t maxFlushLatency = 0;
+	double averageFlushLatency = 0;
+};
+
+/**
+ * Write-behind persistence of peer variables. Instead of writing every received value to the database, BidCoSPeer::packetReceived only marks the
+ * parameter as changed. The changed parameters are written in one database transaction per flush interval. The queue only stores which parameter
+ * changed, the value is read from the peer's valuesCentral when the parameter is written. So a parameter saved synchronously in the meantime is never
+ * overwritten with an outdated value.
+ */
+class BidCoSParameterWriter
+{
+public:
+	BidCoSParameterWriter();
+	virtual ~BidCoSParameterWriter();
+
+	/**
+	 * Reads the settings and starts the flush thread.
+	 */
+	void init(HomeMaticCentral* central);
+
+	/**
+	 * Writes all queued parameters and stops the flush thread. Parameters enqueued afterwards are rejected.
+	 */
+	void dispose();
+
+	/**
+	 * Marks a variable of a peer as changed. The variable needs to exist in the database already (databaseId > 0).
+	 *
+	 * @param peerID The ID of the peer.
+	 * @param channel The channel of the variable.
+	 * @param key The ID of the variable.
+	 * @return Returns false when the parameter was not queued. The caller then needs to save the parameter itself.
+	 */
+	bool enqueue(uint64_t peerID, uint32_t channel, const std::string& key);
+
+	/**
+	 * Writes all queued parameters.
+	 */
+	void flush();
+
+	BidCoSParameterWriterStatistics getStatistics();
+protected:
+	typedef std::pair<uint32_t, std::string> ChannelKey;
+
+	HomeMaticCentral* _central = nullptr;
+	std::atomic_bool _disposing;
+	std::atomic_bool _stopFlushThread;
+	std::thread _flushThread;
+	int64_t _flushInterval = 0;
+	uint32_t _maxPendingParameters = 0;
+
+	std::mutex _pendingMutex;
+	std::condition_variable _pendingConditionVariable;
+	std::map<uint64_t, std::set<ChannelKey>> _pending;
+	uint32_t _pendingCount = 0;
+
+	std::mutex _flushMutex;
+
+	std::atomic<uint64_t> _parametersQueued;
+	std::atomic<uint64_t> _parametersCoalesced;
+	std::atomic<uint64_t> _parametersWritten;
+	std::atomic<uint64_t> _synchronousWrites;
+	std::mutex _statisticsMutex;
+	uint64_t _flushes = 0;
+	int64_t _lastFlushLatency = 0;
+	int64_t _maxFlushLatency = 0;
+	int64_t _totalFlushLatency = 0;
+
+	void flushThread();
+};
+
+}
+#endif
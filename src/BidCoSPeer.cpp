@@ -418,31 +418,20 @@ void BidCoSPeer::worker()
 			}
 			else
 			{
-				if(configCentral[0].find("POLLING") != configCentral[0].end())
+				if(getConfigParameter(0, BidCoSParameterKeys::polling))
 				{
-					BaseLib::Systems::RpcConfigurationParameter& parameter = configCentral[0]["POLLING"];
-					std::vector<uint8_t> parameterData = parameter.getBinaryData();
-					if(parameterData.size() > 0 && parameterData.at(0) > 0 && configCentral[0].find("POLLING_INTERVAL") != configCentral[0].end())
+					int64_t pollingInterval = getPollingInterval();
+					if(pollingInterval > 0 && time - _lastPing >= pollingInterval && (getRXModes() & HomegearDevice::ReceiveModes::Enum::always))
 					{
-						//Polling is enabled
-						BaseLib::Systems::RpcConfigurationParameter& parameter = configCentral[0]["POLLING_INTERVAL"];
-						parameterData = parameter.getBinaryData();
-						int32_t data = 0;
-						_bl->hf.memcpyBigEndian(data, parameterData); //Shortcut to save resources. The normal way would be to call "convertFromPacket".
-						int64_t pollingInterval = data * 60000;
-						if(pollingInterval < 600000) pollingInterval = 600000;
-						if(time - _lastPing >= pollingInterval && (getRXModes() & HomegearDevice::ReceiveModes::Enum::always))
+						int64_t timeSinceLastPacket = time - ((int64_t)_lastPacketReceived * 1000);
+						if(timeSinceLastPacket > 0 && timeSinceLastPacket >= pollingInterval)
 						{
-							int64_t timeSinceLastPacket = time - ((int64_t)_lastPacketReceived * 1000);
-							if(timeSinceLastPacket > 0 && timeSinceLastPacket >= pollingInterval)
+							if(!_disposing && !deleting && _lastPing < time) //Check that _lastPing wasn't set in putParamset after locking the mutex
 							{
-								if(!_disposing && !deleting && _lastPing < time) //Check that _lastPing wasn't set in putParamset after locking the mutex
-								{
-									std::lock_guard<std::mutex> pingGuard(_pingThreadMutex);
-									_lastPing = time; //Set here to avoid race condition between worker thread and ping thread
-									_bl->threadManager.join(_pingThread);
-									_bl->threadManager.start(_pingThread, false, &BidCoSPeer::pingThread, this);
-								}
+								std::lock_guard<std::mutex> pingGuard(_pingThreadMutex);
+								_lastPing = time; //Set here to avoid race condition between worker thread and ping thread
+								_bl->threadManager.join(_pingThread);
+								_bl->threadManager.start(_pingThread, false, &BidCoSPeer::pingThread, this);
 							}
 						}
 					}
@@ -450,9 +439,10 @@ void BidCoSPeer::worker()
 				else _lastPing = time; //Set _lastPing, so there is a delay of 10 minutes after the device is unreachable before the first ping.
 			}
 		}
+		if(_configWritesFlushTime != 0 && _configWritesFlushTime <= time) flushConfigWrites();
 		if(serviceMessages->getConfigPending())
 		{
-			if(!pendingBidCoSQueues || pendingBidCoSQueues->empty()) serviceMessages->setConfigPending(false);
+			if((!pendingBidCoSQueues || pendingBidCoSQueues->empty()) && !configWritesPending()) serviceMessages->setConfigPending(false);
 			else if(_bl->settings.devLog() && (getRXModes() & HomegearDevice::ReceiveModes::Enum::wakeUp) && (_bl->hf.getTime() - serviceMessages->getConfigPendingSetTime()) > 360000)
 			{
 				GD::out.printWarning("Devlog warning: Configuration for peer with id " + std::to_string(_peerID) + " supporting wake up is pending since more than 6 minutes.");
@@ -481,6 +471,125 @@ void BidCoSPeer::worker()
 	}
 }
 
+void BidCoSPeer::scheduleWorker(int64_t time)
+{
+	try
+	{
+		std::shared_ptr<HomeMaticCentral> central = std::dynamic_pointer_cast<HomeMaticCentral>(getCentral());
+		if(central) central->schedulePeerWorker(_peerID, time);
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+}
+
+int64_t BidCoSPeer::getPollingInterval()
+{
+	try
+	{
+		BaseLib::Systems::RpcConfigurationParameter* polling = getConfigParameter(0, BidCoSParameterKeys::polling);
+		BaseLib::Systems::RpcConfigurationParameter* pollingIntervalParameter = getConfigParameter(0, BidCoSParameterKeys::pollingInterval);
+		if(!polling || !pollingIntervalParameter) return 0;
+		std::vector<uint8_t> parameterData = polling->getBinaryData();
+		if(parameterData.empty() || parameterData.at(0) == 0) return 0;
+		//Polling is enabled
+		parameterData = pollingIntervalParameter->getBinaryData();
+		int32_t data = 0;
+		_bl->hf.memcpyBigEndian(data, parameterData); //Shortcut to save resources. The normal way would be to call "convertFromPacket".
+		int64_t pollingInterval = data * 60000;
+		if(pollingInterval < 600000) pollingInterval = 600000;
+		return pollingInterval;
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+	return 0;
+}
+
+int64_t BidCoSPeer::getNextWorkerTime(int64_t time)
+{
+	//Upper bound, so changes not signaled to the central (e. g. a new polling interval) are picked up in time
+	int64_t nextTime = time + 60000;
+	try
+	{
+		if(_disposing) return std::numeric_limits<int64_t>::max();
+		//Config and value pending flags are cleared as soon as the queues are empty. Keep checking them once per worker thread window.
+		if(serviceMessages->getConfigPending() || _valuePending) nextTime = time + _bl->settings.workerThreadWindow();
+		int64_t configWritesFlushTime = _configWritesFlushTime;
+		if(configWritesFlushTime != 0 && configWritesFlushTime < nextTime) nextTime = configWritesFlushTime < time ? time : configWritesFlushTime;
+		{
+			std::lock_guard<std::mutex> variablesToResetGuard(_variablesToResetMutex);
+			for(std::map<std::int32_t, std::map<std::string, std::shared_ptr<VariableToReset>>>::iterator i = _variablesToReset.begin(); i != _variablesToReset.end(); ++i)
+			{
+				for(std::map<std::string, std::shared_ptr<VariableToReset>>::iterator j = i->second.begin(); j != i->second.end(); ++j)
+				{
+					//Variables due now were added while worker() was running
+					int64_t resetTime = j->second->resetTime < time ? time : j->second->resetTime;
+					if(resetTime < nextTime) nextTime = resetTime;
+				}
+			}
+		}
+		if(_rpcDevice)
+		{
+			//Deadlines not in the future were handled by the last call of worker(). Ignoring them prevents busy looping on peers that can't be pinged.
+			if(serviceMessages->getUnreach())
+			{
+				if(getRXModes() & HomegearDevice::ReceiveModes::Enum::always)
+				{
+					int64_t pingTime = _lastPing + 600001;
+					if(pingTime > time && pingTime < nextTime) nextTime = pingTime;
+				}
+			}
+			else
+			{
+				if(_rpcDevice->timeout > 0)
+				{
+					int64_t unreachTime = ((int64_t)getLastPacketReceived() + _rpcDevice->timeout + 1) * 1000;
+					if(unreachTime > time && unreachTime < nextTime) nextTime = unreachTime;
+				}
+				int64_t pollingInterval = getPollingInterval();
+				if(pollingInterval > 0 && (getRXModes() & HomegearDevice::ReceiveModes::Enum::always))
+				{
+					int64_t lastPacketReceived = (int64_t)_lastPacketReceived * 1000;
+					int64_t pollingTime = (_lastPing > lastPacketReceived ? _lastPing : lastPacketReceived) + pollingInterval;
+					if(pollingTime > time && pollingTime < nextTime) nextTime = pollingTime;
+				}
+			}
+		}
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+	return nextTime;
+}
+
 std::string BidCoSPeer::handleCliCommand(std::string command)
 {
 	try
@@ -1280,10 +1389,13 @@ void BidCoSPeer::savePendingQueues()
 {
 	try
 	{
-		if(!pendingBidCoSQueues) return;
+		//Unchanged queues are not encoded again. This keeps shutdown fast with many pending config packets.
+		if(!pendingBidCoSQueues || !pendingBidCoSQueues->changed()) return;
 		std::vector<uint8_t> serializedData;
-		pendingBidCoSQueues->serialize(serializedData);
+		int64_t changes = pendingBidCoSQueues->serialize(serializedData);
+		if(changes == -1) return;
 		saveVariable(16, serializedData);
+		pendingBidCoSQueues->setSaved(changes);
 	}
 	catch(const std::exception& ex)
     {
@@ -1426,8 +1538,20 @@ bool BidCoSPeer::load(BaseLib::Systems::ICentral* device)
 {
 	try
 	{
-		std::shared_ptr<BaseLib::Database::DataTable> rows;
+		_loadTimings = PeerLoadTimings();
+		std::chrono::steady_clock::time_point phaseStart = std::chrono::steady_clock::now();
+		std::function<int64_t()> endPhase = [&phaseStart]()
+		{
+			std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+			int64_t duration = std::chrono::duration_cast<std::chrono::microseconds>(now - phaseStart).count();
+			phaseStart = now;
+			return duration;
+		};
+
+		std::shared_ptr<BaseLib::Database::DataTable> rows = _bl->db->getPeerVariables(_peerID);
+		_loadTimings.database = endPhase();
 		loadVariables(device, rows);
+		_loadTimings.unserialize = endPhase();
 
 		_rpcDevice = GD::family->getRpcDevices()->find(_deviceType, _firmwareVersion, _countFromSysinfo);
 		if(!_rpcDevice)
@@ -1436,6 +1560,9 @@ bool BidCoSPeer::load(BaseLib::Systems::ICentral* device)
 			return false;
 		}
 		initializeTypeString();
+		getFrameDecoder();
+		getFrameEncoder();
+		_loadTimings.rpcDeviceBinding = endPhase();
 		std::string entry;
 		loadConfig();
 		initializeCentralConfig();
@@ -1452,6 +1579,7 @@ bool BidCoSPeer::load(BaseLib::Systems::ICentral* device)
 		serviceMessages->load();
 
 		if(aesEnabled()) checkAESKey();
+		_loadTimings.config = endPhase();
 
 		return true;
 	}
@@ -1506,17 +1634,14 @@ bool BidCoSPeer::aesEnabled(int32_t channel)
 {
 	try
 	{
-		std::unordered_map<uint32_t, std::unordered_map<std::string, BaseLib::Systems::RpcConfigurationParameter>>::iterator channelIterator = configCentral.find(channel);
-		if(channelIterator != configCentral.end())
+		if(channel < 0) return false;
+		BaseLib::Systems::RpcConfigurationParameter* aesActive = getConfigParameter(channel, BidCoSParameterKeys::aesActive);
+		if(aesActive)
 		{
-			std::unordered_map<std::string, BaseLib::Systems::RpcConfigurationParameter>::iterator parameterIterator = channelIterator->second.find("AES_ACTIVE");
-			if(parameterIterator != channelIterator->second.end())
+			std::vector<uint8_t> parameterData = aesActive->getBinaryData();
+			if(!parameterData.empty() && (bool)parameterData.at(0))
 			{
-				std::vector<uint8_t> parameterData = parameterIterator->second.getBinaryData();
-				if(!parameterData.empty() && (bool)parameterData.at(0))
-				{
-					return true;
-				}
+				return true;
 			}
 		}
 	}
@@ -1804,6 +1929,8 @@ void BidCoSPeer::onConfigPending(bool configPending)
 	try
 	{
 		Peer::onConfigPending(configPending);
+		//The worker clears the flag. It might be scheduled later than one worker thread window, because the flag wasn't set when its time was calculated.
+		if(configPending) scheduleWorker(BaseLib::HelperFunctions::getTime() + _bl->settings.workerThreadWindow());
 
 		HomegearDevice::ReceiveModes::Enum rxModes = getRXModes();
 		if(configPending)
@@ -1843,6 +1970,8 @@ void BidCoSPeer::setValuePending(bool value)
 	{
 		_valuePending = value;
 		saveVariable(20, value);
+		//See onConfigPending()
+		if(value) scheduleWorker(BaseLib::HelperFunctions::getTime() + _bl->settings.workerThreadWindow());
 
 		HomegearDevice::ReceiveModes::Enum rxModes = getRXModes();
 		if(value)
@@ -1985,93 +2114,182 @@ bool BidCoSPeer::firmwareUpdateAvailable()
 	return false;
 }
 
-void BidCoSPeer::getValuesFromPacket(std::shared_ptr<BidCoSPacket> packet, std::vector<FrameValues>& frameValues)
+std::shared_ptr<BidCoSFrameDecoder> BidCoSPeer::getFrameDecoder()
 {
 	try
 	{
-		if(!_rpcDevice) return;
-		//equal_range returns all elements with "0" or an unknown element as argument
-		if(packet->messageType() == 0 || _rpcDevice->packetsByMessageType.find(packet->messageType()) == _rpcDevice->packetsByMessageType.end()) return;
-		std::pair<PacketsByMessageType::iterator, PacketsByMessageType::iterator> range = _rpcDevice->packetsByMessageType.equal_range((uint32_t)packet->messageType());
-		if(range.first == _rpcDevice->packetsByMessageType.end()) return;
-		PacketsByMessageType::iterator i = range.first;
-		do
-		{
-			FrameValues currentFrameValues;
-			PPacket frame(i->second);
-			if(!frame) continue;
+		std::lock_guard<std::mutex> frameDecoderGuard(_frameDecoderMutex);
+		if(!_rpcDevice) return std::shared_ptr<BidCoSFrameDecoder>();
+		//The device description is replaced by setRpcDevice() on firmware updates and when teams are created.
+		if(!_frameDecoder || _frameDecoder->getDevice() != _rpcDevice.get()) _frameDecoder.reset(new BidCoSFrameDecoder(_bl, _rpcDevice));
+		return _frameDecoder;
+	}
+	catch(const std::exception& ex)
+    {
+    	GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(BaseLib::Exception& ex)
+    {
+    	GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+    	GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+    return std::shared_ptr<BidCoSFrameDecoder>();
+}
+
+std::shared_ptr<BidCoSFrameEncoder> BidCoSPeer::getFrameEncoder()
+{
+	try
+	{
+		std::lock_guard<std::mutex> frameEncoderGuard(_frameEncoderMutex);
+		if(!_rpcDevice) return std::shared_ptr<BidCoSFrameEncoder>();
+		if(!_frameEncoder || _frameEncoder->getDevice() != _rpcDevice.get()) _frameEncoder.reset(new BidCoSFrameEncoder(_bl, _rpcDevice));
+		return _frameEncoder;
+	}
+	catch(const std::exception& ex)
+    {
+    	GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(BaseLib::Exception& ex)
+    {
+    	GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+    	GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+    return std::shared_ptr<BidCoSFrameEncoder>();
+}
+
+BaseLib::Systems::RpcConfigurationParameter* BidCoSPeer::getValueParameter(uint32_t channel, uint32_t key)
+{
+	return findParameter(valuesCentral, channel, key);
+}
+
+BaseLib::Systems::RpcConfigurationParameter* BidCoSPeer::getConfigParameter(uint32_t channel, uint32_t key)
+{
+	return findParameter(configCentral, channel, key);
+}
+
+BaseLib::Systems::RpcConfigurationParameter* BidCoSPeer::findParameter(std::unordered_map<uint32_t, std::unordered_map<std::string, BaseLib::Systems::RpcConfigurationParameter>>& parameters, uint32_t channel, uint32_t key)
+{
+	std::unordered_map<uint32_t, std::unordered_map<std::string, BaseLib::Systems::RpcConfigurationParameter>>::iterator channelIterator = parameters.find(channel);
+	if(channelIterator == parameters.end()) return nullptr;
+	std::unordered_map<std::string, BaseLib::Systems::RpcConfigurationParameter>::iterator parameterIterator = channelIterator->second.find(GD::parameterKeys.name(key));
+	if(parameterIterator == channelIterator->second.end()) return nullptr;
+	return &parameterIterator->second;
+}
+
+bool BidCoSPeer::frameVariableExists(const BidCoSFrameDecoder::Variable& variable, int32_t channel)
+{
+	if(channel < 0 || channel >= (signed)variable.channels.size()) return false;
+	int8_t state = variable.channels[channel];
+	if(state != BidCoSFrameDecoder::Variable::resolveAtRuntime) return state == BidCoSFrameDecoder::Variable::available;
+	PParameterGroup parameterGroup = getParameterSet(channel, variable.parameterSetType);
+	return parameterGroup && parameterGroup->parameters.find(variable.id) != parameterGroup->parameters.end();
+}
+
+void BidCoSPeer::getValuesFromPacket(std::shared_ptr<BidCoSPacket> packet, FrameValuesBuffer& frameValues)
+{
+	try
+	{
+		frameValues.size = 0;
+		if(!_rpcDevice || packet->messageType() == 0) return;
+		std::shared_ptr<BidCoSFrameDecoder> frameDecoder = getFrameDecoder();
+		if(!frameDecoder) return;
+		const std::vector<BidCoSFrameDecoder::Frame>* frames = frameDecoder->getFrames(packet->messageType());
+		if(!frames) return;
+		std::vector<uint8_t>* payload = packet->payload();
+		//Reused for all values of all packets of the thread.
+		static thread_local std::vector<uint8_t> data;
+		for(std::vector<BidCoSFrameDecoder::Frame>::const_iterator frame = frames->begin(); frame != frames->end(); ++frame)
+		{
 			if(frame->direction == Packet::Direction::Enum::toCentral && packet->senderAddress() != _address && (!hasTeam() || packet->senderAddress() != _team.address)) continue;
 			if(frame->direction == Packet::Direction::Enum::fromCentral && packet->destinationAddress() != _address) continue;
-			if(packet->payload()->empty()) break;
-			if(frame->subtype > -1 && frame->subtypeIndex >= 9 && (signed)packet->payload()->size() > (frame->subtypeIndex - 9) && packet->payload()->at(frame->subtypeIndex - 9) != (unsigned)frame->subtype) continue;
-			int32_t channelIndex = frame->channelIndex;
+			if(payload->empty()) break;
+			if(frame->subtypeIndex > -1 && (signed)payload->size() > frame->subtypeIndex && payload->at(frame->subtypeIndex) != frame->subtype) continue;
 			int32_t channel = -1;
-			if(channelIndex >= 9 && (signed)packet->payload()->size() > (channelIndex - 9)) channel = packet->payload()->at(channelIndex - 9);
-			if(channel > -1 && frame->channelSize < 1.0) channel &= (0xFF >> (8 - std::lround(frame->channelSize * 10) % 10));
-			if(frame->channel > -1) channel = frame->channel;
-			if(frame->length > 0 && packet->length() != frame->length) continue;
+			if(frame->channelIndex > -1 && (signed)payload->size() > frame->channelIndex) channel = payload->at(frame->channelIndex);
+			if(channel > -1 && frame->maskChannel) channel &= frame->channelMask;
+			if(frame->fixedChannel > -1) channel = frame->fixedChannel;
+			if(frame->length > 0 && packet->length() != (unsigned)frame->length) continue;
+
+			//Elements are only added, never removed, so the vectors of previous packets are reused.
+			if(frameValues.size == frameValues.frames.size()) frameValues.frames.push_back(FrameValues());
+			FrameValues& currentFrameValues = frameValues.frames[frameValues.size];
 			currentFrameValues.frameID = frame->id;
+			currentFrameValues.paramsetChannels.clear();
+			if(currentFrameValues.values.size() < frame->slotCount) currentFrameValues.values.resize(frame->slotCount);
+			currentFrameValues.valueCount = frame->slotCount;
+			for(uint32_t i = 0; i < frame->slotCount; i++)
+			{
+				currentFrameValues.values[i].channels.clear();
+			}
+			bool hasValues = false;
 
-			for(BinaryPayloads::iterator j = frame->binaryPayloads.begin(); j != frame->binaryPayloads.end(); ++j)
+			for(std::vector<BidCoSFrameDecoder::Payload>::const_iterator j = frame->payloads.begin(); j != frame->payloads.end(); ++j)
 			{
-				std::vector<uint8_t> data;
-				if((*j)->size > 0 && (*j)->index > 0)
+				const std::vector<uint8_t>* value = &j->constData;
+				if(j->hasPosition)
 				{
-					if(((int32_t)(*j)->index) - 9 >= (signed)packet->payload()->size()) continue;
-					data = packet->getPosition((*j)->index, (*j)->size, -1);
+					if(j->payloadIndex >= (signed)payload->size()) continue;
+					BidCoSFrameDecoder::getValue(packet.get(), j->position, data);
+					value = &data;
 
-					if((*j)->constValueInteger > -1)
+					if(j->hasConstValue)
 					{
 						int32_t intValue = 0;
 						_bl->hf.memcpyBigEndian(intValue, data);
-						if(intValue != (*j)->constValueInteger) break; else continue;
+						if(intValue != j->constValue) break; else continue;
 					}
 				}
-				else if((*j)->constValueInteger > -1)
-				{
-					_bl->hf.memcpyBigEndian(data, (*j)->constValueInteger);
-				}
-				else continue;
-				for(std::vector<PParameter>::iterator k = frame->associatedVariables.begin(); k != frame->associatedVariables.end(); ++k)
+
+				for(std::vector<BidCoSFrameDecoder::Variable>::const_iterator k = j->variables.begin(); k != j->variables.end(); ++k)
 				{
-					if((*k)->physical->groupId != (*j)->parameterId) continue;
-					currentFrameValues.parameterSetType = (*k)->parent()->type();
-					bool setValues = false;
+					currentFrameValues.parameterSetType = k->parameterSetType;
+					FrameValue& frameValue = currentFrameValues.values[k->slot];
+					bool setValue = false;
 					if(currentFrameValues.paramsetChannels.empty()) //Fill paramsetChannels
 					{
 						int32_t startChannel = (channel < 0) ? 0 : channel;
 						int32_t endChannel;
 						//When fixedChannel is -2 (means '*') cycle through all channels
-						if(frame->channel == -2)
+						if(frame->fixedChannel == -2)
 						{
 							startChannel = 0;
-							endChannel = _rpcDevice->functions.rbegin()->first;
+							endChannel = frameDecoder->getLastChannel();
 						}
 						else endChannel = startChannel;
 						for(int32_t l = startChannel; l <= endChannel; l++)
 						{
-							PParameterGroup parameterGroup = getParameterSet(l, currentFrameValues.parameterSetType);
-							if(!parameterGroup || parameterGroup->parameters.find((*k)->id) == parameterGroup->parameters.end()) continue;
+							if(!frameVariableExists(*k, l)) continue;
 							currentFrameValues.paramsetChannels.push_back(l);
-							currentFrameValues.values[(*k)->id].channels.insert(l);
-							setValues = true;
+							if(std::find(frameValue.channels.begin(), frameValue.channels.end(), (uint32_t)l) == frameValue.channels.end()) frameValue.channels.push_back(l);
+							setValue = true;
 						}
 					}
 					else //Use paramsetChannels
 					{
-						for(std::list<uint32_t>::const_iterator l = currentFrameValues.paramsetChannels.begin(); l != currentFrameValues.paramsetChannels.end(); ++l)
+						for(std::vector<uint32_t>::const_iterator l = currentFrameValues.paramsetChannels.begin(); l != currentFrameValues.paramsetChannels.end(); ++l)
 						{
-							PParameterGroup parameterGroup = getParameterSet(*l, currentFrameValues.parameterSetType);
-							if(!parameterGroup || parameterGroup->parameters.find((*k)->id) == parameterGroup->parameters.end()) continue;
-							currentFrameValues.values[(*k)->id].channels.insert(*l);
-							setValues = true;
+							if(!frameVariableExists(*k, *l)) continue;
+							if(std::find(frameValue.channels.begin(), frameValue.channels.end(), *l) == frameValue.channels.end()) frameValue.channels.push_back(*l);
+							setValue = true;
 						}
 					}
-					if(setValues) currentFrameValues.values[(*k)->id].value = data;
+					if(setValue)
+					{
+						frameValue.id = k->id;
+						frameValue.key = k->key;
+						frameValue.value = *value;
+						hasValues = true;
+					}
 				}
 			}
-			if(!currentFrameValues.values.empty()) frameValues.push_back(currentFrameValues);
-		} while(++i != range.second && i != _rpcDevice->packetsByMessageType.end());
+			if(hasValues) frameValues.size++;
+		}
 	}
 	catch(const std::exception& ex)
     {
@@ -2133,6 +2351,7 @@ void BidCoSPeer::handleDominoEvent(PParameter parameter, std::string& frameID, u
 			_variablesToResetMutex.lock();
 			_variablesToReset[variable->channel][variable->key] = variable;
 			_variablesToResetMutex.unlock();
+			scheduleWorker(variable->resetTime);
 			GD::out.printDebug("Debug: " + parameter->id + " will be reset in " + std::to_string((variable->resetTime - time) / 1000) + "s.", 5);
 		}
 	}
@@ -2154,8 +2373,9 @@ void BidCoSPeer::checkForBestInterface(std::string interfaceID, int32_t rssi, ui
 {
 	try
 	{
-		if(configCentral.find(0) == configCentral.end() || configCentral.at(0).find("ROAMING") == configCentral.at(0).end()) return;
-		std::vector<uint8_t> parameterData = configCentral.at(0).at("ROAMING").getBinaryData();
+		BaseLib::Systems::RpcConfigurationParameter* roaming = getConfigParameter(0, BidCoSParameterKeys::roaming);
+		if(!roaming) return;
+		std::vector<uint8_t> parameterData = roaming->getBinaryData();
 		if(parameterData.size() == 0 || parameterData.at(0) == 0) return;
 		if(interfaceID.empty() || GD::physicalInterfaces.find(interfaceID) == GD::physicalInterfaces.end()) return;
 
@@ -2195,16 +2415,63 @@ void BidCoSPeer::checkForBestInterface(std::string interfaceID, int32_t rssi, ui
     }
 }
 
+void BidCoSPeer::checkForBestInterface(const std::map<std::string, int32_t>& rssi)
+{
+	try
+	{
+		BaseLib::Systems::RpcConfigurationParameter* roaming = getConfigParameter(0, BidCoSParameterKeys::roaming);
+		if(!roaming) return;
+		std::vector<uint8_t> parameterData = roaming->getBinaryData();
+		if(parameterData.size() == 0 || parameterData.at(0) == 0) return;
+
+		std::string bestInterfaceID;
+		int32_t bestRssi = 0;
+		for(std::map<std::string, int32_t>::const_iterator i = rssi.begin(); i != rssi.end(); ++i)
+		{
+			if(i->second == 0) continue;
+			std::map<std::string, std::shared_ptr<IBidCoSInterface>>::iterator interfaceIterator = GD::physicalInterfaces.find(i->first);
+			if(interfaceIterator == GD::physicalInterfaces.end() || !interfaceIterator->second->isOpen()) continue;
+			if(bestInterfaceID.empty() || i->second < bestRssi)
+			{
+				bestInterfaceID = i->first;
+				bestRssi = i->second;
+			}
+		}
+		if(bestInterfaceID.empty() || bestInterfaceID == _physicalInterfaceID) return;
+
+		std::map<std::string, int32_t>::const_iterator currentInterface = rssi.find(_physicalInterfaceID);
+		if(currentInterface == rssi.end() || currentInterface->second - bestRssi > 10)
+		{
+			GD::bl->out.printInfo("Info: Changing interface of peer " + std::to_string(_peerID) + " to " + bestInterfaceID + ", because the reception is better.");
+			setPhysicalInterfaceID(bestInterfaceID);
+		}
+	}
+	catch(const std::exception& ex)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(BaseLib::Exception& ex)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+}
+
 void BidCoSPeer::setRSSIDevice(uint8_t rssi)
 {
 	try
 	{
 		if(_disposing || rssi == 0) return;
 		uint32_t time = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
-		if(valuesCentral.find(0) != valuesCentral.end() && valuesCentral.at(0).find("RSSI_DEVICE") != valuesCentral.at(0).end() && (time - _lastRSSIDevice) > 10)
+		if((time - _lastRSSIDevice) <= 10) return;
+		BaseLib::Systems::RpcConfigurationParameter* rssiDevice = getValueParameter(0, BidCoSParameterKeys::rssiDevice);
+		if(rssiDevice)
 		{
 			_lastRSSIDevice = time;
-			BaseLib::Systems::RpcConfigurationParameter& parameter = valuesCentral.at(0).at("RSSI_DEVICE");
+			BaseLib::Systems::RpcConfigurationParameter& parameter = *rssiDevice;
 			std::vector<uint8_t> parameterData{ rssi };
 			parameter.setBinaryData(parameterData);
 
@@ -2433,6 +2700,62 @@ PParameterGroup BidCoSPeer::getParameterSet(int32_t channel, ParameterGroup::Typ
 	return PParameterGroup();
 }
 
+void BidCoSPeer::saveReceivedParameter(BidCoSParameterWriter* parameterWriter, uint32_t channel, const std::string& key, BaseLib::Systems::RpcConfigurationParameter& parameter, std::vector<uint8_t>& value)
+{
+	try
+	{
+		if(parameter.databaseId > 0)
+		{
+			if(parameterWriter && parameterWriter->enqueue(_peerID, channel, key)) return;
+			saveParameter(parameter.databaseId, value);
+		}
+		else saveParameter(0, ParameterGroup::Type::Enum::variables, channel, key, value);
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+}
+
+uint32_t BidCoSPeer::saveQueuedParameters(const std::set<std::pair<uint32_t, std::string>>& parameters)
+{
+	uint32_t count = 0;
+	try
+	{
+		for(std::set<std::pair<uint32_t, std::string>>::const_iterator i = parameters.begin(); i != parameters.end(); ++i)
+		{
+			std::unordered_map<uint32_t, std::unordered_map<std::string, BaseLib::Systems::RpcConfigurationParameter>>::iterator channelIterator = valuesCentral.find(i->first);
+			if(channelIterator == valuesCentral.end()) continue;
+			std::unordered_map<std::string, BaseLib::Systems::RpcConfigurationParameter>::iterator parameterIterator = channelIterator->second.find(i->second);
+			if(parameterIterator == channelIterator->second.end() || parameterIterator->second.databaseId == 0) continue;
+			std::vector<uint8_t> parameterData = parameterIterator->second.getBinaryData();
+			saveParameter(parameterIterator->second.databaseId, parameterData);
+			count++;
+		}
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+	return count;
+}
+
 void BidCoSPeer::packetReceived(std::shared_ptr<BidCoSPacket> packet)
 {
 	try
@@ -2452,44 +2775,46 @@ void BidCoSPeer::packetReceived(std::shared_ptr<BidCoSPacket> packet)
 			else _bl->out.printInfo("Info: Ignoring broadcast packet from peer " + std::to_string(_peerID) + " to other peer, because AES handshakes are enabled for this peer.");
 			return;
 		}
-		std::vector<FrameValues> frameValues;
-		getValuesFromPacket(packet, frameValues);
+		//packetReceived() isn't called recursively, so one buffer per thread is enough.
+		static thread_local FrameValuesBuffer frameValuesBuffer;
+		getValuesFromPacket(packet, frameValuesBuffer);
 		std::map<uint32_t, std::shared_ptr<std::vector<std::string>>> valueKeys;
 		std::map<uint32_t, std::shared_ptr<std::vector<PVariable>>> rpcValues;
 		//Loop through all matching frames
-		for(std::vector<FrameValues>::iterator a = frameValues.begin(); a != frameValues.end(); ++a)
+		for(std::vector<FrameValues>::iterator a = frameValuesBuffer.frames.begin(); a != frameValuesBuffer.frames.begin() + frameValuesBuffer.size; ++a)
 		{
 			PPacket frame;
 			if(!a->frameID.empty()) frame = _rpcDevice->packetsById.at(a->frameID);
 
 			//Check for low battery
 			//If values is not empty, packet is valid
-			if(_rpcDevice->hasBattery && !a->values.empty() && !packet->payload()->empty() && frame && hasLowbatBit(frame))
+			if(_rpcDevice->hasBattery && !packet->payload()->empty() && frame && hasLowbatBit(frame))
 			{
 				if(packet->payload()->at(0) & 0x80) serviceMessages->set("LOWBAT", true);
 				else serviceMessages->set("LOWBAT", false);
 			}
 
-			for(std::map<std::string, FrameValue>::iterator i = a->values.begin(); i != a->values.end(); ++i)
+			for(std::vector<FrameValue>::iterator i = a->values.begin(); i != a->values.begin() + a->valueCount; ++i)
 			{
-				for(std::list<uint32_t>::const_iterator j = a->paramsetChannels.begin(); j != a->paramsetChannels.end(); ++j)
+				if(i->channels.empty()) continue;
+				for(std::vector<uint32_t>::const_iterator j = a->paramsetChannels.begin(); j != a->paramsetChannels.end(); ++j)
 				{
 					if(packet->messageType() == 0x02 && aesEnabled(*j) && !packet->validAesAck()) continue;
-					if(std::find(i->second.channels.begin(), i->second.channels.end(), *j) == i->second.channels.end()) continue;
-					if(pendingBidCoSQueues->exists(BidCoSQueueType::PEER, i->first, *j)) continue; //Don't set queued values
+					if(std::find(i->channels.begin(), i->channels.end(), *j) == i->channels.end()) continue;
+					if(pendingBidCoSQueues->exists(BidCoSQueueType::PEER, i->id, *j)) continue; //Don't set queued values
 					if(!valueKeys[*j] || !rpcValues[*j])
 					{
 						valueKeys[*j].reset(new std::vector<std::string>());
 						rpcValues[*j].reset(new std::vector<PVariable>());
 					}
 
-					BaseLib::Systems::RpcConfigurationParameter& parameter = valuesCentral[*j][i->first];
-					parameter.setBinaryData(i->second.value);
-					if(parameter.databaseId > 0) saveParameter(parameter.databaseId, i->second.value);
-					else saveParameter(0, ParameterGroup::Type::Enum::variables, *j, i->first, i->second.value);
+					BaseLib::Systems::RpcConfigurationParameter* parameterPointer = getValueParameter(*j, i->key);
+					BaseLib::Systems::RpcConfigurationParameter& parameter = parameterPointer ? *parameterPointer : valuesCentral[*j][i->id];
+					parameter.setBinaryData(i->value);
+					saveReceivedParameter(central->getParameterWriter(), *j, i->id, parameter, i->value);
 
 					// {{{ Only set PRESS_LONG of remotes once on continuous pressing
-						if(i->first == "PRESS_LONG")
+						if(i->key == BidCoSParameterKeys::pressLong)
 						{
 							if(BaseLib::HelperFunctions::getTime() - _lastPressLong < 1000)
 							{
@@ -2499,16 +2824,16 @@ void BidCoSPeer::packetReceived(std::shared_ptr<BidCoSPacket> packet)
 							}
 							_lastPressLong = BaseLib::HelperFunctions::getTime();
 						}
-						if(i->first == "PRESS_LONG_RELEASE") _lastPressLong = 0;
+						if(i->key == BidCoSParameterKeys::pressLongRelease) _lastPressLong = 0;
 					// }}}
-					if(_bl->debugLevel >= 4) GD::out.printInfo("Info: " + i->first + " on channel " + std::to_string(*j) + " of HomeMatic BidCoS peer " + std::to_string(_peerID) + " with serial number " + _serialNumber + " was set to 0x" + BaseLib::HelperFunctions::getHexString(i->second.value) + ".");
+					if(_bl->debugLevel >= 4) GD::out.printInfo("Info: " + i->id + " on channel " + std::to_string(*j) + " of HomeMatic BidCoS peer " + std::to_string(_peerID) + " with serial number " + _serialNumber + " was set to 0x" + BaseLib::HelperFunctions::getHexString(i->value) + ".");
 
 					/// {{{ Remove parameter from _variablesToReset
 						_variablesToResetMutex.lock();
 						std::map<std::int32_t, std::map<std::string, std::shared_ptr<VariableToReset>>>::iterator resetIterator1 = _variablesToReset.find(*j);
 						if(resetIterator1 != _variablesToReset.end())
 						{
-							std::map<std::string, std::shared_ptr<VariableToReset>>::iterator resetIterator2 = resetIterator1->second.find(i->first);
+							std::map<std::string, std::shared_ptr<VariableToReset>>::iterator resetIterator2 = resetIterator1->second.find(i->id);
 							if(resetIterator2 != resetIterator1->second.end())
 							{
 								if(parameter.equals(resetIterator2->second->data))
@@ -2525,26 +2850,26 @@ void BidCoSPeer::packetReceived(std::shared_ptr<BidCoSPacket> packet)
 					if(parameter.rpcParameter)
 					{
 						 //Process service messages
-						if(parameter.rpcParameter->service && !i->second.value.empty())
+						if(parameter.rpcParameter->service && !i->value.empty())
 						{
 							if(parameter.rpcParameter->logical->type == ILogical::Type::Enum::tEnum)
 							{
 								LogicalEnumeration* logical = (LogicalEnumeration*)parameter.rpcParameter->logical.get();
-								int32_t value = i->second.value.at(0);
+								int32_t value = i->value.at(0);
 								if(value >= 0 && (unsigned)value < logical->values.size() && logical->values.at(value).id == "LOWBAT")
 								{
 									serviceMessages->set("LOWBAT", true);
 								}
-								serviceMessages->set(i->first, value, *j);
+								serviceMessages->set(i->id, value, *j);
 							}
 							else if(parameter.rpcParameter->logical->type == ILogical::Type::Enum::tBoolean)
 							{
-								serviceMessages->set(i->first, (bool)i->second.value.at(0));
+								serviceMessages->set(i->id, (bool)i->value.at(0));
 							}
 						}
 
-						valueKeys[*j]->push_back(i->first);
-						rpcValues[*j]->push_back(parameter.rpcParameter->convertFromPacket(i->second.value, true));
+						valueKeys[*j]->push_back(i->id);
+						rpcValues[*j]->push_back(parameter.rpcParameter->convertFromPacket(i->value, true));
 					}
 				}
 			}
@@ -2557,12 +2882,12 @@ void BidCoSPeer::packetReceived(std::shared_ptr<BidCoSPacket> packet)
 				{
 					//Check for low battery
 					//If values is not empty, packet is valid
-					if(senderPeer->_rpcDevice->hasBattery && !a->values.empty() && !packet->payload()->empty() && frame && hasLowbatBit(frame))
+					if(senderPeer->_rpcDevice->hasBattery && !packet->payload()->empty() && frame && hasLowbatBit(frame))
 					{
 						if(packet->payload()->at(0) & 0x80) senderPeer->serviceMessages->set("LOWBAT", true);
 						else senderPeer->serviceMessages->set("LOWBAT", false);
 					}
-					for(std::list<uint32_t>::const_iterator i = a->paramsetChannels.begin(); i != a->paramsetChannels.end(); ++i)
+					for(std::vector<uint32_t>::const_iterator i = a->paramsetChannels.begin(); i != a->paramsetChannels.end(); ++i)
 					{
 						PParameterGroup parameterGroup = getParameterSet(*i, a->parameterSetType);
 						if(!parameterGroup) continue;
@@ -2573,8 +2898,7 @@ void BidCoSPeer::packetReceived(std::shared_ptr<BidCoSPacket> packet)
 							std::vector<uint8_t> parameterData;
 							rpcParameter->convertToPacket(senderPeer->getSerialNumber() + ":" + std::to_string(*i), parameterData);
 							parameter.setBinaryData(parameterData);
-							if(parameter.databaseId > 0) saveParameter(parameter.databaseId, parameterData);
-							else saveParameter(0, ParameterGroup::Type::Enum::variables, *i, "SENDERADDRESS", parameterData);
+							saveReceivedParameter(central->getParameterWriter(), *i, "SENDERADDRESS", parameter, parameterData);
 							valueKeys[*i]->push_back("SENDERADDRESS");
 							rpcValues[*i]->push_back(rpcParameter->convertFromPacket(parameterData, true));
 						}
@@ -2587,8 +2911,7 @@ void BidCoSPeer::packetReceived(std::shared_ptr<BidCoSPacket> packet)
 							std::vector<uint8_t> parameterData;
 							rpcParameter->convertToPacket(peerIdValue, parameterData);
 							parameter.setBinaryData(parameterData);
-							if(parameter.databaseId > 0) saveParameter(parameter.databaseId, parameterData);
-							else saveParameter(0, ParameterGroup::Type::Enum::variables, *i, "SENDERID", parameterData);
+							saveReceivedParameter(central->getParameterWriter(), *i, "SENDERID", parameter, parameterData);
 							valueKeys[*i]->push_back("SENDERID");
 							rpcValues[*i]->push_back(rpcParameter->convertFromPacket(parameterData, true));
 						}
@@ -2597,15 +2920,16 @@ void BidCoSPeer::packetReceived(std::shared_ptr<BidCoSPacket> packet)
 			}
 
 			//We have to do this in a seperate loop, because all parameters need to be set first
-			for(std::map<std::string, FrameValue>::iterator i = a->values.begin(); i != a->values.end(); ++i)
+			for(std::vector<FrameValue>::iterator i = a->values.begin(); i != a->values.begin() + a->valueCount; ++i)
 			{
-				for(std::list<uint32_t>::const_iterator j = a->paramsetChannels.begin(); j != a->paramsetChannels.end(); ++j)
+				if(i->channels.empty()) continue;
+				for(std::vector<uint32_t>::const_iterator j = a->paramsetChannels.begin(); j != a->paramsetChannels.end(); ++j)
 				{
 					if(packet->messageType() == 0x02 && aesEnabled(*j) && !packet->validAesAck()) continue;
-					if(std::find(i->second.channels.begin(), i->second.channels.end(), *j) == i->second.channels.end()) continue;
+					if(std::find(i->channels.begin(), i->channels.end(), *j) == i->channels.end()) continue;
 					PParameterGroup parameterGroup = getParameterSet(*j, a->parameterSetType);
 					if(!parameterGroup) continue;
-					handleDominoEvent(parameterGroup->parameters.at(i->first), a->frameID, *j);
+					handleDominoEvent(parameterGroup->parameters.at(i->id), a->frameID, *j);
 				}
 			}
 		}
@@ -2632,6 +2956,8 @@ void BidCoSPeer::packetReceived(std::shared_ptr<BidCoSPacket> packet)
 				else if(!message->typeIsEqual(packet) && queuePacket) queue->pushFront(queuePacket);
 			}
 		}
+		//Don't wait for the delay of buffered config writes while the device is awake
+		if(packet->senderAddress() == _address && (getRXModes() & HomegearDevice::ReceiveModes::Enum::wakeUp) && (packet->controlByte() & 2) && configWritesPending()) flushConfigWrites(false);
 		if(pendingBidCoSQueues && !pendingBidCoSQueues->empty() && packet->senderAddress() == _address)
 		{
 			if((getRXModes() & HomegearDevice::ReceiveModes::Enum::wakeUp) && (packet->controlByte() & 2)) //Packet is wake me up packet
@@ -2937,6 +3263,147 @@ PVariable BidCoSPeer::getParamsetDescription(BaseLib::PRpcClientInfo clientInfo,
     return Variable::createError(-32500, "Unknown application error.");
 }
 
+int64_t BidCoSPeer::getConfigWriteDelay()
+{
+	static const int64_t configWriteDelay = []() -> int64_t
+	{
+		std::string setting = GD::settings ? GD::settings->getString("configwritedelay") : "";
+		int64_t delay = setting.empty() ? 500 : BaseLib::Math::getNumber(setting);
+		if(delay < 0) delay = 0;
+		else if(delay > 10000) delay = 10000;
+		return delay;
+	}();
+	return configWriteDelay;
+}
+
+int64_t BidCoSPeer::bufferConfigWrites(int32_t channel, int32_t remoteAddress, int32_t remoteChannel, std::map<int32_t, std::map<int32_t, std::vector<uint8_t>>>& changedParameters)
+{
+	std::lock_guard<std::mutex> configWritesGuard(_configWritesMutex);
+	for(std::map<int32_t, std::map<int32_t, std::vector<uint8_t>>>::iterator i = changedParameters.begin(); i != changedParameters.end(); ++i)
+	{
+		std::map<int32_t, std::vector<uint8_t>>& indexes = _configWrites[std::make_tuple(channel, remoteAddress, remoteChannel, i->first)];
+		//The values contain all parameters at the index (see "allParameters" in putParamset()), so they can simply be replaced.
+		for(std::map<int32_t, std::vector<uint8_t>>::iterator j = i->second.begin(); j != i->second.end(); ++j)
+		{
+			indexes[j->first] = j->second;
+		}
+	}
+	//Not extended by later writes, so parameters set continuously don't delay the config indefinitely
+	if(_configWritesFlushTime == 0) _configWritesFlushTime = BaseLib::HelperFunctions::getTime() + getConfigWriteDelay();
+	return _configWritesFlushTime;
+}
+
+bool BidCoSPeer::configWritesPending()
+{
+	return _configWritesFlushTime != 0;
+}
+
+void BidCoSPeer::flushConfigWrites(bool enqueue)
+{
+	try
+	{
+		std::map<std::tuple<int32_t, int32_t, int32_t, int32_t>, std::map<int32_t, std::vector<uint8_t>>> configWrites;
+		{
+			std::lock_guard<std::mutex> configWritesGuard(_configWritesMutex);
+			configWrites.swap(_configWrites);
+			_configWritesFlushTime = 0;
+		}
+		if(configWrites.empty()) return;
+
+		std::shared_ptr<HomeMaticCentral> central = std::dynamic_pointer_cast<HomeMaticCentral>(getCentral());
+		if(!central || !pendingBidCoSQueues) return;
+
+		std::shared_ptr<BidCoSQueue> queue(new BidCoSQueue(_physicalInterface, BidCoSQueueType::CONFIG));
+		queue->noSending = true;
+		std::vector<uint8_t> payload;
+		bool firstPacket = true;
+
+		for(std::map<std::tuple<int32_t, int32_t, int32_t, int32_t>, std::map<int32_t, std::vector<uint8_t>>>::iterator i = configWrites.begin(); i != configWrites.end(); ++i)
+		{
+			int32_t channel = std::get<0>(i->first);
+			int32_t remoteAddress = std::get<1>(i->first);
+
+			//CONFIG_START
+			payload.push_back(channel);
+			payload.push_back(0x05);
+			payload.push_back(remoteAddress >> 16);
+			payload.push_back((remoteAddress >> 8) & 0xFF);
+			payload.push_back(remoteAddress & 0xFF);
+			payload.push_back(std::get<2>(i->first));
+			payload.push_back(std::get<3>(i->first));
+			uint8_t controlByte = 0xA0;
+			//Always send config start packets of the master parameter set as burst packet => no ACK otherwise for some devices. Of link
+			//parameter sets only the first packet is sent as burst packet.
+			if((firstPacket || remoteAddress == 0) && (getRXModes() & HomegearDevice::ReceiveModes::Enum::wakeOnRadio)) controlByte |= 0x10;
+			firstPacket = false;
+			std::shared_ptr<BidCoSPacket> configPacket(new BidCoSPacket(_messageCounter, controlByte, 0x01, central->getAddress(), _address, payload));
+			queue->push(configPacket);
+			queue->push(central->getMessages()->find(0x02));
+			payload.clear();
+			setMessageCounter(_messageCounter + 1);
+
+			//CONFIG_WRITE_INDEX
+			payload.push_back(channel);
+			payload.push_back(0x08);
+			for(std::map<int32_t, std::vector<uint8_t>>::iterator j = i->second.begin(); j != i->second.end(); ++j)
+			{
+				int32_t index = j->first;
+				for(std::vector<uint8_t>::iterator k = j->second.begin(); k != j->second.end(); ++k)
+				{
+					payload.push_back(index);
+					payload.push_back(*k);
+					index++;
+					if(payload.size() == 16)
+					{
+						configPacket = std::shared_ptr<BidCoSPacket>(new BidCoSPacket(_messageCounter, 0xA0, 0x01, central->getAddress(), _address, payload));
+						queue->push(configPacket);
+						queue->push(central->getMessages()->find(0x02));
+						payload.clear();
+						setMessageCounter(_messageCounter + 1);
+						payload.push_back(channel);
+						payload.push_back(0x08);
+					}
+				}
+			}
+			if(payload.size() > 2)
+			{
+				configPacket = std::shared_ptr<BidCoSPacket>(new BidCoSPacket(_messageCounter, 0xA0, 0x01, central->getAddress(), _address, payload));
+				queue->push(configPacket);
+				queue->push(central->getMessages()->find(0x02));
+				payload.clear();
+				setMessageCounter(_messageCounter + 1);
+			}
+			else payload.clear();
+
+			//END_CONFIG
+			payload.push_back(channel);
+			payload.push_back(0x06);
+			configPacket = std::shared_ptr<BidCoSPacket>(new BidCoSPacket(_messageCounter, 0xA0, 0x01, central->getAddress(), _address, payload));
+			queue->push(configPacket);
+			queue->push(central->getMessages()->find(0x02));
+			payload.clear();
+			setMessageCounter(_messageCounter + 1);
+		}
+
+		GD::out.printDebug("Debug: Writing " + std::to_string(configWrites.size()) + " buffered parameter list(s) of peer " + std::to_string(_peerID) + ".");
+		pendingBidCoSQueues->push(queue);
+		serviceMessages->setConfigPending(true);
+		if(enqueue) central->enqueuePendingQueues(_address);
+	}
+	catch(const std::exception& ex)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(BaseLib::Exception& ex)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+}
+
 PVariable BidCoSPeer::putParamset(BaseLib::PRpcClientInfo clientInfo, int32_t channel, ParameterGroup::Type::Enum type, uint64_t remoteID, int32_t remoteChannel, PVariable variables, bool checkAcls, bool onlyPushing)
 {
 	try
@@ -3046,79 +3513,17 @@ PVariable BidCoSPeer::putParamset(BaseLib::PRpcClientInfo clientInfo, int32_t ch
 				return PVariable(new Variable(VariableType::tVoid));
 			}
 
-			std::shared_ptr<BidCoSQueue> queue(new BidCoSQueue(_physicalInterface, BidCoSQueueType::CONFIG));
-			queue->noSending = true;
-			std::vector<uint8_t> payload;
+			//Write immediately when the caller expects the packets in pendingBidCoSQueues or the AES key needs to be set after the config
+			bool flush = onlyPushing || aesActivated || getConfigWriteDelay() == 0;
 			std::shared_ptr<HomeMaticCentral> central = std::dynamic_pointer_cast<HomeMaticCentral>(getCentral());
-
-			for(std::map<int32_t, std::map<int32_t, std::vector<uint8_t>>>::iterator i = changedParameters.begin(); i != changedParameters.end(); ++i)
-			{
-				//CONFIG_START
-				payload.push_back(channel);
-				payload.push_back(0x05);
-				payload.push_back(0);
-				payload.push_back(0);
-				payload.push_back(0);
-				payload.push_back(0);
-				payload.push_back(i->first);
-				uint8_t controlByte = 0xA0;
-				//Always send config start packet as burst packet => no ACK otherwise for some devices
-				if(getRXModes() & HomegearDevice::ReceiveModes::Enum::wakeOnRadio) controlByte |= 0x10;
-				std::shared_ptr<BidCoSPacket> configPacket(new BidCoSPacket(_messageCounter, controlByte, 0x01, central->getAddress(), _address, payload));
-				queue->push(configPacket);
-				queue->push(central->getMessages()->find(0x02));
-				payload.clear();
-				setMessageCounter(_messageCounter + 1);
-
-				//CONFIG_WRITE_INDEX
-				payload.push_back(channel);
-				payload.push_back(0x08);
-				for(std::map<int32_t, std::vector<uint8_t>>::iterator j = i->second.begin(); j != i->second.end(); ++j)
-				{
-					int32_t index = j->first;
-					for(std::vector<uint8_t>::iterator k = j->second.begin(); k != j->second.end(); ++k)
-					{
-						payload.push_back(index);
-						payload.push_back(*k);
-						index++;
-						if(payload.size() == 16)
-						{
-							configPacket = std::shared_ptr<BidCoSPacket>(new BidCoSPacket(_messageCounter, 0xA0, 0x01, central->getAddress(), _address, payload));
-							queue->push(configPacket);
-							queue->push(central->getMessages()->find(0x02));
-							payload.clear();
-							setMessageCounter(_messageCounter + 1);
-							payload.push_back(channel);
-							payload.push_back(0x08);
-						}
-					}
-				}
-				if(payload.size() > 2)
-				{
-					configPacket = std::shared_ptr<BidCoSPacket>(new BidCoSPacket(_messageCounter, 0xA0, 0x01, central->getAddress(), _address, payload));
-					queue->push(configPacket);
-					queue->push(central->getMessages()->find(0x02));
-					payload.clear();
-					setMessageCounter(_messageCounter + 1);
-				}
-				else payload.clear();
-
-				//END_CONFIG
-				payload.push_back(channel);
-				payload.push_back(0x06);
-				configPacket = std::shared_ptr<BidCoSPacket>(new BidCoSPacket(_messageCounter, 0xA0, 0x01, central->getAddress(), _address, payload));
-				queue->push(configPacket);
-				queue->push(central->getMessages()->find(0x02));
-				payload.clear();
-				setMessageCounter(_messageCounter + 1);
-			}
-
-			pendingBidCoSQueues->push(queue);
+			int64_t flushTime = bufferConfigWrites(channel, 0, 0, changedParameters);
+			if(flush) flushConfigWrites(false);
+			else scheduleWorker(flushTime);
 			if(aesActivated) checkAESKey(onlyPushing);
 			serviceMessages->setConfigPending(true);
 			//if((getRXModes() & HomegearDevice::ReceiveModes::Enum::always) || (getRXModes() & HomegearDevice::ReceiveModes::Enum::wakeOnRadio))
 			//{
-				if(!onlyPushing) central->enqueuePendingQueues(_address);
+				if(flush && !onlyPushing) central->enqueuePendingQueues(_address);
 			//}
 			//else
 			//{
@@ -3214,80 +3619,15 @@ PVariable BidCoSPeer::putParamset(BaseLib::PRpcClientInfo clientInfo, int32_t ch
 
 			if(changedParameters.empty() || changedParameters.begin()->second.empty()) return PVariable(new Variable(VariableType::tVoid));
 
-			std::shared_ptr<BidCoSQueue> queue(new BidCoSQueue(_physicalInterface, BidCoSQueueType::CONFIG));
-			queue->noSending = true;
-			std::vector<uint8_t> payload;
+			bool flush = onlyPushing || getConfigWriteDelay() == 0;
 			std::shared_ptr<HomeMaticCentral> central = std::dynamic_pointer_cast<HomeMaticCentral>(getCentral());
-			bool firstPacket = true;
-
-			for(std::map<int32_t, std::map<int32_t, std::vector<uint8_t>>>::iterator i = changedParameters.begin(); i != changedParameters.end(); ++i)
-			{
-				//CONFIG_START
-				payload.push_back(channel);
-				payload.push_back(0x05);
-				payload.push_back(remotePeer->address >> 16);
-				payload.push_back((remotePeer->address >> 8) & 0xFF);
-				payload.push_back(remotePeer->address & 0xFF);
-				payload.push_back(remotePeer->channel);
-				payload.push_back(i->first);
-				uint8_t controlByte = 0xA0;
-				//Only send first packet as burst packet
-				if(firstPacket && (getRXModes() & HomegearDevice::ReceiveModes::Enum::wakeOnRadio)) controlByte |= 0x10;
-				firstPacket = false;
-				std::shared_ptr<BidCoSPacket> configPacket(new BidCoSPacket(_messageCounter, controlByte, 0x01, central->getAddress(), _address, payload));
-				queue->push(configPacket);
-				queue->push(central->getMessages()->find(0x02));
-				payload.clear();
-				setMessageCounter(_messageCounter + 1);
-
-				//CONFIG_WRITE_INDEX
-				payload.push_back(channel);
-				payload.push_back(0x08);
-				for(std::map<int32_t, std::vector<uint8_t>>::iterator j = i->second.begin(); j != i->second.end(); ++j)
-				{
-					int32_t index = j->first;
-					for(std::vector<uint8_t>::iterator k = j->second.begin(); k != j->second.end(); ++k)
-					{
-						payload.push_back(index);
-						payload.push_back(*k);
-						index++;
-						if(payload.size() == 16)
-						{
-							configPacket = std::shared_ptr<BidCoSPacket>(new BidCoSPacket(_messageCounter, 0xA0, 0x01, central->getAddress(), _address, payload));
-							queue->push(configPacket);
-							queue->push(central->getMessages()->find(0x02));
-							payload.clear();
-							setMessageCounter(_messageCounter + 1);
-							payload.push_back(channel);
-							payload.push_back(0x08);
-						}
-					}
-				}
-				if(payload.size() > 2)
-				{
-					configPacket = std::shared_ptr<BidCoSPacket>(new BidCoSPacket(_messageCounter, 0xA0, 0x01, central->getAddress(), _address, payload));
-					queue->push(configPacket);
-					queue->push(central->getMessages()->find(0x02));
-					payload.clear();
-					setMessageCounter(_messageCounter + 1);
-				}
-				else payload.clear();
-
-				//END_CONFIG
-				payload.push_back(channel);
-				payload.push_back(0x06);
-				configPacket = std::shared_ptr<BidCoSPacket>(new BidCoSPacket(_messageCounter, 0xA0, 0x01, central->getAddress(), _address, payload));
-				queue->push(configPacket);
-				queue->push(central->getMessages()->find(0x02));
-				payload.clear();
-				setMessageCounter(_messageCounter + 1);
-			}
-
-			pendingBidCoSQueues->push(queue);
+			int64_t flushTime = bufferConfigWrites(channel, remotePeer->address, remotePeer->channel, changedParameters);
+			if(flush) flushConfigWrites(false);
+			else scheduleWorker(flushTime);
 			serviceMessages->setConfigPending(true);
 			//if((getRXModes() & HomegearDevice::ReceiveModes::Enum::always) || (getRXModes() & HomegearDevice::ReceiveModes::Enum::wakeOnRadio))
 			//{
-				if(!onlyPushing) central->enqueuePendingQueues(_address);
+				if(flush && !onlyPushing) central->enqueuePendingQueues(_address);
 			//}
 			//else
 			//{
@@ -3524,6 +3864,7 @@ void BidCoSPeer::addVariableToResetCallback(std::shared_ptr<CallbackFunctionPara
 		_variablesToResetMutex.lock();
 		_variablesToReset[variable->channel][variable->key] = variable;
 		_variablesToResetMutex.unlock();
+		scheduleWorker(variable->resetTime);
 	}
 	catch(const std::exception& ex)
     {
@@ -3571,20 +3912,56 @@ PVariable BidCoSPeer::setInterface(BaseLib::PRpcClientInfo clientInfo, std::stri
     return Variable::createError(-32500, "Unknown application error.");
 }
 
+void BidCoSPeer::setOnTimeCallback(std::shared_ptr<BidCoSQueue>& queue, uint32_t channel, PParameter& rpcParameter, PVariable& value, BaseLib::Systems::RpcConfigurationParameter& onTimeParameter, const std::string& frameId)
+{
+	try
+	{
+		if((rpcParameter->physical->groupId != "STATE" && rpcParameter->physical->groupId != "LEVEL") || (rpcParameter->physical->groupId == "STATE" && rpcParameter->logical->type != ILogical::Type::Enum::tBoolean) || (rpcParameter->physical->groupId == "LEVEL" && rpcParameter->logical->type != ILogical::Type::Enum::tFloat))
+		{
+			GD::out.printInfo("Info: Not setting auto reset after \"ON_TIME\" for " + rpcParameter->physical->groupId + ". Currently this is only supported for \"STATE\" of type \"boolean\" or \"LEVEL\" of type \"float\". Peer: " + std::to_string(_peerID) + " Serial number: " + _serialNumber + " Frame: " + frameId);
+			return;
+		}
+		std::vector<uint8_t> parameterData = onTimeParameter.getBinaryData();
+		if((rpcParameter->physical->groupId == "STATE" && !value->booleanValue) || (rpcParameter->physical->groupId == "LEVEL" && value->floatValue == 0) || parameterData.empty() || parameterData.at(0) == 0) return;
+		std::shared_ptr<CallbackFunctionParameter> parameters(new CallbackFunctionParameter());
+		parameters->integers.push_back(channel);
+		parameters->integers.push_back(0); //false = off
+		parameters->integers.push_back(std::lround(onTimeParameter.rpcParameter->convertFromPacket(parameterData)->floatValue * 1000));
+		parameters->strings.push_back(rpcParameter->physical->groupId);
+		queue->callbackParameter = parameters;
+		queue->queueEmptyCallback = std::bind(&BidCoSPeer::addVariableToResetCallback, this, std::placeholders::_1);
+	}
+	catch(const std::exception& ex)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(BaseLib::Exception& ex)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+}
+
 PVariable BidCoSPeer::setValue(BaseLib::PRpcClientInfo clientInfo, uint32_t channel, std::string valueKey, PVariable value, bool wait)
 {
 	try
 	{
+		int64_t commandTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
 		Peer::setValue(clientInfo, channel, valueKey, value, wait); //Ignore result, otherwise setHomegerValue might not be executed
 		if(_disposing) return Variable::createError(-32500, "Peer is disposing.");
 		if(valueKey.empty()) return Variable::createError(-5, "Value key is empty.");
 		if(channel == 0 && serviceMessages->set(valueKey, value->booleanValue)) return std::make_shared<BaseLib::Variable>();
 		if(valuesCentral.find(channel) == valuesCentral.end()) return Variable::createError(-2, "Unknown channel.");
 		if(setHomegearValue(channel, valueKey, value)) return PVariable(new Variable(VariableType::tVoid));
-		if(valuesCentral[channel].find(valueKey) == valuesCentral[channel].end()) return Variable::createError(-5, "Unknown parameter.");
-		PParameter rpcParameter = valuesCentral[channel][valueKey].rpcParameter;
+		std::unordered_map<std::string, BaseLib::Systems::RpcConfigurationParameter>& channelParameters = valuesCentral[channel];
+		std::unordered_map<std::string, BaseLib::Systems::RpcConfigurationParameter>::iterator parameterIterator = channelParameters.find(valueKey);
+		if(parameterIterator == channelParameters.end()) return Variable::createError(-5, "Unknown parameter.");
+		BaseLib::Systems::RpcConfigurationParameter& parameter = parameterIterator->second;
+		PParameter rpcParameter = parameter.rpcParameter;
 		if(!rpcParameter) return Variable::createError(-5, "Unknown parameter.");
-		BaseLib::Systems::RpcConfigurationParameter& parameter = valuesCentral[channel][valueKey];
 		std::shared_ptr<std::vector<std::string>> valueKeys(new std::vector<std::string>());
 		std::shared_ptr<std::vector<PVariable>> values(new std::vector<PVariable>());
 
@@ -3633,10 +4010,17 @@ PVariable BidCoSPeer::setValue(BaseLib::PRpcClientInfo clientInfo, uint32_t chan
 			return setValue(clientInfo, channel, toggleCast->parameter, toggleValue, wait);
 		}
 		if(rpcParameter->setPackets.empty()) return Variable::createError(-6, "parameter is read only");
-		std::string setRequest = rpcParameter->setPackets.front()->id;
-		PacketsById::iterator packetIterator = _rpcDevice->packetsById.find(setRequest);
-		if(packetIterator == _rpcDevice->packetsById.end()) return Variable::createError(-6, "No frame was found for parameter " + valueKey);
-		PPacket frame = packetIterator->second;
+		std::shared_ptr<BidCoSFrameEncoder> frameEncoder = getFrameEncoder();
+		const BidCoSFrameEncoder::Command* command = frameEncoder ? frameEncoder->getCommand(rpcParameter.get()) : nullptr;
+		PPacket frame;
+		if(command) frame = command->frame;
+		else
+		{
+			std::string setRequest = rpcParameter->setPackets.front()->id;
+			PacketsById::iterator packetIterator = _rpcDevice->packetsById.find(setRequest);
+			if(packetIterator == _rpcDevice->packetsById.end()) return Variable::createError(-6, "No frame was found for parameter " + valueKey);
+			frame = packetIterator->second;
+		}
 		std::vector<uint8_t> parameterData;
 		rpcParameter->convertToPacket(value, parameterData);
 		parameter.setBinaryData(parameterData);
@@ -3653,120 +4037,136 @@ PVariable BidCoSPeer::setValue(BaseLib::PRpcClientInfo clientInfo, uint32_t chan
 		queue->parameterName = valueKey;
 		queue->channel = channel;
 
-		std::vector<uint8_t> payload;
-		if(frame->subtype > -1 && frame->subtypeIndex >= 9)
-		{
-			while((signed)payload.size() - 1 < frame->subtypeIndex - 9) payload.push_back(0);
-			payload.at(frame->subtypeIndex - 9) = (uint8_t)frame->subtype;
-		}
-		if(frame->channelIndex >= 9)
-		{
-			while((signed)payload.size() - 1 < frame->channelIndex - 9) payload.push_back(0);
-			payload.at(frame->channelIndex - 9) = (uint8_t)channel;
-		}
 		std::shared_ptr<HomeMaticCentral> central = std::dynamic_pointer_cast<HomeMaticCentral>(getCentral());
 		uint8_t controlByte = 0xA0;
 		if(getRXModes() & HomegearDevice::ReceiveModes::Enum::wakeOnRadio) controlByte |= 0x10;
-		std::shared_ptr<BidCoSPacket> packet(new BidCoSPacket(_messageCounter, controlByte, (uint8_t)frame->type, getCentral()->getAddress(), _address, payload));
-
-		for(BinaryPayloads::iterator i = frame->binaryPayloads.begin(); i != frame->binaryPayloads.end(); ++i)
+		std::shared_ptr<BidCoSPacket> packet;
+		if(command)
 		{
-			if((*i)->constValueInteger > -1)
+			std::vector<uint8_t> payload(command->payload);
+			if(command->channelIndex > -1) payload[command->channelIndex] |= (uint8_t)channel;
+			for(std::vector<BidCoSFrameEncoder::Field>::const_iterator i = command->fields.begin(); i != command->fields.end(); ++i)
 			{
-				std::vector<uint8_t> data;
-				_bl->hf.memcpyBigEndian(data, (*i)->constValueInteger);
-				packet->setPosition((*i)->index, (*i)->size, data);
-				continue;
+				if(i->source == BidCoSFrameEncoder::Field::Source::value)
+				{
+					BidCoSFrameEncoder::setValue(payload, *i, parameterData);
+					continue;
+				}
+				BaseLib::Systems::RpcConfigurationParameter* additionalParameter = getValueParameter(channel, i->key);
+				if(!additionalParameter) continue;
+				std::vector<uint8_t> additionalData = additionalParameter->getBinaryData();
+				if(i->source == BidCoSFrameEncoder::Field::Source::onTime)
+				{
+					int32_t intValue = 0;
+					_bl->hf.memcpyBigEndian(intValue, additionalData);
+					//Don't set ON_TIME when value is false
+					if((!i->omitIfSet || intValue != i->omitIf) && (value->booleanValue || value->floatValue > 0 || value->integerValue > 0)) BidCoSFrameEncoder::setValue(payload, *i, additionalData);
+					setOnTimeCallback(queue, channel, rpcParameter, value, *additionalParameter, frame->id);
+				}
+				else BidCoSFrameEncoder::setValue(payload, *i, additionalData);
 			}
-			else if(!(*i)->constValueString.empty())
+			packet.reset(new BidCoSPacket(_messageCounter, controlByte, command->messageType, getCentral()->getAddress(), _address, payload));
+		}
+		else
+		{
+			std::vector<uint8_t> payload;
+			if(frame->subtype > -1 && frame->subtypeIndex >= 9)
 			{
-				std::vector<uint8_t> data;
-				data.insert(data.begin(), (*i)->constValueString.begin(), (*i)->constValueString.end());
-				packet->setPosition((*i)->index, (*i)->size, data);
-				continue;
+				while((signed)payload.size() - 1 < frame->subtypeIndex - 9) payload.push_back(0);
+				payload.at(frame->subtypeIndex - 9) = (uint8_t)frame->subtype;
 			}
-			BaseLib::Systems::RpcConfigurationParameter* additionalParameter = nullptr;
-			//We can't just search for param, because it is ambiguous (see for example LEVEL for HM-CC-TC.
-			if((*i)->parameterId == "ON_TIME" && valuesCentral[channel].find((*i)->parameterId) != valuesCentral[channel].end())
+			if(frame->channelIndex >= 9)
 			{
-				additionalParameter = &valuesCentral[channel][(*i)->parameterId];
-				int32_t intValue = 0;
-				std::vector<uint8_t> parameterData = additionalParameter->getBinaryData();
-				_bl->hf.memcpyBigEndian(intValue, parameterData);
-				if(!(*i)->omitIfSet || intValue != (*i)->omitIf)
-				{
-					//Don't set ON_TIME when value is false
-					if(value->booleanValue || value->floatValue > 0 || value->integerValue > 0) packet->setPosition((*i)->index, (*i)->size, parameterData);
-				}
+				while((signed)payload.size() - 1 < frame->channelIndex - 9) payload.push_back(0);
+				payload.at(frame->channelIndex - 9) = (uint8_t)channel;
 			}
-			//param sometimes is ambiguous (e. g. LEVEL of HM-CC-TC), so don't search and use the given parameter when possible
-			else if((*i)->parameterId == rpcParameter->physical->groupId)
+			packet.reset(new BidCoSPacket(_messageCounter, controlByte, (uint8_t)frame->type, getCentral()->getAddress(), _address, payload));
+
+			for(BinaryPayloads::iterator i = frame->binaryPayloads.begin(); i != frame->binaryPayloads.end(); ++i)
 			{
-				if(frame->splitAfter > -1)
+				if((*i)->constValueInteger > -1)
 				{
-					//For HM-Dis-WM55
-					if(frame->binaryPayloads.size() > 1) GD::out.printError("Error constructing packet: Split after requires that there is only one parameter.");
-					int32_t blockSize = frame->splitAfter - payload.size();
-					std::vector<uint8_t> parameterData = valuesCentral[channel][valueKey].getBinaryData();
-					int32_t blocks = parameterData.size() / blockSize;
-					if(parameterData.size() % blockSize) blocks++;
-					if(blocks > frame->maxPackets) blocks = frame->maxPackets;
-					for(int32_t j = 0; j < blocks; j++)
-					{
-						int32_t startPosition = j * blockSize;
-						int32_t endPosition = startPosition + blockSize;
-						if((unsigned)endPosition >= parameterData.size()) endPosition = parameterData.size();
-						std::vector<uint8_t> dataBlock(parameterData.begin() + startPosition, parameterData.begin() + endPosition);
-						packet->setPosition((*i)->index, (double)(endPosition - startPosition), dataBlock);
-						if(j < blocks - 1)
-						{
-							queue->push(packet);
-							queue->push(central->getMessages()->find(0x02));
-							setMessageCounter(_messageCounter + 1);
-							packet = std::shared_ptr<BidCoSPacket>(new BidCoSPacket(_messageCounter, controlByte, (uint8_t)frame->type, getCentral()->getAddress(), _address, payload));
-						}
-					}
+					std::vector<uint8_t> data;
+					_bl->hf.memcpyBigEndian(data, (*i)->constValueInteger);
+					packet->setPosition((*i)->index, (*i)->size, data);
+					continue;
 				}
-				else
+				else if(!(*i)->constValueString.empty())
 				{
-					std::vector<uint8_t> parameterData = valuesCentral[channel][valueKey].getBinaryData();
-					packet->setPosition((*i)->index, (*i)->size, parameterData);
+					std::vector<uint8_t> data;
+					data.insert(data.begin(), (*i)->constValueString.begin(), (*i)->constValueString.end());
+					packet->setPosition((*i)->index, (*i)->size, data);
+					continue;
 				}
-			}
-			//Search for all other parameters
-			else
-			{
-				bool paramFound = false;
-				for(std::unordered_map<std::string, BaseLib::Systems::RpcConfigurationParameter>::iterator j = valuesCentral[channel].begin(); j != valuesCentral[channel].end(); ++j)
+				BaseLib::Systems::RpcConfigurationParameter* additionalParameter = nullptr;
+				//We can't just search for param, because it is ambiguous (see for example LEVEL for HM-CC-TC.
+				if((*i)->parameterId == "ON_TIME" && channelParameters.find((*i)->parameterId) != channelParameters.end())
 				{
-					if((*i)->parameterId == j->second.rpcParameter->physical->groupId)
+					additionalParameter = &channelParameters[(*i)->parameterId];
+					int32_t intValue = 0;
+					std::vector<uint8_t> parameterData = additionalParameter->getBinaryData();
+					_bl->hf.memcpyBigEndian(intValue, parameterData);
+					if(!(*i)->omitIfSet || intValue != (*i)->omitIf)
 					{
-						std::vector<uint8_t> parameterData = j->second.getBinaryData();
+						//Don't set ON_TIME when value is false
+						if(value->booleanValue || value->floatValue > 0 || value->integerValue > 0) packet->setPosition((*i)->index, (*i)->size, parameterData);
+					}
+				}
+				//param sometimes is ambiguous (e. g. LEVEL of HM-CC-TC), so don't search and use the given parameter when possible
+				else if((*i)->parameterId == rpcParameter->physical->groupId)
+				{
+					if(frame->splitAfter > -1)
+					{
+						//For HM-Dis-WM55
+						if(frame->binaryPayloads.size() > 1) GD::out.printError("Error constructing packet: Split after requires that there is only one parameter.");
+						int32_t blockSize = frame->splitAfter - payload.size();
+						std::vector<uint8_t> parameterData = parameter.getBinaryData();
+						int32_t blocks = parameterData.size() / blockSize;
+						if(parameterData.size() % blockSize) blocks++;
+						if(blocks > frame->maxPackets) blocks = frame->maxPackets;
+						for(int32_t j = 0; j < blocks; j++)
+						{
+							int32_t startPosition = j * blockSize;
+							int32_t endPosition = startPosition + blockSize;
+							if((unsigned)endPosition >= parameterData.size()) endPosition = parameterData.size();
+							std::vector<uint8_t> dataBlock(parameterData.begin() + startPosition, parameterData.begin() + endPosition);
+							packet->setPosition((*i)->index, (double)(endPosition - startPosition), dataBlock);
+							if(j < blocks - 1)
+							{
+								queue->push(packet);
+								queue->push(central->getMessages()->find(0x02));
+								setMessageCounter(_messageCounter + 1);
+								packet = std::shared_ptr<BidCoSPacket>(new BidCoSPacket(_messageCounter, controlByte, (uint8_t)frame->type, getCentral()->getAddress(), _address, payload));
+							}
+						}
+					}
+					else
+					{
+						std::vector<uint8_t> parameterData = parameter.getBinaryData();
 						packet->setPosition((*i)->index, (*i)->size, parameterData);
-						paramFound = true;
-						break;
 					}
 				}
-				if(!paramFound) GD::out.printError("Error constructing packet. param \"" + (*i)->parameterId + "\" not found. Peer: " + std::to_string(_peerID) + " Serial number: " + _serialNumber + " Frame: " + frame->id);
-			}
-			if((*i)->parameterId == "ON_TIME" && additionalParameter)
-			{
-				if((rpcParameter->physical->groupId != "STATE" && rpcParameter->physical->groupId != "LEVEL") || (rpcParameter->physical->groupId == "STATE" && rpcParameter->logical->type != ILogical::Type::Enum::tBoolean) || (rpcParameter->physical->groupId == "LEVEL" && rpcParameter->logical->type != ILogical::Type::Enum::tFloat))
+				//Search for all other parameters
+				else
 				{
-					GD::out.printInfo("Info: Not setting auto reset after \"ON_TIME\" for " + rpcParameter->physical->groupId + ". Currently this is only supported for \"STATE\" of type \"boolean\" or \"LEVEL\" of type \"float\". Peer: " + std::to_string(_peerID) + " Serial number: " + _serialNumber + " Frame: " + frame->id);
-					continue;
+					bool paramFound = false;
+					for(std::unordered_map<std::string, BaseLib::Systems::RpcConfigurationParameter>::iterator j = channelParameters.begin(); j != channelParameters.end(); ++j)
+					{
+						if((*i)->parameterId == j->second.rpcParameter->physical->groupId)
+						{
+							std::vector<uint8_t> parameterData = j->second.getBinaryData();
+							packet->setPosition((*i)->index, (*i)->size, parameterData);
+							paramFound = true;
+							break;
+						}
+					}
+					if(!paramFound) GD::out.printError("Error constructing packet. param \"" + (*i)->parameterId + "\" not found. Peer: " + std::to_string(_peerID) + " Serial number: " + _serialNumber + " Frame: " + frame->id);
 				}
-				std::vector<uint8_t> parameterData = additionalParameter->getBinaryData();
-				if((rpcParameter->physical->groupId == "STATE" && !value->booleanValue) || (rpcParameter->physical->groupId == "LEVEL" && value->floatValue == 0) || parameterData.empty() || parameterData.at(0) == 0) continue;
-				std::shared_ptr<CallbackFunctionParameter> parameters(new CallbackFunctionParameter());
-				parameters->integers.push_back(channel);
-				parameters->integers.push_back(0); //false = off
-				parameters->integers.push_back(std::lround(additionalParameter->rpcParameter->convertFromPacket(parameterData)->floatValue * 1000));
-				parameters->strings.push_back(rpcParameter->physical->groupId);
-				queue->callbackParameter = parameters;
-				queue->queueEmptyCallback = std::bind(&BidCoSPeer::addVariableToResetCallback, this, std::placeholders::_1);
+				if((*i)->parameterId == "ON_TIME" && additionalParameter) setOnTimeCallback(queue, channel, rpcParameter, value, *additionalParameter, frame->id);
 			}
 		}
+		packet->setCommandTime(commandTime);
+		central->countCommand(command != nullptr);
 
 		_variablesToResetMutex.lock();
 		std::map<std::int32_t, std::map<std::string, std::shared_ptr<VariableToReset>>>::iterator resetIterator1 = _variablesToReset.find(channel);
@@ -33,6 +33,8 @@
 #include <homegear-base/BaseLib.h>
 #include "BidCoSDeviceTypes.h"
 #include "BidCoSPacket.h"
+#include "BidCoSFrameDecoder.h"
+#include "BidCoSFrameEncoder.h"
 #include "PhysicalInterfaces/IBidCoSInterface.h"
 
 #include <iomanip>
@@ -44,7 +46,10 @@
 #include <queue>
 #include <mutex>
 #include <list>
+#include <set>
 #include <tuple>
+#include <limits>
+#include <atomic>
 
 using namespace BaseLib;
 using namespace BaseLib::DeviceDescription;
@@ -56,6 +61,7 @@ class CallbackFunctionParameter;
 class HomeMaticCentral;
 class BidCoSQueue;
 class BidCoSMessages;
+class BidCoSParameterWriter;
 
 class VariableToReset
 {
@@ -73,17 +79,59 @@ public:
 class FrameValue
 {
 public:
-	std::set<uint32_t> channels;
+	std::string id;
+
+	/**
+	 * The interned parameter name, see BidCoSParameterKeys.
+	 */
+	uint32_t key = 0;
+
+	/**
+	 * Empty when the slot isn't used by the frame.
+	 */
+	std::vector<uint32_t> channels;
 	std::vector<uint8_t> value;
 };
 
+/**
+ * The values of one frame. "values" is indexed by BidCoSFrameDecoder::Variable::slot.
+ */
 class FrameValues
 {
 public:
 	std::string frameID;
-	std::list<uint32_t> paramsetChannels;
+	std::vector<uint32_t> paramsetChannels;
 	ParameterGroup::Type::Enum parameterSetType;
-	std::map<std::string, FrameValue> values;
+
+	/**
+	 * Only the first "valueCount" elements belong to the frame. The vector is never shrunk, so the vectors of the elements keep their
+	 * capacity for the next packet.
+	 */
+	std::vector<FrameValue> values;
+	uint32_t valueCount = 0;
+};
+
+/**
+ * The output of BidCoSPeer::getValuesFromPacket(). It is reused for all packets received by a thread, so after the first packets decoding
+ * doesn't allocate memory. Like in "values" of FrameValues, only the first "size" elements of "frames" are valid.
+ */
+class FrameValuesBuffer
+{
+public:
+	std::vector<FrameValues> frames;
+	uint32_t size = 0;
+};
+
+/**
+ * Durations of the phases of BidCoSPeer::load() in microseconds.
+ */
+class PeerLoadTimings
+{
+public:
+	int64_t database = 0;
+	int64_t unserialize = 0;
+	int64_t rpcDeviceBinding = 0;
+	int64_t config = 0;
 };
 
 class BidCoSPeer : public BaseLib::Systems::Peer
@@ -137,10 +185,20 @@ class BidCoSPeer : public BaseLib::Systems::Peer
         bool peerInfoPacketsEnabled = true;
 
         virtual void worker();
+
+        /**
+         * Returns the time at which worker() needs to be called next. That is the earliest variable reset, config write flush, unreach check or ping.
+         *
+         * @param time The current time in milliseconds.
+         * @return Returns the next time in milliseconds.
+         */
+        virtual int64_t getNextWorkerTime(int64_t time);
         virtual std::string handleCliCommand(std::string command);
         void initializeLinkConfig(int32_t channel, int32_t address, int32_t remoteChannel, bool useConfigFunction);
         void applyConfigFunction(int32_t channel, int32_t address, int32_t remoteChannel);
         virtual bool load(BaseLib::Systems::ICentral* device);
+
+        const PeerLoadTimings& getLoadTimings() { return _loadTimings; }
         virtual void save(bool savePeer, bool saveVariables, bool saveCentralConfig);
         void serializePeers(std::vector<uint8_t>& encodedData);
         void unserializePeers(std::shared_ptr<std::vector<char>> serializedData);
@@ -168,8 +226,43 @@ class BidCoSPeer : public BaseLib::Systems::Peer
         virtual void enqueuePendingQueues();
 
         void handleDominoEvent(PParameter parameter, std::string& frameID, uint32_t channel);
+
+        /**
+         * Returns the polling interval set in the configuration of channel 0.
+         *
+         * @return Returns the polling interval in milliseconds or 0 if polling is disabled.
+         */
+        int64_t getPollingInterval();
+
+        /**
+         * Makes sure worker() is called at or before "time". Needs to be called whenever a new deadline is added outside of worker().
+         *
+         * @param time The time in milliseconds.
+         */
+        void scheduleWorker(int64_t time);
+
+        /**
+         * Moves the config writes buffered by putParamset() as one config queue to pendingBidCoSQueues. Needs to be called by functions
+         * expecting the packets of putParamset() in pendingBidCoSQueues.
+         *
+         * @param enqueue Set to true to pass the pending queues to the queue manager.
+         */
+        void flushConfigWrites(bool enqueue = true);
+
+        /**
+         * Returns true when putParamset() buffered config writes, which were not moved to pendingBidCoSQueues yet.
+         */
+        bool configWritesPending();
         bool hasLowbatBit(PPacket frame);
         void packetReceived(std::shared_ptr<BidCoSPacket> packet);
+
+        /**
+         * Writes the current values of variables queued by BidCoSParameterWriter to the database.
+         *
+         * @param parameters The channels and IDs of the variables to write.
+         * @return Returns the number of variables written.
+         */
+        uint32_t saveQueuedParameters(const std::set<std::pair<uint32_t, std::string>>& parameters);
         bool setHomegearValue(uint32_t channel, std::string valueKey, PVariable value);
         virtual int32_t getChannelGroupedWith(int32_t channel);
         virtual int32_t getNewFirmwareVersion();
@@ -232,6 +325,13 @@ class BidCoSPeer : public BaseLib::Systems::Peer
          */
         virtual void checkForBestInterface(std::string interfaceID, int32_t rssi, uint8_t messageCounter);
 
+        /**
+         * Checks all copies of one packet for the interface with the best reception. The interface is changed, when the configuration parameter
+         * "ROAMING" is "true" and the current interface didn't receive the packet or its RSSI is more than 10 dBm worse.
+         * @param rssi The receive strength signal indicators by interface ID
+         */
+        virtual void checkForBestInterface(const std::map<std::string, int32_t>& rssi);
+
         /**
          * {@inheritDoc}
          */
@@ -243,6 +343,38 @@ class BidCoSPeer : public BaseLib::Systems::Peer
         std::mutex _variablesToResetMutex;
         std::map<std::int32_t, std::map<std::string, std::shared_ptr<VariableToReset>>> _variablesToReset;
         std::shared_ptr<IBidCoSInterface> _physicalInterface;
+        std::mutex _frameDecoderMutex;
+        std::shared_ptr<BidCoSFrameDecoder> _frameDecoder;
+        std::mutex _frameEncoderMutex;
+        std::shared_ptr<BidCoSFrameEncoder> _frameEncoder;
+
+        PeerLoadTimings _loadTimings;
+
+        // {{{ Config write buffer
+            /**
+             * Changed indexes and their values by channel, remote address, remote channel and list. The remote address and channel are 0
+             * for the master parameter set.
+             */
+            std::map<std::tuple<int32_t, int32_t, int32_t, int32_t>, std::map<int32_t, std::vector<uint8_t>>> _configWrites;
+            std::mutex _configWritesMutex;
+
+            /**
+             * The time at which the buffered config writes are flushed by worker(). 0 when nothing is buffered.
+             */
+            std::atomic<int64_t> _configWritesFlushTime{0};
+
+            /**
+             * Returns the time in milliseconds config writes are buffered. 0 disables buffering.
+             */
+            static int64_t getConfigWriteDelay();
+
+            /**
+             * Merges changed indexes into the config write buffer. Later values for the same index replace earlier ones.
+             *
+             * @return Returns the time at which the buffer needs to be flushed.
+             */
+            int64_t bufferConfigWrites(int32_t channel, int32_t remoteAddress, int32_t remoteChannel, std::map<int32_t, std::map<int32_t, std::vector<uint8_t>>>& changedParameters);
+        // }}}
 
         //In table variables:
 		int32_t _remoteChannel = 0;
@@ -308,6 +440,12 @@ class BidCoSPeer : public BaseLib::Systems::Peer
 		virtual void loadVariables(BaseLib::Systems::ICentral* device, std::shared_ptr<BaseLib::Database::DataTable>& rows);
         virtual void saveVariables();
 
+		/**
+		 * Saves a variable set by a received packet. When the variable already exists in the database, it is queued in parameterWriter and written
+		 * later together with other variables. Otherwise or when the queue is full it is saved immediately.
+		 */
+		void saveReceivedParameter(BidCoSParameterWriter* parameterWriter, uint32_t channel, const std::string& key, BaseLib::Systems::RpcConfigurationParameter& parameter, std::vector<uint8_t>& value);
+
 		virtual void setPhysicalInterface(std::shared_ptr<IBidCoSInterface> interface);
 
 		//ServiceMessages event handling
@@ -340,7 +478,48 @@ class BidCoSPeer : public BaseLib::Systems::Peer
 		 */
 		virtual void setDefaultValue(BaseLib::Systems::RpcConfigurationParameter& parameter);
 
-		void getValuesFromPacket(std::shared_ptr<BidCoSPacket> packet, std::vector<FrameValues>& frameValue);
+		/**
+		 * Returns the compiled frames of the current device description. The frames are compiled on first use and again after the device description changed.
+		 */
+		std::shared_ptr<BidCoSFrameDecoder> getFrameDecoder();
+
+		/**
+		 * Returns the compiled set frames of the current device description. Like the frame decoder the encoder is recreated after the device description changed.
+		 */
+		std::shared_ptr<BidCoSFrameEncoder> getFrameEncoder();
+
+		/**
+		 * Returns a parameter of valuesCentral by its interned name.
+		 *
+		 * @param key The key from BidCoSParameterKeys.
+		 * @return Returns nullptr when the channel doesn't have the parameter.
+		 */
+		BaseLib::Systems::RpcConfigurationParameter* getValueParameter(uint32_t channel, uint32_t key);
+
+		/**
+		 * Returns a parameter of configCentral by its interned name.
+		 *
+		 * @param key The key from BidCoSParameterKeys.
+		 * @return Returns nullptr when the channel doesn't have the parameter.
+		 */
+		BaseLib::Systems::RpcConfigurationParameter* getConfigParameter(uint32_t channel, uint32_t key);
+
+		/**
+		 * Looks the parameter up in the map by the name of the key. The maps are owned by BaseLib, so no pointers into them are kept.
+		 */
+		static BaseLib::Systems::RpcConfigurationParameter* findParameter(std::unordered_map<uint32_t, std::unordered_map<std::string, BaseLib::Systems::RpcConfigurationParameter>>& parameters, uint32_t channel, uint32_t key);
+
+		/**
+		 * Makes the queue reset STATE or LEVEL after ON_TIME, when the command switches the channel on.
+		 */
+		void setOnTimeCallback(std::shared_ptr<BidCoSQueue>& queue, uint32_t channel, PParameter& rpcParameter, PVariable& value, BaseLib::Systems::RpcConfigurationParameter& onTimeParameter, const std::string& frameId);
+
+		/**
+		 * Checks if a variable of a frame exists in the parameter set of a channel.
+		 */
+		bool frameVariableExists(const BidCoSFrameDecoder::Variable& variable, int32_t channel);
+
+		void getValuesFromPacket(std::shared_ptr<BidCoSPacket> packet, FrameValuesBuffer& frameValues);
 
 		/**
 		 * Returns if the peer needs to be woken up on next reception of a wake me up packet.
@@ -78,47 +78,81 @@ BidCoSQueue::~BidCoSQueue()
     }
 }
 
-void BidCoSQueue::serialize(std::vector<uint8_t>& encodedData)
+void BidCoSQueue::serialize(BidCoSSnapshotWriter& writer)
 {
+	std::lock_guard<std::mutex> queueGuard(_queueMutex);
 	try
 	{
-		BaseLib::BinaryEncoder encoder(GD::bl);
-		_queueMutex.lock();
-		if(_queue.size() == 0)
+		//Parameter name, channel and interface are the same for all entries, so they are only stored once per queue.
+		writer.writeByte((uint8_t)_queueType);
+		writer.writeString(parameterName);
+		writer.writeSignedInteger(channel);
+		writer.writeString(_physicalInterface ? _physicalInterface->getID() : "");
+		writer.writeInteger(_queue.size());
+		for(std::list<BidCoSQueueEntry>::iterator i = _queue.begin(); i != _queue.end(); ++i)
 		{
-			_queueMutex.unlock();
-			return;
+			std::shared_ptr<BidCoSPacket> packet = i->getPacket();
+			std::shared_ptr<BidCoSMessage> message = i->getMessage();
+			//Bits 0 and 1: entry type, bit 2: stealthy, bit 3: packet follows, bit 4: message type follows
+			uint8_t flags = ((uint8_t)i->getType() & 3) | (i->stealthy ? 4 : 0) | (packet ? 8 : 0) | (message ? 0x10 : 0);
+			writer.writeByte(flags);
+			if(packet) writer.writeBytes(packet->byteArray());
+			if(message) writer.writeByte(message->getMessageType());
 		}
-		encoder.encodeByte(encodedData, (int32_t)_queueType);
-		encoder.encodeInteger(encodedData, _queue.size());
-		for(std::list<BidCoSQueueEntry>::iterator i = _queue.begin(); i != _queue.end(); ++i)
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+}
+
+bool BidCoSQueue::unserialize(BidCoSSnapshotReader& reader)
+{
+	std::lock_guard<std::mutex> queueGuard(_queueMutex);
+	try
+	{
+		_queueType = (BidCoSQueueType)reader.readByte();
+		parameterName = reader.readString();
+		channel = reader.readSignedInteger();
+		std::string physicalInterfaceID = reader.readString();
+		std::map<std::string, std::shared_ptr<IBidCoSInterface>>::iterator interfaceIterator = GD::physicalInterfaces.find(physicalInterfaceID);
+		_physicalInterface = (interfaceIterator == GD::physicalInterfaces.end()) ? GD::defaultPhysicalInterface : interfaceIterator->second;
+		std::shared_ptr<HomeMaticCentral> central(std::dynamic_pointer_cast<HomeMaticCentral>(GD::family->getCentral()));
+		uint64_t queueSize = reader.readInteger();
+		std::vector<uint8_t> packetData;
+		for(uint64_t i = 0; i < queueSize && !reader.error(); i++)
 		{
-			encoder.encodeByte(encodedData, (uint8_t)i->getType());
-			encoder.encodeBoolean(encodedData, i->stealthy);
-			encoder.encodeBoolean(encodedData, true); //dummy
-			if(!i->getPacket()) encoder.encodeBoolean(encodedData, false);
-			else
+			BidCoSQueueEntry entry;
+			uint8_t flags = reader.readByte();
+			entry.setType((QueueEntryType)(flags & 3));
+			entry.stealthy = flags & 4;
+			if(flags & 8)
 			{
-				encoder.encodeBoolean(encodedData, true);
-				std::vector<uint8_t> packet = i->getPacket()->byteArray();
-				encoder.encodeByte(encodedData, packet.size());
-				encodedData.insert(encodedData.end(), packet.begin(), packet.end());
+				reader.readBytes(packetData);
+				if(!packetData.empty()) entry.setPacket(std::shared_ptr<BidCoSPacket>(new BidCoSPacket(packetData, false)), false);
 			}
-			std::shared_ptr<BidCoSMessage> message = i->getMessage();
-			if(!message) encoder.encodeBoolean(encodedData, false);
-			else
+			if(flags & 0x10)
 			{
-				encoder.encodeBoolean(encodedData, true);
-				uint8_t dummy = 0;
-				encoder.encodeByte(encodedData, dummy);
-				encoder.encodeByte(encodedData, message->getMessageType());
-				encoder.encodeByte(encodedData, 0); //Dummy
+				int32_t messageType = reader.readByte();
+				if(central) entry.setMessage(central->getMessages()->find(messageType), false);
 			}
-			encoder.encodeString(encodedData, parameterName);
-			encoder.encodeInteger(encodedData, channel);
-			std::string id = _physicalInterface->getID();
-			encoder.encodeString(encodedData, id);
+			if(reader.error() || (entry.getType() == QueueEntryType::PACKET && !entry.getPacket()) || (entry.getType() == QueueEntryType::MESSAGE && !entry.getMessage()))
+			{
+				GD::out.printError("Error unserializing queue of type " + std::to_string((int32_t)_queueType) + ". Clearing it...");
+				_queue.clear();
+				return false;
+			}
+			_queue.push_back(std::move(entry));
 		}
+		if(!reader.error()) return true;
 	}
 	catch(const std::exception& ex)
 	{
@@ -132,7 +166,9 @@ void BidCoSQueue::serialize(std::vector<uint8_t>& encodedData)
 	{
 		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
 	}
-	_queueMutex.unlock();
+	_queue.clear();
+	if(!_physicalInterface) _physicalInterface = GD::defaultPhysicalInterface;
+	return false;
 }
 
 void BidCoSQueue::unserialize(std::shared_ptr<std::vector<char>> serializedData, uint32_t position)
@@ -203,17 +239,13 @@ void BidCoSQueue::dispose()
 {
 	try
 	{
-		if(_disposing) return;
-		_disposing = true;
-		_startResendThreadMutex.lock();
-		GD::bl->threadManager.join(_startResendThread);
-		_startResendThreadMutex.unlock();
-		_pushPendingQueueThreadMutex.lock();
-		GD::bl->threadManager.join(_pushPendingQueueThread);
-		_pushPendingQueueThreadMutex.unlock();
-		_sendThreadMutex.lock();
-		GD::bl->threadManager.join(_sendThread);
-        _sendThreadMutex.unlock();
+		{
+			//No new tasks can be scheduled after _disposing is set within _scheduleMutex
+			std::lock_guard<std::mutex> scheduleGuard(_scheduleMutex);
+			if(_disposing) return;
+			_disposing = true;
+		}
+		if(GD::queueScheduler) GD::queueScheduler->cancel(this);
 		_queueMutex.lock();
 		_queue.clear();
 		_pendingQueues.reset();
@@ -221,27 +253,32 @@ void BidCoSQueue::dispose()
 	catch(const std::exception& ex)
     {
     	GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
-    	_sendThreadMutex.unlock();
-    	_pushPendingQueueThreadMutex.unlock();
-    	_startResendThreadMutex.unlock();
     }
     catch(BaseLib::Exception& ex)
     {
     	GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
-    	_sendThreadMutex.unlock();
-    	_pushPendingQueueThreadMutex.unlock();
-    	_startResendThreadMutex.unlock();
     }
     catch(...)
     {
     	GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
-    	_sendThreadMutex.unlock();
-    	_pushPendingQueueThreadMutex.unlock();
-    	_startResendThreadMutex.unlock();
     }
     _queueMutex.unlock();
 }
 
+void BidCoSQueue::scheduleSend(std::shared_ptr<BidCoSPacket> packet, bool stealthy)
+{
+	std::lock_guard<std::mutex> scheduleGuard(_scheduleMutex);
+	if(_disposing || !GD::queueScheduler) return;
+	GD::queueScheduler->schedule(this, std::bind(&BidCoSQueue::send, this, packet, stealthy, false));
+}
+
+void BidCoSQueue::schedulePushPendingQueue()
+{
+	std::lock_guard<std::mutex> scheduleGuard(_scheduleMutex);
+	if(_disposing || !GD::queueScheduler) return;
+	GD::queueScheduler->schedule(this, std::bind(&BidCoSQueue::pushPendingQueue, this));
+}
+
 bool BidCoSQueue::isEmpty()
 {
 	return _queue.empty() && (!_pendingQueues || _pendingQueues->empty());
@@ -265,18 +302,7 @@ void BidCoSQueue::push(std::shared_ptr<BidCoSPacket> packet, bool stealthy)
 		{
 			_queue.push_back(entry);
 			_queueMutex.unlock();
-			if(!noSending)
-			{
-				_sendThreadMutex.lock();
-				if(_disposing)
-				{
-					_sendThreadMutex.unlock();
-					return;
-				}
-				GD::bl->threadManager.join(_sendThread);
-				GD::bl->threadManager.start(_sendThread, false, GD::bl->settings.packetQueueThreadPriority(), GD::bl->settings.packetQueueThreadPolicy(), &BidCoSQueue::send, this, entry.getPacket(), entry.stealthy);
-				_sendThreadMutex.unlock();
-			}
+			if(!noSending) scheduleSend(entry.getPacket(), entry.stealthy);
 		}
 		else
 		{
@@ -287,19 +313,16 @@ void BidCoSQueue::push(std::shared_ptr<BidCoSPacket> packet, bool stealthy)
 	catch(const std::exception& ex)
     {
 		_queueMutex.unlock();
-		_sendThreadMutex.unlock();
     	GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
     }
     catch(BaseLib::Exception& ex)
     {
     	_queueMutex.unlock();
-    	_sendThreadMutex.unlock();
     	GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
     }
     catch(...)
     {
     	_queueMutex.unlock();
-    	_sendThreadMutex.unlock();
     	GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
     }
 }
@@ -385,19 +408,16 @@ void BidCoSQueue::push(std::shared_ptr<BidCoSMessage> message)
 	catch(const std::exception& ex)
     {
 		_queueMutex.unlock();
-		_sendThreadMutex.unlock();
     	GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
     }
     catch(BaseLib::Exception& ex)
     {
     	_queueMutex.unlock();
-    	_sendThreadMutex.unlock();
     	GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
     }
     catch(...)
     {
     	_queueMutex.unlock();
-    	_sendThreadMutex.unlock();
     	GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
     }
 }
@@ -423,18 +443,7 @@ void BidCoSQueue::pushFront(std::shared_ptr<BidCoSPacket> packet, bool stealthy,
 			_queueMutex.lock();
 			_queue.push_front(entry);
 			_queueMutex.unlock();
-			if(!noSending)
-			{
-				_sendThreadMutex.lock();
-				if(_disposing)
-				{
-					_sendThreadMutex.unlock();
-					return;
-				}
-				GD::bl->threadManager.join(_sendThread);
-				GD::bl->threadManager.start(_sendThread, false, GD::bl->settings.packetQueueThreadPriority(), GD::bl->settings.packetQueueThreadPolicy(), &BidCoSQueue::send, this, entry.getPacket(), entry.stealthy);
-				_sendThreadMutex.unlock();
-			}
+			if(!noSending) scheduleSend(entry.getPacket(), entry.stealthy);
 		}
 		else
 		{
@@ -446,24 +455,21 @@ void BidCoSQueue::pushFront(std::shared_ptr<BidCoSPacket> packet, bool stealthy,
 	catch(const std::exception& ex)
     {
 		_queueMutex.unlock();
-		_sendThreadMutex.unlock();
         GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
     }
     catch(BaseLib::Exception& ex)
     {
     	_queueMutex.unlock();
-    	_sendThreadMutex.unlock();
         GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
     }
     catch(...)
     {
     	_queueMutex.unlock();
-    	_sendThreadMutex.unlock();
         GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
     }
 }
 
-void BidCoSQueue::send(std::shared_ptr<BidCoSPacket> packet, bool stealthy)
+void BidCoSQueue::send(std::shared_ptr<BidCoSPacket> packet, bool stealthy, bool delayed)
 {
 	try
 	{
@@ -474,8 +480,34 @@ void BidCoSQueue::send(std::shared_ptr<BidCoSPacket> packet, bool stealthy)
 			_setWakeOnRadioBit = false;
 		}
 		std::shared_ptr<HomeMaticCentral> central(std::dynamic_pointer_cast<HomeMaticCentral>(GD::family->getCentral()));
-		if(central) central->sendPacket(_physicalInterface, packet, stealthy);
-		else GD::out.printError("Error: Device pointer of queue " + std::to_string(id) + " is null.");
+		if(!central)
+		{
+			GD::out.printError("Error: Device pointer of queue " + std::to_string(id) + " is null.");
+			return;
+		}
+		int64_t airtimeDelay = _physicalInterface ? _physicalInterface->getAirtimeDelay(packet) : 0;
+		if(airtimeDelay > 0)
+		{
+			//The queue manager would otherwise delete the queue after three seconds and set the peer unreachable.
+			keepAliveUntil(BaseLib::HelperFunctions::getTime() + airtimeDelay);
+			std::lock_guard<std::mutex> scheduleGuard(_scheduleMutex);
+			if(_disposing || !GD::queueScheduler) return;
+			GD::queueScheduler->reschedule(this, std::bind(&BidCoSQueue::send, this, packet, stealthy, false), airtimeDelay);
+			return;
+		}
+		if(!delayed)
+		{
+			//The remaining millisecond is waited for in sendPacket.
+			int64_t sendingDelay = central->getSendingDelay(_physicalInterface, packet);
+			if(sendingDelay > 1)
+			{
+				std::lock_guard<std::mutex> scheduleGuard(_scheduleMutex);
+				if(_disposing || !GD::queueScheduler) return;
+				GD::queueScheduler->reschedule(this, std::bind(&BidCoSQueue::send, this, packet, stealthy, true), sendingDelay);
+				return;
+			}
+		}
+		central->sendPacket(_physicalInterface, packet, stealthy);
 	}
 	catch(const std::exception& ex)
     {
@@ -556,16 +588,9 @@ void BidCoSQueue::pushPendingQueue()
 				_queueMutex.unlock();
 				if(!noSending)
 				{
-					_sendThreadMutex.lock();
-					if(_disposing)
-					{
-						_sendThreadMutex.unlock();
-						return;
-					}
-					GD::bl->threadManager.join(_sendThread);
+					if(_disposing) return;
 					_lastPop = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
-					GD::bl->threadManager.start(_sendThread, false, GD::bl->settings.packetQueueThreadPriority(), GD::bl->settings.packetQueueThreadPolicy(), &BidCoSQueue::send, this, i->getPacket(), i->stealthy);
-					_sendThreadMutex.unlock();
+					scheduleSend(i->getPacket(), i->stealthy);
 				}
 			}
 			else
@@ -580,19 +605,16 @@ void BidCoSQueue::pushPendingQueue()
 	catch(const std::exception& ex)
     {
 		_queueMutex.unlock();
-		_sendThreadMutex.unlock();
     	GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
     }
     catch(BaseLib::Exception& ex)
     {
     	_queueMutex.unlock();
-    	_sendThreadMutex.unlock();
     	GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
     }
     catch(...)
     {
     	_queueMutex.unlock();
-    	_sendThreadMutex.unlock();
     	GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
     }
 }
@@ -609,6 +631,12 @@ void BidCoSQueue::longKeepAlive()
 	if(lastAction) *lastAction = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count() + 5000;
 }
 
+void BidCoSQueue::keepAliveUntil(int64_t time)
+{
+	if(_disposing) return;
+	if(lastAction && *lastAction < time) *lastAction = time;
+}
+
 void BidCoSQueue::nextQueueEntry()
 {
 	try
@@ -630,15 +658,7 @@ void BidCoSQueue::nextQueueEntry()
 			{
 				_queueMutex.unlock();
 				GD::out.printDebug("Queue " + std::to_string(id) + " is empty. Pushing pending queue...");
-				_pushPendingQueueThreadMutex.lock();
-				if(_disposing)
-				{
-					_pushPendingQueueThreadMutex.unlock();
-					return;
-				}
-				GD::bl->threadManager.join(_pushPendingQueueThread);
-				GD::bl->threadManager.start(_pushPendingQueueThread, true, GD::bl->settings.packetQueueThreadPriority(), GD::bl->settings.packetQueueThreadPolicy(), &BidCoSQueue::pushPendingQueue, this);
-				_pushPendingQueueThreadMutex.unlock();
+				schedulePushPendingQueue();
 				return;
 			}
 		}
@@ -649,15 +669,7 @@ void BidCoSQueue::nextQueueEntry()
 				std::shared_ptr<BidCoSPacket> packet = _queue.front().getPacket();
 				bool stealthy = _queue.front().stealthy;
 				_queueMutex.unlock();
-				_sendThreadMutex.lock();
-				if(_disposing)
-				{
-					_sendThreadMutex.unlock();
-					return;
-				}
-				GD::bl->threadManager.join(_sendThread);
-				GD::bl->threadManager.start(_sendThread, false, GD::bl->settings.packetQueueThreadPriority(), GD::bl->settings.packetQueueThreadPolicy(), &BidCoSQueue::send, this, packet, stealthy);
-				_sendThreadMutex.unlock();
+				scheduleSend(packet, stealthy);
 			}
 			else _queueMutex.unlock();
 		}
@@ -666,22 +678,16 @@ void BidCoSQueue::nextQueueEntry()
 	catch(const std::exception& ex)
     {
 		_queueMutex.unlock();
-		_sendThreadMutex.unlock();
-		_pushPendingQueueThreadMutex.unlock();
     	GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
     }
     catch(BaseLib::Exception& ex)
     {
     	_queueMutex.unlock();
-    	_sendThreadMutex.unlock();
-    	_pushPendingQueueThreadMutex.unlock();
     	GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
     }
     catch(...)
     {
     	_queueMutex.unlock();
-    	_sendThreadMutex.unlock();
-    	_pushPendingQueueThreadMutex.unlock();
     	GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
     }
 }
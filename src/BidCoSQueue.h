@@ -32,6 +32,7 @@
 
 #include <homegear-base/BaseLib.h>
 #include "BidCoSPacket.h"
+#include "BidCoSSnapshot.h"
 #include "PhysicalInterfaces/IBidCoSInterface.h"
 
 #include <iostream>
@@ -91,17 +92,14 @@ class BidCoSQueue
         std::shared_ptr<PendingBidCoSQueues> _pendingQueues;
         std::mutex _queueMutex;
         BidCoSQueueType _queueType;
-        std::thread _sendThread;
-        std::mutex _sendThreadMutex;
-        std::thread _startResendThread;
-        std::mutex _startResendThreadMutex;
-        std::thread _pushPendingQueueThread;
-        std::mutex _pushPendingQueueThreadMutex;
+        std::mutex _scheduleMutex;
         std::atomic_bool _workingOnPendingQueue;
         int64_t _lastPop = 0;
         void (HomeMaticCentral::*_queueProcessed)() = nullptr;
         void pushPendingQueue();
         void nextQueueEntry();
+        void scheduleSend(std::shared_ptr<BidCoSPacket> packet, bool stealthy);
+        void schedulePushPendingQueue();
     public:
         uint32_t id = 0;
         uint32_t pendingQueueID = 0;
@@ -129,12 +127,36 @@ class BidCoSQueue
         bool isEmpty();
         bool pendingQueuesEmpty();
         void clear();
-        void send(std::shared_ptr<BidCoSPacket> packet, bool stealthy);
+
+        /**
+         * Sends a packet. When the receiver still needs time before it can receive the packet, sending is rescheduled once instead of
+         * blocking the worker thread of the queue scheduler. When the airtime budget of the interface is exhausted, sending is rescheduled
+         * until enough airtime is free.
+         *
+         * @param packet The packet to send.
+         * @param stealthy Set to true, when the packet should not be recorded as sent.
+         * @param delayed Set to true, when sending already was rescheduled.
+         */
+        void send(std::shared_ptr<BidCoSPacket> packet, bool stealthy, bool delayed = false);
         void keepAlive();
         void longKeepAlive();
+
+        /**
+         * Keeps the queue from being reset until the given time in milliseconds.
+         */
+        void keepAliveUntil(int64_t time);
         void setWakeOnRadioBit();
         void dispose();
-        void serialize(std::vector<uint8_t>& encodedData);
+        void serialize(BidCoSSnapshotWriter& writer);
+
+        /**
+         * @return Returns false when the data is invalid. The queue is empty then.
+         */
+        bool unserialize(BidCoSSnapshotReader& reader);
+
+        /**
+         * Reads queues saved in the format used before snapshots.
+         */
         void unserialize(std::shared_ptr<std::vector<char>> serializedData, uint32_t position = 0);
 
         BidCoSQueue();
@@ -0,0 +1,348 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Homegear.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+
+#include "BidCoSQueueScheduler.h"
+#include "GD.h"
+
+namespace BidCoS
+{
+BidCoSQueueScheduler::BidCoSQueueScheduler()
+{
+	try
+	{
+		_disposing = false;
+		_stopWorkerThreads = false;
+		_tasksExecuted = 0;
+		_lastStatisticsTime = BaseLib::HelperFunctions::getTime();
+
+		int32_t workerThreadCount = GD::settings ? GD::settings->getNumber("queueschedulerthreads") : 0;
+		if(workerThreadCount < 1) workerThreadCount = 4;
+		else if(workerThreadCount > 32) workerThreadCount = 32;
+		_workerThreads.resize(workerThreadCount);
+		for(std::vector<std::thread>::iterator i = _workerThreads.begin(); i != _workerThreads.end(); ++i)
+		{
+			GD::bl->threadManager.start(*i, true, GD::bl->settings.packetQueueThreadPriority(), GD::bl->settings.packetQueueThreadPolicy(), &BidCoSQueueScheduler::worker, this);
+		}
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+}
+
+BidCoSQueueScheduler::~BidCoSQueueScheduler()
+{
+	try
+	{
+		dispose();
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+}
+
+void BidCoSQueueScheduler::dispose()
+{
+	try
+	{
+		{
+			std::lock_guard<std::mutex> tasksGuard(_tasksMutex);
+			if(_disposing) return;
+			_disposing = true;
+			_stopWorkerThreads = true;
+		}
+		_tasksConditionVariable.notify_all();
+		for(std::vector<std::thread>::iterator i = _workerThreads.begin(); i != _workerThreads.end(); ++i)
+		{
+			GD::bl->threadManager.join(*i);
+		}
+		std::lock_guard<std::mutex> tasksGuard(_tasksMutex);
+		_tasks.clear();
+		_dueQueues.clear();
+		_runningQueues.clear();
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+	_taskFinishedConditionVariable.notify_all();
+}
+
+bool BidCoSQueueScheduler::schedule(BidCoSQueue* queue, std::function<void()> task, int64_t delay)
+{
+	try
+	{
+		if(!queue || !task) return false;
+		{
+			std::lock_guard<std::mutex> tasksGuard(_tasksMutex);
+			if(_disposing) return false;
+			Task entry;
+			entry.time = std::chrono::steady_clock::now() + std::chrono::milliseconds(delay > 0 ? delay : 0);
+			entry.function = std::move(task);
+			std::deque<Task>& queueTasks = _tasks[queue];
+			queueTasks.push_back(std::move(entry));
+			//Otherwise the queue is added when the task before this one is finished.
+			if(queueTasks.size() == 1 && _runningQueues.find(queue) == _runningQueues.end()) _dueQueues.insert(std::pair<std::chrono::steady_clock::time_point, BidCoSQueue*>(queueTasks.front().time, queue));
+		}
+		_tasksConditionVariable.notify_one();
+		return true;
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+	return false;
+}
+
+bool BidCoSQueueScheduler::reschedule(BidCoSQueue* queue, std::function<void()> task, int64_t delay)
+{
+	try
+	{
+		if(!queue || !task) return false;
+		{
+			std::lock_guard<std::mutex> tasksGuard(_tasksMutex);
+			if(_disposing) return false;
+			Task entry;
+			entry.time = std::chrono::steady_clock::now() + std::chrono::milliseconds(delay > 0 ? delay : 0);
+			entry.function = std::move(task);
+			std::deque<Task>& queueTasks = _tasks[queue];
+			queueTasks.push_front(std::move(entry));
+			if(_runningQueues.find(queue) == _runningQueues.end())
+			{
+				for(std::multimap<std::chrono::steady_clock::time_point, BidCoSQueue*>::iterator i = _dueQueues.begin(); i != _dueQueues.end();)
+				{
+					if(i->second == queue) i = _dueQueues.erase(i);
+					else ++i;
+				}
+				_dueQueues.insert(std::pair<std::chrono::steady_clock::time_point, BidCoSQueue*>(queueTasks.front().time, queue));
+			}
+		}
+		_tasksConditionVariable.notify_one();
+		return true;
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+	return false;
+}
+
+void BidCoSQueueScheduler::cancel(BidCoSQueue* queue)
+{
+	try
+	{
+		std::unique_lock<std::mutex> tasksGuard(_tasksMutex);
+		_tasks.erase(queue);
+		for(std::multimap<std::chrono::steady_clock::time_point, BidCoSQueue*>::iterator i = _dueQueues.begin(); i != _dueQueues.end();)
+		{
+			if(i->second == queue) i = _dueQueues.erase(i);
+			else ++i;
+		}
+		//Don't wait when the queue is disposed from within one of its own tasks.
+		std::unordered_map<BidCoSQueue*, std::thread::id>::iterator runningQueue = _runningQueues.find(queue);
+		while(runningQueue != _runningQueues.end() && runningQueue->second != std::this_thread::get_id())
+		{
+			_taskFinishedConditionVariable.wait(tasksGuard);
+			runningQueue = _runningQueues.find(queue);
+		}
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+}
+
+BidCoSQueueSchedulerStatistics BidCoSQueueScheduler::getStatistics()
+{
+	BidCoSQueueSchedulerStatistics statistics;
+	try
+	{
+		{
+			std::lock_guard<std::mutex> tasksGuard(_tasksMutex);
+			for(std::unordered_map<BidCoSQueue*, std::deque<Task>>::iterator i = _tasks.begin(); i != _tasks.end(); ++i)
+			{
+				statistics.tasksPending += i->second.size();
+			}
+		}
+		statistics.workerThreads = _workerThreads.size();
+		statistics.tasksExecuted = _tasksExecuted;
+
+		std::lock_guard<std::mutex> statisticsGuard(_statisticsMutex);
+		int64_t time = BaseLib::HelperFunctions::getTime();
+		if(time > _lastStatisticsTime)
+		{
+			statistics.tasksPerSecond = (double)((statistics.tasksExecuted - _lastStatisticsTasksExecuted) * 1000) / (time - _lastStatisticsTime);
+		}
+		_lastStatisticsTime = time;
+		_lastStatisticsTasksExecuted = statistics.tasksExecuted;
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+	return statistics;
+}
+
+void BidCoSQueueScheduler::worker()
+{
+	while(!_stopWorkerThreads)
+	{
+		try
+		{
+			std::unique_lock<std::mutex> tasksGuard(_tasksMutex);
+			std::multimap<std::chrono::steady_clock::time_point, BidCoSQueue*>::iterator dueQueue = _dueQueues.begin();
+			if(dueQueue == _dueQueues.end())
+			{
+				_tasksConditionVariable.wait(tasksGuard);
+				continue;
+			}
+			if(dueQueue->first > std::chrono::steady_clock::now())
+			{
+				_tasksConditionVariable.wait_until(tasksGuard, dueQueue->first);
+				continue;
+			}
+			BidCoSQueue* queue = dueQueue->second;
+			_dueQueues.erase(dueQueue);
+			std::unordered_map<BidCoSQueue*, std::deque<Task>>::iterator queueTasks = _tasks.find(queue);
+			if(queueTasks == _tasks.end()) continue;
+			if(queueTasks->second.empty())
+			{
+				_tasks.erase(queueTasks);
+				continue;
+			}
+			Task task = std::move(queueTasks->second.front());
+			queueTasks->second.pop_front();
+			_runningQueues[queue] = std::this_thread::get_id();
+			tasksGuard.unlock();
+
+			try
+			{
+				task.function();
+			}
+			catch(const std::exception& ex)
+			{
+				GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+			}
+			catch(BaseLib::Exception& ex)
+			{
+				GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+			}
+			catch(...)
+			{
+				GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+			}
+			_tasksExecuted++;
+
+			tasksGuard.lock();
+			_runningQueues.erase(queue);
+			//The queue might have been cancelled while the task was running.
+			queueTasks = _tasks.find(queue);
+			if(queueTasks != _tasks.end())
+			{
+				if(queueTasks->second.empty()) _tasks.erase(queueTasks);
+				else _dueQueues.insert(std::pair<std::chrono::steady_clock::time_point, BidCoSQueue*>(queueTasks->second.front().time, queue));
+			}
+			tasksGuard.unlock();
+			_taskFinishedConditionVariable.notify_all();
+			//Tasks of this queue might be waiting for it to finish.
+			_tasksConditionVariable.notify_all();
+		}
+		catch(const std::exception& ex)
+		{
+			GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+		}
+		catch(BaseLib::Exception& ex)
+		{
+			GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+		}
+		catch(...)
+		{
+			GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+		}
+	}
+}
+
+}
@@ -0,0 +1,132 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Homegear.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+
+#ifndef BIDCOSQUEUESCHEDULER_H_
+#define BIDCOSQUEUESCHEDULER_H_
+
+#include <homegear-base/BaseLib.h>
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <map>
+#include <deque>
+#include <unordered_map>
+#include <vector>
+
+namespace BidCoS
+{
+class BidCoSQueue;
+
+class BidCoSQueueSchedulerStatistics
+{
+public:
+	BidCoSQueueSchedulerStatistics() {}
+	virtual ~BidCoSQueueSchedulerStatistics() {}
+
+	uint32_t workerThreads = 0;
+	uint64_t tasksExecuted = 0;
+	uint64_t tasksPending = 0;
+	double tasksPerSecond = 0;
+};
+
+/**
+ * Executes the send and pushPendingQueue tasks of all BidCoSQueues on a fixed set of worker threads. Every queue has its own FIFO of tasks.
+ * A task is executed when it is due and all tasks scheduled before it on the same queue are finished. So tasks of the same queue are executed
+ * in the order they were scheduled and never concurrently, and a queue behaves as if it still had its own send thread. A task with a delay
+ * holds back the tasks scheduled after it on the same queue.
+ */
+class BidCoSQueueScheduler
+{
+public:
+	BidCoSQueueScheduler();
+	virtual ~BidCoSQueueScheduler();
+	void dispose();
+
+	/**
+	 * Schedules a task of a queue.
+	 *
+	 * @param queue The queue the task belongs to.
+	 * @param task The function to execute.
+	 * @param delay Time in milliseconds to wait before the task is executed.
+	 * @return Returns false when the scheduler is disposing.
+	 */
+	bool schedule(BidCoSQueue* queue, std::function<void()> task, int64_t delay = 0);
+
+	/**
+	 * Schedules a task of a queue before all pending tasks of the queue. Called by a running task to continue later without letting tasks
+	 * scheduled after it run first.
+	 *
+	 * @param queue The queue the task belongs to.
+	 * @param task The function to execute.
+	 * @param delay Time in milliseconds to wait before the task is executed.
+	 * @return Returns false when the scheduler is disposing.
+	 */
+	bool reschedule(BidCoSQueue* queue, std::function<void()> task, int64_t delay);
+
+	/**
+	 * Removes all pending tasks of a queue and waits for a running task of the queue to finish. Has to be called before the queue is destroyed.
+	 */
+	void cancel(BidCoSQueue* queue);
+
+	BidCoSQueueSchedulerStatistics getStatistics();
+protected:
+	class Task
+	{
+	public:
+		std::chrono::steady_clock::time_point time;
+		std::function<void()> function;
+	};
+
+	std::atomic_bool _disposing;
+	std::atomic_bool _stopWorkerThreads;
+	std::vector<std::thread> _workerThreads;
+	std::mutex _tasksMutex;
+	std::condition_variable _tasksConditionVariable;
+	std::condition_variable _taskFinishedConditionVariable;
+	std::unordered_map<BidCoSQueue*, std::deque<Task>> _tasks;
+
+	/**
+	 * Due time of the first task of every queue which has tasks and is not running.
+	 */
+	std::multimap<std::chrono::steady_clock::time_point, BidCoSQueue*> _dueQueues;
+	std::unordered_map<BidCoSQueue*, std::thread::id> _runningQueues;
+
+	std::atomic<uint64_t> _tasksExecuted;
+	std::mutex _statisticsMutex;
+	int64_t _lastStatisticsTime = 0;
+	uint64_t _lastStatisticsTasksExecuted = 0;
+
+	void worker();
+};
+
+}
+#endif
@@ -0,0 +1,222 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Homegear.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+
+
+#include "BidCoSReceptionMerger.h"
+#include "BidCoSPacket.h"
+#include "GD.h"
+
+namespace BidCoS
+{
+
+BidCoSReceptionMerger::BidCoSReceptionMerger()
+{
+}
+
+BidCoSReceptionMerger::~BidCoSReceptionMerger()
+{
+}
+
+void BidCoSReceptionMerger::init()
+{
+	try
+	{
+		std::string setting = GD::settings ? GD::settings->getString("duplicatewindow") : "";
+		_window = setting.empty() ? 150 : BaseLib::Math::getNumber(setting);
+		if(_window < 0) _window = 0;
+		else if(_window > 2000) _window = 2000;
+		if(GD::physicalInterfaces.size() < 2) _window = 0;
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+}
+
+uint64_t BidCoSReceptionMerger::getKey(std::shared_ptr<BidCoSPacket>& packet)
+{
+	//FNV-1a. The control byte is not part of the hash, as it might be changed by the interfaces (e. g. for wake up packets).
+	uint32_t hash = 2166136261u;
+	int32_t destinationAddress = packet->destinationAddress();
+	hash = (hash ^ ((destinationAddress >> 16) & 0xFF)) * 16777619u;
+	hash = (hash ^ ((destinationAddress >> 8) & 0xFF)) * 16777619u;
+	hash = (hash ^ (destinationAddress & 0xFF)) * 16777619u;
+	hash = (hash ^ packet->messageType()) * 16777619u;
+	std::vector<uint8_t>* payload = packet->payload();
+	for(std::vector<uint8_t>::iterator i = payload->begin(); i != payload->end(); ++i)
+	{
+		hash = (hash ^ *i) * 16777619u;
+	}
+	return ((uint64_t)(packet->senderAddress() & 0xFFFFFF) << 40) | ((uint64_t)packet->messageCounter() << 32) | hash;
+}
+
+bool BidCoSReceptionMerger::merge(const std::string& interfaceID, std::shared_ptr<BidCoSPacket>& packet, std::function<std::string()> getForwardInterface, std::vector<Reception>& completedReceptions)
+{
+	try
+	{
+		if(!packet) return false;
+		uint64_t key = getKey(packet);
+		int64_t time = BaseLib::HelperFunctions::getTime();
+
+		std::lock_guard<std::mutex> entriesGuard(_entriesMutex);
+		complete(time, completedReceptions);
+
+		InterfaceCounters& counters = _counters[interfaceID];
+		counters.packetsReceived++;
+		if(packet->rssiDevice() != 0)
+		{
+			counters.rssiCount++;
+			counters.rssiSum += packet->rssiDevice();
+		}
+
+		std::unordered_map<uint64_t, Entry>::iterator entryIterator = _entries.find(key);
+		if(entryIterator == _entries.end())
+		{
+			counters.packetsFirst++;
+			entryIterator = _entries.emplace(key, Entry()).first;
+			Entry& entry = entryIterator->second;
+			entry.time = time;
+			entry.forwardInterface = getForwardInterface();
+			entry.reception.senderAddress = packet->senderAddress();
+			entry.reception.roaming = packet->messageType() != 0x02 && packet->messageType() != 0x03;
+			_entryTimes.push_back(std::pair<int64_t, uint64_t>(time, key));
+		}
+
+		Entry& entry = entryIterator->second;
+		std::map<std::string, int32_t>::iterator rssiIterator = entry.reception.rssi.find(interfaceID);
+		if(rssiIterator == entry.reception.rssi.end() || rssiIterator->second == 0 || (packet->rssiDevice() != 0 && packet->rssiDevice() < rssiIterator->second)) entry.reception.rssi[interfaceID] = packet->rssiDevice();
+
+		//Repetitions received by the peer's interface are passed on, so they are acknowledged as before.
+		if(interfaceID == entry.forwardInterface)
+		{
+			counters.packetsForwarded++;
+			return true;
+		}
+		counters.duplicatesDropped++;
+		return false;
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+	return true;
+}
+
+void BidCoSReceptionMerger::collect(std::vector<Reception>& completedReceptions)
+{
+	try
+	{
+		std::lock_guard<std::mutex> entriesGuard(_entriesMutex);
+		complete(BaseLib::HelperFunctions::getTime(), completedReceptions);
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+}
+
+void BidCoSReceptionMerger::complete(int64_t time, std::vector<Reception>& completedReceptions)
+{
+	while(!_entryTimes.empty() && time - _entryTimes.front().first >= _window)
+	{
+		std::unordered_map<uint64_t, Entry>::iterator entryIterator = _entries.find(_entryTimes.front().second);
+		_entryTimes.pop_front();
+		if(entryIterator == _entries.end()) continue;
+
+		Reception& reception = entryIterator->second.reception;
+		std::map<std::string, int32_t>::iterator best = reception.rssi.end();
+		for(std::map<std::string, int32_t>::iterator i = reception.rssi.begin(); i != reception.rssi.end(); ++i)
+		{
+			if(i->second == 0) continue;
+			if(best == reception.rssi.end() || i->second < best->second) best = i;
+		}
+		if(best != reception.rssi.end()) _counters[best->first].packetsBestRssi++;
+
+		if(reception.roaming) completedReceptions.push_back(std::move(reception));
+		_entries.erase(entryIterator);
+	}
+}
+
+std::map<std::string, BidCoSReceptionStatistics> BidCoSReceptionMerger::getStatistics()
+{
+	std::map<std::string, BidCoSReceptionStatistics> statistics;
+	try
+	{
+		std::lock_guard<std::mutex> entriesGuard(_entriesMutex);
+		for(std::map<std::string, InterfaceCounters>::iterator i = _counters.begin(); i != _counters.end(); ++i)
+		{
+			BidCoSReceptionStatistics& interfaceStatistics = statistics[i->first];
+			interfaceStatistics.packetsReceived = i->second.packetsReceived;
+			interfaceStatistics.packetsFirst = i->second.packetsFirst;
+			interfaceStatistics.packetsBestRssi = i->second.packetsBestRssi;
+			interfaceStatistics.packetsForwarded = i->second.packetsForwarded;
+			interfaceStatistics.duplicatesDropped = i->second.duplicatesDropped;
+			if(i->second.rssiCount > 0) interfaceStatistics.averageRssi = (double)i->second.rssiSum / i->second.rssiCount;
+		}
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+	return statistics;
+}
+
+}
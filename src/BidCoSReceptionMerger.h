@@ -0,0 +1,172 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Homegear.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+
+
+#ifndef BIDCOSRECEPTIONMERGER_H_
+#define BIDCOSRECEPTIONMERGER_H_
+
+#include <homegear-base/BaseLib.h>
+
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace BidCoS
+{
+class BidCoSPacket;
+
+class BidCoSReceptionStatistics
+{
+public:
+	BidCoSReceptionStatistics() {}
+	virtual ~BidCoSReceptionStatistics() {}
+
+	uint64_t packetsReceived = 0;
+
+	/**
+	 * Number of packets received by this interface before any other interface.
+	 */
+	uint64_t packetsFirst = 0;
+
+	/**
+	 * Number of packets this interface received with the best RSSI of all interfaces.
+	 */
+	uint64_t packetsBestRssi = 0;
+
+	/**
+	 * Number of packets passed on to the central.
+	 */
+	uint64_t packetsForwarded = 0;
+	uint64_t duplicatesDropped = 0;
+	double averageRssi = 0;
+};
+
+/**
+ * With more than one interface the same packet is received once per interface. The reception merger groups these copies by sender, message counter
+ * and a hash of the packet within a short window. Only the copy received by the interface the peer is assigned to is passed on, all other copies are
+ * dropped before any peer lookup. When the window has passed, the RSSI values of all copies are returned as one reception to decide which interface
+ * is best for the peer.
+ */
+class BidCoSReceptionMerger
+{
+public:
+	/**
+	 * All copies of a packet.
+	 */
+	class Reception
+	{
+	public:
+		Reception() {}
+		virtual ~Reception() {}
+
+		int32_t senderAddress = 0;
+
+		/**
+		 * False for ACKs and AES handshake packets. They are not used to change the interface of a peer.
+		 */
+		bool roaming = false;
+
+		/**
+		 * The RSSI by interface ID. Smaller values are better. "0" means unknown.
+		 */
+		std::map<std::string, int32_t> rssi;
+	};
+
+	BidCoSReceptionMerger();
+	virtual ~BidCoSReceptionMerger();
+
+	/**
+	 * Reads the settings. The merger is only enabled, when more than one interface is configured.
+	 */
+	void init();
+	bool enabled() { return _window > 0; }
+
+	/**
+	 * Adds a received packet.
+	 *
+	 * @param interfaceID The ID of the interface that received the packet.
+	 * @param packet The received packet.
+	 * @param getForwardInterface Returns the ID of the interface whose copy is passed on. Only called for the first copy of a packet.
+	 * @param[out] completedReceptions Receptions whose window has passed.
+	 * @return Returns true when the packet should be processed.
+	 */
+	bool merge(const std::string& interfaceID, std::shared_ptr<BidCoSPacket>& packet, std::function<std::string()> getForwardInterface, std::vector<Reception>& completedReceptions);
+
+	/**
+	 * Returns receptions whose window has passed. Needs to be called regularly, as merge() is not called, when no packets are received.
+	 */
+	void collect(std::vector<Reception>& completedReceptions);
+
+	int64_t getWindow() { return _window; }
+	std::map<std::string, BidCoSReceptionStatistics> getStatistics();
+protected:
+	class Entry
+	{
+	public:
+		int64_t time = 0;
+		std::string forwardInterface;
+		Reception reception;
+	};
+
+	class InterfaceCounters
+	{
+	public:
+		uint64_t packetsReceived = 0;
+		uint64_t packetsFirst = 0;
+		uint64_t packetsBestRssi = 0;
+		uint64_t packetsForwarded = 0;
+		uint64_t duplicatesDropped = 0;
+		uint64_t rssiCount = 0;
+		uint64_t rssiSum = 0;
+	};
+
+	int64_t _window = 0;
+	std::mutex _entriesMutex;
+	std::unordered_map<uint64_t, Entry> _entries;
+	std::deque<std::pair<int64_t, uint64_t>> _entryTimes; //Time and key of entries in the order they were created
+	std::map<std::string, InterfaceCounters> _counters;
+
+	/**
+	 * Creates the key of a packet from the sender address, the message counter and a hash of all other fields (except the RSSI).
+	 */
+	static uint64_t getKey(std::shared_ptr<BidCoSPacket>& packet);
+
+	/**
+	 * Removes entries older than the window. _entriesMutex needs to be locked.
+	 */
+	void complete(int64_t time, std::vector<Reception>& completedReceptions);
+};
+
+}
+#endif
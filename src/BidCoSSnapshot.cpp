@@ -0,0 +1,172 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Homegear.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+
+#include "BidCoSSnapshot.h"
+
+namespace BidCoS
+{
+const uint8_t BidCoSSnapshotReader::marker;
+const uint8_t BidCoSSnapshotReader::version;
+
+BidCoSSnapshotWriter::BidCoSSnapshotWriter(std::vector<uint8_t>& data, BidCoSSnapshotType type) : _data(data)
+{
+	_data.push_back(BidCoSSnapshotReader::marker);
+	_data.push_back((uint8_t)type);
+	_data.push_back(BidCoSSnapshotReader::version);
+}
+
+void BidCoSSnapshotWriter::writeInteger(uint64_t value)
+{
+	while(value > 0x7F)
+	{
+		_data.push_back((uint8_t)(value & 0x7F) | 0x80);
+		value >>= 7;
+	}
+	_data.push_back((uint8_t)value);
+}
+
+void BidCoSSnapshotWriter::writeSignedInteger(int64_t value)
+{
+	writeInteger(((uint64_t)value << 1) ^ (uint64_t)(value >> 63));
+}
+
+void BidCoSSnapshotWriter::writeBytes(const std::vector<uint8_t>& value)
+{
+	writeInteger(value.size());
+	_data.insert(_data.end(), value.begin(), value.end());
+}
+
+void BidCoSSnapshotWriter::writeString(const std::string& value)
+{
+	std::unordered_map<std::string, uint32_t>::iterator stringIterator = _strings.find(value);
+	if(stringIterator != _strings.end())
+	{
+		writeInteger(stringIterator->second);
+		return;
+	}
+	uint32_t index = _strings.size();
+	_strings.emplace(value, index);
+	//The next free index defines the string
+	writeInteger(index);
+	writeInteger(value.size());
+	_data.insert(_data.end(), value.begin(), value.end());
+}
+
+BidCoSSnapshotReader::BidCoSSnapshotReader(const std::vector<char>& data) : _data(data)
+{
+}
+
+bool BidCoSSnapshotReader::isSnapshot(const std::vector<char>& data)
+{
+	return data.size() >= 3 && (uint8_t)data[0] == marker;
+}
+
+bool BidCoSSnapshotReader::open(BidCoSSnapshotType type)
+{
+	_position = 0;
+	_error = false;
+	_strings.clear();
+	if(!isSnapshot(_data) || (uint8_t)_data[1] != (uint8_t)type || (uint8_t)_data[2] > version)
+	{
+		_error = true;
+		return false;
+	}
+	_position = 3;
+	return true;
+}
+
+uint8_t BidCoSSnapshotReader::readByte()
+{
+	if(_position >= _data.size())
+	{
+		_error = true;
+		return 0;
+	}
+	return (uint8_t)_data[_position++];
+}
+
+uint64_t BidCoSSnapshotReader::readInteger()
+{
+	uint64_t value = 0;
+	for(uint32_t shift = 0; shift < 64; shift += 7)
+	{
+		if(_position >= _data.size())
+		{
+			_error = true;
+			return 0;
+		}
+		uint8_t byte = (uint8_t)_data[_position++];
+		value |= (uint64_t)(byte & 0x7F) << shift;
+		if(!(byte & 0x80)) return value;
+	}
+	_error = true;
+	return 0;
+}
+
+int64_t BidCoSSnapshotReader::readSignedInteger()
+{
+	uint64_t value = readInteger();
+	return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+void BidCoSSnapshotReader::readBytes(std::vector<uint8_t>& value)
+{
+	value.clear();
+	uint64_t size = readInteger();
+	if(_error || size > _data.size() - _position)
+	{
+		_error = true;
+		return;
+	}
+	value.insert(value.end(), _data.begin() + _position, _data.begin() + _position + size);
+	_position += size;
+}
+
+std::string BidCoSSnapshotReader::readString()
+{
+	uint64_t index = readInteger();
+	if(_error) return "";
+	if(index < _strings.size()) return _strings[index];
+	if(index > _strings.size())
+	{
+		_error = true;
+		return "";
+	}
+	uint64_t size = readInteger();
+	if(_error || size > _data.size() - _position)
+	{
+		_error = true;
+		return "";
+	}
+	_strings.push_back(std::string(_data.begin() + _position, _data.begin() + _position + size));
+	_position += size;
+	return _strings.back();
+}
+
+}
@@ -0,0 +1,114 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Homegear.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+
+#ifndef BIDCOSSNAPSHOT_H_
+#define BIDCOSSNAPSHOT_H_
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace BidCoS
+{
+
+enum class BidCoSSnapshotType : uint8_t
+{
+	pendingQueues = 0x51, //'Q'
+	messageCounters = 0x43 //'C'
+};
+
+/**
+ * Writes the compact binary format used for the pending queues and the message counters. A snapshot starts with a marker byte, the type
+ * and the version. Integers are stored as variable length integers (7 bits per byte), so small values only need one byte. Strings are
+ * interned: The first occurrence stores the string, every further occurrence only its index.
+ *
+ * The marker byte can't be the first byte of the BinaryEncoder format used before, so both formats can be read.
+ */
+class BidCoSSnapshotWriter
+{
+public:
+	BidCoSSnapshotWriter(std::vector<uint8_t>& data, BidCoSSnapshotType type);
+	virtual ~BidCoSSnapshotWriter() {}
+
+	void writeByte(uint8_t value) { _data.push_back(value); }
+	void writeInteger(uint64_t value);
+
+	/**
+	 * Zigzag encodes the value first, so small negative values (e. g. channel -1) also only need one byte.
+	 */
+	void writeSignedInteger(int64_t value);
+	void writeBytes(const std::vector<uint8_t>& value);
+	void writeString(const std::string& value);
+private:
+	std::vector<uint8_t>& _data;
+	std::unordered_map<std::string, uint32_t> _strings;
+};
+
+/**
+ * Reads snapshots written by BidCoSSnapshotWriter directly from the database value without copying it. Reading beyond the end or invalid
+ * string references set the error flag and return empty values.
+ */
+class BidCoSSnapshotReader
+{
+public:
+	static const uint8_t marker = 0xB5;
+	static const uint8_t version = 1;
+
+	BidCoSSnapshotReader(const std::vector<char>& data);
+	virtual ~BidCoSSnapshotReader() {}
+
+	/**
+	 * Returns true when the data starts with a snapshot header. Used to detect data saved in the old format.
+	 */
+	static bool isSnapshot(const std::vector<char>& data);
+
+	/**
+	 * Checks the header.
+	 *
+	 * @return Returns false when the data is no snapshot of the type or was written by a newer version.
+	 */
+	bool open(BidCoSSnapshotType type);
+	bool error() { return _error; }
+	bool end() { return _position >= _data.size(); }
+
+	uint8_t readByte();
+	uint64_t readInteger();
+	int64_t readSignedInteger();
+	void readBytes(std::vector<uint8_t>& value);
+	std::string readString();
+private:
+	const std::vector<char>& _data;
+	uint32_t _position = 0;
+	bool _error = false;
+	std::vector<std::string> _strings;
+};
+
+}
+#endif
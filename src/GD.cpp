@@ -37,4 +37,7 @@ namespace BidCoS
 	BaseLib::Output GD::out;
 	std::map<std::string, std::shared_ptr<IBidCoSInterface>> GD::physicalInterfaces;
 	std::shared_ptr<IBidCoSInterface> GD::defaultPhysicalInterface;
+	std::shared_ptr<BidCoSQueueScheduler> GD::queueScheduler;
+	std::shared_ptr<BidCoSDutyCycleTimer> GD::dutyCycleTimer;
+	BidCoSParameterKeys GD::parameterKeys;
 }
@@ -34,6 +34,9 @@
 #define BIDCOS_FAMILY_NAME "HomeMatic BidCoS"
 
 #include "PhysicalInterfaces/IBidCoSInterface.h"
+#include "BidCoSQueueScheduler.h"
+#include "BidCoSDutyCycleTimer.h"
+#include "BidCoSParameterKeys.h"
 #include "BidCoS.h"
 
 namespace BidCoS
@@ -49,6 +52,9 @@ public:
 	static std::shared_ptr<Systems::FamilySettings> settings;
 	static std::map<std::string, std::shared_ptr<IBidCoSInterface>> physicalInterfaces;
 	static std::shared_ptr<IBidCoSInterface> defaultPhysicalInterface;
+	static std::shared_ptr<BidCoSQueueScheduler> queueScheduler;
+	static std::shared_ptr<BidCoSDutyCycleTimer> dutyCycleTimer;
+	static BidCoSParameterKeys parameterKeys;
 	static BaseLib::Output out;
 private:
 	GD();
@@ -75,6 +75,8 @@ void HomeMaticCentral::dispose(bool wait)
 
 		stopThreads();
 
+		//Write queued variables while the peers still exist.
+		_parameterWriter.dispose();
 		_bidCoSQueueManager.dispose(false);
 		_receivedPackets.dispose(false);
 		_sentPackets.dispose(false);
@@ -84,6 +86,13 @@ void HomeMaticCentral::dispose(bool wait)
 		{
 			try
 			{
+				//Buffered config writes are saved as pending queues
+				std::shared_ptr<BidCoSPeer> peer = std::dynamic_pointer_cast<BidCoSPeer>(i->second);
+				if(peer && peer->configWritesPending())
+				{
+					peer->flushConfigWrites(false);
+					peer->savePendingQueues();
+				}
 				i->second->dispose();
 			}
 			catch(const std::exception& ex)
@@ -145,7 +154,10 @@ void HomeMaticCentral::stopThreads()
 		_bl->threadManager.join(_updateFirmwareThread);
 		_updateFirmwareThreadMutex.unlock();
 
+		_peerWorkerMutex.lock();
 		_stopWorkerThread = true;
+		_peerWorkerConditionVariable.notify_all();
+		_peerWorkerMutex.unlock();
 		GD::out.printDebug("Debug: Waiting for worker thread of device " + std::to_string(_deviceId) + "...");
 		_bl->threadManager.join(_workerThread);
 	}
@@ -174,11 +186,15 @@ void HomeMaticCentral::init()
 		_pairing = false;
 		_stopPairingModeThread = false;
 		_updateMode = false;
+		_commandsEncoded = 0;
+		_commandsGeneric = 0;
 
 		_messages = std::shared_ptr<BidCoSMessages>(new BidCoSMessages());
 		_messageCounter[0] = 0; //Broadcast message counter
 
 		setUpBidCoSMessages();
+		_parameterWriter.init(this);
+		_receptionMerger.init();
 
 		for(std::map<std::string, std::shared_ptr<IBidCoSInterface>>::iterator i = GD::physicalInterfaces.begin(); i != GD::physicalInterfaces.end(); ++i)
 		{
@@ -227,43 +243,161 @@ void HomeMaticCentral::setUpBidCoSMessages()
     }
 }
 
+std::shared_ptr<BidCoSPeer> HomeMaticCentral::loadPeer(BaseLib::Database::DataRow& row)
+{
+	try
+	{
+		int32_t peerId = row.at(0)->intValue;
+		GD::out.printMessage("Loading peer " + std::to_string(peerId));
+		int32_t address = row.at(2)->intValue;
+		std::string serialNumber = row.at(3)->textValue;
+		std::shared_ptr<BidCoSPeer> peer;
+		if(serialNumber.substr(0, 3) == "VCD")
+		{
+			if(row.at(4)->intValue == (uint32_t)DeviceType::HMCCTC)
+			{
+				GD::out.printMessage("Peer is virtual.");
+				peer.reset(new HmCcTc(peerId, address, serialNumber, _deviceId, this));
+			}
+			else
+			{
+				GD::out.printError("Error: Unknown virtual HM-CC-TC: 0x" + BaseLib::HelperFunctions::getHexString(row.at(4)->intValue));
+				return std::shared_ptr<BidCoSPeer>();
+			}
+		}
+		else peer.reset(new BidCoSPeer(peerId, address, serialNumber, _deviceId, this));
+		if(!peer->load(this) || !peer->getRpcDevice()) return std::shared_ptr<BidCoSPeer>();
+		return peer;
+	}
+	catch(const std::exception& ex)
+    {
+    	GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(BaseLib::Exception& ex)
+    {
+    	GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+    	GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+    return std::shared_ptr<BidCoSPeer>();
+}
+
+void HomeMaticCentral::loadPeersThread(std::vector<BaseLib::Database::DataRow*>* rows, std::vector<std::shared_ptr<BidCoSPeer>>* peers, std::atomic<uint32_t>* nextRow)
+{
+	try
+	{
+		//Every row is written by exactly one thread, so no locking is necessary.
+		for(uint32_t index = (*nextRow)++; index < rows->size(); index = (*nextRow)++)
+		{
+			peers->at(index) = loadPeer(*rows->at(index));
+		}
+	}
+	catch(const std::exception& ex)
+    {
+    	GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(BaseLib::Exception& ex)
+    {
+    	GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+    	GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+}
+
 void HomeMaticCentral::loadPeers()
 {
 	try
 	{
+		std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+		std::chrono::steady_clock::time_point phaseStart = startTime;
+		std::function<int64_t()> endPhase = [&phaseStart]()
+		{
+			std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+			int64_t duration = std::chrono::duration_cast<std::chrono::milliseconds>(now - phaseStart).count();
+			phaseStart = now;
+			return duration;
+		};
+
 		std::shared_ptr<BaseLib::Database::DataTable> rows = _bl->db->getPeers(_deviceId);
+		int64_t databaseTime = endPhase();
+		std::vector<BaseLib::Database::DataRow*> peerRows;
+		peerRows.reserve(rows->size());
 		for(BaseLib::Database::DataTable::iterator row = rows->begin(); row != rows->end(); ++row)
 		{
-			int32_t peerId = row->second.at(0)->intValue;
-			GD::out.printMessage("Loading peer " + std::to_string(peerId));
-			int32_t address = row->second.at(2)->intValue;
-			std::string serialNumber = row->second.at(3)->textValue;
-			std::shared_ptr<BidCoSPeer> peer;
-			if(serialNumber.substr(0, 3) == "VCD")
+			peerRows.push_back(&row->second);
+		}
+
+		// {{{ Load peers in parallel
+			std::vector<std::shared_ptr<BidCoSPeer>> peers(peerRows.size());
+			int32_t threadCount = GD::settings ? GD::settings->getNumber("peerloadthreads") : 0;
+			if(threadCount < 1) threadCount = std::thread::hardware_concurrency();
+			if(threadCount < 1) threadCount = 1;
+			else if(threadCount > 16) threadCount = 16;
+			if((unsigned)threadCount > peerRows.size()) threadCount = peerRows.size();
+			std::atomic<uint32_t> nextRow(0);
+			//The current thread is one of the workers. If a thread can't be started, the remaining threads load its rows.
+			std::vector<std::thread> threads(threadCount > 1 ? threadCount - 1 : 0);
+			for(std::vector<std::thread>::iterator i = threads.begin(); i != threads.end(); ++i)
 			{
-				if(row->second.at(4)->intValue == (uint32_t)DeviceType::HMCCTC)
+				try
 				{
-					GD::out.printMessage("Peer is virtual.");
-					peer.reset(new HmCcTc(peerId, address, serialNumber, _deviceId, this));
+					_bl->threadManager.start(*i, false, &HomeMaticCentral::loadPeersThread, this, &peerRows, &peers, &nextRow);
 				}
-				else
+				catch(const std::exception& ex)
 				{
-					GD::out.printError("Error: Unknown virtual HM-CC-TC: 0x" + BaseLib::HelperFunctions::getHexString(row->second.at(4)->intValue));
-					continue;
+					GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+				}
+				catch(BaseLib::Exception& ex)
+				{
+					GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
 				}
 			}
-			else peer.reset(new BidCoSPeer(peerId, address, row->second.at(3)->textValue, _deviceId, this));
-			if(!peer->load(this)) continue;
-			PHomegearDevice rpcDevice = peer->getRpcDevice();
-			if(!rpcDevice) continue;
+			loadPeersThread(&peerRows, &peers, &nextRow);
+			for(std::vector<std::thread>::iterator i = threads.begin(); i != threads.end(); ++i)
+			{
+				_bl->threadManager.join(*i);
+			}
+		// }}}
+		int64_t loadTime = endPhase();
+
+		// {{{ Publish all peers in one step
+			PeerLoadTimings peerTimings;
+			uint32_t peerCount = 0;
 			_peersMutex.lock();
-			if(peer->getAddress() != _address) _peers[peer->getAddress()] = peer;
-			if(!peer->getSerialNumber().empty()) _peersBySerial[peer->getSerialNumber()] = peer;
-			_peersById[peerId] = peer;
+			for(std::vector<std::shared_ptr<BidCoSPeer>>::iterator i = peers.begin(); i != peers.end(); ++i)
+			{
+				if(!*i) continue;
+				std::shared_ptr<BidCoSPeer>& peer = *i;
+				if(peer->getAddress() != _address) _peers[peer->getAddress()] = peer;
+				if(!peer->getSerialNumber().empty()) _peersBySerial[peer->getSerialNumber()] = peer;
+				_peersById[peer->getID()] = peer;
+				peerCount++;
+
+				const PeerLoadTimings& timings = peer->getLoadTimings();
+				peerTimings.database += timings.database;
+				peerTimings.unserialize += timings.unserialize;
+				peerTimings.rpcDeviceBinding += timings.rpcDeviceBinding;
+				peerTimings.config += timings.config;
+			}
 			_peersMutex.unlock();
-			peer->getPhysicalInterface()->addPeer(peer->getPeerInfo());
-			if(!peer->getTeamRemoteSerialNumber().empty())
+		// }}}
+
+		for(std::vector<std::shared_ptr<BidCoSPeer>>::iterator i = peers.begin(); i != peers.end(); ++i)
+		{
+			if(*i) (*i)->getPhysicalInterface()->addPeer((*i)->getPeerInfo());
+		}
+		int64_t interfaceTime = endPhase();
+
+		// {{{ Create teams in database order, so the result doesn't depend on which thread loaded a peer first
+			for(std::vector<std::shared_ptr<BidCoSPeer>>::iterator i = peers.begin(); i != peers.end(); ++i)
 			{
+				std::shared_ptr<BidCoSPeer>& peer = *i;
+				if(!peer || peer->getTeamRemoteSerialNumber().empty()) continue;
+				PHomegearDevice rpcDevice = peer->getRpcDevice();
 				_peersMutex.lock();
 				if(_peersBySerial.find(peer->getTeamRemoteSerialNumber()) == _peersBySerial.end())
 				{
@@ -276,16 +410,20 @@ void HomeMaticCentral::loadPeers()
 					_peersById[team->getID()] = team;
 				}
 				_peersMutex.unlock();
-				for(Functions::iterator i = rpcDevice->functions.begin(); i != rpcDevice->functions.end(); ++i)
+				for(Functions::iterator j = rpcDevice->functions.begin(); j != rpcDevice->functions.end(); ++j)
 				{
-					if(i->second->hasGroup)
+					if(j->second->hasGroup)
 					{
 						getPeer(peer->getTeamRemoteSerialNumber())->teamChannels.push_back(std::pair<std::string, uint32_t>(peer->getSerialNumber(), peer->getTeamRemoteChannel()));
 						break;
 					}
 				}
 			}
-		}
+		// }}}
+		int64_t teamTime = endPhase();
+
+		GD::out.printInfo("Info: Loaded " + std::to_string(peerCount) + " peers in " + std::to_string(std::chrono::duration_cast<std::chrono::milliseconds>(phaseStart - startTime).count()) + " ms using " + std::to_string(threadCount) + " threads. Fetching peers: " + std::to_string(databaseTime) + " ms, loading peers: " + std::to_string(loadTime) + " ms, interface registration: " + std::to_string(interfaceTime) + " ms, teams: " + std::to_string(teamTime) + " ms.");
+		GD::out.printInfo("Info: Peer load phases summed over all threads: Database: " + std::to_string(peerTimings.database / 1000) + " ms, unserialize: " + std::to_string(peerTimings.unserialize / 1000) + " ms, device binding: " + std::to_string(peerTimings.rpcDeviceBinding / 1000) + " ms, config: " + std::to_string(peerTimings.config / 1000) + " ms.");
 	}
 	catch(const std::exception& ex)
     {
@@ -367,7 +505,9 @@ void HomeMaticCentral::saveMessageCounters()
 	{
 		std::vector<uint8_t> serializedData;
 		serializeMessageCounters(serializedData);
+		if(serializedData == _savedMessageCounters) return;
 		saveVariable(2, serializedData);
+		_savedMessageCounters.swap(serializedData);
 	}
 	catch(const std::exception& ex)
     {
@@ -387,12 +527,17 @@ void HomeMaticCentral::serializeMessageCounters(std::vector<uint8_t>& encodedDat
 {
 	try
 	{
-		BaseLib::BinaryEncoder encoder(_bl);
-		encoder.encodeInteger(encodedData, _messageCounter.size());
-		for(std::unordered_map<int32_t, uint8_t>::const_iterator i = _messageCounter.begin(); i != _messageCounter.end(); ++i)
-		{
-			encoder.encodeInteger(encodedData, i->first);
-			encoder.encodeByte(encodedData, i->second);
+		//Sorted, so unchanged counters always result in the same data. The differences of the addresses mostly need two or three bytes.
+		std::map<int32_t, uint8_t> messageCounter(_messageCounter.begin(), _messageCounter.end());
+		encodedData.reserve(encodedData.size() + 8 + messageCounter.size() * 4);
+		BidCoSSnapshotWriter writer(encodedData, BidCoSSnapshotType::messageCounters);
+		writer.writeInteger(messageCounter.size());
+		int32_t lastAddress = 0;
+		for(std::map<int32_t, uint8_t>::const_iterator i = messageCounter.begin(); i != messageCounter.end(); ++i)
+		{
+			writer.writeSignedInteger((int64_t)i->first - lastAddress);
+			writer.writeByte(i->second);
+			lastAddress = i->first;
 		}
 	}
 	catch(const std::exception& ex)
@@ -413,6 +558,27 @@ void HomeMaticCentral::unserializeMessageCounters(std::shared_ptr<std::vector<ch
 {
 	try
 	{
+		if(BidCoSSnapshotReader::isSnapshot(*serializedData))
+		{
+			BidCoSSnapshotReader reader(*serializedData);
+			if(!reader.open(BidCoSSnapshotType::messageCounters))
+			{
+				GD::out.printError("Error: Message counters were saved in an unknown format.");
+				return;
+			}
+			uint64_t messageCounterSize = reader.readInteger();
+			int64_t address = 0;
+			for(uint64_t i = 0; i < messageCounterSize && !reader.error(); i++)
+			{
+				address += reader.readSignedInteger();
+				uint8_t messageCounter = reader.readByte();
+				if(!reader.error()) _messageCounter[(int32_t)address] = messageCounter;
+			}
+			if(reader.error()) GD::out.printError("Error: Message counters are incomplete.");
+			else _savedMessageCounters.assign(serializedData->begin(), serializedData->end());
+			return;
+		}
+
 		BaseLib::BinaryDecoder decoder(_bl);
 		uint32_t position = 0;
 		uint32_t messageCounterSize = decoder.decodeInteger(*serializedData, position);
@@ -440,6 +606,7 @@ void HomeMaticCentral::savePeers(bool full)
 {
 	try
 	{
+		_parameterWriter.flush();
 		_peersMutex.lock();
 		for(std::map<uint64_t, std::shared_ptr<BaseLib::Systems::Peer>>::iterator i = _peersById.begin(); i != _peersById.end(); ++i)
 		{
@@ -679,61 +846,85 @@ void HomeMaticCentral::worker()
 			std::this_thread::sleep_for(std::chrono::seconds(1));
 		}
 
-		std::chrono::milliseconds sleepingTime(10);
-		uint32_t counter = 0;
-		uint64_t lastPeer = 0;
-		//One loop on the Raspberry Pi takes about 30Âµs
+		int64_t lastPeerCheck = 0;
 		while(!_stopWorkerThread)
 		{
 			try
 			{
-				std::this_thread::sleep_for(sleepingTime);
-				if(_stopWorkerThread) return;
-				if(counter > 10000)
+				int64_t time = BaseLib::HelperFunctions::getTime();
+				int64_t workerThreadWindow = _bl->settings.workerThreadWindow();
+				if(time - lastPeerCheck >= workerThreadWindow)
 				{
-					counter = 0;
+					//Schedule peers added and forget peers deleted since the last check
+					lastPeerCheck = time;
+					std::vector<uint64_t> peerIDs; //Sorted, because _peersById is sorted
 					_peersMutex.lock();
-					if(_peersById.size() > 0)
+					peerIDs.reserve(_peersById.size());
+					for(std::map<uint64_t, std::shared_ptr<BaseLib::Systems::Peer>>::iterator i = _peersById.begin(); i != _peersById.end(); ++i)
 					{
-						int32_t windowTimePerPeer = _bl->settings.workerThreadWindow() / _peersById.size();
-						if(windowTimePerPeer > 2) windowTimePerPeer -= 2;
-						sleepingTime = std::chrono::milliseconds(windowTimePerPeer);
+						peerIDs.push_back(i->first);
 					}
 					_peersMutex.unlock();
-				}
-				_peersMutex.lock();
-				if(!_peersById.empty())
-				{
-					if(!_peersById.empty())
 					{
-						std::map<uint64_t, std::shared_ptr<BaseLib::Systems::Peer>>::iterator nextPeer = _peersById.find(lastPeer);
-						if(nextPeer != _peersById.end())
+						std::lock_guard<std::mutex> peerWorkerGuard(_peerWorkerMutex);
+						for(std::unordered_map<uint64_t, int64_t>::iterator i = _peerWorkerTimes.begin(); i != _peerWorkerTimes.end();)
+						{
+							if(!std::binary_search(peerIDs.begin(), peerIDs.end(), i->first)) i = _peerWorkerTimes.erase(i); //Queue entries of the peer are skipped from now on
+							else ++i;
+						}
+						for(std::vector<uint64_t>::iterator i = peerIDs.begin(); i != peerIDs.end(); ++i)
 						{
-							nextPeer++;
-							if(nextPeer == _peersById.end()) nextPeer = _peersById.begin();
+							if(_peerWorkerTimes.find(*i) != _peerWorkerTimes.end()) continue;
+							_peerWorkerTimes[*i] = time;
+							_peerWorkerQueue.push(std::pair<int64_t, uint64_t>(time, *i));
 						}
-						else nextPeer = _peersById.begin();
-						lastPeer = nextPeer->first;
 					}
+					//Raises an RPC event, so _peerWorkerMutex must not be locked here.
+					updateAirtimeUsage();
 				}
-				_peersMutex.unlock();
-				std::shared_ptr<BidCoSPeer> peer(getPeer(lastPeer));
-				if(peer && !peer->deleting) peer->worker();
-				counter++;
+				if(_receptionMerger.enabled())
+				{
+					std::vector<BidCoSReceptionMerger::Reception> completedReceptions;
+					_receptionMerger.collect(completedReceptions);
+					if(!completedReceptions.empty()) checkReceptions(completedReceptions);
+				}
+
+				uint64_t peerID = 0;
+				{
+					std::unique_lock<std::mutex> peerWorkerGuard(_peerWorkerMutex);
+					while(!_peerWorkerQueue.empty())
+					{
+						std::unordered_map<uint64_t, int64_t>::iterator peerTime = _peerWorkerTimes.find(_peerWorkerQueue.top().second);
+						if(peerTime != _peerWorkerTimes.end() && peerTime->second == _peerWorkerQueue.top().first) break;
+						_peerWorkerQueue.pop();
+					}
+					int64_t nextTime = lastPeerCheck + workerThreadWindow;
+					if(!_peerWorkerQueue.empty() && _peerWorkerQueue.top().first < nextTime) nextTime = _peerWorkerQueue.top().first;
+					if(nextTime > time)
+					{
+						_peerWorkerConditionVariable.wait_for(peerWorkerGuard, std::chrono::milliseconds(nextTime - time));
+						continue;
+					}
+					peerID = _peerWorkerQueue.top().second;
+					_peerWorkerQueue.pop();
+					_peerWorkerTimes.erase(peerID);
+				}
+
+				std::shared_ptr<BidCoSPeer> peer(getPeer(peerID));
+				if(!peer || peer->deleting) continue;
+				peer->worker();
+				schedulePeerWorker(peerID, peer->getNextWorkerTime(BaseLib::HelperFunctions::getTime()));
 			}
 			catch(const std::exception& ex)
 			{
-				_peersMutex.unlock();
 				GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
 			}
 			catch(BaseLib::Exception& ex)
 			{
-				_peersMutex.unlock();
 				GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
 			}
 			catch(...)
 			{
-				_peersMutex.unlock();
 				GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
 			}
 		}
@@ -752,6 +943,38 @@ void HomeMaticCentral::worker()
     }
 }
 
+void HomeMaticCentral::schedulePeerWorker(uint64_t peerID, int64_t time)
+{
+	try
+	{
+		std::lock_guard<std::mutex> peerWorkerGuard(_peerWorkerMutex);
+		std::unordered_map<uint64_t, int64_t>::iterator peerTime = _peerWorkerTimes.find(peerID);
+		if(peerTime != _peerWorkerTimes.end() && peerTime->second <= time) return;
+		if(time == std::numeric_limits<int64_t>::max())
+		{
+			//The peer doesn't need its worker. Only remember it, so it isn't scheduled again as a new peer.
+			_peerWorkerTimes[peerID] = time;
+			return;
+		}
+		bool notify = _peerWorkerQueue.empty() || time < _peerWorkerQueue.top().first;
+		_peerWorkerTimes[peerID] = time;
+		_peerWorkerQueue.push(std::pair<int64_t, uint64_t>(time, peerID));
+		if(notify) _peerWorkerConditionVariable.notify_one();
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+}
+
 bool deleteThis = false;
 
 bool HomeMaticCentral::onPacketReceived(std::string& senderID, std::shared_ptr<BaseLib::Systems::Packet> packet)
@@ -792,16 +1015,30 @@ bool HomeMaticCentral::onPacketReceived(std::string& senderID, std::shared_ptr<B
 			}
 			return false;
 		}*/
-		if(_bl->settings.devLog()) _bl->out.printMessage("Devlog (" + senderID + "): Getting peer for packet " + packet->hexString() + ".");
-		std::shared_ptr<BidCoSPeer> peer(getPeer(bidCoSPacket->senderAddress()));
-		if(peer && bidCoSPacket->messageType() != 0x02 && bidCoSPacket->messageType() != 0x03)
+		std::shared_ptr<BidCoSPeer> peer;
+		if(_receptionMerger.enabled())
 		{
-			if(_bl->settings.devLog()) _bl->out.printMessage("Devlog (" + senderID + "): Packet " + packet->hexString() + " is now passed to checkForBestInterface.");
-			peer->checkForBestInterface(senderID, bidCoSPacket->rssiDevice(), bidCoSPacket->messageCounter()); //Ignore ACK and AES handshake packets.
-			if(_bl->settings.devLog()) _bl->out.printMessage("Devlog (" + senderID + "): checkForBestInterface finished.");
+			//Copies received by other interfaces than the peer's are dropped here. Roaming is checked once per packet when all copies are received.
+			std::vector<BidCoSReceptionMerger::Reception> completedReceptions;
+			bool forward = _receptionMerger.merge(senderID, bidCoSPacket, [&]() { return getPhysicalInterface(bidCoSPacket->senderAddress())->getID(); }, completedReceptions);
+			if(!completedReceptions.empty()) checkReceptions(completedReceptions);
+			if(!forward) return true;
+			if(_bl->settings.devLog()) _bl->out.printMessage("Devlog (" + senderID + "): Getting peer for packet " + packet->hexString() + ".");
+			peer = getPeer(bidCoSPacket->senderAddress());
+		}
+		else
+		{
+			if(_bl->settings.devLog()) _bl->out.printMessage("Devlog (" + senderID + "): Getting peer for packet " + packet->hexString() + ".");
+			peer = getPeer(bidCoSPacket->senderAddress());
+			if(peer && bidCoSPacket->messageType() != 0x02 && bidCoSPacket->messageType() != 0x03)
+			{
+				if(_bl->settings.devLog()) _bl->out.printMessage("Devlog (" + senderID + "): Packet " + packet->hexString() + " is now passed to checkForBestInterface.");
+				peer->checkForBestInterface(senderID, bidCoSPacket->rssiDevice(), bidCoSPacket->messageCounter()); //Ignore ACK and AES handshake packets.
+				if(_bl->settings.devLog()) _bl->out.printMessage("Devlog (" + senderID + "): checkForBestInterface finished.");
+			}
+			std::shared_ptr<IBidCoSInterface> physicalInterface = getPhysicalInterface(bidCoSPacket->senderAddress());
+			if(physicalInterface->getID() != senderID) return true;
 		}
-		std::shared_ptr<IBidCoSInterface> physicalInterface = getPhysicalInterface(bidCoSPacket->senderAddress());
-		if(physicalInterface->getID() != senderID) return true;
 
 		// {{{ Handle wrong ACKs
 			if(bidCoSPacket->messageType() == 0x02 && bidCoSPacket->destinationAddress() != 0 && bidCoSPacket->payload()->size() == 1 && bidCoSPacket->payload()->at(0) == 0)
@@ -825,10 +1062,10 @@ bool HomeMaticCentral::onPacketReceived(std::string& senderID, std::shared_ptr<B
 			else
 			{
 				std::shared_ptr<BidCoSMessage> message = _messages->find(bidCoSPacket);
-				if(message && message->checkAccess(bidCoSPacket, queue))
+				if(message && message->checkAccess(this, bidCoSPacket, queue))
 				{
 					if(_bl->debugLevel >= 6) GD::out.printDebug("Debug: Device " + std::to_string(_deviceId) + ": Access granted for packet " + bidCoSPacket->hexString());
-					message->invokeMessageHandler(bidCoSPacket);
+					message->invokeMessageHandler(this, bidCoSPacket);
 					handled = true;
 				}
 			}
@@ -875,6 +1112,31 @@ bool HomeMaticCentral::onPacketReceived(std::string& senderID, std::shared_ptr<B
     return false;
 }
 
+void HomeMaticCentral::checkReceptions(std::vector<BidCoSReceptionMerger::Reception>& receptions)
+{
+	try
+	{
+		for(std::vector<BidCoSReceptionMerger::Reception>::iterator i = receptions.begin(); i != receptions.end(); ++i)
+		{
+			if(!i->roaming) continue;
+			std::shared_ptr<BidCoSPeer> peer(getPeer(i->senderAddress));
+			if(peer) peer->checkForBestInterface(i->rssi);
+		}
+	}
+	catch(const std::exception& ex)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(BaseLib::Exception& ex)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+}
+
 std::shared_ptr<IBidCoSInterface> HomeMaticCentral::getPhysicalInterface(int32_t peerAddress)
 {
 	try
@@ -1047,6 +1309,73 @@ void HomeMaticCentral::sendPacket(std::shared_ptr<IBidCoSInterface> physicalInte
     }
 }
 
+void HomeMaticCentral::updateAirtimeUsage()
+{
+	try
+	{
+		bool changed = false;
+		PVariable usages(new Variable(VariableType::tStruct));
+		for(std::map<std::string, std::shared_ptr<IBidCoSInterface>>::iterator i = GD::physicalInterfaces.begin(); i != GD::physicalInterfaces.end(); ++i)
+		{
+			uint32_t usage = i->second->getAirtimeStatistics().usage;
+			std::map<std::string, uint32_t>::iterator airtimeIterator = _airtimeUsage.find(i->first);
+			if(airtimeIterator == _airtimeUsage.end() || airtimeIterator->second != usage)
+			{
+				_airtimeUsage[i->first] = usage;
+				changed = true;
+			}
+			usages->structValue->insert(StructElement(i->first, PVariable(new Variable((int32_t)usage))));
+		}
+		if(!changed) return;
+
+		std::shared_ptr<std::vector<std::string>> valueKeys(new std::vector<std::string>{ "AIRTIME_USAGE" });
+		std::shared_ptr<std::vector<PVariable>> values(new std::vector<PVariable>{ usages });
+		std::string eventSource = "device-" + std::to_string(_deviceId);
+		raiseRPCEvent(eventSource, 0, -1, _serialNumber, valueKeys, values);
+	}
+	catch(const std::exception& ex)
+    {
+    	GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(BaseLib::Exception& ex)
+    {
+    	GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+    	GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+}
+
+int64_t HomeMaticCentral::getSendingDelay(std::shared_ptr<IBidCoSInterface> physicalInterface, std::shared_ptr<BidCoSPacket> packet)
+{
+	try
+	{
+		if(!packet || !physicalInterface) return 0;
+		int64_t responseDelay = physicalInterface->responseDelay();
+		int64_t time = BaseLib::HelperFunctions::getTime();
+		int64_t sendingDelay = 0;
+		std::shared_ptr<BidCoSPacketInfo> packetInfo = _sentPackets.getInfo(packet->destinationAddress());
+		if(packetInfo && time - packetInfo->time < responseDelay) sendingDelay = responseDelay - (time - packetInfo->time);
+		packetInfo = _receivedPackets.getInfo(packet->destinationAddress());
+		if(packetInfo && time - packetInfo->time >= 0 && time - packetInfo->time < responseDelay && responseDelay - (time - packetInfo->time) > sendingDelay) sendingDelay = responseDelay - (time - packetInfo->time);
+		return sendingDelay;
+	}
+	catch(const std::exception& ex)
+    {
+    	GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(BaseLib::Exception& ex)
+    {
+    	GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+    	GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+    return 0;
+}
+
 void HomeMaticCentral::sendPacketMultipleTimes(std::shared_ptr<IBidCoSInterface> physicalInterface, std::shared_ptr<BidCoSPacket> packet, int32_t peerAddress, int32_t count, int32_t delay, bool incrementMessageCounter, bool useCentralMessageCounter, bool isThread)
 {
 	try
@@ -1174,6 +1503,17 @@ std::shared_ptr<BidCoSPeer> HomeMaticCentral::createTeam(int32_t address, uint32
     return std::shared_ptr<BidCoSPeer>();
 }
 
+void HomeMaticCentral::printHistogram(std::ostringstream& stringStream, const std::vector<std::pair<int64_t, uint64_t>>& histogram, const std::string& indentation)
+{
+	int64_t lowerBound = 0;
+	for(std::vector<std::pair<int64_t, uint64_t>>::const_iterator i = histogram.begin(); i != histogram.end(); ++i)
+	{
+		if(i->first == -1) stringStream << indentation << ">= " << lowerBound << " us:\t" << i->second << std::endl;
+		else stringStream << indentation << "< " << i->first << " us:\t" << i->second << std::endl;
+		lowerBound = i->first;
+	}
+}
+
 std::string HomeMaticCentral::handleCliCommand(std::string command)
 {
 	try
@@ -1199,6 +1539,12 @@ std::string HomeMaticCentral::handleCliCommand(std::string command)
 		{
 			stringStream << "List of commands (shortcut in brackets):" << std::endl << std::endl;
 			stringStream << "For more information about the individual command type: COMMAND help" << std::endl << std::endl;
+			stringStream << "aes stats (as)\t\tPrints latencies of the AES handshakes" << std::endl;
+			stringStream << "airtime stats (at)\tPrints the airtime used by the communication modules" << std::endl;
+			stringStream << "commands stats (cs)\tPrints the time from setting a value until the packet is sent" << std::endl;
+			stringStream << "dispatch stats (ds)\tPrints latencies of passing received packets to the central" << std::endl;
+			stringStream << "duty cycle stats (dcs)\tPrints the timing accuracy of HM-CC-TC duty cycle packets" << std::endl;
+			stringStream << "interfaces stats (is)\tPrints read statistics of the communication modules" << std::endl;
 			stringStream << "pairing on (pon)\tEnables pairing mode" << std::endl;
 			stringStream << "pairing off (pof)\tDisables pairing mode" << std::endl;
 			stringStream << "peers list (ls)\t\tList all peers" << std::endl;
@@ -1209,7 +1555,11 @@ std::string HomeMaticCentral::handleCliCommand(std::string command)
 			stringStream << "peers setname (pn)\tName a peer" << std::endl;
 			stringStream << "peers unpair (pup)\tUnpair a peer" << std::endl;
 			stringStream << "peers update (pud)\tUpdates a peer to the newest firmware version" << std::endl;
+			stringStream << "peertables (pt)\t\tPrints the peers stored on the communication modules" << std::endl;
+			stringStream << "queues stats (qs)\tPrints statistics of the queue scheduler" << std::endl;
+			stringStream << "reception stats (rs)\tPrints how many packets each interface received" << std::endl;
 			stringStream << "unselect (u)\t\tUnselect this device" << std::endl;
+			stringStream << "variables stats (vs)\tPrints statistics of the variable write queue" << std::endl;
 			return stringStream.str();
 		}
 		else if(BaseLib::HelperFunctions::checkCliCommand(command, "pairing on", "pon", "", 0, arguments, showHelp))
@@ -1229,6 +1579,265 @@ std::string HomeMaticCentral::handleCliCommand(std::string command)
 			stringStream << "Pairing mode enabled for " + std::to_string(duration) + " seconds." << std::endl;
 			return stringStream.str();
 		}
+		else if(BaseLib::HelperFunctions::checkCliCommand(command, "aes stats", "as", "", 0, arguments, showHelp))
+		{
+			if(showHelp)
+			{
+				stringStream << "Description: This command prints the latencies of the AES handshakes of all interfaces. The latency is the time from receiving a frame until the answer is ready to send." << std::endl;
+				stringStream << "Usage: aes stats" << std::endl << std::endl;
+				stringStream << "Parameters:" << std::endl;
+				stringStream << "  There are no parameters." << std::endl;
+				return stringStream.str();
+			}
+
+			std::vector<std::pair<AesHandshake::HandshakeStep, std::string>> steps{ { AesHandshake::HandshakeStep::cFrame, "c-Frame" }, { AesHandshake::HandshakeStep::rFrame, "r-Frame" }, { AesHandshake::HandshakeStep::aFrame, "a-Frame" } };
+			for(std::map<std::string, std::shared_ptr<IBidCoSInterface>>::iterator i = GD::physicalInterfaces.begin(); i != GD::physicalInterfaces.end(); ++i)
+			{
+				std::shared_ptr<AesHandshake> aesHandshake = i->second->getAesHandshake();
+				if(!aesHandshake) continue;
+				stringStream << "Interface " << i->first << ":" << std::endl;
+				for(std::vector<std::pair<AesHandshake::HandshakeStep, std::string>>::iterator j = steps.begin(); j != steps.end(); ++j)
+				{
+					AesHandshake::LatencyStatistics statistics = aesHandshake->getLatencyStatistics(j->first);
+					stringStream << "  " << j->second << ":\t" << statistics.count << " handshakes";
+					if(statistics.count > 0) stringStream << ", p50 " << statistics.percentile50 << " ms, p90 " << statistics.percentile90 << " ms, p99 " << statistics.percentile99 << " ms, max " << statistics.maximum << " ms";
+					stringStream << std::endl;
+				}
+			}
+			return stringStream.str();
+		}
+		else if(BaseLib::HelperFunctions::checkCliCommand(command, "airtime stats", "at", "", 0, arguments, showHelp))
+		{
+			if(showHelp)
+			{
+				stringStream << "Description: This command prints the airtime used by the communication modules within the last hour and the number of packets not sent because the budget was exceeded." << std::endl;
+				stringStream << "Usage: airtime stats" << std::endl << std::endl;
+				stringStream << "Parameters:" << std::endl;
+				stringStream << "  There are no parameters." << std::endl;
+				return stringStream.str();
+			}
+
+			for(std::map<std::string, std::shared_ptr<IBidCoSInterface>>::iterator i = GD::physicalInterfaces.begin(); i != GD::physicalInterfaces.end(); ++i)
+			{
+				IBidCoSInterface::AirtimeStatistics statistics = i->second->getAirtimeStatistics();
+				stringStream << "Interface " << i->first << ":" << std::endl;
+				stringStream << "  Airtime used:\t\t" << statistics.used << " ms of " << statistics.budget << " ms (" << statistics.usage << " %)" << std::endl;
+				stringStream << "  Packets sent:\t\t" << statistics.packetsSent << std::endl;
+				stringStream << "  Deferred (high):\t" << statistics.packetsDeferred.at((int32_t)IBidCoSInterface::AirtimePriority::high) << std::endl;
+				stringStream << "  Deferred (normal):\t" << statistics.packetsDeferred.at((int32_t)IBidCoSInterface::AirtimePriority::normal) << std::endl;
+				stringStream << "  Deferred (bulk):\t" << statistics.packetsDeferred.at((int32_t)IBidCoSInterface::AirtimePriority::bulk) << std::endl;
+			}
+			return stringStream.str();
+		}
+		else if(BaseLib::HelperFunctions::checkCliCommand(command, "commands stats", "cs", "", 0, arguments, showHelp))
+		{
+			if(showHelp)
+			{
+				stringStream << "Description: This command prints the time from calling setValue until the packet is passed to the communication module and how many packets were built from compiled frames. Together with the simulator interface it can be used to benchmark commands." << std::endl;
+				stringStream << "Usage: commands stats" << std::endl << std::endl;
+				stringStream << "Parameters:" << std::endl;
+				stringStream << "  There are no parameters." << std::endl;
+				return stringStream.str();
+			}
+
+			stringStream << "Compiled frames:\t" << _commandsEncoded << std::endl;
+			stringStream << "Generic frames:\t\t" << _commandsGeneric << std::endl;
+			for(std::map<std::string, std::shared_ptr<IBidCoSInterface>>::iterator i = GD::physicalInterfaces.begin(); i != GD::physicalInterfaces.end(); ++i)
+			{
+				IBidCoSInterface::CommandStatistics statistics = i->second->getCommandStatistics();
+				stringStream << "Interface " << i->first << ":" << std::endl;
+				stringStream << "  Commands sent:\t" << statistics.commandsSent << std::endl;
+				stringStream << "  Maximum latency:\t" << statistics.maximumLatency << " us" << std::endl;
+				stringStream << "  Latencies:" << std::endl;
+				printHistogram(stringStream, statistics.latencyHistogram, "    ");
+			}
+			return stringStream.str();
+		}
+		else if(BaseLib::HelperFunctions::checkCliCommand(command, "dispatch stats", "ds", "", 0, arguments, showHelp))
+		{
+			if(showHelp)
+			{
+				stringStream << "Description: This command prints the time received packets wait in the queue of the communication modules until they are processed by the central." << std::endl;
+				stringStream << "Usage: dispatch stats" << std::endl << std::endl;
+				stringStream << "Parameters:" << std::endl;
+				stringStream << "  There are no parameters." << std::endl;
+				return stringStream.str();
+			}
+
+			for(std::map<std::string, std::shared_ptr<IBidCoSInterface>>::iterator i = GD::physicalInterfaces.begin(); i != GD::physicalInterfaces.end(); ++i)
+			{
+				IBidCoSInterface::DispatchStatistics statistics = i->second->getDispatchStatistics();
+				stringStream << "Interface " << i->first << ":" << std::endl;
+				if(!statistics.enabled)
+				{
+					stringStream << "  Not listening." << std::endl;
+					continue;
+				}
+				stringStream << "  Queued packets:\t" << statistics.queued << " of " << statistics.capacity << std::endl;
+				stringStream << "  Packets dispatched:\t" << statistics.packetsDispatched << std::endl;
+				stringStream << "  Queue overflows:\t" << statistics.overflows << std::endl;
+				stringStream << "  Packets dropped:\t" << statistics.drops << std::endl;
+				stringStream << "  Maximum latency:\t" << statistics.maximumLatency << " us" << std::endl;
+				stringStream << "  Latencies:" << std::endl;
+				printHistogram(stringStream, statistics.latencyHistogram, "    ");
+			}
+			return stringStream.str();
+		}
+		else if(BaseLib::HelperFunctions::checkCliCommand(command, "duty cycle stats", "dcs", "", 0, arguments, showHelp))
+		{
+			if(showHelp)
+			{
+				stringStream << "Description: This command prints how late the duty cycle timer executed its tasks, e. g. sending the duty cycle packets of virtual HM-CC-TCs." << std::endl;
+				stringStream << "Usage: duty cycle stats" << std::endl << std::endl;
+				stringStream << "Parameters:" << std::endl;
+				stringStream << "  There are no parameters." << std::endl;
+				return stringStream.str();
+			}
+
+			if(!GD::dutyCycleTimer) return "Duty cycle timer is not initialized.\n";
+			BidCoSDutyCycleTimerStatistics statistics = GD::dutyCycleTimer->getStatistics();
+			stringStream << "Tasks executed:\t\t" << statistics.tasksExecuted << std::endl;
+			stringStream << "Tasks pending:\t\t" << statistics.tasksPending << std::endl;
+			stringStream << "Saves:\t\t\t" << statistics.saves << std::endl;
+			stringStream << "Saves pending:\t\t" << statistics.variablesPending << std::endl;
+			stringStream << "Maximum error:\t\t" << statistics.maximumError << " us" << std::endl;
+			stringStream << "Errors:" << std::endl;
+			printHistogram(stringStream, statistics.errorHistogram, "  ");
+			return stringStream.str();
+		}
+		else if(BaseLib::HelperFunctions::checkCliCommand(command, "interfaces stats", "is", "", 0, arguments, showHelp))
+		{
+			if(showHelp)
+			{
+				stringStream << "Description: This command prints how many system calls the communication modules need to read from their devices." << std::endl;
+				stringStream << "Usage: interfaces stats" << std::endl << std::endl;
+				stringStream << "Parameters:" << std::endl;
+				stringStream << "  There are no parameters." << std::endl;
+				return stringStream.str();
+			}
+
+			for(std::map<std::string, std::shared_ptr<IBidCoSInterface>>::iterator i = GD::physicalInterfaces.begin(); i != GD::physicalInterfaces.end(); ++i)
+			{
+				IBidCoSInterface::ReadStatistics statistics = i->second->getReadStatistics();
+				if(!statistics.enabled) continue;
+				stringStream << "Interface " << i->first << ":" << std::endl;
+				stringStream << "  Packets received:\t" << statistics.packetsReceived << std::endl;
+				stringStream << "  Bytes read:\t\t" << statistics.bytesRead << std::endl;
+				stringStream << "  Poll calls:\t\t" << statistics.pollCalls << std::endl;
+				stringStream << "  Read calls:\t\t" << statistics.readCalls << std::endl;
+				stringStream << "  Syscalls per packet:\t" << std::fixed << std::setprecision(2) << (statistics.packetsReceived > 0 ? (double)(statistics.pollCalls + statistics.readCalls) / statistics.packetsReceived : 0) << std::endl;
+				stringStream << "  Bytes per read:\t" << std::fixed << std::setprecision(2) << (statistics.readCalls > 0 ? (double)statistics.bytesRead / statistics.readCalls : 0) << std::endl;
+			}
+			return stringStream.str();
+		}
+		else if(BaseLib::HelperFunctions::checkCliCommand(command, "peertables", "pt", "", 0, arguments, showHelp))
+		{
+			if(showHelp)
+			{
+				stringStream << "Description: This command prints the peers stored on the communication modules (HM-LGW and HM-MOD-RPI-PCB) as confirmed by the modules. Only peers differing from these entries are sent to the modules." << std::endl;
+				stringStream << "Usage: peertables [INTERFACE]" << std::endl << std::endl;
+				stringStream << "Parameters:" << std::endl;
+				stringStream << "  INTERFACE:\tOptional ID of the interface to print the peer table of." << std::endl;
+				return stringStream.str();
+			}
+
+			for(std::map<std::string, std::shared_ptr<IBidCoSInterface>>::iterator i = GD::physicalInterfaces.begin(); i != GD::physicalInterfaces.end(); ++i)
+			{
+				if(!arguments.empty() && arguments.at(0) != i->first) continue;
+				std::map<int32_t, IBidCoSInterface::PeerInfo> peerTable;
+				IBidCoSInterface::PeerTableStatistics statistics = i->second->getPeerTable(peerTable);
+				if(!statistics.enabled) continue;
+				stringStream << "Interface " << i->first << ":" << std::endl;
+				stringStream << "  Peers added:\t\t" << statistics.peersAdded << std::endl;
+				stringStream << "  Peers updated:\t" << statistics.peersUpdated << std::endl;
+				stringStream << "  Peers unchanged:\t" << statistics.peersUnchanged << std::endl;
+				stringStream << "  Requests:\t\t" << statistics.requests << std::endl;
+				stringStream << "  Address\tKey index\tWake up\tAES channels" << std::endl;
+				for(std::map<int32_t, IBidCoSInterface::PeerInfo>::iterator j = peerTable.begin(); j != peerTable.end(); ++j)
+				{
+					std::string aesChannels;
+					for(std::map<int32_t, bool>::iterator k = j->second.aesChannels.begin(); k != j->second.aesChannels.end(); ++k)
+					{
+						if(!k->second) continue;
+						if(!aesChannels.empty()) aesChannels.push_back(',');
+						aesChannels.append(std::to_string(k->first));
+					}
+					stringStream << "  0x" << BaseLib::HelperFunctions::getHexString(j->first, 6) << "\t" << j->second.keyIndex << "\t\t" << (j->second.wakeUp ? "yes" : "no") << "\t" << (aesChannels.empty() ? "-" : aesChannels) << std::endl;
+				}
+			}
+			return stringStream.str();
+		}
+		else if(BaseLib::HelperFunctions::checkCliCommand(command, "queues stats", "qs", "", 0, arguments, showHelp))
+		{
+			if(showHelp)
+			{
+				stringStream << "Description: This command prints statistics of the scheduler executing the send tasks of all queues." << std::endl;
+				stringStream << "Usage: queues stats" << std::endl << std::endl;
+				stringStream << "Parameters:" << std::endl;
+				stringStream << "  There are no parameters." << std::endl;
+				return stringStream.str();
+			}
+
+			if(!GD::queueScheduler) return "Queue scheduler is not initialized.\n";
+			BidCoSQueueSchedulerStatistics statistics = GD::queueScheduler->getStatistics();
+			stringStream << "Worker threads:\t\t\t" << statistics.workerThreads << std::endl;
+			stringStream << "Tasks executed:\t\t\t" << statistics.tasksExecuted << std::endl;
+			stringStream << "Tasks pending:\t\t\t" << statistics.tasksPending << std::endl;
+			stringStream << "Tasks per second:\t\t" << std::fixed << std::setprecision(2) << statistics.tasksPerSecond << std::endl;
+			stringStream << "Rates are calculated since the last call of this command." << std::endl;
+			return stringStream.str();
+		}
+		else if(BaseLib::HelperFunctions::checkCliCommand(command, "reception stats", "rs", "", 0, arguments, showHelp))
+		{
+			if(showHelp)
+			{
+				stringStream << "Description: This command prints how many packets each interface received and how often it had the best reception. Copies of a packet received by more than one interface are only processed once." << std::endl;
+				stringStream << "Usage: reception stats" << std::endl << std::endl;
+				stringStream << "Parameters:" << std::endl;
+				stringStream << "  There are no parameters." << std::endl;
+				return stringStream.str();
+			}
+
+			if(!_receptionMerger.enabled()) return "Merging of packets received by more than one interface is disabled (duplicateWindow = 0 or only one interface).\n";
+			stringStream << "Window: " << _receptionMerger.getWindow() << " ms" << std::endl;
+			std::map<std::string, BidCoSReceptionStatistics> statistics = _receptionMerger.getStatistics();
+			for(std::map<std::string, BidCoSReceptionStatistics>::iterator i = statistics.begin(); i != statistics.end(); ++i)
+			{
+				stringStream << "Interface " << i->first << ":" << std::endl;
+				stringStream << "  Packets received:\t" << i->second.packetsReceived << std::endl;
+				stringStream << "  Received first:\t" << i->second.packetsFirst << std::endl;
+				stringStream << "  Best RSSI:\t\t" << i->second.packetsBestRssi << std::endl;
+				stringStream << "  Processed:\t\t" << i->second.packetsForwarded << std::endl;
+				stringStream << "  Dropped duplicates:\t" << i->second.duplicatesDropped << std::endl;
+				stringStream << "  Average RSSI:\t\t-" << std::fixed << std::setprecision(1) << i->second.averageRssi << " dBm" << std::endl;
+			}
+			return stringStream.str();
+		}
+		else if(BaseLib::HelperFunctions::checkCliCommand(command, "variables stats", "vs", "", 0, arguments, showHelp))
+		{
+			if(showHelp)
+			{
+				stringStream << "Description: This command prints statistics of the queue writing received variables to the database." << std::endl;
+				stringStream << "Usage: variables stats" << std::endl << std::endl;
+				stringStream << "Parameters:" << std::endl;
+				stringStream << "  There are no parameters." << std::endl;
+				return stringStream.str();
+			}
+
+			BidCoSParameterWriterStatistics statistics = _parameterWriter.getStatistics();
+			if(!statistics.enabled) return "Write-behind of variables is disabled (variableWriteInterval = 0).\n";
+			stringStream << "Flush interval:\t\t\t" << statistics.flushInterval << " ms" << std::endl;
+			stringStream << "Pending variables:\t\t" << statistics.pendingParameters << " (maximum " << statistics.maxPendingParameters << ")" << std::endl;
+			stringStream << "Variables queued:\t\t" << statistics.parametersQueued << std::endl;
+			stringStream << "Updates coalesced:\t\t" << statistics.parametersCoalesced << std::endl;
+			stringStream << "Variables written:\t\t" << statistics.parametersWritten << std::endl;
+			stringStream << "Written immediately (full):\t" << statistics.synchronousWrites << std::endl;
+			stringStream << "Flushes:\t\t\t" << statistics.flushes << std::endl;
+			stringStream << "Last flush latency:\t\t" << statistics.lastFlushLatency << " us" << std::endl;
+			stringStream << "Average flush latency:\t\t" << std::fixed << std::setprecision(2) << statistics.averageFlushLatency << " us" << std::endl;
+			stringStream << "Maximum flush latency:\t\t" << statistics.maxFlushLatency << " us" << std::endl;
+			return stringStream.str();
+		}
 		else if(BaseLib::HelperFunctions::checkCliCommand(command, "pairing off", "pof", "", 0, arguments, showHelp))
 		{
 			if(showHelp)
@@ -1270,7 +1879,7 @@ std::string HomeMaticCentral::handleCliCommand(std::string command)
 					{
 						index = 6;
 						packet.reset(new BidCoSPacket());
-						packet->import(element, false);
+						if(!packet->import(element, false) || packet->payload()->size() < 13) return "Invalid pairing packet. The packet has to be provided as 54 hexadecimal characters.\n";
 						peerAddress = packet->senderAddress();
 						deviceType = (packet->payload()->at(1) << 8) + packet->payload()->at(2);
 						firmwareVersion = packet->payload()->at(0);
@@ -2430,6 +3039,7 @@ void HomeMaticCentral::addHomegearFeaturesRemote(std::shared_ptr<BidCoSPeer> pee
 
 			//putParamset pushes the packets on pendingQueues, but does not send immediately
 			if(!paramset->structValue->empty()) peer->putParamset(nullptr, channel, ParameterGroup::Type::Enum::link, 0xFFFFFFFFFFFFFFFF, channel, paramset, true);
+			peer->flushConfigWrites();
 		}
 		else
 		{
@@ -2455,6 +3065,7 @@ void HomeMaticCentral::addHomegearFeaturesRemote(std::shared_ptr<BidCoSPeer> pee
 
 				//putParamset pushes the packets on pendingQueues, but does not send immediately
 				if(!paramset->structValue->empty()) peer->putParamset(nullptr, i->first, ParameterGroup::Type::Enum::link, 0xFFFFFFFFFFFFFFFF, i->first, paramset, true);
+				peer->flushConfigWrites();
 			}
 		}
 
@@ -3524,7 +4135,11 @@ void HomeMaticCentral::handleConfigParamResponse(int32_t messageCounter, std::sh
 					}
 				}
 			}
-			if(!peer->getPairingComplete() && !parametersToEnforce->structValue->empty()) peer->putParamset(nullptr, channel, type, 0, -1, parametersToEnforce, true);
+			if(!peer->getPairingComplete() && !parametersToEnforce->structValue->empty())
+			{
+				peer->putParamset(nullptr, channel, type, 0, -1, parametersToEnforce, true);
+				peer->flushConfigWrites();
+			}
 		}
 		if((continuousData || multiPacket) && !multiPacketEnd && (packet->controlByte() & 0x20)) //Multiple config response packets
 		{
@@ -3862,6 +4477,7 @@ void HomeMaticCentral::handleAck(int32_t messageCounter, std::shared_ptr<BidCoSP
 							PVariable variables(new Variable(VariableType::tStruct));
 							variables->structValue->insert(StructElement("AES_ACTIVE", PVariable(new Variable(true))));
 							queue->peer->putParamset(nullptr, i->first, ParameterGroup::Type::config, 0, -1, variables, true);
+							queue->peer->flushConfigWrites();
 							queue->peer->peerInfoPacketsEnabled = true;
 						}
 						if(i->second->hasGroup)
@@ -4184,6 +4800,7 @@ PVariable HomeMaticCentral::addLink(BaseLib::PRpcClientInfo clientInfo, uint64_t
 				}
 			}
 
+			sender->flushConfigWrites();
 			queue->push(sender->pendingBidCoSQueues);
 
 			raiseRPCUpdateDevice(sender->getID(), senderChannelIndex, sender->getSerialNumber() + ":" + std::to_string(senderChannelIndex), 1);
@@ -4282,6 +4899,7 @@ PVariable HomeMaticCentral::addLink(BaseLib::PRpcClientInfo clientInfo, uint64_t
 				}
 			}
 
+			receiver->flushConfigWrites();
 			queue->push(receiver->pendingBidCoSQueues);
 
 			raiseRPCUpdateDevice(receiver->getID(), receiverChannelIndex, receiver->getSerialNumber() + ":" + std::to_string(receiverChannelIndex), 1);
@@ -4957,6 +5575,8 @@ PVariable HomeMaticCentral::putParamset(BaseLib::PRpcClientInfo clientInfo, std:
 		}
 		PVariable result = peer->putParamset(clientInfo, channel, type, remoteID, remoteChannel, paramset, false);
 		if(result->errorStruct) return result;
+		//Return immediately, so further calls can be merged into the buffered config writes. The config is sent by the peer's worker.
+		if(peer->configWritesPending()) return result;
 		int32_t waitIndex = 0;
 		while(_bidCoSQueueManager.get(peer->getAddress()) && waitIndex < 50)
 		{
@@ -4989,6 +5609,8 @@ PVariable HomeMaticCentral::putParamset(BaseLib::PRpcClientInfo clientInfo, uint
 		if(!peer) return Variable::createError(-2, "Unknown device.");
 		PVariable result = peer->putParamset(clientInfo, channel, type, remoteID, remoteChannel, paramset, checkAcls);
 		if(result->errorStruct) return result;
+		//Return immediately, so further calls can be merged into the buffered config writes. The config is sent by the peer's worker.
+		if(peer->configWritesPending()) return result;
 		int32_t waitIndex = 0;
 		while(_bidCoSQueueManager.get(peer->getAddress()) && waitIndex < 50)
 		{
@@ -37,11 +37,16 @@
 #include "BidCoSMessages.h"
 #include "BidCoSQueueManager.h"
 #include "BidCoSPacketManager.h"
+#include "BidCoSParameterWriter.h"
+#include "BidCoSReceptionMerger.h"
 
 #include <memory>
 #include <mutex>
+#include <condition_variable>
+#include <queue>
 #include <string>
 #include <cmath>
+#include <algorithm>
 
 namespace BidCoS
 {
@@ -66,6 +71,14 @@ public:
 
 	std::unordered_map<int32_t, uint8_t>* messageCounter() { return &_messageCounter; }
 	virtual std::shared_ptr<BidCoSMessages> getMessages() { return _messages; }
+	BidCoSParameterWriter* getParameterWriter() { return &_parameterWriter; }
+
+	/**
+	 * Counts a packet constructed by setValue().
+	 *
+	 * @param encoded True when the packet was built from a compiled frame of BidCoSFrameEncoder.
+	 */
+	void countCommand(bool encoded) { if(encoded) _commandsEncoded++; else _commandsGeneric++; }
 	virtual bool isInPairingMode() { return _pairing; }
 	static bool isDimmer(uint32_t type);
     static bool isSwitch(uint32_t type);
@@ -82,8 +95,22 @@ public:
 	void resetTeam(std::shared_ptr<BidCoSPeer> peer, uint32_t channel);
 	std::string handleCliCommand(std::string command);
 	virtual void sendPacket(std::shared_ptr<IBidCoSInterface> physicalInterface, std::shared_ptr<BidCoSPacket> packet, bool stealthy = false);
+
+	/**
+	 * Returns the time in milliseconds sendPacket() would wait before sending the packet, because the receiver is still busy with the last
+	 * packet sent to or received from it.
+	 */
+	int64_t getSendingDelay(std::shared_ptr<IBidCoSInterface> physicalInterface, std::shared_ptr<BidCoSPacket> packet);
     virtual void sendPacketMultipleTimes(std::shared_ptr<IBidCoSInterface> physicalInterface, std::shared_ptr<BidCoSPacket> packet, int32_t peerAddress, int32_t count, int32_t delay, bool incrementMessageCounter, bool useCentralMessageCounter = false, bool isThread = false);
 	virtual void enqueuePackets(int32_t deviceAddress, std::shared_ptr<BidCoSQueue> packets, bool pushPendingBidCoSQueues = false);
+
+	/**
+	 * Makes sure the worker of a peer is called at or before "time". Earlier times replace later ones, later times are ignored.
+	 *
+	 * @param peerID The ID of the peer.
+	 * @param time The time in milliseconds.
+	 */
+	void schedulePeerWorker(uint64_t peerID, int64_t time);
 	std::shared_ptr<BidCoSPacket> getReceivedPacket(int32_t address) { return _receivedPackets.get(address); }
     std::shared_ptr<BidCoSPacket> getSentPacket(int32_t address) { return _sentPackets.get(address); }
 
@@ -137,14 +164,38 @@ protected:
         std::unordered_map<int32_t, uint8_t> _messageCounter;
     // }}}
 
+    /**
+     * The message counters as last saved. Used to skip saving, when nothing changed.
+     */
+    std::vector<uint8_t> _savedMessageCounters;
+
     BidCoSQueueManager _bidCoSQueueManager;
 	BidCoSPacketManager _receivedPackets;
 	BidCoSPacketManager _sentPackets;
 	std::shared_ptr<BidCoSMessages> _messages;
+	BidCoSParameterWriter _parameterWriter;
+	BidCoSReceptionMerger _receptionMerger;
+	std::atomic<uint64_t> _commandsEncoded;
+	std::atomic<uint64_t> _commandsGeneric;
+
+	/**
+	 * The airtime usage of each interface last raised as AIRTIME_USAGE. Only accessed by the worker thread.
+	 */
+	std::map<std::string, uint32_t> _airtimeUsage;
 
     std::atomic_bool _stopWorkerThread;
     std::thread _workerThread;
 
+    // {{{ Peer worker deadlines
+    std::mutex _peerWorkerMutex;
+    std::condition_variable _peerWorkerConditionVariable;
+    /**
+     * Min-heap of (time, peer ID). Entries not matching _peerWorkerTimes were superseded by an earlier time and are skipped.
+     */
+    std::priority_queue<std::pair<int64_t, uint64_t>, std::vector<std::pair<int64_t, uint64_t>>, std::greater<std::pair<int64_t, uint64_t>>> _peerWorkerQueue;
+    std::unordered_map<uint64_t, int64_t> _peerWorkerTimes;
+    // }}}
+
     std::mutex _sendMultiplePacketsThreadMutex;
     std::thread _sendMultiplePacketsThread;
     std::mutex _sendPacketThreadMutex;
@@ -165,6 +216,31 @@ protected:
 	//End
 
 	virtual void loadPeers();
+
+	/**
+	 * Changes the interface of peers with roaming enabled, when another interface received the packets with better reception.
+	 */
+	void checkReceptions(std::vector<BidCoSReceptionMerger::Reception>& receptions);
+
+	/**
+	 * Raises the central variable AIRTIME_USAGE, when the percentage of the 1 % airtime budget used by one of the interfaces changed. The
+	 * value is a struct with the interface IDs as keys.
+	 */
+	void updateAirtimeUsage();
+
+	/**
+	 * Prints a histogram of the CLI statistics commands. Each element is the exclusive upper bound of a bucket in microseconds and the
+	 * number of values in the bucket. The last bucket has the bound -1 and counts all values above the previous bound.
+	 */
+	void printHistogram(std::ostringstream& stringStream, const std::vector<std::pair<int64_t, uint64_t>>& histogram, const std::string& indentation);
+
+	/**
+	 * Creates and loads one peer. Called by the threads of loadPeers(), so it must not access _peers, _peersBySerial or _peersById.
+	 *
+	 * @return Returns the loaded peer or nullptr on errors.
+	 */
+	std::shared_ptr<BidCoSPeer> loadPeer(BaseLib::Database::DataRow& row);
+	void loadPeersThread(std::vector<BaseLib::Database::DataRow*>* rows, std::vector<std::shared_ptr<BidCoSPeer>>* peers, std::atomic<uint32_t>* nextRow);
 	virtual void savePeers(bool full);
 	virtual void loadVariables();
 	virtual void saveVariables();
@@ -38,6 +38,7 @@
 #include "PhysicalInterfaces/HM-LGW.h"
 #include "PhysicalInterfaces/Hm-Mod-Rpi-Pcb.h"
 #include "PhysicalInterfaces/HomegearGateway.h"
+#include "PhysicalInterfaces/Simulator.h"
 
 namespace BidCoS
 {
@@ -70,6 +71,7 @@ void Interfaces::create()
 			else if(i->second->type == "hmlgw") device.reset(new HM_LGW(i->second));
 			else if(i->second->type == "hm-mod-rpi-pcb") device.reset(new Hm_Mod_Rpi_Pcb(i->second));
 			else if(i->second->type == "homegeargateway") device.reset(new HomegearGateway(i->second));
+			else if(i->second->type == "simulator") device.reset(new Simulator(i->second));
 			else GD::out.printError("Error: Unsupported physical device type: " + i->second->type);
 			if(device)
 			{
@@ -34,31 +34,32 @@ namespace BidCoS
 {
 PendingBidCoSQueues::PendingBidCoSQueues()
 {
+	_changes = 1;
+	_savedChanges = 0;
 }
 
-void PendingBidCoSQueues::serialize(std::vector<uint8_t>& encodedData)
+int64_t PendingBidCoSQueues::serialize(std::vector<uint8_t>& encodedData)
 {
 	try
 	{
-		BaseLib::BinaryEncoder encoder(GD::bl);
-		_queuesMutex.lock();
-		encoder.encodeInteger(encodedData, _queues.size());
+		std::lock_guard<std::mutex> queuesGuard(_queuesMutex);
+		int64_t changes = _changes;
+		BidCoSSnapshotWriter writer(encodedData, BidCoSSnapshotType::pendingQueues);
+		writer.writeInteger(_queues.size());
 		for(std::deque<std::shared_ptr<BidCoSQueue>>::iterator i = _queues.begin(); i != _queues.end(); ++i)
 		{
-			std::vector<uint8_t> serializedQueue;
-			(*i)->serialize(serializedQueue);
-			encoder.encodeInteger(encodedData, serializedQueue.size());
-			encodedData.insert(encodedData.end(), serializedQueue.begin(), serializedQueue.end());
+			(*i)->serialize(writer);
 			bool hasCallbackFunction = ((*i)->callbackParameter && (*i)->callbackParameter->integers.size() == 3 && (*i)->callbackParameter->strings.size() == 1);
-			encoder.encodeBoolean(encodedData, hasCallbackFunction);
+			writer.writeByte(hasCallbackFunction);
 			if(hasCallbackFunction)
 			{
-				encoder.encodeInteger(encodedData, (*i)->callbackParameter->integers.at(0));
-				encoder.encodeString(encodedData, (*i)->callbackParameter->strings.at(0));
-				encoder.encodeInteger(encodedData, (*i)->callbackParameter->integers.at(1));
-				encoder.encodeInteger(encodedData, (*i)->callbackParameter->integers.at(2) / 1000);
+				writer.writeSignedInteger((*i)->callbackParameter->integers.at(0));
+				writer.writeString((*i)->callbackParameter->strings.at(0));
+				writer.writeSignedInteger((*i)->callbackParameter->integers.at(1));
+				writer.writeSignedInteger((*i)->callbackParameter->integers.at(2) / 1000);
 			}
 		}
+		return changes;
 	}
 	catch(const std::exception& ex)
 	{
@@ -72,16 +73,76 @@ void PendingBidCoSQueues::serialize(std::vector<uint8_t>& encodedData)
 	{
 		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
 	}
-	_queuesMutex.unlock();
+	return -1;
+}
+
+void PendingBidCoSQueues::setSaved(int64_t changes)
+{
+	if(changes > _savedChanges) _savedChanges = changes;
 }
 
 void PendingBidCoSQueues::unserialize(std::shared_ptr<std::vector<char>> serializedData, BidCoSPeer* peer)
+{
+	try
+	{
+		if(!serializedData || serializedData->empty()) return;
+		std::lock_guard<std::mutex> queuesGuard(_queuesMutex);
+		if(!BidCoSSnapshotReader::isSnapshot(*serializedData))
+		{
+			unserializeLegacy(serializedData, peer);
+			//Converted to the snapshot format on the next save
+			_changes++;
+			return;
+		}
+		BidCoSSnapshotReader reader(*serializedData);
+		if(!reader.open(BidCoSSnapshotType::pendingQueues))
+		{
+			GD::out.printError("Error: Pending queues of peer " + std::to_string(peer->getID()) + " were saved in an unknown format.");
+			return;
+		}
+		uint64_t pendingQueuesSize = reader.readInteger();
+		for(uint64_t i = 0; i < pendingQueuesSize && !reader.error(); i++)
+		{
+			std::shared_ptr<BidCoSQueue> queue(new BidCoSQueue());
+			if(!queue->unserialize(reader)) break;
+			queue->noSending = true;
+			bool hasCallbackFunction = reader.readByte();
+			if(hasCallbackFunction)
+			{
+				std::shared_ptr<CallbackFunctionParameter> parameters(new CallbackFunctionParameter());
+				parameters->integers.push_back(reader.readSignedInteger());
+				parameters->strings.push_back(reader.readString());
+				parameters->integers.push_back(reader.readSignedInteger());
+				parameters->integers.push_back(reader.readSignedInteger() * 1000);
+				queue->callbackParameter = parameters;
+				queue->queueEmptyCallback = std::bind(&BidCoSPeer::addVariableToResetCallback, peer, std::placeholders::_1);
+			}
+			queue->pendingQueueID = _currentID++;
+			if(!queue->isEmpty()) _queues.push_back(queue);
+		}
+		//Save again, when not everything could be read.
+		if(!reader.error()) _savedChanges = _changes.load();
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+}
+
+void PendingBidCoSQueues::unserializeLegacy(std::shared_ptr<std::vector<char>> serializedData, BidCoSPeer* peer)
 {
 	try
 	{
 		BaseLib::BinaryDecoder decoder(GD::bl);
 		uint32_t position = 0;
-		_queuesMutex.lock();
 		uint32_t pendingQueuesSize = decoder.decodeInteger(*serializedData, position);
 		for(uint32_t i = 0; i < pendingQueuesSize; i++)
 		{
@@ -106,18 +167,17 @@ void PendingBidCoSQueues::unserialize(std::shared_ptr<std::vector<char>> seriali
 		}
 	}
 	catch(const std::exception& ex)
-    {
-    	GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
-    }
-    catch(BaseLib::Exception& ex)
-    {
-    	GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
-    }
-    catch(...)
-    {
-    	GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
-    }
-    _queuesMutex.unlock();
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
 }
 
 bool PendingBidCoSQueues::empty()
@@ -153,6 +213,7 @@ void PendingBidCoSQueues::push(std::shared_ptr<BidCoSQueue> queue)
 		_queuesMutex.lock();
 		queue->pendingQueueID = _currentID++;
 		_queues.push_back(queue);
+		_changes++;
 	}
 	catch(const std::exception& ex)
     {
@@ -174,7 +235,11 @@ void PendingBidCoSQueues::pop()
 	try
 	{
 		_queuesMutex.lock();
-		if(!_queues.empty()) _queues.pop_front();
+		if(!_queues.empty())
+		{
+			_queues.pop_front();
+			_changes++;
+		}
 	}
 	catch(const std::exception& ex)
     {
@@ -196,7 +261,11 @@ void PendingBidCoSQueues::pop(uint32_t id)
 	try
 	{
 		_queuesMutex.lock();
-		if(!_queues.empty() && _queues.front()->pendingQueueID == id) _queues.pop_front();
+		if(!_queues.empty() && _queues.front()->pendingQueueID == id)
+		{
+			_queues.pop_front();
+			_changes++;
+		}
 	}
 	catch(const std::exception& ex)
     {
@@ -218,6 +287,7 @@ void PendingBidCoSQueues::clear()
 	try
 	{
 		_queuesMutex.lock();
+		if(!_queues.empty()) _changes++;
 		_queues.clear();
 	}
 	catch(const std::exception& ex)
@@ -299,7 +369,11 @@ void PendingBidCoSQueues::remove(BidCoSQueueType type, std::string parameterName
 		}
 		for(int32_t i = _queues.size() - 1; i >= 0; i--)
 		{
-			if(!_queues.at(i) || (_queues.at(i)->getQueueType() == type && _queues.at(i)->parameterName == parameterName && _queues.at(i)->channel == channel)) _queues.erase(_queues.begin() + i);
+			if(!_queues.at(i) || (_queues.at(i)->getQueueType() == type && _queues.at(i)->parameterName == parameterName && _queues.at(i)->channel == channel))
+			{
+				_queues.erase(_queues.begin() + i);
+				_changes++;
+			}
 		}
 	}
 	catch(const std::exception& ex)
@@ -391,7 +465,11 @@ void PendingBidCoSQueues::setWakeOnRadioBit()
 		_queuesMutex.lock();
 		std::shared_ptr<BidCoSQueue> firstQueue = _queues.front();
 		std::shared_ptr<BidCoSPacket> packet = firstQueue->front()->getPacket();
-		if(packet) packet->setControlByte(packet->controlByte() | 0x10);
+		if(packet)
+		{
+			packet->setControlByte(packet->controlByte() | 0x10);
+			_changes++;
+		}
 	}
 	catch(const std::exception& ex)
 	{
@@ -39,6 +39,7 @@
 #include <memory>
 #include <queue>
 #include <mutex>
+#include <atomic>
 
 namespace BidCoS
 {
@@ -48,9 +49,32 @@ class PendingBidCoSQueues
 public:
 	PendingBidCoSQueues();
 	virtual ~PendingBidCoSQueues() {}
-	void serialize(std::vector<uint8_t>& encodedData);
+
+	/**
+	 * Encodes the queues. changed() stays true until setSaved() is called with the returned value.
+	 *
+	 * @return Returns the number of changes contained in "encodedData" or -1 on errors.
+	 */
+	int64_t serialize(std::vector<uint8_t>& encodedData);
+
+	/**
+	 * Reads snapshots and data saved in the format used before.
+	 */
 	void unserialize(std::shared_ptr<std::vector<char>> serializedData, BidCoSPeer* peer);
 
+	/**
+	 * Returns true when queues were added or removed since they were last saved or unserialized.
+	 */
+	bool changed() { return _changes != _savedChanges; }
+
+	/**
+	 * Marks the data returned by serialize() as saved. Call it only after the data was written. Changes made after serialize() are
+	 * still reported by changed().
+	 *
+	 * @param changes The return value of serialize().
+	 */
+	void setSaved(int64_t changes);
+
 	void push(std::shared_ptr<BidCoSQueue> queue);
 	void pop();
 	void pop(uint32_t id);
@@ -66,8 +90,19 @@ public:
 	void getInfoString(std::ostringstream& stringStream);
 private:
 	uint32_t _currentID = 0;
+
+	/**
+	 * Incremented on every change of the queues. The queues are saved when it differs from _savedChanges.
+	 */
+	std::atomic<int64_t> _changes;
+	std::atomic<int64_t> _savedChanges;
 	std::mutex _queuesMutex;
     std::deque<std::shared_ptr<BidCoSQueue>> _queues;
+
+    /**
+     * Reads data saved before snapshots were introduced. _queuesMutex needs to be locked.
+     */
+    void unserializeLegacy(std::shared_ptr<std::vector<char>> serializedData, BidCoSPeer* peer);
 };
 
 }
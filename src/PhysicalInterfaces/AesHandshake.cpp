@@ -27,11 +27,16 @@
  * files in the program, then also delete it here.
  */
 
+
 #include "AesHandshake.h"
 #include "../BidCoSPacket.h"
 
+#include <algorithm>
+
 namespace BidCoS
 {
+const std::array<uint8_t, 16> AesHandshake::_defaultKey = { { 0xA4, 0xE3, 0x75, 0xC6, 0xB0, 0x9F, 0xD1, 0x85, 0xF2, 0x7C, 0x4E, 0x96, 0xFC, 0x27, 0x3A, 0xE4 } };
+
 AesHandshake::AesHandshake(BaseLib::SharedObjects* baseLib, BaseLib::Output& out, int32_t address, std::vector<uint8_t> rfKey, std::vector<uint8_t> oldRfKey, uint32_t currentRfKeyIndex)
 {
 	_bl = baseLib;
@@ -41,77 +46,217 @@ AesHandshake::AesHandshake(BaseLib::SharedObjects* baseLib, BaseLib::Output& out
 	_rfKey = rfKey;
 	_oldRfKey = oldRfKey;
 	_currentRfKeyIndex = currentRfKeyIndex;
+	_latencyCount.fill(0);
 
-	gcry_error_t result;
-	if((result = gcry_cipher_open(&_encryptHandle, GCRY_CIPHER_AES128, GCRY_CIPHER_MODE_ECB, GCRY_CIPHER_SECURE)) != GPG_ERR_NO_ERROR)
+	//Open one cipher, so errors are reported on startup
+	std::unique_ptr<Cipher> cipher = acquireCipher();
+	if(cipher) releaseCipher(cipher);
+}
+
+AesHandshake::~AesHandshake()
+{
+	std::lock_guard<std::mutex> cipherPoolGuard(_cipherPoolMutex);
+	_cipherPool.clear();
+}
+
+// {{{ Cipher pool
+std::unique_ptr<AesHandshake::Cipher> AesHandshake::acquireCipher()
+{
+	try
 	{
-		_encryptHandle = nullptr;
-		_out.printError("Error initializing cypher handle for encryption: " + BaseLib::Security::Gcrypt::getError(result));
-		return;
+		{
+			std::lock_guard<std::mutex> cipherPoolGuard(_cipherPoolMutex);
+			if(!_cipherPool.empty())
+			{
+				std::unique_ptr<Cipher> cipher = std::move(_cipherPool.back());
+				_cipherPool.pop_back();
+				return cipher;
+			}
+		}
+
+		//Pool is empty. Handshakes run in parallel, so open another cipher.
+		std::unique_ptr<Cipher> cipher(new Cipher());
+		gcry_error_t result;
+		if((result = gcry_cipher_open(&cipher->handle, GCRY_CIPHER_AES128, GCRY_CIPHER_MODE_ECB, GCRY_CIPHER_SECURE)) != GPG_ERR_NO_ERROR)
+		{
+			cipher->handle = nullptr;
+			_out.printError("Error initializing cypher handle: " + BaseLib::Security::Gcrypt::getError(result));
+			return std::unique_ptr<Cipher>();
+		}
+		if(!cipher->handle)
+		{
+			_out.printError("Error cypher handle is nullptr.");
+			return std::unique_ptr<Cipher>();
+		}
+		return cipher;
 	}
-	if(!_encryptHandle)
+    catch(const std::exception& ex)
+    {
+    	_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(BaseLib::Exception& ex)
+    {
+    	_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+    	_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+	return std::unique_ptr<Cipher>();
+}
+
+void AesHandshake::releaseCipher(std::unique_ptr<Cipher>& cipher)
+{
+	try
 	{
-		_out.printError("Error cypher handle for encryption is nullptr.");
-		return;
+		std::lock_guard<std::mutex> cipherPoolGuard(_cipherPoolMutex);
+		_cipherPool.push_back(std::move(cipher));
 	}
-	if((result = gcry_cipher_open(&_encryptHandleKeyChange, GCRY_CIPHER_AES128, GCRY_CIPHER_MODE_ECB, GCRY_CIPHER_SECURE)) != GPG_ERR_NO_ERROR)
+    catch(const std::exception& ex)
+    {
+    	_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(BaseLib::Exception& ex)
+    {
+    	_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+    	_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+}
+
+bool AesHandshake::PooledCipher::setKey(const uint8_t* key)
+{
+	if(!_cipher) return false;
+	//Ciphers keep their key, so signing with the RF key doesn't need a key schedule per packet
+	if(_cipher->keySet && std::equal(_cipher->key.begin(), _cipher->key.end(), key)) return true;
+	gcry_error_t result;
+	if((result = gcry_cipher_setkey(_cipher->handle, key, 16)) != GPG_ERR_NO_ERROR)
 	{
-		_encryptHandleKeyChange = nullptr;
-		_out.printError("Error initializing cypher handle for encryption: " + BaseLib::Security::Gcrypt::getError(result));
-		return;
+		_cipher->keySet = false;
+		_aesHandshake->_out.printError("Error: Could not set key: " + BaseLib::Security::Gcrypt::getError(result));
+		return false;
 	}
-	if(!_encryptHandleKeyChange)
+	std::copy(key, key + 16, _cipher->key.begin());
+	_cipher->keySet = true;
+	return true;
+}
+
+bool AesHandshake::PooledCipher::encrypt(uint8_t* out, const uint8_t* in, size_t size)
+{
+	if(!_cipher || !_cipher->keySet) return false;
+	gcry_error_t result;
+	if((result = gcry_cipher_encrypt(_cipher->handle, out, 16, in, size)) != GPG_ERR_NO_ERROR)
 	{
-		_out.printError("Error cypher handle for encryption is nullptr.");
-		return;
+		_aesHandshake->_out.printError("Error encrypting data: " + BaseLib::Security::Gcrypt::getError(result));
+		return false;
 	}
-	if((result = gcry_cipher_open(&_decryptHandle, GCRY_CIPHER_AES128, GCRY_CIPHER_MODE_ECB, GCRY_CIPHER_SECURE)) != GPG_ERR_NO_ERROR)
+	return true;
+}
+
+bool AesHandshake::PooledCipher::decrypt(uint8_t* out, const uint8_t* in, size_t size)
+{
+	if(!_cipher || !_cipher->keySet) return false;
+	gcry_error_t result;
+	if((result = gcry_cipher_decrypt(_cipher->handle, out, 16, in, size)) != GPG_ERR_NO_ERROR)
 	{
-		_decryptHandle = nullptr;
-		_out.printError("Error initializing cypher handle for decryption: " + BaseLib::Security::Gcrypt::getError(result));
-		return;
+		_aesHandshake->_out.printError("Error decrypting data: " + BaseLib::Security::Gcrypt::getError(result));
+		return false;
 	}
-	if(!_decryptHandle)
+	return true;
+}
+// }}}
+
+// {{{ Latency
+void AesHandshake::setLatencyHook(LatencyHook hook)
+{
+	std::lock_guard<std::mutex> latencyGuard(_latencyMutex);
+	_latencyHook = hook;
+}
+
+void AesHandshake::addLatency(HandshakeStep step, int32_t address, int64_t latency)
+{
+	try
 	{
-		_out.printError("Error cypher handle for decryption is nullptr.");
-		return;
+		LatencyHook hook;
+		{
+			std::lock_guard<std::mutex> latencyGuard(_latencyMutex);
+			uint32_t index = (uint32_t)step;
+			_latencies[index][_latencyCount[index] % _latencies[index].size()] = latency;
+			_latencyCount[index]++;
+			hook = _latencyHook;
+		}
+		if(hook) hook(step, address, latency);
 	}
+    catch(const std::exception& ex)
+    {
+    	_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(BaseLib::Exception& ex)
+    {
+    	_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+    	_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
 }
 
-AesHandshake::~AesHandshake()
+AesHandshake::LatencyStatistics AesHandshake::getLatencyStatistics(HandshakeStep step)
 {
-	if(_decryptHandle) gcry_cipher_close(_decryptHandle);
-	if(_encryptHandle) gcry_cipher_close(_encryptHandle);
-	if(_encryptHandleKeyChange) gcry_cipher_close(_encryptHandleKeyChange);
-	_decryptHandle = nullptr;
-	_encryptHandle = nullptr;
-	_encryptHandleKeyChange = nullptr;
+	LatencyStatistics statistics;
+	try
+	{
+		uint32_t index = (uint32_t)step;
+		std::vector<int64_t> latencies;
+		{
+			std::lock_guard<std::mutex> latencyGuard(_latencyMutex);
+			statistics.count = _latencyCount[index];
+			size_t size = statistics.count < _latencies[index].size() ? statistics.count : _latencies[index].size();
+			latencies.insert(latencies.end(), _latencies[index].begin(), _latencies[index].begin() + size);
+		}
+		if(latencies.empty()) return statistics;
+		std::sort(latencies.begin(), latencies.end());
+		statistics.percentile50 = latencies.at((latencies.size() - 1) * 50 / 100);
+		statistics.percentile90 = latencies.at((latencies.size() - 1) * 90 / 100);
+		statistics.percentile99 = latencies.at((latencies.size() - 1) * 99 / 100);
+		statistics.maximum = latencies.back();
+	}
+    catch(const std::exception& ex)
+    {
+    	_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(BaseLib::Exception& ex)
+    {
+    	_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+    	_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+	return statistics;
 }
+// }}}
 
 void AesHandshake::collectGarbage()
 {
-	_handshakeInfoMutex.lock();
 	try
 	{
-		std::vector<int32_t> toDelete;
 		int64_t time = _bl->hf.getTime();
-		for(std::map<int32_t, HandshakeInfo>::iterator i = _handshakeInfoRequest.begin(); i != _handshakeInfoRequest.end(); ++i)
-		{
-			if(!i->second.mFrame || time - i->second.mFrame->timeReceived() > 5000) toDelete.push_back(i->first);
-		}
-		for(std::vector<int32_t>::iterator i = toDelete.begin(); i != toDelete.end(); ++i)
-		{
-			_handshakeInfoRequest.erase(*i);
-		}
-
-		toDelete.clear();
-		for(std::map<int32_t, HandshakeInfo>::iterator i = _handshakeInfoResponse.begin(); i != _handshakeInfoResponse.end(); ++i)
-		{
-			if(!i->second.mFrame || time - i->second.mFrame->timeSending() > 5000) toDelete.push_back(i->first);
-		}
-		for(std::vector<int32_t>::iterator i = toDelete.begin(); i != toDelete.end(); ++i)
+		for(std::array<HandshakeShard, 16>::iterator shard = _handshakeShards.begin(); shard != _handshakeShards.end(); ++shard)
 		{
-			_handshakeInfoResponse.erase(*i);
+			std::lock_guard<std::mutex> shardGuard(shard->mutex);
+			for(std::unordered_map<int32_t, HandshakeInfo>::iterator i = shard->request.begin(); i != shard->request.end();)
+			{
+				if(!i->second.mFrame || time - i->second.mFrame->timeReceived() > 5000) i = shard->request.erase(i);
+				else ++i;
+			}
+			for(std::unordered_map<int32_t, HandshakeInfo>::iterator i = shard->response.begin(); i != shard->response.end();)
+			{
+				if(!i->second.mFrame || time - i->second.mFrame->timeSending() > 5000) i = shard->response.erase(i);
+				else ++i;
+			}
 		}
 	}
     catch(const std::exception& ex)
@@ -126,7 +271,6 @@ void AesHandshake::collectGarbage()
     {
     	_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
     }
-    _handshakeInfoMutex.unlock();
 }
 
 
@@ -150,28 +294,17 @@ std::shared_ptr<BidCoSPacket> AesHandshake::getCFrame(std::shared_ptr<BidCoSPack
 		cPayload.push_back(0);
 		cFrame.reset(new BidCoSPacket(mFrame->messageCounter(), 0xA0, 0x02, _myAddress, mFrame->senderAddress(), cPayload));
 		cFrame->setTimeReceived(mFrame->timeReceived());
-	}
-    catch(const std::exception& ex)
-    {
-    	_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
-    }
-    catch(BaseLib::Exception& ex)
-    {
-    	_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
-    }
-    catch(...)
-    {
-    	_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
-    }
 
-    _handshakeInfoMutex.lock();
-	try
-	{
-		HandshakeInfo* handshakeInfo = &_handshakeInfoRequest[mFrame->senderAddress()];
-		*handshakeInfo = HandshakeInfo();
-		handshakeInfo->handshakeStarted = true;
-		handshakeInfo->mFrame = mFrame;
-		handshakeInfo->cFrame = cFrame;
+		HandshakeShard& shard = getShard(mFrame->senderAddress());
+		{
+			std::lock_guard<std::mutex> shardGuard(shard.mutex);
+			HandshakeInfo& handshakeInfo = shard.request[mFrame->senderAddress()];
+			handshakeInfo = HandshakeInfo();
+			handshakeInfo.handshakeStarted = true;
+			handshakeInfo.mFrame = mFrame;
+			handshakeInfo.cFrame = cFrame;
+		}
+		addLatency(HandshakeStep::cFrame, mFrame->senderAddress(), BaseLib::HelperFunctions::getTime() - mFrame->timeReceived());
 	}
     catch(const std::exception& ex)
     {
@@ -185,7 +318,6 @@ std::shared_ptr<BidCoSPacket> AesHandshake::getCFrame(std::shared_ptr<BidCoSPack
     {
     	_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
     }
-    _handshakeInfoMutex.unlock();
     return cFrame;
 }
 
@@ -194,67 +326,51 @@ std::shared_ptr<BidCoSPacket> AesHandshake::getAFrame(std::shared_ptr<BidCoSPack
 	std::shared_ptr<BidCoSPacket> cFrame;
 	std::shared_ptr<BidCoSPacket> aFrame;
 	{
-		std::lock_guard<std::mutex> hanshakeInfoGuard(_handshakeInfoMutex);
-		HandshakeInfo* handshakeInfo = &_handshakeInfoRequest[rFrame->senderAddress()];
+		HandshakeShard& shard = getShard(rFrame->senderAddress());
+		std::lock_guard<std::mutex> shardGuard(shard.mutex);
+		std::unordered_map<int32_t, HandshakeInfo>::iterator handshakeInfo = shard.request.find(rFrame->senderAddress());
+		if(handshakeInfo == shard.request.end()) return aFrame;
 		int64_t time = BaseLib::HelperFunctions::getTime();
-		if(!handshakeInfo->mFrame || !handshakeInfo->cFrame || time - handshakeInfo->mFrame->timeReceived() > 1000) return aFrame;
-		handshakeInfo->handshakeStarted = true;
-		mFrame = handshakeInfo->mFrame;
-		cFrame = handshakeInfo->cFrame;
+		if(!handshakeInfo->second.mFrame || !handshakeInfo->second.cFrame || time - handshakeInfo->second.mFrame->timeReceived() > 1000) return aFrame;
+		handshakeInfo->second.handshakeStarted = true;
+		mFrame = handshakeInfo->second.mFrame;
+		cFrame = handshakeInfo->second.cFrame;
     }
 
     try
 	{
 		if(_myAddress == -1) _out.printWarning("Warning: address is unset in AesHandshake.");
 
-    	std::lock_guard<std::mutex> decryptGuard(_decryptMutex);
     	if(_bl->debugLevel >= 4)_out.printInfo("Info: r-Frame is: " + rFrame->hexString());
-    	std::vector<uint8_t> rfKey;
-    	getKey(rfKey, keyIndex);
-    	if(rfKey.empty())
+    	const uint8_t* rfKey = getKey(keyIndex);
+    	if(!rfKey || cFrame->payload()->size() < 7 || rFrame->payload()->size() < 16)
     	{
     		return aFrame;
     	}
-    	std::vector<uint8_t> tempKey;
-		tempKey.reserve(16);
-		uint32_t j = 0;
-		for(std::vector<uint8_t>::iterator i = rfKey.begin(); i != rfKey.end(); ++i, ++j)
+    	uint8_t tempKey[16];
+		for(uint32_t j = 0; j < 16; j++)
 		{
-			if(j < 6) tempKey.push_back(*i ^ cFrame->payload()->at(j + 1));
-			else tempKey.push_back(*i);
+			if(j < 6) tempKey[j] = rfKey[j] ^ cFrame->payload()->at(j + 1);
+			else tempKey[j] = rfKey[j];
 		}
 
-		gcry_error_t result;
-		if((result = gcry_cipher_setkey(_decryptHandle, &tempKey.at(0), tempKey.size())) != GPG_ERR_NO_ERROR)
-		{
-			_out.printError("Error: Could not set key for decryption: " + BaseLib::Security::Gcrypt::getError(result));
-			return aFrame;
-		}
+		PooledCipher cipher(this);
+		if(!cipher.valid() || !cipher.setKey(tempKey)) return aFrame;
 
-		std::vector<uint8_t> pd(tempKey.size());
-		if(!_decryptHandle) return aFrame;
-		if((result = gcry_cipher_decrypt(_decryptHandle, &pd.at(0), pd.size(), &rFrame->payload()->at(0), rFrame->payload()->size())) != GPG_ERR_NO_ERROR)
-		{
-			_out.printError("Error decrypting data: " + BaseLib::Security::Gcrypt::getError(result));
-			return aFrame;
-		}
+		uint8_t pd[16];
+		if(!cipher.decrypt(pd, rFrame->payload()->data(), 16)) return aFrame;
 
-		j = 1;
-		for(std::vector<uint8_t>::iterator i = pd.begin(); i != pd.end(); ++i, ++j)
+		const std::vector<uint8_t>& mPayload = *mFrame->payload();
+		for(uint32_t j = 1; j <= 16; j++)
 		{
-			if(j < mFrame->payload()->size()) *i = *i ^ mFrame->payload()->at(j);
+			if(j < mPayload.size()) pd[j - 1] = pd[j - 1] ^ mPayload[j];
 			else break;
 		}
 
+		uint8_t pdd[16];
+		if(!cipher.decrypt(pdd, pd, 16)) return aFrame;
 
-		std::vector<uint8_t> pdd(tempKey.size());
-		if((result = gcry_cipher_decrypt(_decryptHandle, &pdd.at(0), pdd.size(), &pd.at(0), pd.size())) != GPG_ERR_NO_ERROR)
-		{
-			_out.printError("Error decrypting data: " + BaseLib::Security::Gcrypt::getError(result));
-			return aFrame;
-		}
-
-		for(uint32_t i = 6; i < pdd.size(); i++)
+		for(uint32_t i = 6; i < 16; i++)
 		{
 			if(i == 6)
 			{
@@ -294,19 +410,14 @@ std::shared_ptr<BidCoSPacket> AesHandshake::getAFrame(std::shared_ptr<BidCoSPack
 			}
 			else if(i == 15)
 			{
-				if(!mFrame->payload()->empty() && pdd[i] != mFrame->payload()->at(0)) return aFrame;
+				if(!mPayload.empty() && pdd[i] != mPayload.at(0)) return aFrame;
 			}
 		}
 
-		std::vector<uint8_t> aPayload;
-		aPayload.reserve(5);
-		aPayload.push_back(0);
-		aPayload.push_back(pd.at(0));
-		aPayload.push_back(pd.at(1));
-		aPayload.push_back(pd.at(2));
-		aPayload.push_back(pd.at(3));
+		std::vector<uint8_t> aPayload{ 0, pd[0], pd[1], pd[2], pd[3] };
 		aFrame.reset(new BidCoSPacket(mFrame->messageCounter(), ((mFrame->controlByte() & 2) && wakeUp && mFrame->messageType() != 0) ? 0x81 : 0x80, 0x02, _myAddress, mFrame->senderAddress(), aPayload));
 		aFrame->setTimeReceived(rFrame->timeReceived());
+		addLatency(HandshakeStep::aFrame, rFrame->senderAddress(), BaseLib::HelperFunctions::getTime() - rFrame->timeReceived());
 	}
     catch(const std::exception& ex)
     {
@@ -328,12 +439,13 @@ std::shared_ptr<BidCoSPacket> AesHandshake::getAFrame(std::shared_ptr<BidCoSPack
 void AesHandshake::setMFrame(std::shared_ptr<BidCoSPacket> mFrame)
 {
 	if(mFrame->messageType() == 0x03) return;
-	_handshakeInfoMutex.lock();
 	try
 	{
-		HandshakeInfo* handshakeInfo = &_handshakeInfoResponse[mFrame->destinationAddress()];
-		*handshakeInfo = HandshakeInfo();
-		handshakeInfo->mFrame = mFrame;
+		HandshakeShard& shard = getShard(mFrame->destinationAddress());
+		std::lock_guard<std::mutex> shardGuard(shard.mutex);
+		HandshakeInfo& handshakeInfo = shard.response[mFrame->destinationAddress()];
+		handshakeInfo = HandshakeInfo();
+		handshakeInfo.mFrame = mFrame;
 	}
     catch(const std::exception& ex)
     {
@@ -347,7 +459,6 @@ void AesHandshake::setMFrame(std::shared_ptr<BidCoSPacket> mFrame)
     {
     	_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
     }
-    _handshakeInfoMutex.unlock();
 }
 
 std::shared_ptr<BidCoSPacket> AesHandshake::getRFrame(std::shared_ptr<BidCoSPacket> cFrame, std::shared_ptr<BidCoSPacket>& mFrame, uint32_t keyIndex)
@@ -356,66 +467,33 @@ std::shared_ptr<BidCoSPacket> AesHandshake::getRFrame(std::shared_ptr<BidCoSPack
 	if(_bl->debugLevel >= 4) _out.printInfo("Info: c-Frame is: " + cFrame->hexString());
 
 	std::shared_ptr<BidCoSPacket> rFrame;
-	_handshakeInfoMutex.lock();
 	try
 	{
-		HandshakeInfo* handshakeInfo = &_handshakeInfoResponse[cFrame->senderAddress()];
-		int64_t time = BaseLib::HelperFunctions::getTime();
-		if(!handshakeInfo->mFrame || time - handshakeInfo->mFrame->timeSending() > 1000)
+		HandshakeShard& shard = getShard(cFrame->senderAddress());
 		{
-			_handshakeInfoMutex.unlock();
-			return rFrame;
+			std::lock_guard<std::mutex> shardGuard(shard.mutex);
+			std::unordered_map<int32_t, HandshakeInfo>::iterator handshakeInfo = shard.response.find(cFrame->senderAddress());
+			if(handshakeInfo == shard.response.end()) return rFrame;
+			int64_t time = BaseLib::HelperFunctions::getTime();
+			if(!handshakeInfo->second.mFrame || time - handshakeInfo->second.mFrame->timeSending() > 1000) return rFrame;
+			handshakeInfo->second.handshakeStarted = true;
+			mFrame = handshakeInfo->second.mFrame;
 		}
-		handshakeInfo->handshakeStarted = true;
-		mFrame = handshakeInfo->mFrame;
-	}
-    catch(const std::exception& ex)
-    {
-    	_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
-    }
-    catch(BaseLib::Exception& ex)
-    {
-    	_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
-    }
-    catch(...)
-    {
-    	_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
-    }
-    _handshakeInfoMutex.unlock();
 
-    _encryptMutex.lock();
-    try
-    {
-    	std::vector<uint8_t> rfKey;
-    	getKey(rfKey, keyIndex);
-    	if(rfKey.empty())
-    	{
-    		_encryptMutex.unlock();
-			return rFrame;
-    	}
-    	std::vector<uint8_t> tempKey;
-		tempKey.reserve(16);
-		uint32_t j = 0;
-		for(std::vector<uint8_t>::iterator i = rfKey.begin(); i != rfKey.end(); ++i, ++j)
+		const uint8_t* rfKey = getKey(keyIndex);
+		if(!rfKey || cFrame->payload()->size() < 7) return rFrame;
+		uint8_t tempKey[16];
+		for(uint32_t j = 0; j < 16; j++)
 		{
-			if(j < 6) tempKey.push_back(*i ^ cFrame->payload()->at(j + 1));
-			else tempKey.push_back(*i);
+			if(j < 6) tempKey[j] = rfKey[j] ^ cFrame->payload()->at(j + 1);
+			else tempKey[j] = rfKey[j];
 		}
 
-		gcry_error_t result;
-		if(!_encryptHandle)
-		{
-			_encryptMutex.unlock();
-			return rFrame;
-		}
-		if((result = gcry_cipher_setkey(_encryptHandle, &tempKey.at(0), tempKey.size())) != GPG_ERR_NO_ERROR)
-		{
-			_out.printError("Error: Could not set key for encryption: " + BaseLib::Security::Gcrypt::getError(result));
-			_encryptMutex.unlock();
-			return rFrame;
-		}
+		PooledCipher cipher(this);
+		if(!cipher.valid() || !cipher.setKey(tempKey)) return rFrame;
 
-		std::vector<uint8_t> pdd(tempKey.size());
+		const std::vector<uint8_t>& mPayload = *mFrame->payload();
+		uint8_t pdd[16];
 		for(int32_t i = 0; i < 6; i++)
 		{
 			pdd[i] = BaseLib::HelperFunctions::getRandomNumber(0, 255);
@@ -429,55 +507,30 @@ std::shared_ptr<BidCoSPacket> AesHandshake::getRFrame(std::shared_ptr<BidCoSPack
 		pdd[12] = mFrame->destinationAddress() >> 16;
 		pdd[13] = (mFrame->destinationAddress() >> 8) & 0xFF;
 		pdd[14] = mFrame->destinationAddress() & 0xFF;
-		pdd[15] = mFrame->payload()->empty() ? 0 : mFrame->payload()->at(0);
+		pdd[15] = mPayload.empty() ? 0 : mPayload.at(0);
 
-		std::vector<uint8_t> pd(tempKey.size());
-		if((result = gcry_cipher_encrypt(_encryptHandle, &pd.at(0), pd.size(), &pdd.at(0), pdd.size())) != GPG_ERR_NO_ERROR)
-		{
-			_out.printError("Error encrypting data: " + BaseLib::Security::Gcrypt::getError(result));
-			_encryptMutex.unlock();
-			return rFrame;
-		}
+		uint8_t pd[16];
+		if(!cipher.encrypt(pd, pdd, 16)) return rFrame;
 
-		_handshakeInfoMutex.lock();
-		try
-		{
-			HandshakeInfo* handshakeInfo = &_handshakeInfoResponse[cFrame->senderAddress()];
-			handshakeInfo->pd.reset(new std::vector<uint8_t>());
-			handshakeInfo->pd->insert(handshakeInfo->pd->begin(), pd.begin(), pd.end());
-		}
-		catch(const std::exception& ex)
 		{
-			_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+			std::lock_guard<std::mutex> shardGuard(shard.mutex);
+			HandshakeInfo& handshakeInfo = shard.response[cFrame->senderAddress()];
+			std::copy(pd, pd + 4, handshakeInfo.pd.begin());
+			handshakeInfo.pdSet = true;
 		}
-		catch(BaseLib::Exception& ex)
-		{
-			_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
-		}
-		catch(...)
-		{
-			_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
-		}
-		_handshakeInfoMutex.unlock();
 
-		j = 1;
-		for(std::vector<uint8_t>::iterator i = pd.begin(); i != pd.end(); ++i, ++j)
+		for(uint32_t j = 1; j <= 16; j++)
 		{
-			if(j < mFrame->payload()->size()) *i = *i ^ mFrame->payload()->at(j);
+			if(j < mPayload.size()) pd[j - 1] = pd[j - 1] ^ mPayload[j];
 			else break;
 		}
 
-		std::vector<uint8_t> rPayload(tempKey.size());
-		if((result = gcry_cipher_encrypt(_encryptHandle, &rPayload.at(0), tempKey.size(), &pd.at(0), pd.size())) != GPG_ERR_NO_ERROR)
-		{
-			_out.printError("Error decrypting data: " + BaseLib::Security::Gcrypt::getError(result));
-			_encryptMutex.unlock();
-			return rFrame;
-		}
+		std::vector<uint8_t> rPayload(16);
+		if(!cipher.encrypt(rPayload.data(), pd, 16)) return rFrame;
 
 		rFrame.reset(new BidCoSPacket(mFrame->messageCounter(), 0xA0, 0x03, _myAddress, mFrame->destinationAddress(), rPayload));
 		rFrame->setTimeReceived(cFrame->timeReceived());
-		_encryptMutex.unlock();
+		addLatency(HandshakeStep::rFrame, cFrame->senderAddress(), BaseLib::HelperFunctions::getTime() - cFrame->timeReceived());
 		return rFrame;
     }
     catch(const std::exception& ex)
@@ -492,7 +545,6 @@ std::shared_ptr<BidCoSPacket> AesHandshake::getRFrame(std::shared_ptr<BidCoSPack
     {
     	_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
     }
-    _encryptMutex.unlock();
     return rFrame;
 }
 
@@ -500,14 +552,15 @@ bool AesHandshake::handshakeStarted(int32_t address)
 {
 	try
 	{
-		std::lock_guard<std::mutex> handshakeInfoGuard(_handshakeInfoMutex);
-		HandshakeInfo* handshakeInfo = &_handshakeInfoResponse[address];
-		if(!handshakeInfo->handshakeStarted || !handshakeInfo->mFrame || BaseLib::HelperFunctions::getTime() - handshakeInfo->mFrame->timeSending() > 1000)
+		HandshakeShard& shard = getShard(address);
+		std::lock_guard<std::mutex> shardGuard(shard.mutex);
+		std::unordered_map<int32_t, HandshakeInfo>::iterator handshakeInfo = shard.response.find(address);
+		if(handshakeInfo == shard.response.end() || !handshakeInfo->second.handshakeStarted || !handshakeInfo->second.mFrame || BaseLib::HelperFunctions::getTime() - handshakeInfo->second.mFrame->timeSending() > 1000)
 		{
 			return false;
 		}
 	}
-	catch(const std::exception& ex)
+    catch(const std::exception& ex)
     {
     	_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
     }
@@ -526,40 +579,19 @@ bool AesHandshake::checkAFrame(std::shared_ptr<BidCoSPacket> aFrame)
 {
 	try
 	{
-		std::shared_ptr<std::vector<uint8_t>> pd;
-		_handshakeInfoMutex.lock();
-		try
+		std::array<uint8_t, 4> pd;
 		{
-			HandshakeInfo* handshakeInfo = &_handshakeInfoResponse[aFrame->senderAddress()];
+			HandshakeShard& shard = getShard(aFrame->senderAddress());
+			std::lock_guard<std::mutex> shardGuard(shard.mutex);
+			std::unordered_map<int32_t, HandshakeInfo>::iterator handshakeInfo = shard.response.find(aFrame->senderAddress());
 			int64_t time = BaseLib::HelperFunctions::getTime();
-			if(!handshakeInfo->mFrame || time - handshakeInfo->mFrame->timeSending() > 1000)
-			{
-				_handshakeInfoMutex.unlock();
-				return false;
-			}
-			if(!handshakeInfo->pd) //No AES handshake was performed
-			{
-				_handshakeInfoMutex.unlock();
-				return true;
-			}
-			pd = handshakeInfo->pd;
-		}
-		catch(const std::exception& ex)
-		{
-			_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
-		}
-		catch(BaseLib::Exception& ex)
-		{
-			_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
-		}
-		catch(...)
-		{
-			_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+			if(handshakeInfo == shard.response.end() || !handshakeInfo->second.mFrame || time - handshakeInfo->second.mFrame->timeSending() > 1000) return false;
+			if(!handshakeInfo->second.pdSet) return true; //No AES handshake was performed
+			pd = handshakeInfo->second.pd;
 		}
-		_handshakeInfoMutex.unlock();
 
-		if(!pd) return false;
-		if(aFrame->payload()->size() >= 5 && aFrame->payload()->at(aFrame->payload()->size() - 4) == pd->at(0) && aFrame->payload()->at(aFrame->payload()->size() - 3) == pd->at(1) && aFrame->payload()->at(aFrame->payload()->size() - 2) == pd->at(2) && aFrame->payload()->at(aFrame->payload()->size() - 1) == pd->at(3))
+		std::vector<uint8_t>& payload = *aFrame->payload();
+		if(payload.size() >= 5 && payload.at(payload.size() - 4) == pd[0] && payload.at(payload.size() - 3) == pd[1] && payload.at(payload.size() - 2) == pd[2] && payload.at(payload.size() - 1) == pd[3])
 		{
 			aFrame->setValidAesAck(true);
 			if(_bl->debugLevel >= 5) _out.printDebug("Debug: ACK AES signature is valid.");
@@ -567,7 +599,7 @@ bool AesHandshake::checkAFrame(std::shared_ptr<BidCoSPacket> aFrame)
 		}
 		else if(_bl->debugLevel >= 3) _out.printInfo("Warning: ACK AES signature is invalid.");
 	}
-	catch(const std::exception& ex)
+    catch(const std::exception& ex)
     {
     	_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
     }
@@ -585,29 +617,28 @@ bool AesHandshake::checkAFrame(std::shared_ptr<BidCoSPacket> aFrame)
 bool AesHandshake::generateKeyChangePacket(std::shared_ptr<BidCoSPacket> keyChangeTemplate)
 {
 	std::vector<uint8_t>* payload = keyChangeTemplate->payload();
-	std::vector<uint8_t> oldRfKey;
+	const uint8_t* oldRfKey = nullptr;
 	try
 	{
 		payload->at(1) += 2;
 		uint32_t index = (payload->at(1) / 2);
 		uint32_t subindex = payload->at(1) % 2;
-		std::vector<uint8_t> key;
 		if(_currentRfKeyIndex != index)
 		{
 			_out.printError("Error: No AES key is defined for the key index to set. You probably changed rfKey before the last key was sent to the device or you forgot to set oldRfKey. Please set oldRfKey in homematicbidcos.conf to the current AES key of the peer or reset the peer and pair it again.");
 			return false;
 		}
-		if(_currentRfKeyIndex == 1) oldRfKey = std::vector<uint8_t> { 0xA4, 0xE3, 0x75, 0xC6, 0xB0, 0x9F, 0xD1, 0x85, 0xF2, 0x7C, 0x4E, 0x96, 0xFC, 0x27, 0x3A, 0xE4 };
-		else oldRfKey = _oldRfKey;
-		getKey(key, index);
-		if(key.empty() || oldRfKey.empty())
+		if(_currentRfKeyIndex == 1) oldRfKey = _defaultKey.data();
+		else oldRfKey = getKey(_currentRfKeyIndex - 1);
+		const uint8_t* key = getKey(index);
+		if(!key || !oldRfKey)
 		{
 			_out.printError("Error: rfKey or oldRfKey are empty.");
 			return false;
 		}
 
-		if(subindex == 0) payload->insert(payload->end(), key.begin(), key.begin() + 8);
-		else payload->insert(payload->end(), key.begin() + 8, key.end());
+		if(subindex == 0) payload->insert(payload->end(), key, key + 8);
+		else payload->insert(payload->end(), key + 8, key + 16);
 		payload->push_back((uint8_t)BaseLib::HelperFunctions::getRandomNumber(0, 255));
 		payload->push_back((uint8_t)BaseLib::HelperFunctions::getRandomNumber(0, 255));
 		payload->push_back(0x7E);
@@ -615,7 +646,7 @@ bool AesHandshake::generateKeyChangePacket(std::shared_ptr<BidCoSPacket> keyChan
 		payload->push_back(0x6F);
 		payload->push_back(0xA5);
 	}
-	catch(const std::exception& ex)
+    catch(const std::exception& ex)
     {
     	_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
     }
@@ -630,34 +661,17 @@ bool AesHandshake::generateKeyChangePacket(std::shared_ptr<BidCoSPacket> keyChan
 
     try
     {
-		gcry_error_t result;
-		_keyChangeMutex.lock();
-		if(!_encryptHandleKeyChange)
-		{
-			_keyChangeMutex.unlock();
-			return false;
-		}
-		if((result = gcry_cipher_setkey(_encryptHandleKeyChange, &oldRfKey.at(0), oldRfKey.size())) != GPG_ERR_NO_ERROR)
-		{
-			_out.printError("Error: Could not set key for encryption: " + BaseLib::Security::Gcrypt::getError(result));
-			_keyChangeMutex.unlock();
-			return false;
-		}
+    	if(!oldRfKey || payload->size() > 16) return false;
+    	PooledCipher cipher(this);
+		if(!cipher.valid() || !cipher.setKey(oldRfKey)) return false;
 
-		std::vector<uint8_t> encryptedPayload(oldRfKey.size());
-		if((result = gcry_cipher_encrypt(_encryptHandleKeyChange, &encryptedPayload.at(0), encryptedPayload.size(), &payload->at(0), payload->size())) != GPG_ERR_NO_ERROR)
-		{
-			_out.printError("Error encrypting data: " + BaseLib::Security::Gcrypt::getError(result));
-			_keyChangeMutex.unlock();
-			return false;
-		}
+		std::vector<uint8_t> encryptedPayload(16);
+		if(!cipher.encrypt(encryptedPayload.data(), payload->data(), payload->size())) return false;
 
 		*keyChangeTemplate->payload() = encryptedPayload;
-
-		_keyChangeMutex.unlock();
 		return true;
 	}
-	catch(const std::exception& ex)
+    catch(const std::exception& ex)
     {
     	_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
     }
@@ -669,31 +683,15 @@ bool AesHandshake::generateKeyChangePacket(std::shared_ptr<BidCoSPacket> keyChan
     {
     	_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
     }
-    _keyChangeMutex.unlock();
     return false;
 }
 
-void AesHandshake::getKey(std::vector<uint8_t>& key, uint32_t keyIndex)
+const uint8_t* AesHandshake::getKey(uint32_t keyIndex)
 {
-	try
-	{
-		if(keyIndex == 0) key = std::vector<uint8_t> { 0xA4, 0xE3, 0x75, 0xC6, 0xB0, 0x9F, 0xD1, 0x85, 0xF2, 0x7C, 0x4E, 0x96, 0xFC, 0x27, 0x3A, 0xE4 };
-		else if(keyIndex == _currentRfKeyIndex) key = _rfKey;
-		else if(keyIndex == _currentRfKeyIndex - 1) key = _oldRfKey;
-		else key.clear();
-	}
-	catch(const std::exception& ex)
-    {
-    	_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
-    }
-    catch(BaseLib::Exception& ex)
-    {
-    	_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
-    }
-    catch(...)
-    {
-    	_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
-    }
+	if(keyIndex == 0) return _defaultKey.data();
+	else if(keyIndex == _currentRfKeyIndex) return _rfKey.size() == 16 ? _rfKey.data() : nullptr;
+	else if(keyIndex == _currentRfKeyIndex - 1) return _oldRfKey.size() == 16 ? _oldRfKey.data() : nullptr;
+	return nullptr;
 }
 // }}}
 
@@ -702,68 +700,52 @@ void AesHandshake::appendSignature(std::shared_ptr<BidCoSPacket> packet)
 {
 	try
 	{
-		if(packet->payload()->size() < 6) return;
+		std::vector<uint8_t>& payload = *packet->payload();
+		if(payload.size() < 6 || _rfKey.size() != 16) return;
 
-		std::vector<uint8_t> iv(16, 0);
-		iv.at(0) = 0x49;
+		uint8_t iv[16] = { 0 };
+		iv[0] = 0x49;
 		int32_t senderAddress = packet->senderAddress();
-		iv.at(1) = senderAddress >> 16;
-		iv.at(2) = (senderAddress >> 8) & 0xFF;
-		iv.at(3) = senderAddress & 0xFF;
+		iv[1] = senderAddress >> 16;
+		iv[2] = (senderAddress >> 8) & 0xFF;
+		iv[3] = senderAddress & 0xFF;
 		int32_t destinationAddress = packet->destinationAddress();
-		iv.at(4) = destinationAddress >> 16;
-		iv.at(5) = (destinationAddress >> 8) & 0xFF;
-		iv.at(6) = destinationAddress & 0xFF;
-		iv.at(7) = packet->payload()->at(4);
-		iv.at(8) = packet->payload()->at(5);
-		iv.at(9) = packet->messageCounter();
-		iv.at(15) = 5;
-
-		gcry_error_t result = 0;
-		std::vector<uint8_t> eIv(iv.size());
-
-		std::lock_guard<std::mutex> encryptGuard(_encryptMutex);
-		if(!_encryptHandle) return;
-
-		if((result = gcry_cipher_setkey(_encryptHandle, _rfKey.data(), _rfKey.size())) != GPG_ERR_NO_ERROR)
-		{
-			_out.printError("Error: Could not set key for encryption: " + BaseLib::Security::Gcrypt::getError(result));
-			return;
-		}
-
-		if((result = gcry_cipher_encrypt(_encryptHandle, eIv.data(), eIv.size(), iv.data(), iv.size())) != GPG_ERR_NO_ERROR)
-		{
-			_out.printError("Error encrypting data: " + BaseLib::Security::Gcrypt::getError(result));
-			return;
-		}
-
-		std::vector<uint8_t> plain(2, 0);
-		plain.reserve(16);
-		plain.at(0) = packet->messageCounter();
-		plain.at(1) = packet->controlByte();
-		plain.insert(plain.end(), packet->payload()->begin(), packet->payload()->end() - 2);
-		plain.resize(16, 0);
+		iv[4] = destinationAddress >> 16;
+		iv[5] = (destinationAddress >> 8) & 0xFF;
+		iv[6] = destinationAddress & 0xFF;
+		iv[7] = payload[4];
+		iv[8] = payload[5];
+		iv[9] = packet->messageCounter();
+		iv[15] = 5;
+
+		PooledCipher cipher(this);
+		if(!cipher.valid() || !cipher.setKey(_rfKey.data())) return;
+
+		uint8_t eIv[16];
+		if(!cipher.encrypt(eIv, iv, 16)) return;
+
+		uint8_t plain[16] = { 0 };
+		plain[0] = packet->messageCounter();
+		plain[1] = packet->controlByte();
+		//Everything but the last two bytes of the payload. Only 14 bytes fit.
+		size_t plainSize = payload.size() - 2 > 14 ? 14 : payload.size() - 2;
+		std::copy(payload.begin(), payload.begin() + plainSize, plain + 2);
 
 		for(int32_t i = 0; i < 16; i++)
 		{
-			eIv.at(i) = eIv.at(i) ^ plain.at(i);
+			eIv[i] = eIv[i] ^ plain[i];
 		}
 
-		std::vector<uint8_t> signature(16);
-
-		if((result = gcry_cipher_encrypt(_encryptHandle, signature.data(), signature.size(), eIv.data(), eIv.size())) != GPG_ERR_NO_ERROR)
-		{
-			_out.printError("Error encrypting data: " + BaseLib::Security::Gcrypt::getError(result));
-			return;
-		}
+		uint8_t signature[16];
+		if(!cipher.encrypt(signature, eIv, 16)) return;
 
-		packet->payload()->reserve(packet->payload()->size() + 4);
-		packet->payload()->push_back(signature.at(12));
-		packet->payload()->push_back(signature.at(13));
-		packet->payload()->push_back(signature.at(14));
-		packet->payload()->push_back(signature.at(15));
+		payload.reserve(payload.size() + 4);
+		payload.push_back(signature[12]);
+		payload.push_back(signature[13]);
+		payload.push_back(signature[14]);
+		payload.push_back(signature[15]);
 	}
-	catch(const std::exception& ex)
+    catch(const std::exception& ex)
     {
     	_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
     }
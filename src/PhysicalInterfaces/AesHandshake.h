@@ -27,6 +27,7 @@
  * files in the program, then also delete it here.
  */
 
+
 #ifndef AESHANDSHAKE_H
 #define AESHANDSHAKE_H
 
@@ -34,6 +35,10 @@
 
 #include <gcrypt.h>
 
+#include <array>
+#include <functional>
+#include <unordered_map>
+
 namespace BidCoS
 {
 
@@ -42,6 +47,34 @@ class BidCoSPacket;
 class AesHandshake
 {
 	public:
+		enum class HandshakeStep
+		{
+			cFrame = 0, ///< Time from receiving an m-Frame to creating the c-Frame
+			rFrame = 1, ///< Time from receiving a c-Frame to creating the r-Frame
+			aFrame = 2  ///< Time from receiving an r-Frame to creating the a-Frame
+		};
+
+		class LatencyStatistics
+		{
+		public:
+			LatencyStatistics() {}
+			virtual ~LatencyStatistics() {}
+
+			/**
+			 * The total number of measurements. Percentiles are calculated over the last measurements only.
+			 */
+			uint64_t count = 0;
+			int64_t percentile50 = 0;
+			int64_t percentile90 = 0;
+			int64_t percentile99 = 0;
+			int64_t maximum = 0;
+		};
+
+		/**
+		 * Called for every created frame with the handshake step, the address of the peer and the latency in milliseconds.
+		 */
+		typedef std::function<void(HandshakeStep step, int32_t address, int64_t latency)> LatencyHook;
+
 		AesHandshake(BaseLib::SharedObjects* baseLib, BaseLib::Output& out, int32_t address, std::vector<uint8_t> rfKey, std::vector<uint8_t> oldRfKey, uint32_t currentRfKeyIndex);
         virtual ~AesHandshake();
 
@@ -56,6 +89,9 @@ class AesHandshake
         bool generateKeyChangePacket(std::shared_ptr<BidCoSPacket> keyChangeTemplate);
 
         void appendSignature(std::shared_ptr<BidCoSPacket> packet);
+
+        void setLatencyHook(LatencyHook hook);
+        LatencyStatistics getLatencyStatistics(HandshakeStep step);
     private:
         class HandshakeInfo
 		{
@@ -66,26 +102,79 @@ class AesHandshake
         	bool handshakeStarted = false;
         	std::shared_ptr<BidCoSPacket> mFrame;
         	std::shared_ptr<BidCoSPacket> cFrame;
-        	std::shared_ptr<std::vector<uint8_t>> pd;
+        	bool pdSet = false;
+        	std::array<uint8_t, 4> pd{ { 0, 0, 0, 0 } }; //Only the first four bytes are needed to check the a-Frame
 		};
 
+        /**
+         * Handshakes of addresses in different shards don't wait for each other.
+         */
+        class HandshakeShard
+        {
+        public:
+        	std::mutex mutex;
+        	std::unordered_map<int32_t, HandshakeInfo> request;
+        	std::unordered_map<int32_t, HandshakeInfo> response;
+        };
+
+        class Cipher
+        {
+        public:
+        	Cipher() {}
+        	virtual ~Cipher() { if(handle) gcry_cipher_close(handle); }
+
+        	gcry_cipher_hd_t handle = nullptr;
+        	bool keySet = false;
+        	std::array<uint8_t, 16> key;
+        };
+
+        /**
+         * Takes a cipher from the pool for the lifetime of the object and puts it back on destruction.
+         */
+        class PooledCipher
+        {
+        public:
+        	PooledCipher(AesHandshake* aesHandshake) { _aesHandshake = aesHandshake; _cipher = aesHandshake->acquireCipher(); }
+        	virtual ~PooledCipher() { if(_cipher) _aesHandshake->releaseCipher(_cipher); }
+
+        	bool valid() { return (bool)_cipher; }
+        	bool setKey(const uint8_t* key);
+        	bool encrypt(uint8_t* out, const uint8_t* in, size_t size);
+        	bool decrypt(uint8_t* out, const uint8_t* in, size_t size);
+        private:
+        	AesHandshake* _aesHandshake = nullptr;
+        	std::unique_ptr<Cipher> _cipher;
+        };
+
+        static const std::array<uint8_t, 16> _defaultKey;
         BaseLib::SharedObjects* _bl = nullptr;
         BaseLib::Output _out;
         int32_t _myAddress = -1;
         std::vector<uint8_t> _rfKey;
         std::vector<uint8_t> _oldRfKey;
         uint32_t _currentRfKeyIndex = 0;
-        std::mutex _encryptMutex;
-        std::mutex _decryptMutex;
-        std::mutex _keyChangeMutex;
-        gcry_cipher_hd_t _encryptHandle = nullptr;
-        gcry_cipher_hd_t _encryptHandleKeyChange = nullptr;
-        gcry_cipher_hd_t _decryptHandle = nullptr;
-        std::mutex _handshakeInfoMutex;
-        std::map<int32_t, HandshakeInfo> _handshakeInfoRequest;
-        std::map<int32_t, HandshakeInfo> _handshakeInfoResponse;
-
-        void getKey(std::vector<uint8_t>& key, uint32_t keyIndex);
+        std::mutex _cipherPoolMutex;
+        std::vector<std::unique_ptr<Cipher>> _cipherPool;
+        std::array<HandshakeShard, 16> _handshakeShards;
+
+        // {{{ Latency
+        std::mutex _latencyMutex;
+        LatencyHook _latencyHook;
+        std::array<uint64_t, 3> _latencyCount;
+        std::array<std::array<int64_t, 1024>, 3> _latencies; //Ring buffer of the last measurements per step
+        // }}}
+
+        HandshakeShard& getShard(int32_t address) { return _handshakeShards[((uint32_t)address ^ ((uint32_t)address >> 8) ^ ((uint32_t)address >> 16)) & 0x0F]; }
+        std::unique_ptr<Cipher> acquireCipher();
+        void releaseCipher(std::unique_ptr<Cipher>& cipher);
+
+        /**
+         * Returns the key with the specified index.
+         *
+         * @return Returns a pointer to the 16 bytes long key or nullptr if there is no valid key for this index.
+         */
+        const uint8_t* getKey(uint32_t keyIndex);
+        void addLatency(HandshakeStep step, int32_t address, int64_t latency);
 };
 
 }
@@ -271,8 +271,9 @@ void COC::lineReceived(const std::string& data)
 		}
 		if(packetHex.size() > 21) //21 is minimal packet length (=10 Byte + COC "A" + "\n")
 		{
-			std::shared_ptr<BidCoSPacket> packet(new BidCoSPacket(packetHex, BaseLib::HelperFunctions::getTime()));
-			processReceivedPacket(packet);
+			std::shared_ptr<BidCoSPacket> packet(new BidCoSPacket());
+			packet->setTimeReceived(BaseLib::HelperFunctions::getTime());
+			if(packet->import(packetHex, packetHex.front() == 'A')) processReceivedPacket(packet);
 		}
 		else if(!packetHex.empty())
 		{
@@ -31,12 +31,7 @@
 
 namespace BidCoS
 {
-CRC16::CRC16()
-{
-	if(_crcTable.empty()) initCRCTable();
-}
-
-void CRC16::initCRCTable()
+CRC16::Tables::Tables()
 {
 	uint32_t bit, crc;
 
@@ -51,32 +46,58 @@ void CRC16::initCRCTable()
 			if(bit) crc ^= 0x8005;
 		}
 
-		crc &= 0xFFFF;
-		_crcTable[i]= crc;
+		tables[0][i] = crc & 0xFFFF;
 	}
-}
 
-uint16_t CRC16::calculate(const std::vector<char>& data, bool ignoreLastTwoBytes)
-{
-	int32_t size = ignoreLastTwoBytes ? data.size() - 2 : data.size();
-	uint16_t crc = 0xd77f;
-	for(int32_t i = 0; i < size; i++)
+	for(uint32_t n = 1; n < 4; n++)
 	{
-		crc = (crc << 8) ^ _crcTable[((crc >> 8) & 0xff) ^ (uint8_t)data[i]];
+		for(uint32_t i = 0; i < 256; i++)
+		{
+			uint16_t previous = tables[n - 1][i];
+			tables[n][i] = (uint16_t)(previous << 8) ^ tables[0][previous >> 8];
+		}
 	}
+}
 
-    return crc;
+const CRC16::Tables& CRC16::getTables()
+{
+	//Initialized once and shared by all interfaces. Initialization of function local statics is thread safe.
+	static const Tables tables;
+	return tables;
 }
 
-uint16_t CRC16::calculate(const std::vector<uint8_t>& data, bool ignoreLastTwoBytes)
+uint16_t CRC16::calculate(const uint8_t* data, size_t size, uint16_t crc)
 {
-	int32_t size = ignoreLastTwoBytes ? data.size() - 2 : data.size();
-	uint16_t crc = 0xd77f;
-	for(int32_t i = 0; i < size; i++)
+	const Tables& tables = getTables();
+	while(size >= 4)
 	{
-		crc = (crc << 8) ^ _crcTable[((crc >> 8) & 0xff) ^ data[i]];
+		crc = tables.tables[3][(crc >> 8) ^ data[0]] ^
+			  tables.tables[2][(crc & 0xFF) ^ data[1]] ^
+			  tables.tables[1][data[2]] ^
+			  tables.tables[0][data[3]];
+		data += 4;
+		size -= 4;
 	}
+	while(size > 0)
+	{
+		crc = (uint16_t)(crc << 8) ^ tables.tables[0][(crc >> 8) ^ *data];
+		data++;
+		size--;
+	}
+	return crc;
+}
 
-    return crc;
+uint16_t CRC16::calculate(const std::vector<char>& data, bool ignoreLastTwoBytes)
+{
+	size_t size = data.size();
+	if(ignoreLastTwoBytes) size = size >= 2 ? size - 2 : 0;
+	return calculate((const uint8_t*)data.data(), size);
+}
+
+uint16_t CRC16::calculate(const std::vector<uint8_t>& data, bool ignoreLastTwoBytes)
+{
+	size_t size = data.size();
+	if(ignoreLastTwoBytes) size = size >= 2 ? size - 2 : 0;
+	return calculate(data.data(), size);
 }
 }
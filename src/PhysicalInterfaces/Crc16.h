@@ -31,8 +31,8 @@
 #define CRC16_H
 
 #include <cstdint>
+#include <cstddef>
 #include <vector>
-#include <map>
 
 namespace BidCoS
 {
@@ -40,13 +40,31 @@ namespace BidCoS
 class CRC16
 {
 public:
-	CRC16();
+	CRC16() {}
 	virtual ~CRC16() {}
-	uint16_t calculate(const std::vector<char>& data, bool ignoreLastTwoBytes = false);
-	uint16_t calculate(const std::vector<uint8_t>& data, bool ignoreLastTwoBytes = false);
+
+	/**
+	 * Calculates the CRC16 (polynomial 0x8005) used by the HM-LGW and the HM-MOD-RPI-PCB. Buffers are processed four bytes at a time (slicing-by-4).
+	 *
+	 * @param data The data to calculate the checksum for.
+	 * @param size The number of bytes.
+	 * @param crc The start value. Pass the result of a previous call to continue the calculation over non-contiguous buffers.
+	 * @return Returns the checksum.
+	 */
+	static uint16_t calculate(const uint8_t* data, size_t size, uint16_t crc = 0xd77f);
+	static uint16_t calculate(const std::vector<char>& data, bool ignoreLastTwoBytes = false);
+	static uint16_t calculate(const std::vector<uint8_t>& data, bool ignoreLastTwoBytes = false);
 private:
-	std::map<uint16_t, uint16_t> _crcTable;
-	void initCRCTable();
+	class Tables
+	{
+	public:
+		Tables();
+
+		//tables[0] is the classic byte-wise table, tables[n] contains the CRC of a byte followed by n zero bytes
+		uint16_t tables[4][256];
+	};
+
+	static const Tables& getTables();
 };
 
 }
@@ -49,6 +49,10 @@ Cul::Cul(std::shared_ptr<BaseLib::Systems::PhysicalInterfaceSettings> settings)
 	}
 
 	memset(&_termios, 0, sizeof(termios));
+	_pollCalls = 0;
+	_readCalls = 0;
+	_bytesRead = 0;
+	_packetsReceived = 0;
 }
 
 Cul::~Cul()
@@ -183,6 +187,7 @@ void Cul::openDevice()
 		//system(chmod.c_str());
 
 		_firstPacket = true;
+		_readBufferSize = 0;
 
 		_fileDescriptor = _bl->fileDescriptorManager.add(open(_settings->device.c_str(), O_RDWR | O_NOCTTY));
 		if(_fileDescriptor->descriptor == -1)
@@ -273,78 +278,140 @@ void Cul::setupDevice()
     }
 }
 
-std::string Cul::readFromDevice()
+void Cul::readFromDevice()
 {
 	try
 	{
-		if(_stopped) return "";
 		if(_fileDescriptor->descriptor == -1)
 		{
 			_out.printCritical("Couldn't read from CUL device, because the file descriptor is not valid: " + _settings->device + ". Trying to reopen...");
 			closeDevice();
 			std::this_thread::sleep_for(std::chrono::milliseconds(5000));
 			openDevice();
-			if(!isOpen()) return "";
+			if(!isOpen()) return;
 			if(_updateMode) writeToDevice("X21\nAR\n");
 			else writeToDevice("X21\nAr\n");
 		}
-		std::string packet;
-		int32_t i;
-		char localBuffer[1] = "";
-		fd_set readFileDescriptor;
-		FD_ZERO(&readFileDescriptor);
-		FD_SET(_fileDescriptor->descriptor, &readFileDescriptor);
-
-		while((!_stopCallbackThread && localBuffer[0] != '\n' && _fileDescriptor->descriptor > -1))
+
+		pollfd pollInfo;
+		pollInfo.fd = _fileDescriptor->descriptor;
+		pollInfo.events = POLLIN;
+		pollInfo.revents = 0;
+		int32_t result = poll(&pollInfo, 1, 500);
+		_pollCalls++;
+		if(result == 0) return; //Timeout
+		else if(result == -1)
 		{
-			FD_ZERO(&readFileDescriptor);
-			FD_SET(_fileDescriptor->descriptor, &readFileDescriptor);
-			//Timeout needs to be set every time, so don't put it outside of the while loop
-			timeval timeout;
-			timeout.tv_sec = 0;
-			timeout.tv_usec = 500000;
-			i = select(_fileDescriptor->descriptor + 1, &readFileDescriptor, NULL, NULL, &timeout);
-			switch(i)
-			{
-				case 0: //Timeout
-					if(!_stopCallbackThread) continue;
-					else return "";
-				case -1:
-					_out.printError("Error reading from CUL device: " + _settings->device);
-					return "";
-				case 1:
-					break;
-				default:
-					_out.printError("Error reading from CUL device: " + _settings->device);
-					return "";
-			}
+			if(errno == EINTR) return;
+			_out.printError("Error reading from CUL device: " + _settings->device);
+			return;
+		}
+		if(pollInfo.revents & (POLLERR | POLLHUP | POLLNVAL))
+		{
+			_out.printError("CUL was disconnected.");
+			closeDevice();
+			return;
+		}
 
-			i = read(_fileDescriptor->descriptor, localBuffer, 1);
-			if(i == -1)
-			{
-				if(errno == EAGAIN) continue;
-				_out.printError("Error reading from CUL device: " + _settings->device);
-				return "";
-			}
-			packet.push_back(localBuffer[0]);
-			if(packet.size() > 200)
+		result = read(_fileDescriptor->descriptor, _readBuffer.data() + _readBufferSize, _readBuffer.size() - _readBufferSize);
+		_readCalls++;
+		if(result == -1)
+		{
+			if(errno == EAGAIN || errno == EINTR) return;
+			_out.printError("Error reading from CUL device: " + _settings->device);
+			return;
+		}
+		else if(result == 0)
+		{
+			_out.printError("CUL was disconnected.");
+			closeDevice();
+			return;
+		}
+		_bytesRead += result;
+		_readBufferSize += result;
+
+		uint32_t lineStart = 0;
+		for(uint32_t i = _readBufferSize - result; i < _readBufferSize; i++)
+		{
+			if(_readBuffer[i] != '\n') continue;
+			processLine(_readBuffer.data() + lineStart, i + 1 - lineStart);
+			lineStart = i + 1;
+		}
+		if(lineStart > 0)
+		{
+			_readBufferSize -= lineStart;
+			if(_readBufferSize > 0) memmove(_readBuffer.data(), _readBuffer.data() + lineStart, _readBufferSize);
+		}
+		if(_readBufferSize > 200)
+		{
+			_out.printError("CUL was disconnected.");
+			closeDevice();
+			_readBufferSize = 0;
+		}
+	}
+	catch(const std::exception& ex)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(BaseLib::Exception& ex)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+}
+
+void Cul::processLine(const char* line, uint32_t size)
+{
+	try
+	{
+		while(size > 0 && (line[size - 1] == '\n' || line[size - 1] == '\r')) size--;
+		if(size >= 21) //21 is minimal packet length (=10 bytes + CUL "A")
+		{
+			_packetsReceived++;
+			std::shared_ptr<BidCoSPacket> packet(new BidCoSPacket());
+			packet->setTimeReceived(BaseLib::HelperFunctions::getTime());
+			if(packet->import(line, size, line[0] == 'A')) processReceivedPacket(packet);
+		}
+		else if(size > 0)
+		{
+			if(size >= 4 && strncmp(line, "LOVF", 4) == 0) _out.printWarning("Warning: CUL with id " + _settings->id + " reached 1% limit. You need to wait, before sending is allowed again.");
+			else if(size == 1 && line[0] == 'A') return;
+			else
 			{
-				_out.printError("CUL was disconnected.");
-				closeDevice();
-				return "";
+				if(_firstPacket) _firstPacket = false;
+				else // E. g.: A0686ECDDBBBBBAC4 (No idea where these short packets come from in my office)
+				{
+					_out.printInfo("Info: Ignoring too small packet: " + std::string(line, size));
+				}
 			}
 		}
-		return packet;
 	}
 	catch(const std::exception& ex)
     {
         _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
     }
+    catch(BaseLib::Exception& ex)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
     catch(...)
     {
         _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
     }
-	return "";
+}
+
+IBidCoSInterface::ReadStatistics Cul::getReadStatistics()
+{
+	ReadStatistics statistics;
+	statistics.enabled = true;
+	statistics.pollCalls = _pollCalls;
+	statistics.readCalls = _readCalls;
+	statistics.bytesRead = _bytesRead;
+	statistics.packetsReceived = _packetsReceived;
+	return statistics;
 }
 
 void Cul::writeToDevice(std::string data)
@@ -466,34 +533,7 @@ void Cul::listen()
         		if(_stopCallbackThread) return;
         		continue;
         	}
-        	std::string packetHex = readFromDevice();
-        	if(packetHex.size() > 200)
-			{
-        		if(_firstPacket) _firstPacket = false;
-				else
-				{
-					_out.printError("Error: Too large packet received. Assuming CUL error. I'm closing and reopening device: " + packetHex);
-					closeDevice();
-        		}
-			}
-        	else if(packetHex.size() >= 21) //21 is minimal packet length (=10 bytes + CUL "A")
-        	{
-        		std::shared_ptr<BidCoSPacket> packet(new BidCoSPacket(packetHex, BaseLib::HelperFunctions::getTime()));
-				processReceivedPacket(packet);
-        	}
-        	else if(!packetHex.empty())
-        	{
-        		if(packetHex.compare(0, 4, "LOVF") == 0) _out.printWarning("Warning: CUL with id " + _settings->id + " reached 1% limit. You need to wait, before sending is allowed again.");
-        		else if(packetHex == "A") continue;
-        		else
-        		{
-        			if(_firstPacket) _firstPacket = false;
-        			else if(packetHex.size() < 21) // E. g.: A0686ECDDBBBBBAC4 (No idea where these short packets come from in my office)
-        			{
-                        _out.printInfo("Info: Ignoring too small packet: " + packetHex);
-        			}
-        		}
-        	}
+        	readFromDevice();
         }
     }
     catch(const std::exception& ex)
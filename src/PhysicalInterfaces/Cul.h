@@ -41,8 +41,11 @@
 #include <chrono>
 #include <ctime>
 #include <iomanip>
+#include <array>
+#include <atomic>
 
 #include <unistd.h>
+#include <poll.h>
 #include <fcntl.h>
 #include <termios.h>
 #include <signal.h>
@@ -64,15 +67,27 @@ class Cul : public IBidCoSInterface
         virtual void setup(int32_t userID, int32_t groupID, bool setPermissions);
         void enableUpdateMode();
         void disableUpdateMode();
+        virtual ReadStatistics getReadStatistics();
     protected:
         bool _firstPacket = true;
         struct termios _termios;
 
+        /**
+         * Everything available is read at once. Complete lines are passed to processLine() directly from this buffer, the rest is moved to the front.
+         */
+        std::array<char, 2048> _readBuffer;
+        uint32_t _readBufferSize = 0;
+        std::atomic<uint64_t> _pollCalls;
+        std::atomic<uint64_t> _readCalls;
+        std::atomic<uint64_t> _bytesRead;
+        std::atomic<uint64_t> _packetsReceived;
+
         void openDevice();
         void closeDevice();
         void setupDevice();
         void writeToDevice(std::string);
-        std::string readFromDevice();
+        void readFromDevice();
+        void processLine(const char* line, uint32_t size);
         void listen();
         void forceSendPacket(std::shared_ptr<BidCoSPacket> packet);
 };
@@ -357,8 +357,9 @@ void Cunx::processData(std::vector<uint8_t>& data)
 		{
 			if(packetHex.size() > 21) //21 is minimal packet length (=10 Byte + CUNX "A" + "\n")
         	{
-				std::shared_ptr<BidCoSPacket> packet(new BidCoSPacket(packetHex, BaseLib::HelperFunctions::getTime()));
-				processReceivedPacket(packet);
+				std::shared_ptr<BidCoSPacket> packet(new BidCoSPacket());
+				packet->setTimeReceived(BaseLib::HelperFunctions::getTime());
+				if(packet->import(packetHex, packetHex.front() == 'A')) processReceivedPacket(packet);
         	}
         	else if(!packetHex.empty())
         	{
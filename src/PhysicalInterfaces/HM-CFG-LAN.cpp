@@ -278,6 +278,7 @@ void HM_CFG_LAN::sendPacket(std::shared_ptr<BaseLib::Systems::Packet> packet)
 			else _out.printWarning(std::string("Warning: !!!Not!!! sending packet, because device is not connected or opened: ") + bidCoSPacket->hexString());
 			return;
 		}
+		addCommandLatency(bidCoSPacket);
 
 		int64_t currentTimeMilliseconds = BaseLib::HelperFunctions::getTime();
 		uint32_t currentTime = currentTimeMilliseconds & 0xFFFFFFFF;
@@ -285,6 +286,7 @@ void HM_CFG_LAN::sendPacket(std::shared_ptr<BaseLib::Systems::Packet> packet)
 		if(_bl->debugLevel >= 4) _out.printInfo("Info: Sending (" + _settings->id + "): " + packetString);
 		std::string hexString = "S" + BaseLib::HelperFunctions::getHexString(currentTime, 8) + ",00,00000000,01," + BaseLib::HelperFunctions::getHexString(currentTimeMilliseconds - _startUpTime, 8) + "," + packetString.substr(2) + "\r\n";
 		send(hexString, false);
+		addAirtime(bidCoSPacket);
 		_lastPacketSent = BaseLib::HelperFunctions::getTime();
 	}
 	catch(const std::exception& ex)
@@ -371,6 +373,7 @@ void HM_CFG_LAN::startListening()
 			return;
 		}
 		if(_useAES) aesInit();
+		_receiveBuffer.clear();
 		_socket = std::unique_ptr<BaseLib::TcpSocket>(new BaseLib::TcpSocket(_bl, _settings->host, _settings->port, _settings->ssl, _settings->caFile, _settings->verifyCertificate));
 		_socket->setReadTimeout(5000000);
 		_socket->setWriteTimeout(5000000);
@@ -381,6 +384,7 @@ void HM_CFG_LAN::startListening()
 		if(_settings->listenThreadPriority > -1) GD::bl->threadManager.start(_listenThread, true, _settings->listenThreadPriority, _settings->listenThreadPolicy, &HM_CFG_LAN::listen, this);
 		else GD::bl->threadManager.start(_listenThread, true, &HM_CFG_LAN::listen, this);
 		IPhysicalInterface::startListening();
+		startDispatching();
 	}
     catch(const std::exception& ex)
     {
@@ -414,6 +418,7 @@ void HM_CFG_LAN::reconnectThread()
 			return;
 		}
 		if(_useAES) aesInit();
+		_receiveBuffer.clear();
 		createInitCommandQueue();
 		_out.printDebug("Debug: Connecting to HM-CFG-LAN with hostname " + _settings->host + " on port " + _settings->port + "...");
 		_socket->open();
@@ -477,6 +482,7 @@ void HM_CFG_LAN::stopListening()
 		if(_useAES) aesCleanup();
 		_sendMutex.unlock(); //In case it is deadlocked - shouldn't happen of course
 		IPhysicalInterface::stopListening();
+		stopDispatching();
 	}
 	catch(const std::exception& ex)
     {
@@ -651,18 +657,17 @@ std::vector<char> HM_CFG_LAN::encrypt(std::vector<char>& data)
 	return encryptedData;
 }
 
-std::vector<uint8_t> HM_CFG_LAN::decrypt(std::vector<uint8_t>& data)
+bool HM_CFG_LAN::decrypt(std::vector<uint8_t>& data, char* decryptedData)
 {
-	std::vector<uint8_t> decryptedData(data.size());
-	if(!_decryptHandle) return decryptedData;
+	if(!_decryptHandle) return false;
 	gcry_error_t result;
-	if((result = gcry_cipher_decrypt(_decryptHandle, &decryptedData.at(0), data.size(), &data.at(0), data.size())) != GPG_ERR_NO_ERROR)
+	if((result = gcry_cipher_decrypt(_decryptHandle, decryptedData, data.size(), &data.at(0), data.size())) != GPG_ERR_NO_ERROR)
 	{
 		GD::out.printError("Error decrypting data: " + BaseLib::Security::Gcrypt::getError(result));
 		reconnect();
-		return std::vector<uint8_t>();
+		return false;
 	}
-	return decryptedData;
+	return true;
 }
 
 void HM_CFG_LAN::sendKeepAlive()
@@ -944,7 +949,6 @@ void HM_CFG_LAN::processData(std::vector<uint8_t>& data)
 	try
 	{
 		if(data.empty()) return;
-		std::string packets;
 		if(_useAES)
 		{
 			if(!_aesExchangeComplete)
@@ -952,17 +956,31 @@ void HM_CFG_LAN::processData(std::vector<uint8_t>& data)
 				aesKeyExchange(data);
 				return;
 			}
-			std::vector<uint8_t> decryptedData = decrypt(data);
-			if(decryptedData.empty()) return;
-			packets.insert(packets.end(), decryptedData.begin(), decryptedData.end());
+			size_t offset = _receiveBuffer.size();
+			_receiveBuffer.resize(offset + data.size());
+			if(!decrypt(data, &_receiveBuffer.at(offset)))
+			{
+				_receiveBuffer.clear();
+				return;
+			}
 		}
-		else packets.insert(packets.end(), data.begin(), data.end());
+		else _receiveBuffer.insert(_receiveBuffer.end(), data.begin(), data.end());
 
-		std::istringstream stringStream(packets);
-		std::string packet;
-		while(std::getline(stringStream, packet))
+		const char* buffer = _receiveBuffer.data();
+		uint32_t lineStart = 0;
+		for(uint32_t i = 0; i < _receiveBuffer.size(); i++)
 		{
-			if(_initCommandQueue.empty()) parsePacket(packet); else processInit(packet);
+			if(buffer[i] != '\n') continue;
+			uint32_t lineEnd = i;
+			if(lineEnd > lineStart && buffer[lineEnd - 1] == '\r') lineEnd--;
+			if(_initCommandQueue.empty()) parsePacket(buffer + lineStart, lineEnd - lineStart); else processInit(buffer + lineStart, lineEnd - lineStart);
+			lineStart = i + 1;
+		}
+		if(lineStart > 0) _receiveBuffer.erase(_receiveBuffer.begin(), _receiveBuffer.begin() + lineStart);
+		if(_receiveBuffer.size() > 1000000)
+		{
+			_out.printError("Could not read from HM-CFG-LAN: Too much data without line break.");
+			_receiveBuffer.clear();
 		}
 	}
     catch(const std::exception& ex)
@@ -979,24 +997,62 @@ void HM_CFG_LAN::processData(std::vector<uint8_t>& data)
     }
 }
 
-void HM_CFG_LAN::processInit(std::string& packet)
+uint32_t HM_CFG_LAN::splitFields(const char* packet, uint32_t size, std::array<std::pair<const char*, uint32_t>, 8>& fields)
+{
+	uint32_t fieldCount = 0;
+	uint32_t fieldStart = 0;
+	for(uint32_t i = 0; i <= size; i++)
+	{
+		if(i < size && packet[i] != ',') continue;
+		if(fieldCount < fields.size()) fields[fieldCount] = std::pair<const char*, uint32_t>(packet + fieldStart, i - fieldStart);
+		fieldCount++;
+		fieldStart = i + 1;
+	}
+	return fieldCount;
+}
+
+int64_t HM_CFG_LAN::getHexNumber(const char* data, uint32_t size)
+{
+	uint32_t i = 0;
+	while(i < size && std::isspace(data[i])) i++;
+	bool negative = false;
+	if(i < size && (data[i] == '-' || data[i] == '+'))
+	{
+		negative = data[i] == '-';
+		i++;
+	}
+	if(i + 1 < size && data[i] == '0' && (data[i + 1] == 'x' || data[i + 1] == 'X')) i += 2;
+	int64_t number = 0;
+	for(; i < size; i++)
+	{
+		char c = data[i];
+		if(c >= '0' && c <= '9') number = (number << 4) | (c - '0');
+		else if(c >= 'A' && c <= 'F') number = (number << 4) | (c - 'A' + 10);
+		else if(c >= 'a' && c <= 'f') number = (number << 4) | (c - 'a' + 10);
+		else break;
+	}
+	return negative ? -number : number;
+}
+
+void HM_CFG_LAN::processInit(const char* packet, uint32_t size)
 {
-	if(_initCommandQueue.empty() || packet.length() < 10) return;
+	if(_initCommandQueue.empty() || size < 9) return;
 	if(_initCommandQueue.front().at(0) == 'A') //No init packet has been sent yet
 	{
-		std::vector<std::string> parts = BaseLib::HelperFunctions::splitAll(packet, ',');
-		if(parts.size() < 7 || (parts.at(0) != "HHM-LAN-IF" && parts.at(0) != "HHM-USB-IF"))
+		std::array<std::pair<const char*, uint32_t>, 8> fields;
+		uint32_t fieldCount = splitFields(packet, size, fields);
+		if(fieldCount < 7 || fields[0].second != 10 || (strncmp(fields[0].first, "HHM-LAN-IF", 10) != 0 && strncmp(fields[0].first, "HHM-USB-IF", 10) != 0))
 		{
-			_out.printError("Error: First packet from HM-CFG-LAN does not start with \"HHM-LAN-IF\", \"HHM-USB-IF\" or has wrong structure. Please check your AES key in homematicbidcos.conf. Stopping listening. Packet was: " + packet);
+			_out.printError("Error: First packet from HM-CFG-LAN does not start with \"HHM-LAN-IF\", \"HHM-USB-IF\" or has wrong structure. Please check your AES key in homematicbidcos.conf. Stopping listening. Packet was: " + std::string(packet, size));
 			reconnect();
 			return;
 		}
-		_startUpTime = BaseLib::HelperFunctions::getTime() - (int64_t)BaseLib::Math::getNumber(parts.at(5), true);
+		_startUpTime = BaseLib::HelperFunctions::getTime() - getHexNumber(fields[5].first, fields[5].second);
 		send(_initCommandQueue.front(), false);
 		_initCommandQueue.pop_front();
 		send(_initCommandQueue.front(), false);
 	}
-	else if((_initCommandQueue.front().at(0) == 'C' || _initCommandQueue.front().at(0) == 'Y') && packet.at(0) == 'I')
+	else if((_initCommandQueue.front().at(0) == 'C' || _initCommandQueue.front().at(0) == 'Y') && packet[0] == 'I')
 	{
 		_initCommandQueue.pop_front();
 		send(_initCommandQueue.front(), false);
@@ -1014,14 +1070,15 @@ void HM_CFG_LAN::processInit(std::string& packet)
 	}
 }
 
-void HM_CFG_LAN::parsePacket(std::string& packet)
+void HM_CFG_LAN::parsePacket(const char* packet, uint32_t size)
 {
 	try
 	{
-		if(packet.empty()) return;
-		if(_bl->debugLevel >= 5) _out.printDebug(std::string("Debug: Packet received from HM-CFG-LAN") + (_useAES ? + " (encrypted)" : "") + ": " + packet);
-		std::vector<std::string> parts = BaseLib::HelperFunctions::splitAll(packet, ',');
-		if(packet.at(0) == 'H' && parts.size() >= 7)
+		if(size == 0) return;
+		if(_bl->debugLevel >= 5) _out.printDebug(std::string("Debug: Packet received from HM-CFG-LAN") + (_useAES ? + " (encrypted)" : "") + ": " + std::string(packet, size));
+		std::array<std::pair<const char*, uint32_t>, 8> fields;
+		uint32_t fieldCount = splitFields(packet, size, fields);
+		if(packet[0] == 'H' && fieldCount >= 7)
 		{
 			/*
 			Index	Meaning
@@ -1035,13 +1092,13 @@ void HM_CFG_LAN::parsePacket(std::string& packet)
 			*/
 
 			_lastKeepAliveResponse = BaseLib::HelperFunctions::getTimeSeconds();
-			_startUpTime = BaseLib::HelperFunctions::getTime() - (int64_t)BaseLib::Math::getNumber(parts.at(5), true);
+			_startUpTime = BaseLib::HelperFunctions::getTime() - getHexNumber(fields[5].first, fields[5].second);
 		}
-		else if(packet.at(0) == 'E' || packet.at(0) == 'R')
+		else if(packet[0] == 'E' || packet[0] == 'R')
 		{
-			if(parts.size() < 6)
+			if(fieldCount < 6)
 			{
-				_out.printWarning("Warning: Invalid packet received from HM-CFG-LAN: " + packet);
+				_out.printWarning("Warning: Invalid packet received from HM-CFG-LAN: " + std::string(packet, size));
 				return;
 			}
 			/*
@@ -1053,7 +1110,7 @@ void HM_CFG_LAN::parsePacket(std::string& packet)
 			4		BidCoS packet
 			*/
 
-			int32_t tempNumber = BaseLib::Math::getNumber(parts.at(1), true);
+			int32_t tempNumber = getHexNumber(fields[1].first, fields[1].second);
 
 			/*
 			00: Not set
@@ -1079,18 +1136,18 @@ void HM_CFG_LAN::parsePacket(std::string& packet)
 			*/
 			uint8_t controlByte = tempNumber & 0xFF;
 
-			if(parts.at(5).size() > 18) //18 is minimal packet length
+			if(fields[5].second >= 18) //18 is minimal packet length
         	{
-				std::vector<uint8_t> binaryPacket({ (uint8_t)(parts.at(5).size() / 2) });
-				_bl->hf.getUBinary(parts.at(5), parts.at(5).size() - 1, binaryPacket);
-				int32_t rssi = BaseLib::Math::getNumber(parts.at(4), true);
+				int32_t rssi = getHexNumber(fields[4].first, fields[4].second);
 				//Convert to TI CC1101 format
 				if(rssi <= -75) rssi = ((rssi + 74) * 2) + 256;
 				else rssi = (rssi + 74) * 2;
-				binaryPacket.push_back(rssi);
 
-				std::shared_ptr<BidCoSPacket> bidCoSPacket(new BidCoSPacket(binaryPacket, true, BaseLib::HelperFunctions::getTime()));
-				if(packet.at(0) == 'E' && (statusByte & 1))
+				//The BidCoS packet is decoded directly from the receive buffer
+				std::shared_ptr<BidCoSPacket> bidCoSPacket(new BidCoSPacket());
+				bidCoSPacket->setTimeReceived(BaseLib::HelperFunctions::getTime());
+				if(!bidCoSPacket->importWithoutLengthByte(fields[5].first, fields[5].second, (uint8_t)rssi)) return;
+				if(packet[0] == 'E' && (statusByte & 1))
 				{
 					_out.printDebug("Debug: Waiting for AES handshake.");
 					_lastPacketReceived = BaseLib::HelperFunctions::getTime();
@@ -1103,11 +1160,12 @@ void HM_CFG_LAN::parsePacket(std::string& packet)
 					_out.printWarning("Warning: AES handshake was not successful: " + bidCoSPacket->hexString());
 					return;
 				}
-				if(packet.at(0) == 'R')
+				if(packet[0] == 'R')
 				{
 					if(controlByte & 8)
 					{
 						_out.printWarning("Info: No response to packet after 3 tries: " + bidCoSPacket->hexString());
+						addAirtime(bidCoSPacket, 2);
 						return;
 					}
 					else if(controlByte & 2)
@@ -1133,11 +1191,11 @@ void HM_CFG_LAN::parsePacket(std::string& packet)
 				}
 				// }}}
 
-				raisePacketReceived(bidCoSPacket);
+				dispatchPacket(bidCoSPacket);
         	}
-        	else if(!parts.at(5).empty()) _out.printInfo("Info: Ignoring too small packet: " + parts.at(5));
+        	else if(fields[5].second > 0) _out.printInfo("Info: Ignoring too small packet: " + std::string(fields[5].first, fields[5].second));
 		}
-		else _out.printInfo("Info: Packet received: " + packet);
+		else _out.printInfo("Info: Packet received: " + std::string(packet, size));
 	}
     catch(const std::exception& ex)
     {
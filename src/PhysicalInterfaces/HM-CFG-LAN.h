@@ -42,6 +42,7 @@
 #include <chrono>
 #include <ctime>
 #include <iomanip>
+#include <array>
 
 #include <unistd.h>
 #include <fcntl.h>
@@ -71,6 +72,19 @@ class HM_CFG_LAN  : public IBidCoSInterface
         virtual void removePeer(int32_t address);
         virtual void sendPeers();
         virtual std::string getPeerInfoPacket(PeerInfo& peerInfo);
+
+        /**
+         * Splits a line at the commas without copying it.
+         *
+         * @param fields Is filled with pointer and size of the first fields. The pointers point into "packet".
+         * @return Returns the total number of fields, which can be larger than the size of "fields".
+         */
+        static uint32_t splitFields(const char* packet, uint32_t size, std::array<std::pair<const char*, uint32_t>, 8>& fields);
+
+        /**
+         * Parses a hexadecimal number like BaseLib::Math::getNumber(std::string, true) does, but without creating a string.
+         */
+        static int64_t getHexNumber(const char* data, uint32_t size);
     protected:
         std::string _port;
         std::unique_ptr<BaseLib::TcpSocket> _socket;
@@ -88,6 +102,11 @@ class HM_CFG_LAN  : public IBidCoSInterface
         std::mutex _listenMutex;
         std::atomic_bool _reconnecting;
 
+        /**
+         * Received (and decrypted) data. Lines are parsed directly from this buffer. Only an incomplete line at the end is kept for the next read.
+         */
+        std::vector<char> _receiveBuffer;
+
         //AES stuff
         bool _aesInitialized = false;
         bool _aesExchangeComplete = false;
@@ -99,7 +118,7 @@ class HM_CFG_LAN  : public IBidCoSInterface
         gcry_cipher_hd_t _decryptHandle = nullptr;
 
         std::vector<char> encrypt(std::vector<char>& data);
-        std::vector<uint8_t> decrypt(std::vector<uint8_t>& data);
+        bool decrypt(std::vector<uint8_t>& data, char* decryptedData);
         bool aesKeyExchange(std::vector<uint8_t>& data);
         bool aesInit();
         void aesCleanup();
@@ -109,8 +128,9 @@ class HM_CFG_LAN  : public IBidCoSInterface
         void reconnectThread();
         void createInitCommandQueue();
         void processData(std::vector<uint8_t>& data);
-        void processInit(std::string& packet);
-        void parsePacket(std::string& packet);
+        void processInit(const char* packet, uint32_t size);
+        void parsePacket(const char* packet, uint32_t size);
+
         void send(std::string hexString, bool raw = false);
         void send(std::vector<char>& data, bool raw);
         void sendKeepAlive();
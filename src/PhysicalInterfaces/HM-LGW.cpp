@@ -38,6 +38,7 @@ HM_LGW::HM_LGW(std::shared_ptr<BaseLib::Systems::PhysicalInterfaceSettings> sett
 	_out.setPrefix(_out.getPrefix() + "HM-LGW \"" + settings->id + "\": ");
 
 	_initCompleteKeepAlive = false;
+	_peerTableEnabled = true;
 	_socket = std::unique_ptr<BaseLib::TcpSocket>(new BaseLib::TcpSocket(_bl));
 	_socketKeepAlive = std::unique_ptr<BaseLib::TcpSocket>(new BaseLib::TcpSocket(_bl));
 
@@ -48,6 +49,9 @@ HM_LGW::HM_LGW(std::shared_ptr<BaseLib::Systems::PhysicalInterfaceSettings> sett
 	}
 
 	if(settings->lanKey.empty()) _out.printInfo("Info: No security key specified in homematicbidcos.conf.");
+
+	int32_t maxOutstandingRequests = GD::settings ? GD::settings->getNumber("hmlgwmaxoutstandingrequests") : 0;
+	if(maxOutstandingRequests > 0) _maxOutstandingRequests = maxOutstandingRequests > 64 ? 64 : maxOutstandingRequests;
 }
 
 HM_LGW::~HM_LGW()
@@ -83,11 +87,8 @@ void HM_LGW::enableUpdateMode()
 		for(int32_t j = 0; j < 40; j++)
 		{
 			std::vector<uint8_t> responsePacket;
-			std::vector<char> requestPacket;
 			std::vector<char> payload{ 0, 6 };
-			buildPacket(requestPacket, payload);
-			_packetIndex++;
-			getResponse(requestPacket, responsePacket, _packetIndex - 1, 0, 4);
+			getResponse(payload, responsePacket, 0, 4);
 			if(responsePacket.size() >= 9  && responsePacket.at(6) == 1)
 			{
 				break;
@@ -107,13 +108,10 @@ void HM_LGW::enableUpdateMode()
 		for(int32_t j = 0; j < 40; j++)
 		{
 			std::vector<uint8_t> responsePacket;
-			std::vector<char> requestPacket;
 			std::vector<char> payload{ 0, 7 };
 			payload.push_back(0xE9);
 			payload.push_back(0xCA);
-			buildPacket(requestPacket, payload);
-			_packetIndex++;
-			getResponse(requestPacket, responsePacket, _packetIndex - 1, 0, 4);
+			getResponse(payload, responsePacket, 0, 4);
 			if(responsePacket.size() >= 9  && responsePacket.at(6) == 1)
 			{
 				_out.printInfo("Info: Update mode enabled.");
@@ -154,11 +152,8 @@ void HM_LGW::disableUpdateMode()
 		/*for(int32_t j = 0; j < 40; j++)
 		{
 			std::vector<uint8_t> responsePacket;
-			std::vector<char> requestPacket;
 			std::vector<char> payload{ 0, 6 };
-			buildPacket(requestPacket, payload);
-			_packetIndex++;
-			getResponse(requestPacket, responsePacket, _packetIndex - 1, 0, 4);
+			getResponse(payload, responsePacket, 0, 4);
 			if(responsePacket.size() >= 9  && responsePacket.at(6) == 1)
 			{
 				_out.printInfo("Info: Update mode disabled.");
@@ -234,12 +229,15 @@ void HM_LGW::addPeers(std::vector<PeerInfo>& peerInfos)
 	try
 	{
 		_peersMutex.lock();
+		std::vector<PeerInfo*> peersToSend;
+		peersToSend.reserve(peerInfos.size());
 		for(std::vector<PeerInfo>::iterator i = peerInfos.begin(); i != peerInfos.end(); ++i)
 		{
 			if(i->address == 0) continue;
 			_peers[i->address] = *i;
-			if(_initComplete) sendPeer(*i);
+			if(_initComplete) peersToSend.push_back(&(*i));
 		}
+		if(!peersToSend.empty()) sendPeers(peersToSend);
 	}
     catch(const std::exception& ex)
     {
@@ -266,95 +264,28 @@ void HM_LGW::processQueueEntry(int32_t index, int64_t id, std::shared_ptr<BaseLi
 		if(!_initComplete) return;
 		if(queueEntry->type == AddPeerQueueEntryType::remove)
 		{
-			for(int32_t i = 0; i < 40; i++)
+			std::vector<char> payload{ 1, 7 };
+			payload.push_back(queueEntry->address >> 16);
+			payload.push_back((queueEntry->address >> 8) & 0xFF);
+			payload.push_back(queueEntry->address & 0xFF);
+			if(!sendPeerRequest(payload, 13, 7))
 			{
-				std::vector<uint8_t> responsePacket;
-				std::vector<char> requestPacket;
-				std::vector<char> payload{ 1, 7 };
-				payload.push_back(queueEntry->address >> 16);
-				payload.push_back((queueEntry->address >> 8) & 0xFF);
-				payload.push_back(queueEntry->address & 0xFF);
-				buildPacket(requestPacket, payload);
-				_packetIndex++;
-				getResponse(requestPacket, responsePacket, _packetIndex - 1, 1, 4);
-				if(responsePacket.size() >= 13  && responsePacket.at(6) == 7) break;
-				else if(responsePacket.size() == 9 && responsePacket.at(6) == 8)
-				{
-					//Operation pending
-					std::this_thread::sleep_for(std::chrono::milliseconds(50));
-					continue;
-				}
-				if(i == 2)
-				{
-					_out.printError("Error: Could not remove peer with address 0x" + _bl->hf.getHexString(queueEntry->address, 6));
-					_peersMutex.unlock();
-					return;
-				}
-			}
-		}
-		else if(queueEntry->type == AddPeerQueueEntryType::wakeUp)
-		{
-			for(int32_t j = 0; j < 40; j++)
-			{
-				std::vector<uint8_t> responsePacket;
-				std::vector<char> requestPacket;
-				std::vector<char> payload{ 1, 6 };
-				payload.push_back(queueEntry->peerInfo.address >> 16);
-				payload.push_back((queueEntry->peerInfo.address >> 8) & 0xFF);
-				payload.push_back(queueEntry->peerInfo.address & 0xFF);
-				payload.push_back(queueEntry->peerInfo.keyIndex);
-				payload.push_back(queueEntry->peerInfo.wakeUp ? 1 : 0); //CCU2 sets this for wake up, too. No idea, what the meaning is.
-				payload.push_back(0);
-				buildPacket(requestPacket, payload);
-				_packetIndex++;
-				getResponse(requestPacket, responsePacket, _packetIndex - 1, 1, 4);
-				if(responsePacket.size() >= 21  && responsePacket.at(6) == 7) break;
-				else if(responsePacket.size() == 9 && responsePacket.at(6) == 8)
-				{
-					//Operation pending
-					std::this_thread::sleep_for(std::chrono::milliseconds(50));
-					continue;
-				}
-				if(j == 2)
-				{
-					_out.printError("Error: Could not add peer with address 0x" + _bl->hf.getHexString(queueEntry->peerInfo.address, 6));
-					return;
-				}
+				_out.printError("Error: Could not remove peer with address 0x" + _bl->hf.getHexString(queueEntry->address, 6));
+				return;
 			}
+			removePeerTableEntry(queueEntry->address);
 		}
-		else if(queueEntry->type == AddPeerQueueEntryType::aes)
+		else
 		{
-			if(queueEntry->peerInfo.aesChannels.find(queueEntry->channel) == queueEntry->peerInfo.aesChannels.end()) return;
-			for(int32_t j = 0; j < 40; j++)
-			{
-				std::vector<uint8_t> responsePacket;
-				std::vector<char> requestPacket;
-				std::vector<char> payload{ 1 };
-				if(queueEntry->peerInfo.aesChannels.at(queueEntry->channel)) payload.push_back(9);
-				else payload.push_back(0xA);
-				payload.push_back(queueEntry->peerInfo.address >> 16);
-				payload.push_back((queueEntry->peerInfo.address >> 8) & 0xFF);
-				payload.push_back(queueEntry->peerInfo.address & 0xFF);
-				payload.push_back(0);
-				payload.push_back(queueEntry->channel);
-				buildPacket(requestPacket, payload);
-				_packetIndex++;
-				getResponse(requestPacket, responsePacket, _packetIndex - 1, 1, 4);
-				if(responsePacket.size() >= 9  && responsePacket.at(6) == 1) break;
-				else if(responsePacket.size() == 9 && responsePacket.at(6) == 8)
-				{
-					//Operation pending
-					std::this_thread::sleep_for(std::chrono::milliseconds(50));
-					continue;
-				}
-				if(j == 2)
-				{
-					_out.printError("Error: Could not set AES for peer with address 0x" + _bl->hf.getHexString(queueEntry->peerInfo.address, 6));
-					return;
-				}
-			}
+			//All changes of the peer are sent at once, so entries queued for the same peer afterwards don't send anything.
+			PeerInfo peerInfo;
+			_peersMutex.lock();
+			std::map<int32_t, PeerInfo>::iterator peerIterator = _peers.find(queueEntry->peerInfo.address);
+			bool peerExists = peerIterator != _peers.end();
+			if(peerExists) peerInfo = peerIterator->second;
+			_peersMutex.unlock();
+			if(peerExists) syncPeer(peerInfo);
 		}
-		else sendPeer(queueEntry->peerInfo);
 	}
     catch(const std::exception& ex)
     {
@@ -375,12 +306,19 @@ void HM_LGW::sendPeers()
 	try
 	{
 		_peersMutex.lock();
+		int64_t startTime = BaseLib::HelperFunctions::getTime();
+		uint64_t peersUnchanged = _peerTablePeersUnchanged;
+		uint64_t requests = _peerTableRequests;
+		std::vector<PeerInfo*> peersToSend;
+		peersToSend.reserve(_peers.size());
 		for(std::map<int32_t, PeerInfo>::iterator i = _peers.begin(); i != _peers.end(); ++i)
 		{
-			sendPeer(i->second);
+			peersToSend.push_back(&i->second);
 		}
+		sendPeers(peersToSend);
 		_initComplete = true; //Init complete is set here within _peersMutex, so there is no conflict with addPeer() and peers are not sent twice
-		_out.printInfo("Info: Peer sending completed.");
+		peersUnchanged = _peerTablePeersUnchanged - peersUnchanged;
+		_out.printInfo("Info: Peer sending completed. Sent " + std::to_string(peersToSend.size() - peersUnchanged) + " of " + std::to_string(peersToSend.size()) + " peers with " + std::to_string(_peerTableRequests - requests) + " requests in " + std::to_string(BaseLib::HelperFunctions::getTime() - startTime) + " ms. The other peers were unchanged.");
 	}
     catch(const std::exception& ex)
     {
@@ -401,6 +339,71 @@ void HM_LGW::sendPeers()
 	t1.detach();*/
 }
 
+void HM_LGW::sendPeers(std::vector<PeerInfo*>& peerInfos)
+{
+	try
+	{
+		//Each thread sends one peer at a time. The requests of one peer depend on each other, so they can't be pipelined.
+		uint32_t threadCount = _maxOutstandingRequests;
+		if(threadCount > peerInfos.size()) threadCount = peerInfos.size();
+		std::atomic<uint32_t> nextPeer(0);
+		std::vector<std::thread> threads(threadCount > 1 ? threadCount - 1 : 0);
+		for(std::vector<std::thread>::iterator i = threads.begin(); i != threads.end(); ++i)
+		{
+			try
+			{
+				GD::bl->threadManager.start(*i, false, &HM_LGW::sendPeersThread, this, &peerInfos, &nextPeer);
+			}
+			catch(const std::exception& ex)
+			{
+				_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+			}
+		}
+		//The current thread sends peers, too. If a thread couldn't be started, the others send its peers.
+		sendPeersThread(&peerInfos, &nextPeer);
+		for(std::vector<std::thread>::iterator i = threads.begin(); i != threads.end(); ++i)
+		{
+			GD::bl->threadManager.join(*i);
+		}
+	}
+    catch(const std::exception& ex)
+    {
+    	_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(BaseLib::Exception& ex)
+    {
+    	_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+    	_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+}
+
+void HM_LGW::sendPeersThread(std::vector<PeerInfo*>* peerInfos, std::atomic<uint32_t>* nextPeer)
+{
+	try
+	{
+		for(uint32_t i = (*nextPeer)++; i < peerInfos->size(); i = (*nextPeer)++)
+		{
+			if(_stopped) return;
+			syncPeer(*peerInfos->at(i));
+		}
+	}
+    catch(const std::exception& ex)
+    {
+    	_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(BaseLib::Exception& ex)
+    {
+    	_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+    	_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+}
+
 void HM_LGW::dutyCycleTest(int32_t destinationAddress)
 {
 	for(int32_t i = 0; i < 1000000; i++)
@@ -412,206 +415,199 @@ void HM_LGW::dutyCycleTest(int32_t destinationAddress)
     }
 }
 
-void HM_LGW::sendPeer(PeerInfo& peerInfo)
+bool HM_LGW::sendPeerRequest(const std::vector<char>& payload, uint32_t responseSize, uint8_t responseType)
+{
+	for(int32_t i = 0; i < 40; i++)
+	{
+		std::vector<uint8_t> responsePacket;
+		_peerTableRequests++;
+		getResponse(payload, responsePacket, 1, 4);
+		if(responsePacket.size() >= responseSize && responsePacket.at(6) == responseType) return true;
+		else if(responsePacket.size() == 9 && responsePacket.at(6) == 8)
+		{
+			//Operation pending
+			std::this_thread::sleep_for(std::chrono::milliseconds(50));
+			continue;
+		}
+		if(i == 2) return false;
+	}
+	return false;
+}
+
+bool HM_LGW::syncPeer(PeerInfo& peerInfo)
 {
 	try
 	{
-		if(GD::bl->debugLevel > 4) _out.printDebug("Debug: Sending peer to LGW \"" + _settings->id + "\": Address " + GD::bl->hf.getHexString(peerInfo.address, 6) + ", AES enabled " + std::to_string(peerInfo.aesEnabled) + ", AES map " + GD::bl->hf.getHexString(peerInfo.getAESChannelMap()) + ".");
-		for(int32_t i = 0; i < 2; i++) //The CCU sends this packet two or even more times, I don't know why
+		PeerInfo gatewayPeerInfo;
+		if(!getPeerTableEntry(peerInfo.address, gatewayPeerInfo)) return sendPeer(peerInfo);
+
+		std::vector<char> enabledChannels;
+		std::vector<char> disabledChannels;
+		peerInfo.getAESChannelDifferences(gatewayPeerInfo, enabledChannels, disabledChannels);
+		if(peerInfo.keyIndex == gatewayPeerInfo.keyIndex && peerInfo.wakeUp == gatewayPeerInfo.wakeUp && enabledChannels.empty() && disabledChannels.empty())
 		{
-			//Get current config
-			for(int32_t j = 0; j < 40; j++)
-			{
-				std::vector<uint8_t> responsePacket;
-				std::vector<char> requestPacket;
-				std::vector<char> payload{ 1, 6 };
-				payload.push_back(peerInfo.address >> 16);
-				payload.push_back((peerInfo.address >> 8) & 0xFF);
-				payload.push_back(peerInfo.address & 0xFF);
-				payload.push_back(0);
-				payload.push_back(0);
-				payload.push_back(0);
-				buildPacket(requestPacket, payload);
-				_packetIndex++;
-				getResponse(requestPacket, responsePacket, _packetIndex - 1, 1, 4);
-				if(responsePacket.size() >= 21  && responsePacket.at(6) == 7) break;
-				else if(responsePacket.size() == 9 && responsePacket.at(6) == 8)
-				{
-					//Operation pending
-					std::this_thread::sleep_for(std::chrono::milliseconds(50));
-					continue;
-				}
-				if(j == 2)
-				{
-					_out.printError("Error: Could not add peer with address 0x" + _bl->hf.getHexString(peerInfo.address, 6));
-					return;
-				}
-			}
+			_peerTablePeersUnchanged++;
+			return true;
 		}
+		if(GD::bl->debugLevel > 4) _out.printDebug("Debug: Updating peer on LGW \"" + _settings->id + "\": Address " + GD::bl->hf.getHexString(peerInfo.address, 6) + ", AES map " + GD::bl->hf.getHexString(peerInfo.getAESChannelMap()) + ".");
 
-		//Reset all channels
-		for(int32_t j = 0; j < 40; j++)
+		if(peerInfo.keyIndex != gatewayPeerInfo.keyIndex || peerInfo.wakeUp != gatewayPeerInfo.wakeUp)
 		{
-			std::vector<uint8_t> responsePacket;
-			std::vector<char> requestPacket;
-			std::vector<char> payload{ 1, 0xA };
+			std::vector<char> payload{ 1, 6 };
 			payload.push_back(peerInfo.address >> 16);
 			payload.push_back((peerInfo.address >> 8) & 0xFF);
 			payload.push_back(peerInfo.address & 0xFF);
+			payload.push_back(peerInfo.keyIndex);
+			payload.push_back(peerInfo.wakeUp ? 1 : 0); //CCU2 sets this for wake up, too. No idea, what the meaning is.
 			payload.push_back(0);
-
-			for(std::map<int32_t, bool>::iterator k = peerInfo.aesChannels.begin(); k != peerInfo.aesChannels.end(); ++k)
-			{
-				payload.push_back(k->first);
-			}
-			buildPacket(requestPacket, payload);
-			_packetIndex++;
-			getResponse(requestPacket, responsePacket, _packetIndex - 1, 1, 4);
-			if(responsePacket.size() >= 9  && responsePacket.at(6) == 1) break;
-			else if(responsePacket.size() == 9 && responsePacket.at(6) == 8)
-			{
-				//Operation pending
-				std::this_thread::sleep_for(std::chrono::milliseconds(50));
-				continue;
-			}
-			if(j == 2)
+			if(!sendPeerRequest(payload, 21, 7))
 			{
 				_out.printError("Error: Could not add peer with address 0x" + _bl->hf.getHexString(peerInfo.address, 6));
-				return;
+				return false;
 			}
 		}
 
-		//Get current config again
-		for(int32_t j = 0; j < 40; j++)
+		//All changed channels are set with one request
+		for(int32_t i = 0; i < 2; i++)
 		{
-			std::vector<uint8_t> responsePacket;
-			std::vector<char> requestPacket;
-			std::vector<char> payload{ 1, 6 };
+			std::vector<char>& channels = (i == 0) ? enabledChannels : disabledChannels;
+			if(channels.empty()) continue;
+			std::vector<char> payload{ 1, (char)(i == 0 ? 9 : 0xA) };
 			payload.push_back(peerInfo.address >> 16);
 			payload.push_back((peerInfo.address >> 8) & 0xFF);
 			payload.push_back(peerInfo.address & 0xFF);
 			payload.push_back(0);
-			payload.push_back(0);
-			payload.push_back(0);
-			buildPacket(requestPacket, payload);
-			_packetIndex++;
-			getResponse(requestPacket, responsePacket, _packetIndex - 1, 1, 4);
-			if(responsePacket.size() >= 21  && responsePacket.at(6) == 7) break;
-			else if(responsePacket.size() == 9 && responsePacket.at(6) == 8)
+			payload.insert(payload.end(), channels.begin(), channels.end());
+			if(!sendPeerRequest(payload, 9, 1))
 			{
-				//Operation pending
-				std::this_thread::sleep_for(std::chrono::milliseconds(50));
-				continue;
+				_out.printError("Error: Could not set AES for peer with address 0x" + _bl->hf.getHexString(peerInfo.address, 6));
+				return false;
 			}
-			if(j == 2)
+		}
+
+		setPeerTableEntry(peerInfo);
+		_peerTablePeersUpdated++;
+		return true;
+	}
+    catch(const std::exception& ex)
+    {
+    	_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(BaseLib::Exception& ex)
+    {
+    	_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+    	_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+    return false;
+}
+
+bool HM_LGW::sendPeer(PeerInfo& peerInfo)
+{
+	try
+	{
+		if(GD::bl->debugLevel > 4) _out.printDebug("Debug: Sending peer to LGW \"" + _settings->id + "\": Address " + GD::bl->hf.getHexString(peerInfo.address, 6) + ", AES enabled " + std::to_string(peerInfo.aesEnabled) + ", AES map " + GD::bl->hf.getHexString(peerInfo.getAESChannelMap()) + ".");
+		std::vector<char> address{ (char)(peerInfo.address >> 16), (char)((peerInfo.address >> 8) & 0xFF), (char)(peerInfo.address & 0xFF) };
+
+		//Get current config
+		std::vector<char> getConfigPayload{ 1, 6 };
+		getConfigPayload.insert(getConfigPayload.end(), address.begin(), address.end());
+		getConfigPayload.push_back(0);
+		getConfigPayload.push_back(0);
+		getConfigPayload.push_back(0);
+		for(int32_t i = 0; i < 2; i++) //The CCU sends this packet two or even more times, I don't know why
+		{
+			if(!sendPeerRequest(getConfigPayload, 21, 7))
 			{
 				_out.printError("Error: Could not add peer with address 0x" + _bl->hf.getHexString(peerInfo.address, 6));
-				return;
+				return false;
 			}
 		}
 
+		//Reset all channels
+		std::vector<char> payload{ 1, 0xA };
+		payload.insert(payload.end(), address.begin(), address.end());
+		payload.push_back(0);
+		for(std::map<int32_t, bool>::iterator k = peerInfo.aesChannels.begin(); k != peerInfo.aesChannels.end(); ++k)
+		{
+			payload.push_back(k->first);
+		}
+		if(!sendPeerRequest(payload, 9, 1))
+		{
+			_out.printError("Error: Could not add peer with address 0x" + _bl->hf.getHexString(peerInfo.address, 6));
+			return false;
+		}
+
+		//Get current config again
+		if(!sendPeerRequest(getConfigPayload, 21, 7))
+		{
+			_out.printError("Error: Could not add peer with address 0x" + _bl->hf.getHexString(peerInfo.address, 6));
+			return false;
+		}
+
 		if(peerInfo.wakeUp)
 		{
 			//Enable sending of wake up packet or just request config again?
-			for(int32_t j = 0; j < 40; j++)
+			payload = std::vector<char>{ 1, 6 };
+			payload.insert(payload.end(), address.begin(), address.end());
+			payload.push_back(0);
+			payload.push_back(1);
+			payload.push_back(0);
+			if(!sendPeerRequest(payload, 21, 7))
 			{
-				std::vector<uint8_t> responsePacket;
-				std::vector<char> requestPacket;
-				std::vector<char> payload{ 1, 6 };
-				payload.push_back(peerInfo.address >> 16);
-				payload.push_back((peerInfo.address >> 8) & 0xFF);
-				payload.push_back(peerInfo.address & 0xFF);
-				payload.push_back(0);
-				payload.push_back(1);
-				payload.push_back(0);
-				buildPacket(requestPacket, payload);
-				_packetIndex++;
-				getResponse(requestPacket, responsePacket, _packetIndex - 1, 1, 4);
-				if(responsePacket.size() >= 21  && responsePacket.at(6) == 7) break;
-				else if(responsePacket.size() == 9 && responsePacket.at(6) == 8)
-				{
-					//Operation pending
-					std::this_thread::sleep_for(std::chrono::milliseconds(50));
-					continue;
-				}
-				if(j == 2)
-				{
-					_out.printError("Error: Could not add peer with address 0x" + _bl->hf.getHexString(peerInfo.address, 6));
-					return;
-				}
+				_out.printError("Error: Could not add peer with address 0x" + _bl->hf.getHexString(peerInfo.address, 6));
+				return false;
 			}
 		}
 
 		//Set key index and enable sending of wake up packet.
-		for(int32_t j = 0; j < 40; j++)
+		payload = std::vector<char>{ 1, 6 };
+		payload.insert(payload.end(), address.begin(), address.end());
+		payload.push_back(peerInfo.keyIndex);
+		payload.push_back(peerInfo.wakeUp ? 1 : 0);
+		payload.push_back(0);
+		if(!sendPeerRequest(payload, 21, 7))
 		{
-			std::vector<uint8_t> responsePacket;
-			std::vector<char> requestPacket;
-			std::vector<char> payload{ 1, 6 };
-			payload.push_back(peerInfo.address >> 16);
-			payload.push_back((peerInfo.address >> 8) & 0xFF);
-			payload.push_back(peerInfo.address & 0xFF);
-			payload.push_back(peerInfo.keyIndex);
-			payload.push_back(peerInfo.wakeUp ? 1 : 0);
+			_out.printError("Error: Could not add peer with address 0x" + _bl->hf.getHexString(peerInfo.address, 6));
+			return false;
+		}
+
+		//Enable AES
+		if(peerInfo.aesEnabled)
+		{
+			payload = std::vector<char>{ 1, 9 };
+			payload.insert(payload.end(), address.begin(), address.end());
 			payload.push_back(0);
-			buildPacket(requestPacket, payload);
-			_packetIndex++;
-			getResponse(requestPacket, responsePacket, _packetIndex - 1, 1, 4);
-			if(responsePacket.size() >= 21  && responsePacket.at(6) == 7) break;
-			else if(responsePacket.size() == 9 && responsePacket.at(6) == 8)
+			bool aesEnabled = false;
+			for(std::map<int32_t, bool>::iterator k = peerInfo.aesChannels.begin(); k != peerInfo.aesChannels.end(); ++k)
 			{
-				//Operation pending
-				std::this_thread::sleep_for(std::chrono::milliseconds(50));
-				continue;
+				if(k->second)
+				{
+					aesEnabled = true;
+					payload.push_back(k->first);
+				}
 			}
-			if(j == 2)
+			if(aesEnabled && !sendPeerRequest(payload, 9, 1))
 			{
 				_out.printError("Error: Could not add peer with address 0x" + _bl->hf.getHexString(peerInfo.address, 6));
-				return;
+				return false;
 			}
 		}
 
-		//Enable AES
-		if(peerInfo.aesEnabled)
+		PeerInfo gatewayPeerInfo = peerInfo;
+		//Channels with AES enabled are only sent when AES is enabled for the peer.
+		if(!peerInfo.aesEnabled)
 		{
-			//Delete old configuration
-			for(int32_t j = 0; j < 40; j++)
+			for(std::map<int32_t, bool>::iterator k = gatewayPeerInfo.aesChannels.begin(); k != gatewayPeerInfo.aesChannels.end(); ++k)
 			{
-				std::vector<uint8_t> responsePacket;
-				std::vector<char> requestPacket;
-				std::vector<char> payload{ 1, 9 };
-				payload.push_back(peerInfo.address >> 16);
-				payload.push_back((peerInfo.address >> 8) & 0xFF);
-				payload.push_back(peerInfo.address & 0xFF);
-				payload.push_back(0);
-
-				bool aesEnabled = false;
-				for(std::map<int32_t, bool>::iterator k = peerInfo.aesChannels.begin(); k != peerInfo.aesChannels.end(); ++k)
-				{
-					if(k->second)
-					{
-						aesEnabled = true;
-						payload.push_back(k->first);
-					}
-				}
-				if(!aesEnabled) break;
-				buildPacket(requestPacket, payload);
-				_packetIndex++;
-				getResponse(requestPacket, responsePacket, _packetIndex - 1, 1, 4);
-				if(responsePacket.size() >= 9  && responsePacket.at(6) == 1) break;
-				else if(responsePacket.size() == 9 && responsePacket.at(6) == 8)
-				{
-					//Operation pending
-					std::this_thread::sleep_for(std::chrono::milliseconds(50));
-					continue;
-				}
-				if(j == 2)
-				{
-					_out.printError("Error: Could not add peer with address 0x" + _bl->hf.getHexString(peerInfo.address, 6));
-					return;
-				}
+				k->second = false;
 			}
 		}
+		setPeerTableEntry(gatewayPeerInfo);
+		_peerTablePeersAdded++;
+		return true;
 	}
     catch(const std::exception& ex)
     {
@@ -625,6 +621,7 @@ void HM_LGW::sendPeer(PeerInfo& peerInfo)
     {
     	_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
     }
+    return false;
 }
 
 void HM_LGW::setAES(PeerInfo peerInfo, int32_t channel)
@@ -803,14 +800,17 @@ void HM_LGW::sendPacket(std::shared_ptr<BaseLib::Systems::Packet> packet)
 			else _out.printWarning(std::string("Warning: !!!Not!!! sending packet, because device is not connected or opened: ") + bidCoSPacket->hexString());
 			return;
 		}
+		addCommandLatency(bidCoSPacket);
 
 		std::vector<char> packetBytes = bidCoSPacket->byteArraySigned();
 		if(_bl->debugLevel >= 4) _out.printInfo("Info: Sending (" + _settings->id + "): " + _bl->hf.getHexString(packetBytes));
+		addAirtime(bidCoSPacket);
 
+		//Only one radio packet is in flight at a time, so packets are sent in order. Other requests are not blocked.
+		std::lock_guard<std::mutex> sendPacketGuard(_sendPacketMutex);
 		for(int32_t j = 0; j < 40; j++)
 		{
 			std::vector<uint8_t> responsePacket;
-			std::vector<char> requestPacket;
 			std::vector<char> payload;
 			payload.reserve(5 + packetBytes.size() - 1);
 			payload.push_back(1);
@@ -819,9 +819,7 @@ void HM_LGW::sendPacket(std::shared_ptr<BaseLib::Systems::Packet> packet)
 			payload.push_back(0);
 			if(!_settings->sendFix) payload.push_back((bidCoSPacket->controlByte() & 0x10) ? 1 : 0);
 			payload.insert(payload.end(), packetBytes.begin() + 1, packetBytes.end());
-			buildPacket(requestPacket, payload);
-			_packetIndex++;
-			getResponse(requestPacket, responsePacket, _packetIndex - 1, 1, 4);
+			getResponse(payload, responsePacket, 1, 4);
 			if(responsePacket.size() == 9  && responsePacket.at(6) == 8)
 			{
 				std::this_thread::sleep_for(std::chrono::milliseconds(50));
@@ -864,6 +862,7 @@ void HM_LGW::sendPacket(std::shared_ptr<BaseLib::Systems::Packet> packet)
 				//NACK is sometimes also returned when the AES handshake wasn't successful (i. e.
 				//the handshake after sending a wake up packet)
 				_out.printInfo("Info: No answer to packet " + _bl->hf.getHexString(packetBytes));
+				addAirtime(bidCoSPacket, 2);
 				return;
 			}
 			if(j == 2)
@@ -894,38 +893,136 @@ void HM_LGW::getResponse(const std::vector<char>& packet, std::vector<uint8_t>&
 	try
     {
 		if(packet.size() < 8 || _stopped) return;
-		std::lock_guard<std::mutex> getResponseGuard(_getResponseMutex);
 		std::shared_ptr<Request> request(new Request(responseControlByte, responseType));
-		_requestsMutex.lock();
-		_requests[messageCounter] = request;
-		_requestsMutex.unlock();
-		std::unique_lock<std::mutex> lock(request->mutex);
+		request->messageCounter = messageCounter;
+		request->deadline = BaseLib::HelperFunctions::getTime() + 10000;
+		request->packet = packet;
+		{
+			std::unique_lock<std::mutex> requestsGuard(_requestsMutex);
+			if(!_requestsConditionVariable.wait_for(requestsGuard, std::chrono::milliseconds(10000), [&] { return _requests.find(messageCounter) == _requests.end() || _stopped; }))
+			{
+				//Overwriting the request in flight would pass its response to this request.
+				_out.printError("Error: Message counter 0x" + BaseLib::HelperFunctions::getHexString(messageCounter, 2) + " is still in use by another request. Not sending packet: " + _bl->hf.getHexString(packet));
+				return;
+			}
+			if(_stopped) return;
+			_requests[messageCounter] = request;
+		}
 		send(packet, false);
-		if(!request->conditionVariable.wait_for(lock, std::chrono::milliseconds(10000), [&] { return request->mutexReady; }))
+		waitForResponse(request, response);
+	}
+	catch(const std::exception& ex)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(BaseLib::Exception& ex)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+}
+
+void HM_LGW::getResponse(const std::vector<char>& payload, std::vector<uint8_t>& response, uint8_t responseControlByte, uint8_t responseType)
+{
+	try
+    {
+		response.clear();
+		std::shared_ptr<Request> request = sendRequest(payload, responseControlByte, responseType);
+		if(request) waitForResponse(request, response);
+	}
+	catch(const std::exception& ex)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(BaseLib::Exception& ex)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+}
+
+std::shared_ptr<HM_LGW::Request> HM_LGW::sendRequest(const std::vector<char>& payload, uint8_t responseControlByte, uint8_t responseType)
+{
+	try
+    {
+		if(payload.empty() || _stopped) return std::shared_ptr<Request>();
+		std::shared_ptr<Request> request(new Request(responseControlByte, responseType));
 		{
-			_out.printError("Error: No response received to packet: " + _bl->hf.getHexString(packet));
+			std::unique_lock<std::mutex> requestsGuard(_requestsMutex);
+			if(!_requestsConditionVariable.wait_for(requestsGuard, std::chrono::milliseconds(10000), [&] { return _requests.size() < _maxOutstandingRequests || _stopped; }))
+			{
+				_out.printError("Error: Too many requests in flight. Not sending packet with payload: " + _bl->hf.getHexString(payload));
+				return std::shared_ptr<Request>();
+			}
+			if(_stopped) return std::shared_ptr<Request>();
+			//Message counters of requests in flight can't be reused. There are at most _maxOutstandingRequests of them, so this terminates quickly.
+			while(_requests.find(_packetIndex) != _requests.end()) _packetIndex++;
+			request->messageCounter = _packetIndex;
+			buildPacket(request->packet, payload);
+			_packetIndex++;
+			request->deadline = BaseLib::HelperFunctions::getTime() + 10000;
+			_requests[request->messageCounter] = request;
 		}
-		response = request->response;
+		send(request->packet, false);
+		return request;
+	}
+	catch(const std::exception& ex)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(BaseLib::Exception& ex)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+    return std::shared_ptr<Request>();
+}
 
-		_requestsMutex.lock();
-		_requests.erase(messageCounter);
-		_requestsMutex.unlock();
+bool HM_LGW::waitForResponse(std::shared_ptr<Request>& request, std::vector<uint8_t>& response)
+{
+	bool responseReceived = false;
+	try
+    {
+		{
+			std::unique_lock<std::mutex> lock(request->mutex);
+			int64_t timeToDeadline = request->deadline - BaseLib::HelperFunctions::getTime();
+			if(timeToDeadline < 0) timeToDeadline = 0;
+			responseReceived = request->conditionVariable.wait_for(lock, std::chrono::milliseconds(timeToDeadline), [&] { return request->mutexReady; });
+			if(responseReceived) response = request->response;
+			else response.clear();
+		}
+		if(!responseReceived) _out.printError("Error: No response received to packet: " + _bl->hf.getHexString(request->packet));
+
+		{
+			std::lock_guard<std::mutex> requestsGuard(_requestsMutex);
+			std::map<uint8_t, std::shared_ptr<Request>>::iterator requestIterator = _requests.find(request->messageCounter);
+			//The request might already be replaced after a reconnect
+			if(requestIterator != _requests.end() && requestIterator->second == request) _requests.erase(requestIterator);
+		}
+		_requestsConditionVariable.notify_all();
 	}
 	catch(const std::exception& ex)
     {
         _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
-        _requestsMutex.unlock();
     }
     catch(BaseLib::Exception& ex)
     {
         _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
-        _requestsMutex.unlock();
     }
     catch(...)
     {
         _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
-        _requestsMutex.unlock();
     }
+    return responseReceived;
 }
 
 void HM_LGW::send(std::string hexString, bool raw)
@@ -956,7 +1053,6 @@ void HM_LGW::send(const std::vector<char>& data, bool raw)
     {
     	if(data.size() < 3) return; //Otherwise error in printInfo
     	std::vector<char> encryptedData;
-    	if(!raw) encryptedData = _settings->lanKey.empty() ? data : encrypt(data);
     	_sendMutex.lock();
     	if(!_socket->connected() || _stopped)
     	{
@@ -964,6 +1060,8 @@ void HM_LGW::send(const std::vector<char>& data, bool raw)
     		_sendMutex.unlock();
     		return;
     	}
+    	//Encrypt within _sendMutex. The cipher is a stream, so packets need to be encrypted in sending order.
+    	if(!raw) encryptedData = _settings->lanKey.empty() ? data : encrypt(data);
     	if(_bl->debugLevel >= 5)
         {
             _out.printDebug("Debug: Sending (Port " + _settings->port + "): " + _bl->hf.getHexString(data));
@@ -1181,6 +1279,9 @@ void HM_LGW::doInit()
 			}
 		}
 
+		//The coprocessor was restarted and doesn't know any peers.
+		if(cpuBLPacket) clearPeerTable();
+
 		//3rd packet - Get firmware version
 		if(_stopped) return;
 		responsePacket.clear();
@@ -1238,6 +1339,13 @@ void HM_LGW::doInit()
 		{
 			std::string serialNumber((char*)responsePacket.data() + 7, 10);
 			_out.printInfo("Info: Serial number: " + serialNumber);
+			if(serialNumber != _serialNumber) clearPeerTable();
+			_serialNumber = serialNumber;
+		}
+		else
+		{
+			clearPeerTable();
+			_serialNumber.clear();
 		}
 
 		//6th packet - Set time
@@ -1405,6 +1513,7 @@ void HM_LGW::startListening()
 		else GD::bl->threadManager.start(_initThread, true, &HM_LGW::doInit, this);
 		startQueue(0, 0, SCHED_OTHER);
 		IPhysicalInterface::startListening();
+		startDispatching();
 	}
     catch(const std::exception& ex)
     {
@@ -1431,6 +1540,7 @@ void HM_LGW::reconnect()
 		_requestsMutex.lock();
 		_requests.clear();
 		_requestsMutex.unlock();
+		_requestsConditionVariable.notify_all();
 		_initStarted = false;
 		_initComplete = false;
 		_initCompleteKeepAlive = false;
@@ -1480,11 +1590,13 @@ void HM_LGW::stopListening()
 		_requestsMutex.lock();
 		_requests.clear();
 		_requestsMutex.unlock();
+		_requestsConditionVariable.notify_all();
 		_initStarted = false;
 		_initComplete = false;
 		_initCompleteKeepAlive = false;
 		_firstPacket = true;
 		IPhysicalInterface::stopListening();
+		stopDispatching();
 	}
 	catch(const std::exception& ex)
     {
@@ -1772,7 +1884,6 @@ void HM_LGW::sendTimePacket()
 {
 	try
     {
-		std::lock_guard<std::mutex> getResponseGuard(_getResponseMutex);
 		const auto timePoint = std::chrono::system_clock::now();
 		time_t t = std::chrono::system_clock::to_time_t(timePoint);
 		std::tm localTime;
@@ -1785,8 +1896,12 @@ void HM_LGW::sendTimePacket()
 		payload.push_back(time & 0xFF);
 		payload.push_back(localTime.tm_gmtoff / 1800);
 		std::vector<char> packet;
-		buildPacket(packet, payload);
-		_packetIndex++;
+		{
+			std::lock_guard<std::mutex> requestsGuard(_requestsMutex);
+			while(_requests.find(_packetIndex) != _requests.end()) _packetIndex++;
+			buildPacket(packet, payload);
+			_packetIndex++;
+		}
 		send(packet, false);
 		_lastTimePacket = BaseLib::HelperFunctions::getTimeSeconds();
 	}
@@ -2263,18 +2378,19 @@ void HM_LGW::buildPacket(std::vector<char>& packet, const std::vector<char>& pay
 {
 	try
 	{
-		std::vector<char> unescapedPacket;
-		unescapedPacket.push_back(0xFD);
+		packet.clear();
+		if(payload.empty()) return;
 		int32_t size = payload.size() + 1; //Payload size plus message counter size - control byte
-		unescapedPacket.push_back(size >> 8);
-		unescapedPacket.push_back(size & 0xFF);
-		unescapedPacket.push_back(payload.at(0));
-		unescapedPacket.push_back(_packetIndex);
-		unescapedPacket.insert(unescapedPacket.end(), payload.begin() + 1, payload.end());
-		uint16_t crc = _crc.calculate(unescapedPacket);
-		unescapedPacket.push_back(crc >> 8);
-		unescapedPacket.push_back(crc & 0xFF);
-		escapePacket(unescapedPacket, packet);
+		char header[5] = { (char)0xFD, (char)(size >> 8), (char)(size & 0xFF), payload[0], (char)_packetIndex };
+		//Checksum and escaping are done in place, so no unescaped copy of the packet is needed
+		uint16_t crc = CRC16::calculate((const uint8_t*)header, sizeof(header));
+		crc = CRC16::calculate((const uint8_t*)payload.data() + 1, payload.size() - 1, crc);
+		char crcBytes[2] = { (char)(crc >> 8), (char)(crc & 0xFF) };
+		packet.reserve((payload.size() + 6) * 2);
+		packet.push_back(header[0]);
+		escapePacket(header + 1, sizeof(header) - 1, packet);
+		escapePacket(payload.data() + 1, payload.size() - 1, packet);
+		escapePacket(crcBytes, sizeof(crcBytes), packet);
 	}
     catch(const std::exception& ex)
     {
@@ -2290,21 +2406,18 @@ void HM_LGW::buildPacket(std::vector<char>& packet, const std::vector<char>& pay
     }
 }
 
-void HM_LGW::escapePacket(const std::vector<char>& unescapedPacket, std::vector<char>& escapedPacket)
+void HM_LGW::escapePacket(const char* data, uint32_t size, std::vector<char>& escapedPacket)
 {
 	try
 	{
-		escapedPacket.clear();
-		if(unescapedPacket.empty()) return;
-		escapedPacket.push_back(unescapedPacket[0]);
-		for(uint32_t i = 1; i < unescapedPacket.size(); i++)
+		for(uint32_t i = 0; i < size; i++)
 		{
-			if(unescapedPacket[i] == (char)0xFC || unescapedPacket[i] == (char)0xFD)
+			if(data[i] == (char)0xFC || data[i] == (char)0xFD)
 			{
 				escapedPacket.push_back(0xFC);
-				escapedPacket.push_back(unescapedPacket[i] & (char)0x7F);
+				escapedPacket.push_back(data[i] & (char)0x7F);
 			}
-			else escapedPacket.push_back(unescapedPacket[i]);
+			else escapedPacket.push_back(data[i]);
 		}
 	}
 	catch(const std::exception& ex)
@@ -2327,7 +2440,7 @@ void HM_LGW::processPacket(std::vector<uint8_t>& packet)
 	{
 		_out.printDebug(std::string("Debug: Packet received from HM-LGW on port " + _settings->port + ": " + _bl->hf.getHexString(packet)));
 		if(packet.size() < 8) return;
-		uint16_t crc = _crc.calculate(packet, true);
+		uint16_t crc = CRC16::calculate(packet.data(), packet.size() - 2);
 		if((packet.at(packet.size() - 2) != (crc >> 8) || packet.at(packet.size() - 1) != (crc & 0xFF)))
 		{
 			if(_firstPacket)
@@ -2615,7 +2728,7 @@ void HM_LGW::parsePacket(std::vector<uint8_t>& packet)
 			}
 			// }}}
 
-			raisePacketReceived(bidCoSPacket);
+			dispatchPacket(bidCoSPacket);
 			if(wakeUp) //Wake up was sent
 			{
 				_out.printInfo("Info: Detected wake-up packet.");
@@ -2624,7 +2737,7 @@ void HM_LGW::parsePacket(std::vector<uint8_t>& packet)
 				std::shared_ptr<BidCoSPacket> ok(new BidCoSPacket(bidCoSPacket->messageCounter(), 0x80, 0x02, bidCoSPacket->senderAddress(), _myAddress, payload));
 				ok->setTimeReceived(bidCoSPacket->timeReceived() + 1);
 				std::this_thread::sleep_for(std::chrono::milliseconds(30));
-				raisePacketReceived(ok);
+				dispatchPacket(ok);
 			}
 		}
 		else _out.printInfo("Info: Packet received: " + BaseLib::HelperFunctions::getHexString(packet));
@@ -41,6 +41,7 @@
 #include <list>
 #include <mutex>
 #include <condition_variable>
+#include <atomic>
 #include <chrono>
 #include <ctime>
 #include <iomanip>
@@ -104,6 +105,9 @@ class HM_LGW  : public IBidCoSInterface
         	std::condition_variable conditionVariable;
         	bool mutexReady = false;
         	std::vector<uint8_t> response;
+        	uint8_t messageCounter = 0;
+        	int64_t deadline = 0;
+        	std::vector<char> packet;
         	uint8_t getResponseControlByte() { return _responseControlByte; }
         	uint8_t getResponseType() { return _responseType; }
 
@@ -120,12 +124,18 @@ class HM_LGW  : public IBidCoSInterface
         std::string _port;
         std::unique_ptr<BaseLib::TcpSocket> _socket;
         std::unique_ptr<BaseLib::TcpSocket> _socketKeepAlive;
-        std::mutex _getResponseMutex;
+        std::mutex _sendPacketMutex;
         std::mutex _requestsMutex;
+        std::condition_variable _requestsConditionVariable;
+        /**
+         * The requests in flight by message counter. The size is limited by _maxOutstandingRequests.
+         */
         std::map<uint8_t, std::shared_ptr<Request>> _requests;
+        uint32_t _maxOutstandingRequests = 1;
         std::mutex _sendMutex;
         std::mutex _sendMutexKeepAlive;
         bool _initStarted = false;
+        std::string _serialNumber; //Used to detect if the peer table is still valid after reconnecting
         bool _firstPacket = true;
         std::atomic_bool _initCompleteKeepAlive;
         int32_t _lastKeepAlive1 = 0;
@@ -140,7 +150,6 @@ class HM_LGW  : public IBidCoSInterface
         std::vector<uint8_t> _packetBuffer;
         uint8_t _packetIndex = 0;
         uint8_t _packetIndexKeepAlive = 0;
-        CRC16 _crc;
 
         //AES stuff
         bool _aesInitialized = false;
@@ -169,7 +178,29 @@ class HM_LGW  : public IBidCoSInterface
         void reconnect();
         void doInit();
         void sendPeers();
-        void sendPeer(PeerInfo& peerInfo);
+
+        /**
+         * Sends peers to the gateway. Up to _maxOutstandingRequests peers are sent at the same time.
+         */
+        void sendPeers(std::vector<PeerInfo*>& peerInfos);
+        void sendPeersThread(std::vector<PeerInfo*>* peerInfos, std::atomic<uint32_t>* nextPeer);
+
+        /**
+         * Sends a peer to the gateway, which the gateway doesn't know yet.
+         */
+        bool sendPeer(PeerInfo& peerInfo);
+
+        /**
+         * Sends only the settings of the peer which differ from the gateway's peer table. Calls sendPeer() for unknown peers.
+         */
+        bool syncPeer(PeerInfo& peerInfo);
+
+        /**
+         * Sends a request to change the peer table and retries it while the gateway is busy.
+         *
+         * @return Returns false when the gateway didn't respond with a response of the expected type.
+         */
+        bool sendPeerRequest(const std::vector<char>& payload, uint32_t responseSize, uint8_t responseType);
         void processData(std::vector<uint8_t>& data);
         void processDataKeepAlive(std::vector<uint8_t>& data);
         void processPacket(std::vector<uint8_t>& packet);
@@ -177,8 +208,32 @@ class HM_LGW  : public IBidCoSInterface
         void parsePacket(std::vector<uint8_t>& packet);
         void parsePacketKeepAlive(std::string& packet);
         void buildPacket(std::vector<char>& packet, const std::vector<char>& payload);
-        void escapePacket(const std::vector<char>& unescapedPacket, std::vector<char>& escapedPacket);
+        void escapePacket(const char* data, uint32_t size, std::vector<char>& escapedPacket);
         void getResponse(const std::vector<char>& packet, std::vector<uint8_t>& response, uint8_t messageCounter, uint8_t responseControlByte, uint8_t responseType);
+
+        /**
+         * Sends a request using the next free message counter without waiting for the response. Blocks while _maxOutstandingRequests requests are in flight.
+         *
+         * @param payload The unescaped payload starting with the control byte.
+         * @param responseControlByte The control byte of the expected response.
+         * @param responseType The type of the expected response.
+         * @return Returns the request to pass to waitForResponse() or nullptr on errors.
+         */
+        std::shared_ptr<Request> sendRequest(const std::vector<char>& payload, uint8_t responseControlByte, uint8_t responseType);
+
+        /**
+         * Waits until the response to a request is received or the deadline of the request is reached and removes the request from _requests.
+         *
+         * @param request The request returned by sendRequest().
+         * @param[out] response The response or an empty vector on timeout.
+         * @return Returns true when a response was received.
+         */
+        bool waitForResponse(std::shared_ptr<Request>& request, std::vector<uint8_t>& response);
+
+        /**
+         * Shortcut for sendRequest() followed by waitForResponse().
+         */
+        void getResponse(const std::vector<char>& payload, std::vector<uint8_t>& response, uint8_t responseControlByte, uint8_t responseType);
         void send(std::string hexString, bool raw = false);
         void send(const std::vector<char>& data, bool raw);
         void sendKeepAlive(std::vector<char>& data, bool raw);
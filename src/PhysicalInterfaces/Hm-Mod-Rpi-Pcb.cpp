@@ -36,6 +36,7 @@ Hm_Mod_Rpi_Pcb::Hm_Mod_Rpi_Pcb(std::shared_ptr<BaseLib::Systems::PhysicalInterfa
 {
 	_out.init(GD::bl);
 	_out.setPrefix(GD::out.getPrefix() + "HM-MOD-RPI-PCB \"" + settings->id + "\": ");
+	_peerTableEnabled = true;
 
 	if(settings->listenThreadPriority == -1)
 	{
@@ -358,7 +359,7 @@ void Hm_Mod_Rpi_Pcb::addPeers(std::vector<PeerInfo>& peerInfos)
 		{
 			if(i->address == 0) continue;
 			_peers[i->address] = *i;
-			if(_initComplete) sendPeer(*i);
+			if(_initComplete) syncPeer(*i);
 		}
 	}
     catch(const std::exception& ex)
@@ -386,95 +387,28 @@ void Hm_Mod_Rpi_Pcb::processQueueEntry(int32_t index, int64_t id, std::shared_pt
 		if(!_initComplete) return;
 		if(queueEntry->type == AddPeerQueueEntryType::remove)
 		{
-			for(int32_t i = 0; i < 40; i++)
+			std::vector<char> payload{ 1, 7 };
+			payload.push_back(queueEntry->address >> 16);
+			payload.push_back((queueEntry->address >> 8) & 0xFF);
+			payload.push_back(queueEntry->address & 0xFF);
+			if(!sendPeerRequest(payload, 13, 7))
 			{
-				std::vector<uint8_t> responsePacket;
-				std::vector<char> requestPacket;
-				std::vector<char> payload{ 1, 7 };
-				payload.push_back(queueEntry->address >> 16);
-				payload.push_back((queueEntry->address >> 8) & 0xFF);
-				payload.push_back(queueEntry->address & 0xFF);
-				buildPacket(requestPacket, payload);
-				_packetIndex++;
-				getResponse(requestPacket, responsePacket, _packetIndex - 1, 1, 4);
-				if(responsePacket.size() >= 13  && responsePacket.at(6) == 7) break;
-				else if(responsePacket.size() == 9 && responsePacket.at(6) == 8)
-				{
-					//Operation pending
-					std::this_thread::sleep_for(std::chrono::milliseconds(50));
-					continue;
-				}
-				if(i == 2)
-				{
-					_out.printError("Error: Could not remove peer with address 0x" + _bl->hf.getHexString(queueEntry->address, 6));
-					_peersMutex.unlock();
-					return;
-				}
-			}
-		}
-		else if(queueEntry->type == AddPeerQueueEntryType::wakeUp)
-		{
-			for(int32_t j = 0; j < 40; j++)
-			{
-				std::vector<uint8_t> responsePacket;
-				std::vector<char> requestPacket;
-				std::vector<char> payload{ 1, 6 };
-				payload.push_back(queueEntry->peerInfo.address >> 16);
-				payload.push_back((queueEntry->peerInfo.address >> 8) & 0xFF);
-				payload.push_back(queueEntry->peerInfo.address & 0xFF);
-				payload.push_back(queueEntry->peerInfo.keyIndex);
-				payload.push_back(queueEntry->peerInfo.wakeUp ? 1 : 0); //CCU2 sets this for wake up, too. No idea, what the meaning is.
-				payload.push_back(0);
-				buildPacket(requestPacket, payload);
-				_packetIndex++;
-				getResponse(requestPacket, responsePacket, _packetIndex - 1, 1, 4);
-				if(responsePacket.size() >= 21  && responsePacket.at(6) == 7) break;
-				else if(responsePacket.size() == 9 && responsePacket.at(6) == 8)
-				{
-					//Operation pending
-					std::this_thread::sleep_for(std::chrono::milliseconds(50));
-					continue;
-				}
-				if(j == 2)
-				{
-					_out.printError("Error: Could not add peer with address 0x" + _bl->hf.getHexString(queueEntry->peerInfo.address, 6));
-					return;
-				}
+				_out.printError("Error: Could not remove peer with address 0x" + _bl->hf.getHexString(queueEntry->address, 6));
+				return;
 			}
+			removePeerTableEntry(queueEntry->address);
 		}
-		else if(queueEntry->type == AddPeerQueueEntryType::aes)
+		else
 		{
-			if(queueEntry->peerInfo.aesChannels.find(queueEntry->channel) == queueEntry->peerInfo.aesChannels.end()) return;
-			for(int32_t j = 0; j < 40; j++)
-			{
-				std::vector<uint8_t> responsePacket;
-				std::vector<char> requestPacket;
-				std::vector<char> payload{ 1 };
-				if(queueEntry->peerInfo.aesChannels.at(queueEntry->channel)) payload.push_back(9);
-				else payload.push_back(0xA);
-				payload.push_back(queueEntry->peerInfo.address >> 16);
-				payload.push_back((queueEntry->peerInfo.address >> 8) & 0xFF);
-				payload.push_back(queueEntry->peerInfo.address & 0xFF);
-				payload.push_back(0);
-				payload.push_back(queueEntry->channel);
-				buildPacket(requestPacket, payload);
-				_packetIndex++;
-				getResponse(requestPacket, responsePacket, _packetIndex - 1, 1, 4);
-				if(responsePacket.size() >= 9  && responsePacket.at(6) == 1) break;
-				else if(responsePacket.size() == 9 && responsePacket.at(6) == 8)
-				{
-					//Operation pending
-					std::this_thread::sleep_for(std::chrono::milliseconds(50));
-					continue;
-				}
-				if(j == 2)
-				{
-					_out.printError("Error: Could not set AES for peer with address 0x" + _bl->hf.getHexString(queueEntry->peerInfo.address, 6));
-					return;
-				}
-			}
+			//All changes of the peer are sent at once, so entries queued for the same peer afterwards don't send anything.
+			PeerInfo peerInfo;
+			_peersMutex.lock();
+			std::map<int32_t, PeerInfo>::iterator peerIterator = _peers.find(queueEntry->peerInfo.address);
+			bool peerExists = peerIterator != _peers.end();
+			if(peerExists) peerInfo = peerIterator->second;
+			_peersMutex.unlock();
+			if(peerExists) syncPeer(peerInfo);
 		}
-		else sendPeer(queueEntry->peerInfo);
 	}
     catch(const std::exception& ex)
     {
@@ -495,12 +429,14 @@ void Hm_Mod_Rpi_Pcb::sendPeers()
 	try
 	{
 		_peersMutex.lock();
+		int64_t startTime = BaseLib::HelperFunctions::getTime();
+		uint64_t requests = _peerTableRequests;
 		for(std::map<int32_t, PeerInfo>::iterator i = _peers.begin(); i != _peers.end(); ++i)
 		{
-			sendPeer(i->second);
+			syncPeer(i->second);
 		}
 		_initComplete = true; //Init complete is set here within _peersMutex, so there is no conflict with addPeer() and peers are not sent twice
-		_out.printInfo("Info: Peer sending completed.");
+		_out.printInfo("Info: Peer sending completed. Sent " + std::to_string(_peers.size()) + " peers with " + std::to_string(_peerTableRequests - requests) + " requests in " + std::to_string(BaseLib::HelperFunctions::getTime() - startTime) + " ms.");
 	}
     catch(const std::exception& ex)
     {
@@ -521,201 +457,202 @@ void Hm_Mod_Rpi_Pcb::sendPeers()
 	t1.detach();*/
 }
 
-void Hm_Mod_Rpi_Pcb::sendPeer(PeerInfo& peerInfo)
+bool Hm_Mod_Rpi_Pcb::sendPeerRequest(const std::vector<char>& payload, uint32_t responseSize, uint8_t responseType)
+{
+	for(int32_t i = 0; i < 40; i++)
+	{
+		std::vector<uint8_t> responsePacket;
+		std::vector<char> requestPacket;
+		buildPacket(requestPacket, payload);
+		_packetIndex++;
+		_peerTableRequests++;
+		getResponse(requestPacket, responsePacket, _packetIndex - 1, 1, 4);
+		if(responsePacket.size() >= responseSize && responsePacket.at(6) == responseType) return true;
+		else if(responsePacket.size() == 9 && responsePacket.at(6) == 8)
+		{
+			//Operation pending
+			std::this_thread::sleep_for(std::chrono::milliseconds(50));
+			continue;
+		}
+		if(i == 2) return false;
+	}
+	return false;
+}
+
+bool Hm_Mod_Rpi_Pcb::syncPeer(PeerInfo& peerInfo)
 {
 	try
 	{
-		if(GD::bl->debugLevel > 4) GD::out.printDebug("Debug: Sending peer to LGW \"" + _settings->id + "\": Address " + GD::bl->hf.getHexString(peerInfo.address, 6) + ", AES enabled " + std::to_string(peerInfo.aesEnabled) + ", AES map " + GD::bl->hf.getHexString(peerInfo.getAESChannelMap()) + ".");
-		for(int32_t i = 0; i < 2; i++) //The CCU sends this packet two times, I don't know why
+		PeerInfo gatewayPeerInfo;
+		if(!getPeerTableEntry(peerInfo.address, gatewayPeerInfo)) return sendPeer(peerInfo);
+
+		std::vector<char> enabledChannels;
+		std::vector<char> disabledChannels;
+		peerInfo.getAESChannelDifferences(gatewayPeerInfo, enabledChannels, disabledChannels);
+		if(peerInfo.keyIndex == gatewayPeerInfo.keyIndex && peerInfo.wakeUp == gatewayPeerInfo.wakeUp && enabledChannels.empty() && disabledChannels.empty())
 		{
-			//Get current config
-			for(int32_t j = 0; j < 40; j++)
-			{
-				std::vector<uint8_t> responsePacket;
-				std::vector<char> requestPacket;
-				std::vector<char> payload{ 1, 6 };
-				payload.push_back(peerInfo.address >> 16);
-				payload.push_back((peerInfo.address >> 8) & 0xFF);
-				payload.push_back(peerInfo.address & 0xFF);
-				payload.push_back(0);
-				payload.push_back(0);
-				payload.push_back(0);
-				buildPacket(requestPacket, payload);
-				_packetIndex++;
-				getResponse(requestPacket, responsePacket, _packetIndex - 1, 1, 4);
-				if(responsePacket.size() >= 21  && responsePacket.at(6) == 7) break;
-				else if(responsePacket.size() == 9 && responsePacket.at(6) == 8)
-				{
-					//Operation pending
-					std::this_thread::sleep_for(std::chrono::milliseconds(50));
-					continue;
-				}
-				if(j == 2)
-				{
-					_out.printError("Error: Could not add peer with address 0x" + _bl->hf.getHexString(peerInfo.address, 6));
-					return;
-				}
-			}
+			_peerTablePeersUnchanged++;
+			return true;
 		}
-		//Reset all channels
-		for(int32_t j = 0; j < 40; j++)
+		if(GD::bl->debugLevel > 4) _out.printDebug("Debug: Updating peer on HM-MOD-RPI-PCB \"" + _settings->id + "\": Address " + GD::bl->hf.getHexString(peerInfo.address, 6) + ", AES map " + GD::bl->hf.getHexString(peerInfo.getAESChannelMap()) + ".");
+
+		if(peerInfo.keyIndex != gatewayPeerInfo.keyIndex || peerInfo.wakeUp != gatewayPeerInfo.wakeUp)
 		{
-			std::vector<uint8_t> responsePacket;
-			std::vector<char> requestPacket;
-			std::vector<char> payload{ 1, 0xA };
+			std::vector<char> payload{ 1, 6 };
 			payload.push_back(peerInfo.address >> 16);
 			payload.push_back((peerInfo.address >> 8) & 0xFF);
 			payload.push_back(peerInfo.address & 0xFF);
+			payload.push_back(peerInfo.keyIndex);
+			payload.push_back(peerInfo.wakeUp ? 1 : 0); //CCU2 sets this for wake up, too. No idea, what the meaning is.
 			payload.push_back(0);
-
-			for(std::map<int32_t, bool>::iterator k = peerInfo.aesChannels.begin(); k != peerInfo.aesChannels.end(); ++k)
-			{
-				payload.push_back(k->first);
-			}
-			buildPacket(requestPacket, payload);
-			_packetIndex++;
-			getResponse(requestPacket, responsePacket, _packetIndex - 1, 1, 4);
-			if(responsePacket.size() >= 9  && responsePacket.at(6) == 1) break;
-			else if(responsePacket.size() == 9 && responsePacket.at(6) == 8)
-			{
-				//Operation pending
-				std::this_thread::sleep_for(std::chrono::milliseconds(50));
-				continue;
-			}
-			if(j == 2)
+			if(!sendPeerRequest(payload, 21, 7))
 			{
 				_out.printError("Error: Could not add peer with address 0x" + _bl->hf.getHexString(peerInfo.address, 6));
-				return;
+				return false;
 			}
 		}
-		//Get current config again
-		for(int32_t j = 0; j < 40; j++)
+
+		//All changed channels are set with one request
+		for(int32_t i = 0; i < 2; i++)
 		{
-			std::vector<uint8_t> responsePacket;
-			std::vector<char> requestPacket;
-			std::vector<char> payload{ 1, 6 };
+			std::vector<char>& channels = (i == 0) ? enabledChannels : disabledChannels;
+			if(channels.empty()) continue;
+			std::vector<char> payload{ 1, (char)(i == 0 ? 9 : 0xA) };
 			payload.push_back(peerInfo.address >> 16);
 			payload.push_back((peerInfo.address >> 8) & 0xFF);
 			payload.push_back(peerInfo.address & 0xFF);
 			payload.push_back(0);
-			payload.push_back(0);
-			payload.push_back(0);
-			buildPacket(requestPacket, payload);
-			_packetIndex++;
-			getResponse(requestPacket, responsePacket, _packetIndex - 1, 1, 4);
-			if(responsePacket.size() >= 21  && responsePacket.at(6) == 7) break;
-			else if(responsePacket.size() == 9 && responsePacket.at(6) == 8)
+			payload.insert(payload.end(), channels.begin(), channels.end());
+			if(!sendPeerRequest(payload, 9, 1))
 			{
-				//Operation pending
-				std::this_thread::sleep_for(std::chrono::milliseconds(50));
-				continue;
+				_out.printError("Error: Could not set AES for peer with address 0x" + _bl->hf.getHexString(peerInfo.address, 6));
+				return false;
 			}
-			if(j == 2)
+		}
+
+		setPeerTableEntry(peerInfo);
+		_peerTablePeersUpdated++;
+		return true;
+	}
+    catch(const std::exception& ex)
+    {
+    	_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(BaseLib::Exception& ex)
+    {
+    	_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+    	_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+    return false;
+}
+
+bool Hm_Mod_Rpi_Pcb::sendPeer(PeerInfo& peerInfo)
+{
+	try
+	{
+		if(GD::bl->debugLevel > 4) _out.printDebug("Debug: Sending peer to HM-MOD-RPI-PCB \"" + _settings->id + "\": Address " + GD::bl->hf.getHexString(peerInfo.address, 6) + ", AES enabled " + std::to_string(peerInfo.aesEnabled) + ", AES map " + GD::bl->hf.getHexString(peerInfo.getAESChannelMap()) + ".");
+		std::vector<char> address{ (char)(peerInfo.address >> 16), (char)((peerInfo.address >> 8) & 0xFF), (char)(peerInfo.address & 0xFF) };
+
+		//Get current config
+		std::vector<char> getConfigPayload{ 1, 6 };
+		getConfigPayload.insert(getConfigPayload.end(), address.begin(), address.end());
+		getConfigPayload.push_back(0);
+		getConfigPayload.push_back(0);
+		getConfigPayload.push_back(0);
+		for(int32_t i = 0; i < 2; i++) //The CCU sends this packet two or even more times, I don't know why
+		{
+			if(!sendPeerRequest(getConfigPayload, 21, 7))
 			{
 				_out.printError("Error: Could not add peer with address 0x" + _bl->hf.getHexString(peerInfo.address, 6));
-				return;
+				return false;
 			}
 		}
+
+		//Reset all channels
+		std::vector<char> payload{ 1, 0xA };
+		payload.insert(payload.end(), address.begin(), address.end());
+		payload.push_back(0);
+		for(std::map<int32_t, bool>::iterator k = peerInfo.aesChannels.begin(); k != peerInfo.aesChannels.end(); ++k)
+		{
+			payload.push_back(k->first);
+		}
+		if(!sendPeerRequest(payload, 9, 1))
+		{
+			_out.printError("Error: Could not add peer with address 0x" + _bl->hf.getHexString(peerInfo.address, 6));
+			return false;
+		}
+
+		//Get current config again
+		if(!sendPeerRequest(getConfigPayload, 21, 7))
+		{
+			_out.printError("Error: Could not add peer with address 0x" + _bl->hf.getHexString(peerInfo.address, 6));
+			return false;
+		}
+
 		if(peerInfo.wakeUp)
 		{
 			//Enable sending of wake up packet or just request config again?
-			for(int32_t j = 0; j < 40; j++)
+			payload = std::vector<char>{ 1, 6 };
+			payload.insert(payload.end(), address.begin(), address.end());
+			payload.push_back(0);
+			payload.push_back(1);
+			payload.push_back(0);
+			if(!sendPeerRequest(payload, 21, 7))
 			{
-				std::vector<uint8_t> responsePacket;
-				std::vector<char> requestPacket;
-				std::vector<char> payload{ 1, 6 };
-				payload.push_back(peerInfo.address >> 16);
-				payload.push_back((peerInfo.address >> 8) & 0xFF);
-				payload.push_back(peerInfo.address & 0xFF);
-				payload.push_back(0);
-				payload.push_back(1);
-				payload.push_back(0);
-				buildPacket(requestPacket, payload);
-				_packetIndex++;
-				getResponse(requestPacket, responsePacket, _packetIndex - 1, 1, 4);
-				if(responsePacket.size() >= 21  && responsePacket.at(6) == 7) break;
-				else if(responsePacket.size() == 9 && responsePacket.at(6) == 8)
-				{
-					//Operation pending
-					std::this_thread::sleep_for(std::chrono::milliseconds(50));
-					continue;
-				}
-				if(j == 2)
-				{
-					_out.printError("Error: Could not add peer with address 0x" + _bl->hf.getHexString(peerInfo.address, 6));
-					return;
-				}
+				_out.printError("Error: Could not add peer with address 0x" + _bl->hf.getHexString(peerInfo.address, 6));
+				return false;
 			}
 		}
+
 		//Set key index and enable sending of wake up packet.
-		for(int32_t j = 0; j < 40; j++)
+		payload = std::vector<char>{ 1, 6 };
+		payload.insert(payload.end(), address.begin(), address.end());
+		payload.push_back(peerInfo.keyIndex);
+		payload.push_back(peerInfo.wakeUp ? 1 : 0);
+		payload.push_back(0);
+		if(!sendPeerRequest(payload, 21, 7))
 		{
-			std::vector<uint8_t> responsePacket;
-			std::vector<char> requestPacket;
-			std::vector<char> payload{ 1, 6 };
-			payload.push_back(peerInfo.address >> 16);
-			payload.push_back((peerInfo.address >> 8) & 0xFF);
-			payload.push_back(peerInfo.address & 0xFF);
-			payload.push_back(peerInfo.keyIndex);
-			payload.push_back(peerInfo.wakeUp ? 1 : 0);
+			_out.printError("Error: Could not add peer with address 0x" + _bl->hf.getHexString(peerInfo.address, 6));
+			return false;
+		}
+
+		//Enable AES
+		if(peerInfo.aesEnabled)
+		{
+			payload = std::vector<char>{ 1, 9 };
+			payload.insert(payload.end(), address.begin(), address.end());
 			payload.push_back(0);
-			buildPacket(requestPacket, payload);
-			_packetIndex++;
-			getResponse(requestPacket, responsePacket, _packetIndex - 1, 1, 4);
-			if(responsePacket.size() >= 21  && responsePacket.at(6) == 7) break;
-			else if(responsePacket.size() == 9 && responsePacket.at(6) == 8)
+			bool aesEnabled = false;
+			for(std::map<int32_t, bool>::iterator k = peerInfo.aesChannels.begin(); k != peerInfo.aesChannels.end(); ++k)
 			{
-				//Operation pending
-				std::this_thread::sleep_for(std::chrono::milliseconds(50));
-				continue;
+				if(k->second)
+				{
+					aesEnabled = true;
+					payload.push_back(k->first);
+				}
 			}
-			if(j == 2)
+			if(aesEnabled && !sendPeerRequest(payload, 9, 1))
 			{
 				_out.printError("Error: Could not add peer with address 0x" + _bl->hf.getHexString(peerInfo.address, 6));
-				return;
+				return false;
 			}
 		}
-		//Enable AES
-		if(peerInfo.aesEnabled)
+
+		PeerInfo gatewayPeerInfo = peerInfo;
+		//Channels with AES enabled are only sent when AES is enabled for the peer.
+		if(!peerInfo.aesEnabled)
 		{
-			//Delete old configuration
-			for(int32_t j = 0; j < 40; j++)
+			for(std::map<int32_t, bool>::iterator k = gatewayPeerInfo.aesChannels.begin(); k != gatewayPeerInfo.aesChannels.end(); ++k)
 			{
-				std::vector<uint8_t> responsePacket;
-				std::vector<char> requestPacket;
-				std::vector<char> payload{ 1, 9 };
-				payload.push_back(peerInfo.address >> 16);
-				payload.push_back((peerInfo.address >> 8) & 0xFF);
-				payload.push_back(peerInfo.address & 0xFF);
-				payload.push_back(0);
-
-				bool aesEnabled = false;
-				for(std::map<int32_t, bool>::iterator k = peerInfo.aesChannels.begin(); k != peerInfo.aesChannels.end(); ++k)
-				{
-					if(k->second)
-					{
-						aesEnabled = true;
-						payload.push_back(k->first);
-					}
-				}
-				if(!aesEnabled) break;
-				buildPacket(requestPacket, payload);
-				_packetIndex++;
-				getResponse(requestPacket, responsePacket, _packetIndex - 1, 1, 4);
-				if(responsePacket.size() >= 9  && responsePacket.at(6) == 1) break;
-				else if(responsePacket.size() == 9 && responsePacket.at(6) == 8)
-				{
-					//Operation pending
-					std::this_thread::sleep_for(std::chrono::milliseconds(50));
-					continue;
-				}
-				if(j == 2)
-				{
-					_out.printError("Error: Could not add peer with address 0x" + _bl->hf.getHexString(peerInfo.address, 6));
-					return;
-				}
+				k->second = false;
 			}
 		}
+		setPeerTableEntry(gatewayPeerInfo);
+		_peerTablePeersAdded++;
+		return true;
 	}
     catch(const std::exception& ex)
     {
@@ -729,6 +666,7 @@ void Hm_Mod_Rpi_Pcb::sendPeer(PeerInfo& peerInfo)
     {
     	_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
     }
+    return false;
 }
 
 void Hm_Mod_Rpi_Pcb::setAES(PeerInfo peerInfo, int32_t channel)
@@ -913,9 +851,11 @@ void Hm_Mod_Rpi_Pcb::sendPacket(std::shared_ptr<BaseLib::Systems::Packet> packet
 			else _out.printWarning(std::string("Warning: !!!Not!!! sending packet, because device is not connected or opened: ") + bidCoSPacket->hexString());
 			return;
 		}
+		addCommandLatency(bidCoSPacket);
 
 		std::vector<char> packetBytes = bidCoSPacket->byteArraySigned();
 		if(_bl->debugLevel >= 4) _out.printInfo("Info: Sending (" + _settings->id + "): " + _bl->hf.getHexString(packetBytes));
+		addAirtime(bidCoSPacket);
 
 		for(int32_t j = 0; j < 40; j++)
 		{
@@ -974,6 +914,7 @@ void Hm_Mod_Rpi_Pcb::sendPacket(std::shared_ptr<BaseLib::Systems::Packet> packet
 				//NACK is sometimes also returned when the AES handshake wasn't successful (i. e.
 				//the handshake after sending a wake up packet)
 				_out.printInfo("Info: No answer to packet " + _bl->hf.getHexString(packetBytes));
+				addAirtime(bidCoSPacket, 2);
 				return;
 			}
 			if(j == 2)
@@ -1126,6 +1067,7 @@ void Hm_Mod_Rpi_Pcb::doInit()
 		if(_stopped) return;
 
 		// {{{ Reset
+		clearPeerTable(); //The module doesn't know any peers after the reset
 		try
 		{
 			openGPIO(1, false);
@@ -1421,6 +1363,7 @@ void Hm_Mod_Rpi_Pcb::startListening()
 		else GD::bl->threadManager.start(_initThread, true, &Hm_Mod_Rpi_Pcb::doInit, this);
 		startQueue(0, 0, SCHED_OTHER);
 		IPhysicalInterface::startListening();
+		startDispatching();
 	}
     catch(const std::exception& ex)
     {
@@ -1485,6 +1428,7 @@ void Hm_Mod_Rpi_Pcb::stopListening()
 		_initStarted = false;
 		_initComplete = false;
 		IPhysicalInterface::stopListening();
+		stopDispatching();
 	}
 	catch(const std::exception& ex)
     {
@@ -1678,18 +1622,19 @@ void Hm_Mod_Rpi_Pcb::buildPacket(std::vector<char>& packet, const std::vector<ch
 {
 	try
 	{
-		std::vector<char> unescapedPacket;
-		unescapedPacket.push_back(0xFD);
+		packet.clear();
+		if(payload.empty()) return;
 		int32_t size = payload.size() + 1; //Payload size plus message counter size - control byte
-		unescapedPacket.push_back(size >> 8);
-		unescapedPacket.push_back(size & 0xFF);
-		unescapedPacket.push_back(payload.at(0));
-		unescapedPacket.push_back(_packetIndex);
-		unescapedPacket.insert(unescapedPacket.end(), payload.begin() + 1, payload.end());
-		uint16_t crc = _crc.calculate(unescapedPacket);
-		unescapedPacket.push_back(crc >> 8);
-		unescapedPacket.push_back(crc & 0xFF);
-		escapePacket(unescapedPacket, packet);
+		char header[5] = { (char)0xFD, (char)(size >> 8), (char)(size & 0xFF), payload[0], (char)_packetIndex };
+		//Checksum and escaping are done in place, so no unescaped copy of the packet is needed
+		uint16_t crc = CRC16::calculate((const uint8_t*)header, sizeof(header));
+		crc = CRC16::calculate((const uint8_t*)payload.data() + 1, payload.size() - 1, crc);
+		char crcBytes[2] = { (char)(crc >> 8), (char)(crc & 0xFF) };
+		packet.reserve((payload.size() + 6) * 2);
+		packet.push_back(header[0]);
+		escapePacket(header + 1, sizeof(header) - 1, packet);
+		escapePacket(payload.data() + 1, payload.size() - 1, packet);
+		escapePacket(crcBytes, sizeof(crcBytes), packet);
 	}
     catch(const std::exception& ex)
     {
@@ -1705,21 +1650,18 @@ void Hm_Mod_Rpi_Pcb::buildPacket(std::vector<char>& packet, const std::vector<ch
     }
 }
 
-void Hm_Mod_Rpi_Pcb::escapePacket(const std::vector<char>& unescapedPacket, std::vector<char>& escapedPacket)
+void Hm_Mod_Rpi_Pcb::escapePacket(const char* data, uint32_t size, std::vector<char>& escapedPacket)
 {
 	try
 	{
-		escapedPacket.clear();
-		if(unescapedPacket.empty()) return;
-		escapedPacket.push_back(unescapedPacket[0]);
-		for(uint32_t i = 1; i < unescapedPacket.size(); i++)
+		for(uint32_t i = 0; i < size; i++)
 		{
-			if(unescapedPacket[i] == (char)0xFC || unescapedPacket[i] == (char)0xFD)
+			if(data[i] == (char)0xFC || data[i] == (char)0xFD)
 			{
 				escapedPacket.push_back(0xFC);
-				escapedPacket.push_back(unescapedPacket[i] & (char)0x7F);
+				escapedPacket.push_back(data[i] & (char)0x7F);
 			}
-			else escapedPacket.push_back(unescapedPacket[i]);
+			else escapedPacket.push_back(data[i]);
 		}
 	}
 	catch(const std::exception& ex)
@@ -1742,7 +1684,7 @@ void Hm_Mod_Rpi_Pcb::processPacket(std::vector<uint8_t>& packet)
 	{
 		_out.printDebug(std::string("Debug: Packet received from HM-MOD-RPI-PCB: " + _bl->hf.getHexString(packet)));
 		if(packet.size() < 8) return;
-		uint16_t crc = _crc.calculate(packet, true);
+		uint16_t crc = CRC16::calculate(packet.data(), packet.size() - 2);
 
 		if(packet.at(3) == 0xFE && packet.at(5) == 0)
 		{
@@ -1896,7 +1838,7 @@ void Hm_Mod_Rpi_Pcb::parsePacket(std::vector<uint8_t>& packet)
 			}
 			// }}}
 
-			raisePacketReceived(bidCoSPacket);
+			dispatchPacket(bidCoSPacket);
 			if(wakeUp) //Wake up was sent
 			{
 				_out.printInfo("Info: Detected wake-up packet.");
@@ -1905,7 +1847,7 @@ void Hm_Mod_Rpi_Pcb::parsePacket(std::vector<uint8_t>& packet)
 				std::shared_ptr<BidCoSPacket> ok(new BidCoSPacket(bidCoSPacket->messageCounter(), 0x80, 0x02, bidCoSPacket->senderAddress(), _myAddress, payload));
 				ok->setTimeReceived(bidCoSPacket->timeReceived() + 1);
 				std::this_thread::sleep_for(std::chrono::milliseconds(30));
-				raisePacketReceived(ok);
+				dispatchPacket(ok);
 			}
 		}
 	}
@@ -131,7 +131,6 @@ class Hm_Mod_Rpi_Pcb  : public IBidCoSInterface
         bool _escapeByte = false;
         std::vector<uint8_t> _packetBuffer;
         std::atomic<uint8_t> _packetIndex;
-        CRC16 _crc;
 
         void openDevice();
         void closeDevice();
@@ -140,12 +139,28 @@ class Hm_Mod_Rpi_Pcb  : public IBidCoSInterface
         void reconnect();
         void doInit();
         void sendPeers();
-        void sendPeer(PeerInfo& peerInfo);
+
+        /**
+         * Sends a peer to the module, which the module doesn't know yet.
+         */
+        bool sendPeer(PeerInfo& peerInfo);
+
+        /**
+         * Sends only the settings of the peer which differ from the module's peer table. Calls sendPeer() for unknown peers.
+         */
+        bool syncPeer(PeerInfo& peerInfo);
+
+        /**
+         * Sends a request to change the peer table and retries it while the module is busy.
+         *
+         * @return Returns false when the module didn't respond with a response of the expected type.
+         */
+        bool sendPeerRequest(const std::vector<char>& payload, uint32_t responseSize, uint8_t responseType);
         void processData(std::vector<uint8_t>& data);
         void processPacket(std::vector<uint8_t>& packet);
         void parsePacket(std::vector<uint8_t>& packet);
         void buildPacket(std::vector<char>& packet, const std::vector<char>& payload);
-        void escapePacket(const std::vector<char>& unescapedPacket, std::vector<char>& escapedPacket);
+        void escapePacket(const char* data, uint32_t size, std::vector<char>& escapedPacket);
         void getResponse(const std::vector<char>& packet, std::vector<uint8_t>& response, uint8_t messageCounter, uint8_t responseControlByte, uint8_t responseType);
         void send(std::string hexString);
         void send(const std::vector<char>& data);
@@ -43,7 +43,6 @@ HomegearGateway::HomegearGateway(std::shared_ptr<BaseLib::Systems::PhysicalInter
     signal(SIGPIPE, SIG_IGN);
 
     _stopped = true;
-    _waitForResponse = false;
 
     _binaryRpc.reset(new BaseLib::Rpc::BinaryRpc(_bl));
     _rpcEncoder.reset(new BaseLib::Rpc::RpcEncoder(_bl, true, true));
@@ -112,6 +111,7 @@ void HomegearGateway::stopListening()
         if(_tcpSocket) _tcpSocket->close();
         _bl->threadManager.join(_listenThread);
         _stopped = true;
+        abortRequest("Connection closed.");
         _tcpSocket.reset();
     }
     catch(const std::exception& ex)
@@ -233,6 +233,7 @@ void HomegearGateway::listen()
                     if(_stopCallbackThread) return;
                     if(_stopped) _out.printWarning("Warning: Connection to device closed. Trying to reconnect...");
                     _tcpSocket->close();
+                    abortRequest("Connection closed.");
                     std::this_thread::sleep_for(std::chrono::milliseconds(1000));
                     _tcpSocket->open();
                     if(_tcpSocket->connected())
@@ -280,12 +281,23 @@ void HomegearGateway::listen()
                                 _rpcEncoder->encodeResponse(response, data);
                                 _tcpSocket->proofwrite(data);
                             }
-                            else if(_binaryRpc->getType() == BaseLib::Rpc::BinaryRpc::Type::response && _waitForResponse)
+                            else if(_binaryRpc->getType() == BaseLib::Rpc::BinaryRpc::Type::response)
                             {
+                                BaseLib::PVariable response = _rpcDecoder->decodeResponse(_binaryRpc->getData());
                                 std::unique_lock<std::mutex> requestLock(_requestMutex);
-                                _rpcResponse = _rpcDecoder->decodeResponse(_binaryRpc->getData());
-                                requestLock.unlock();
-                                _requestConditionVariable.notify_all();
+                                if(_request)
+                                {
+                                    _request->response = response;
+                                    _request->finished = true;
+                                    _request.reset();
+                                    requestLock.unlock();
+                                    _requestConditionVariable.notify_all();
+                                }
+                                else
+                                {
+                                    requestLock.unlock();
+                                    _out.printWarning("Warning: Received RPC response without request.");
+                                }
                             }
                             _binaryRpc->reset();
                         }
@@ -363,15 +375,20 @@ PVariable HomegearGateway::invoke(std::string methodName, PArray& parameters)
 {
     try
     {
+        //Responses can only be assigned to requests by order, so there must not be more than one request waiting for a response.
         std::lock_guard<std::mutex> invokeGuard(_invokeMutex);
-
-        std::unique_lock<std::mutex> requestLock(_requestMutex);
-        _rpcResponse.reset();
-        _waitForResponse = true;
+        if(!_tcpSocket) return BaseLib::Variable::createError(-32500, "Could not send RPC request.");
 
         std::vector<char> encodedPacket;
         _rpcEncoder->encodeRequest(methodName, parameters, encodedPacket);
 
+        PRequest request = std::make_shared<Request>();
+        {
+            //The request needs to be set before writing, because the response might be processed before proofwrite returns.
+            std::lock_guard<std::mutex> requestGuard(_requestMutex);
+            _request = request;
+        }
+
         int32_t i = 0;
         for(i = 0; i < 5; i++)
         {
@@ -383,21 +400,24 @@ PVariable HomegearGateway::invoke(std::string methodName, PArray& parameters)
             catch(BaseLib::SocketOperationException& ex)
             {
                 _out.printError("Error: " + ex.what());
-                if(i == 5) return BaseLib::Variable::createError(-32500, ex.what());
-                _tcpSocket->open();
+                if(i < 4) _tcpSocket->open();
             }
         }
 
-        i = 0;
-        while(!_requestConditionVariable.wait_for(requestLock, std::chrono::milliseconds(1000), [&]
+        std::unique_lock<std::mutex> requestLock(_requestMutex);
+        if(i == 5)
+        {
+            _request.reset();
+            return BaseLib::Variable::createError(-32500, "Could not send RPC request.");
+        }
+        _requestConditionVariable.wait_for(requestLock, std::chrono::milliseconds(10000), [&]
         {
-            i++;
-            return _rpcResponse || _stopped || i == 10;
-        }));
-        _waitForResponse = false;
-        if(i == 10 || !_rpcResponse) return BaseLib::Variable::createError(-32500, "No RPC response received.");
+            return request->finished || _stopped;
+        });
+        if(_request == request) _request.reset();
+        if(!request->finished || !request->response) return BaseLib::Variable::createError(-32500, "No RPC response received.");
 
-        return _rpcResponse;
+        return request->response;
     }
     catch(const std::exception& ex)
     {
@@ -414,6 +434,33 @@ PVariable HomegearGateway::invoke(std::string methodName, PArray& parameters)
     return BaseLib::Variable::createError(-32500, "Unknown application error. See log for more details.");
 }
 
+void HomegearGateway::abortRequest(std::string reason)
+{
+    try
+    {
+        {
+            std::lock_guard<std::mutex> requestGuard(_requestMutex);
+            if(!_request) return;
+            _request->response = BaseLib::Variable::createError(-32500, reason);
+            _request->finished = true;
+            _request.reset();
+        }
+        _requestConditionVariable.notify_all();
+    }
+    catch(const std::exception& ex)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(BaseLib::Exception& ex)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+}
+
 void HomegearGateway::processPacket(std::string& data)
 {
     try
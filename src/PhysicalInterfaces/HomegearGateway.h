@@ -54,15 +54,34 @@ protected:
     std::unique_ptr<BaseLib::Rpc::RpcEncoder> _rpcEncoder;
     std::unique_ptr<BaseLib::Rpc::RpcDecoder> _rpcDecoder;
 
+    class Request
+    {
+    public:
+        Request() {}
+        virtual ~Request() {}
+
+        bool finished = false;
+        BaseLib::PVariable response;
+    };
+    typedef std::shared_ptr<Request> PRequest;
+
     std::mutex _invokeMutex;
     std::mutex _requestMutex;
-    std::atomic_bool _waitForResponse;
     std::condition_variable _requestConditionVariable;
-    BaseLib::PVariable _rpcResponse;
+
+    /**
+     * The request waiting for a response. The binary RPC protocol has no request IDs, so invoke() only sends one request at a time.
+     */
+    PRequest _request;
 
     void listen();
     virtual void forceSendPacket(std::shared_ptr<BidCoSPacket> packet);
     BaseLib::PVariable invoke(std::string methodName, BaseLib::PArray& parameters);
+
+    /**
+     * Finishes the request waiting for a response with an error. Called when the connection is closed, because the response will never arrive.
+     */
+    void abortRequest(std::string reason);
     void processPacket(std::string& data);
 };
 
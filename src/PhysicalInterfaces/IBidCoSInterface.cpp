@@ -33,6 +33,9 @@
 
 namespace BidCoS
 {
+const std::array<uint32_t, 3> IBidCoSInterface::_airtimeLimits{ { 100, 90, 75 } };
+const std::array<int64_t, 12> IBidCoSInterface::_dispatchLatencyBounds{ { 100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000, 500000, 1000000 } };
+const std::array<int64_t, 12> IBidCoSInterface::_commandLatencyBounds{ { 250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000, 250000, 500000, 1000000 } };
 
 std::vector<char> IBidCoSInterface::PeerInfo::getAESChannelMap()
 {
@@ -62,9 +65,52 @@ std::vector<char> IBidCoSInterface::PeerInfo::getAESChannelMap()
     return map;
 }
 
-IBidCoSInterface::IBidCoSInterface(std::shared_ptr<BaseLib::Systems::PhysicalInterfaceSettings> settings) : IPhysicalInterface(GD::bl, GD::family->getFamily(), settings), BaseLib::ITimedQueue(GD::bl, 1)
+void IBidCoSInterface::PeerInfo::getAESChannelDifferences(const PeerInfo& other, std::vector<char>& enabledChannels, std::vector<char>& disabledChannels) const
+{
+	try
+	{
+		for(std::map<int32_t, bool>::const_iterator i = aesChannels.begin(); i != aesChannels.end(); ++i)
+		{
+			std::map<int32_t, bool>::const_iterator otherChannel = other.aesChannels.find(i->first);
+			bool otherEnabled = otherChannel != other.aesChannels.end() && otherChannel->second;
+			if(i->second && !otherEnabled) enabledChannels.push_back(i->first);
+			else if(!i->second && otherEnabled) disabledChannels.push_back(i->first);
+		}
+		for(std::map<int32_t, bool>::const_iterator i = other.aesChannels.begin(); i != other.aesChannels.end(); ++i)
+		{
+			if(i->second && aesChannels.find(i->first) == aesChannels.end()) disabledChannels.push_back(i->first);
+		}
+	}
+    catch(const std::exception& ex)
+    {
+    	GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(BaseLib::Exception& ex)
+    {
+    	GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+    	GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+}
+
+IBidCoSInterface::IBidCoSInterface(std::shared_ptr<BaseLib::Systems::PhysicalInterfaceSettings> settings) : IPhysicalInterface(GD::bl, GD::family->getFamily(), settings), BaseLib::ITimedQueue(GD::bl, 1), _receiveRing(1024)
 {
 	_bl = GD::bl;
+	_airtimePerMinute.fill(0);
+	_airtimePacketsDeferred.fill(0);
+	_peerTablePeersAdded = 0;
+	_peerTablePeersUpdated = 0;
+	_peerTablePeersUnchanged = 0;
+	_peerTableRequests = 0;
+	_stopDispatchThread = true;
+	_dispatchThreadWaiting = false;
+	_packetsDispatched = 0;
+	_dispatchOverflows = 0;
+	_dispatchDrops = 0;
+	_dispatchLatencies.fill(0);
+	_commandLatencies.fill(0);
 	_currentRfKeyIndex = GD::settings->getNumber("currentrfkeyindex");
 	if(_currentRfKeyIndex < 0) _currentRfKeyIndex = 0;
 	_rfKeyHex = GD::settings->getString("rfkey");
@@ -141,7 +187,7 @@ IBidCoSInterface::IBidCoSInterface(std::shared_ptr<BaseLib::Systems::PhysicalInt
 
 IBidCoSInterface::~IBidCoSInterface()
 {
-
+	stopDispatching();
 }
 
 void IBidCoSInterface::addPeer(PeerInfo peerInfo)
@@ -243,6 +289,7 @@ void IBidCoSInterface::startListening()
 	try
 	{
 		IPhysicalInterface::startListening();
+		startDispatching();
 		startQueue(0, 45, SCHED_FIFO);
 	}
     catch(const std::exception& ex)
@@ -265,6 +312,258 @@ void IBidCoSInterface::stopListening()
 	{
 		IPhysicalInterface::stopListening();
 		stopQueue(0);
+		stopDispatching();
+	}
+	catch(const std::exception& ex)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(BaseLib::Exception& ex)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+}
+
+// {{{ Peer table of the communication module
+bool IBidCoSInterface::getPeerTableEntry(int32_t address, PeerInfo& peerInfo)
+{
+	std::lock_guard<std::mutex> peerTableGuard(_peerTableMutex);
+	std::map<int32_t, PeerInfo>::iterator peerIterator = _peerTable.find(address);
+	if(peerIterator == _peerTable.end()) return false;
+	peerInfo = peerIterator->second;
+	return true;
+}
+
+void IBidCoSInterface::setPeerTableEntry(const PeerInfo& peerInfo)
+{
+	std::lock_guard<std::mutex> peerTableGuard(_peerTableMutex);
+	_peerTable[peerInfo.address] = peerInfo;
+}
+
+void IBidCoSInterface::removePeerTableEntry(int32_t address)
+{
+	std::lock_guard<std::mutex> peerTableGuard(_peerTableMutex);
+	_peerTable.erase(address);
+}
+
+void IBidCoSInterface::clearPeerTable()
+{
+	std::lock_guard<std::mutex> peerTableGuard(_peerTableMutex);
+	_peerTable.clear();
+}
+
+IBidCoSInterface::PeerTableStatistics IBidCoSInterface::getPeerTable(std::map<int32_t, PeerInfo>& peerTable)
+{
+	PeerTableStatistics statistics;
+	try
+	{
+		statistics.enabled = _peerTableEnabled;
+		statistics.peersAdded = _peerTablePeersAdded;
+		statistics.peersUpdated = _peerTablePeersUpdated;
+		statistics.peersUnchanged = _peerTablePeersUnchanged;
+		statistics.requests = _peerTableRequests;
+		std::lock_guard<std::mutex> peerTableGuard(_peerTableMutex);
+		peerTable = _peerTable;
+	}
+	catch(const std::exception& ex)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(BaseLib::Exception& ex)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+	return statistics;
+}
+// }}}
+
+// {{{ Dispatching of received packets
+void IBidCoSInterface::startDispatching()
+{
+	try
+	{
+		stopDispatching();
+		_stopDispatchThread = false;
+		GD::bl->threadManager.start(_dispatchThread, true, &IBidCoSInterface::dispatchThread, this);
+	}
+	catch(const std::exception& ex)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(BaseLib::Exception& ex)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+}
+
+void IBidCoSInterface::stopDispatching()
+{
+	try
+	{
+		{
+			std::lock_guard<std::mutex> dispatchGuard(_dispatchMutex);
+			_stopDispatchThread = true;
+		}
+		_dispatchConditionVariable.notify_one();
+		GD::bl->threadManager.join(_dispatchThread);
+
+		//Packets enqueued while the thread was stopping
+		std::shared_ptr<BidCoSPacket> packet;
+		std::chrono::steady_clock::time_point timeEnqueued;
+		while(_receiveRing.dequeue(packet, timeEnqueued))
+		{
+			raisePacketReceived(packet);
+		}
+	}
+	catch(const std::exception& ex)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(BaseLib::Exception& ex)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+}
+
+void IBidCoSInterface::dispatchThread()
+{
+	std::shared_ptr<BidCoSPacket> packet;
+	std::chrono::steady_clock::time_point timeEnqueued;
+	while(true)
+	{
+		try
+		{
+			if(!_receiveRing.dequeue(packet, timeEnqueued))
+			{
+				//Packets enqueued before stopping are still passed to the central.
+				if(_stopDispatchThread) return;
+				std::unique_lock<std::mutex> dispatchGuard(_dispatchMutex);
+				_dispatchThreadWaiting = true;
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+				if(_receiveRing.size() == 0 && !_stopDispatchThread) _dispatchConditionVariable.wait_for(dispatchGuard, std::chrono::milliseconds(1000));
+				_dispatchThreadWaiting = false;
+				continue;
+			}
+
+			int64_t latency = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - timeEnqueued).count();
+			{
+				std::lock_guard<std::mutex> latencyGuard(_dispatchLatencyMutex);
+				uint32_t bucket = 0;
+				while(bucket < _dispatchLatencyBounds.size() && latency >= _dispatchLatencyBounds[bucket]) bucket++;
+				_dispatchLatencies[bucket]++;
+				if(latency > _maximumDispatchLatency) _maximumDispatchLatency = latency;
+			}
+			_packetsDispatched++;
+			raisePacketReceived(packet);
+			packet.reset();
+		}
+		catch(const std::exception& ex)
+		{
+			_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+		}
+		catch(BaseLib::Exception& ex)
+		{
+			_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+		}
+		catch(...)
+		{
+			_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+		}
+	}
+}
+
+void IBidCoSInterface::dispatchPacket(std::shared_ptr<BidCoSPacket> packet)
+{
+	try
+	{
+		if(_stopDispatchThread)
+		{
+			raisePacketReceived(packet);
+			return;
+		}
+		if(!_receiveRing.enqueue(packet))
+		{
+			//Processing the packet here would pass it to the central before the queued ones. So wait briefly for the dispatch thread and drop the packet if it doesn't catch up.
+			_dispatchOverflows++;
+			bool enqueued = false;
+			for(int32_t i = 0; i < 10; i++)
+			{
+				notifyDispatchThread();
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+				if(_stopDispatchThread) break;
+				if(_receiveRing.enqueue(packet))
+				{
+					enqueued = true;
+					break;
+				}
+			}
+			if(!enqueued)
+			{
+				_dispatchDrops++;
+				_out.printWarning("Warning: Queue of received packets is full. Dropping packet: " + packet->hexString());
+				return;
+			}
+		}
+		notifyDispatchThread();
+	}
+	catch(const std::exception& ex)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(BaseLib::Exception& ex)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+}
+
+void IBidCoSInterface::notifyDispatchThread()
+{
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if(_dispatchThreadWaiting)
+	{
+		std::lock_guard<std::mutex> dispatchGuard(_dispatchMutex);
+		_dispatchConditionVariable.notify_one();
+	}
+}
+
+IBidCoSInterface::DispatchStatistics IBidCoSInterface::getDispatchStatistics()
+{
+	DispatchStatistics statistics;
+	try
+	{
+		statistics.enabled = !_stopDispatchThread;
+		statistics.capacity = _receiveRing.capacity();
+		statistics.queued = _receiveRing.size();
+		statistics.packetsDispatched = _packetsDispatched;
+		statistics.overflows = _dispatchOverflows;
+		statistics.drops = _dispatchDrops;
+		std::lock_guard<std::mutex> latencyGuard(_dispatchLatencyMutex);
+		statistics.latencyHistogram.reserve(_dispatchLatencies.size());
+		for(uint32_t i = 0; i < _dispatchLatencies.size(); i++)
+		{
+			statistics.latencyHistogram.push_back(std::pair<int64_t, uint64_t>(i < _dispatchLatencyBounds.size() ? _dispatchLatencyBounds[i] : -1, _dispatchLatencies[i]));
+		}
+		statistics.maximumLatency = _maximumDispatchLatency;
 	}
 	catch(const std::exception& ex)
     {
@@ -278,7 +577,69 @@ void IBidCoSInterface::stopListening()
     {
         _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
     }
+	return statistics;
 }
+// }}}
+
+// {{{ Command latency
+void IBidCoSInterface::addCommandLatency(std::shared_ptr<BidCoSPacket>& packet)
+{
+	try
+	{
+		//Resends and AES handshakes are not counted.
+		int64_t commandTime = packet->takeCommandTime();
+		if(commandTime == 0) return;
+		int64_t latency = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count() - commandTime;
+		std::lock_guard<std::mutex> latencyGuard(_commandLatencyMutex);
+		uint32_t bucket = 0;
+		while(bucket < _commandLatencyBounds.size() && latency >= _commandLatencyBounds[bucket]) bucket++;
+		_commandLatencies[bucket]++;
+		if(latency > _maximumCommandLatency) _maximumCommandLatency = latency;
+		_commandsSent++;
+	}
+	catch(const std::exception& ex)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(BaseLib::Exception& ex)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+}
+
+IBidCoSInterface::CommandStatistics IBidCoSInterface::getCommandStatistics()
+{
+	CommandStatistics statistics;
+	try
+	{
+		std::lock_guard<std::mutex> latencyGuard(_commandLatencyMutex);
+		statistics.commandsSent = _commandsSent;
+		statistics.latencyHistogram.reserve(_commandLatencies.size());
+		for(uint32_t i = 0; i < _commandLatencies.size(); i++)
+		{
+			statistics.latencyHistogram.push_back(std::pair<int64_t, uint64_t>(i < _commandLatencyBounds.size() ? _commandLatencyBounds[i] : -1, _commandLatencies[i]));
+		}
+		statistics.maximumLatency = _maximumCommandLatency;
+	}
+	catch(const std::exception& ex)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(BaseLib::Exception& ex)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+	return statistics;
+}
+// }}}
 
 void IBidCoSInterface::processQueueEntry(int32_t index, int64_t id, std::shared_ptr<BaseLib::ITimedQueueEntry>& entry)
 {
@@ -288,6 +649,7 @@ void IBidCoSInterface::processQueueEntry(int32_t index, int64_t id, std::shared_
 		queueEntry = std::dynamic_pointer_cast<QueueEntry>(entry);
 		if(!queueEntry || !queueEntry->packet) return;
 		forceSendPacket(queueEntry->packet);
+		addAirtime(queueEntry->packet);
 
         if(queueEntry->packet->controlByte() & 0x10) queueEntry->packet->setTimeSending(queueEntry->packet->timeSending() + 560);
         else queueEntry->packet->setTimeSending(queueEntry->packet->timeSending() + 200);
@@ -377,7 +739,7 @@ void IBidCoSInterface::processReceivedPacket(std::shared_ptr<BidCoSPacket> packe
 						if(_bl->debugLevel >= 5) _out.printDebug("Debug: AES handshake successful.");
 						queuePacket(aFrame);
 						mFrame->setTimeReceived(BaseLib::HelperFunctions::getTime());
-						raisePacketReceived(mFrame);
+						dispatchPacket(mFrame);
 						return;
 					}
 					else if(packet->messageType() == 0x02 && packet->payload()->size() == 8 && packet->payload()->at(0) == 0x04)
@@ -496,7 +858,7 @@ void IBidCoSInterface::processReceivedPacket(std::shared_ptr<BidCoSPacket> packe
 					std::shared_ptr<BidCoSPacket> ackPacket(new BidCoSPacket(packet->messageCounter(), controlByte, 0x02, _myAddress, packet->senderAddress(), payload));
 					queuePacket(ackPacket);
 				}
-				raisePacketReceived(packet);
+				dispatchPacket(packet);
 			}
 		}
 		else if(packet->destinationAddress() == 0 && (packet->controlByte() & 2)) //Packet is wake me up packet
@@ -525,7 +887,7 @@ void IBidCoSInterface::processReceivedPacket(std::shared_ptr<BidCoSPacket> packe
 					std::shared_ptr<BidCoSPacket> wakeUpPacket(new BidCoSPacket(packet->messageCounter(), 0xA1, 0x12, _myAddress, packet->senderAddress(), payload));
 					queuePacket(wakeUpPacket);
 				}
-				raisePacketReceived(packet);
+				dispatchPacket(packet);
 			}
 			catch(const std::exception& ex)
 			{
@@ -556,7 +918,7 @@ void IBidCoSInterface::processReceivedPacket(std::shared_ptr<BidCoSPacket> packe
 				}
 			}
 			// }}}
-			raisePacketReceived(packet);
+			dispatchPacket(packet);
 		}
 		if(_bl->hf.getTime() - _lastAesHandshakeGc > 30000)
 		{
@@ -656,7 +1018,9 @@ void IBidCoSInterface::sendPacket(std::shared_ptr<BaseLib::Systems::Packet> pack
 			return;
 		}
 
+		addCommandLatency(bidCoSPacket);
 		forceSendPacket(bidCoSPacket);
+		addAirtime(bidCoSPacket);
 		_aesHandshake->setMFrame(bidCoSPacket);
 		if(!_updateMode &&
                 !(bidCoSPacket->messageType() == 0x01 && bidCoSPacket->controlByte() == 0x84) && //addDevice pairing packet
@@ -692,6 +1056,147 @@ void IBidCoSInterface::sendPacket(std::shared_ptr<BaseLib::Systems::Packet> pack
     }
 }
 
+// {{{ Airtime
+uint32_t IBidCoSInterface::getAirtime(std::shared_ptr<BidCoSPacket>& packet)
+{
+	//10 kBaud => 0.8 ms per byte. On air are 4 bytes preamble, 4 bytes sync word, the length byte, the packet and 2 bytes CRC.
+	uint32_t bytes = 4 + 4 + 1 + 9 + packet->payload()->size() + 2;
+	uint32_t airtime = (bytes * 8 + 9) / 10;
+	//Burst packets wake up devices using WOR and have a preamble of 360 ms.
+	if(packet->controlByte() & 0x10) airtime += 360;
+	return airtime;
+}
+
+IBidCoSInterface::AirtimePriority IBidCoSInterface::getAirtimePriority(std::shared_ptr<BidCoSPacket>& packet)
+{
+	if(packet->messageType() == 0x02 || packet->messageType() == 0x03) return AirtimePriority::high; //ACKs and AES handshake
+	if(packet->isUpdatePacket() || packet->messageType() == 0x01) return AirtimePriority::bulk; //Firmware updates and configuration
+	return AirtimePriority::normal;
+}
+
+uint32_t IBidCoSInterface::getUsedAirtime(int64_t time)
+{
+	int64_t minute = time / 60000;
+	if(minute - _airtimeMinute >= (signed)_airtimePerMinute.size()) _airtimePerMinute.fill(0);
+	else
+	{
+		for(int64_t i = _airtimeMinute + 1; i <= minute; i++)
+		{
+			_airtimePerMinute[i % _airtimePerMinute.size()] = 0;
+		}
+	}
+	if(minute > _airtimeMinute) _airtimeMinute = minute;
+
+	uint32_t used = 0;
+	for(std::array<uint32_t, 60>::iterator i = _airtimePerMinute.begin(); i != _airtimePerMinute.end(); ++i)
+	{
+		used += *i;
+	}
+	return used;
+}
+
+int64_t IBidCoSInterface::getAirtimeDelay(std::shared_ptr<BidCoSPacket>& packet, uint32_t transmissions)
+{
+	try
+	{
+		AirtimePriority priority = getAirtimePriority(packet);
+		if(priority == AirtimePriority::high) return 0;
+		uint32_t airtime = getAirtime(packet) * transmissions;
+		uint32_t limit = _airtimeBudget * _airtimeLimits[(int32_t)priority] / 100;
+		int64_t time = BaseLib::HelperFunctions::getTime();
+		uint32_t used = 0;
+		int64_t delay = 0;
+		{
+			std::lock_guard<std::mutex> airtimeGuard(_airtimeMutex);
+			used = getUsedAirtime(time);
+			if(used + airtime <= limit) return 0;
+			//The airtime of a minute is freed one hour after the minute started.
+			int64_t size = _airtimePerMinute.size();
+			uint32_t remaining = used;
+			delay = (_airtimeMinute + size) * 60000 - time;
+			for(int64_t minute = _airtimeMinute - size + 1; minute <= _airtimeMinute; minute++)
+			{
+				remaining -= _airtimePerMinute[minute % size];
+				if(remaining + airtime <= limit)
+				{
+					delay = (minute + size) * 60000 - time;
+					break;
+				}
+			}
+			if(delay < 1) delay = 1;
+			_airtimePacketsDeferred[(int32_t)priority]++;
+		}
+		_out.printWarning("Warning: Deferring packet to 0x" + BaseLib::HelperFunctions::getHexString(packet->destinationAddress(), 6) + " by " + std::to_string(delay / 1000) + " s, because " + std::to_string(used * 100 / _airtimeBudget) + " % of the airtime allowed by the 1 % rule are used: " + packet->hexString());
+		return delay;
+	}
+    catch(const std::exception& ex)
+    {
+    	_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(BaseLib::Exception& ex)
+    {
+    	_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+    	_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+	return 0;
+}
+
+void IBidCoSInterface::addAirtime(std::shared_ptr<BidCoSPacket>& packet, uint32_t transmissions)
+{
+	try
+	{
+		uint32_t airtime = getAirtime(packet) * transmissions;
+		int64_t time = BaseLib::HelperFunctions::getTime();
+		std::lock_guard<std::mutex> airtimeGuard(_airtimeMutex);
+		getUsedAirtime(time);
+		_airtimePerMinute[(time / 60000) % _airtimePerMinute.size()] += airtime;
+		_airtimePacketsSent += transmissions;
+	}
+    catch(const std::exception& ex)
+    {
+    	_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(BaseLib::Exception& ex)
+    {
+    	_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+    	_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+}
+
+IBidCoSInterface::AirtimeStatistics IBidCoSInterface::getAirtimeStatistics()
+{
+	AirtimeStatistics statistics;
+	try
+	{
+		std::lock_guard<std::mutex> airtimeGuard(_airtimeMutex);
+		statistics.budget = _airtimeBudget;
+		statistics.used = getUsedAirtime(BaseLib::HelperFunctions::getTime());
+		statistics.usage = statistics.used * 100 / _airtimeBudget;
+		statistics.packetsSent = _airtimePacketsSent;
+		statistics.packetsDeferred = _airtimePacketsDeferred;
+	}
+    catch(const std::exception& ex)
+    {
+    	_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(BaseLib::Exception& ex)
+    {
+    	_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+    	_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+	return statistics;
+}
+// }}}
+
 void IBidCoSInterface::appendSignature(std::shared_ptr<BidCoSPacket> packet)
 {
 	try
@@ -31,8 +31,11 @@
 #define IBIDCOSINTERFACE_H_
 
 #include "AesHandshake.h"
+#include "ReceiveRing.h"
 #include <homegear-base/BaseLib.h>
 
+#include <array>
+#include <condition_variable>
 #include <random>
 
 namespace BidCoS {
@@ -47,6 +50,14 @@ public:
 		virtual ~PeerInfo() {}
 		std::vector<char> getAESChannelMap();
 
+		/**
+		 * Returns the channels whose AES setting differs from "other". Channels not in aesChannels are treated as disabled.
+		 *
+		 * @param[out] enabledChannels Channels enabled in this object, but not in "other".
+		 * @param[out] disabledChannels Channels disabled in this object, but enabled in "other".
+		 */
+		void getAESChannelDifferences(const PeerInfo& other, std::vector<char>& enabledChannels, std::vector<char>& disabledChannels) const;
+
 		bool aesEnabled = false;
 		bool wakeUp = false;
 		int32_t address = 0;
@@ -54,6 +65,121 @@ public:
 		std::map<int32_t, bool> aesChannels;
 	};
 
+	class ReadStatistics
+	{
+	public:
+		ReadStatistics() {}
+		virtual ~ReadStatistics() {}
+
+		/**
+		 * False when the interface doesn't count its reads.
+		 */
+		bool enabled = false;
+		uint64_t pollCalls = 0;
+		uint64_t readCalls = 0;
+		uint64_t bytesRead = 0;
+		uint64_t packetsReceived = 0;
+	};
+
+	class PeerTableStatistics
+	{
+	public:
+		PeerTableStatistics() {}
+		virtual ~PeerTableStatistics() {}
+
+		/**
+		 * False when the communication module doesn't store peers.
+		 */
+		bool enabled = false;
+		uint64_t peersAdded = 0;
+		uint64_t peersUpdated = 0;
+
+		/**
+		 * Number of times a peer was not sent, because the module already had the same entry.
+		 */
+		uint64_t peersUnchanged = 0;
+		uint64_t requests = 0;
+	};
+
+	class DispatchStatistics
+	{
+	public:
+		DispatchStatistics() {}
+		virtual ~DispatchStatistics() {}
+
+		/**
+		 * False when received packets are processed on the receiving thread.
+		 */
+		bool enabled = false;
+		uint32_t capacity = 0;
+		uint32_t queued = 0;
+		uint64_t packetsDispatched = 0;
+
+		/**
+		 * Number of packets that found the queue full. The receiving thread then waits up to 10 ms for the dispatch thread.
+		 */
+		uint64_t overflows = 0;
+
+		/**
+		 * Number of packets dropped, because the queue was still full after waiting.
+		 */
+		uint64_t drops = 0;
+
+		/**
+		 * Time from enqueuing a packet until it is passed to the central. The first element is the upper bound of the bucket in microseconds,
+		 * the last bucket's upper bound is -1.
+		 */
+		std::vector<std::pair<int64_t, uint64_t>> latencyHistogram;
+		int64_t maximumLatency = 0;
+	};
+
+	class CommandStatistics
+	{
+	public:
+		CommandStatistics() {}
+		virtual ~CommandStatistics() {}
+
+		uint64_t commandsSent = 0;
+
+		/**
+		 * Time from calling setValue() until the packet is passed to the communication module. The first element is the upper bound of the
+		 * bucket in microseconds, the last bucket's upper bound is -1.
+		 */
+		std::vector<std::pair<int64_t, uint64_t>> latencyHistogram;
+		int64_t maximumLatency = 0;
+	};
+
+	enum class AirtimePriority : int32_t
+	{
+		high = 0, //ACKs and AES handshake. Never deferred.
+		normal = 1,
+		bulk = 2 //Configuration and firmware updates
+	};
+
+	class AirtimeStatistics
+	{
+	public:
+		AirtimeStatistics() {}
+		virtual ~AirtimeStatistics() {}
+
+		/**
+		 * The airtime allowed within one hour in milliseconds (1 % of one hour).
+		 */
+		uint32_t budget = 0;
+
+		/**
+		 * The airtime used within the last hour in milliseconds.
+		 */
+		uint32_t used = 0;
+
+		/**
+		 * Used airtime in percent of the budget.
+		 */
+		uint32_t usage = 0;
+		uint64_t packetsSent = 0;
+		std::array<uint64_t, 3> packetsDeferred{ { 0, 0, 0 } };
+	};
+
 	IBidCoSInterface(std::shared_ptr<BaseLib::Systems::PhysicalInterfaceSettings> settings);
 	virtual ~IBidCoSInterface();
 
@@ -73,6 +199,31 @@ public:
 	virtual uint32_t getCurrentRFKeyIndex() { return _currentRfKeyIndex; }
 
 	void appendSignature(std::shared_ptr<BidCoSPacket> packet);
+	std::shared_ptr<AesHandshake> getAesHandshake() { return _aesHandshake; }
+	virtual ReadStatistics getReadStatistics() { return ReadStatistics(); }
+	AirtimeStatistics getAirtimeStatistics();
+	DispatchStatistics getDispatchStatistics();
+	CommandStatistics getCommandStatistics();
+
+	/**
+	 * Returns the peers stored on the communication module as far as they were confirmed by the module.
+	 */
+	PeerTableStatistics getPeerTable(std::map<int32_t, PeerInfo>& peerTable);
+
+	/**
+	 * Calculates the time in milliseconds one transmission of the packet occupies the radio channel.
+	 */
+	static uint32_t getAirtime(std::shared_ptr<BidCoSPacket>& packet);
+	static AirtimePriority getAirtimePriority(std::shared_ptr<BidCoSPacket>& packet);
+
+	/**
+	 * Checks if the budget has enough airtime left for the packet's priority. The interface itself never holds back packets, so callers
+	 * which can send again later (BidCoSQueue) use this to defer low priority packets.
+	 *
+	 * @param transmissions The number of times the packet is sent when no response is received.
+	 * @return Returns 0 when the packet can be sent now. Otherwise returns the time in milliseconds until enough airtime is free.
+	 */
+	int64_t getAirtimeDelay(std::shared_ptr<BidCoSPacket>& packet, uint32_t transmissions = 3);
 
 	virtual void sendPacket(std::shared_ptr<BaseLib::Systems::Packet> packet);
 	virtual void sendTest() {}
@@ -103,6 +254,96 @@ protected:
 	std::vector<uint8_t> _rfKey;
 	std::vector<uint8_t> _oldRfKey;
 
+	// {{{ Airtime
+		static const uint32_t _airtimeBudget = 36000;
+
+		/**
+		 * Packets of a priority are deferred, when the used airtime plus the airtime of the packet and its resends exceeds this percentage of the budget.
+		 */
+		static const std::array<uint32_t, 3> _airtimeLimits;
+
+		std::mutex _airtimeMutex;
+		std::array<uint32_t, 60> _airtimePerMinute;
+		int64_t _airtimeMinute = 0;
+		uint64_t _airtimePacketsSent = 0;
+		std::array<uint64_t, 3> _airtimePacketsDeferred;
+
+		/**
+		 * Removes minutes older than one hour and returns the airtime used within the last hour. _airtimeMutex needs to be locked.
+		 */
+		uint32_t getUsedAirtime(int64_t time);
+		void addAirtime(std::shared_ptr<BidCoSPacket>& packet, uint32_t transmissions = 1);
+	// }}}
+
+	// {{{ Peer table of the communication module
+		bool _peerTableEnabled = false;
+		std::mutex _peerTableMutex;
+
+		/**
+		 * The peers the module confirmed. Used to only send changed peers.
+		 */
+		std::map<int32_t, PeerInfo> _peerTable;
+		std::atomic<uint64_t> _peerTablePeersAdded;
+		std::atomic<uint64_t> _peerTablePeersUpdated;
+		std::atomic<uint64_t> _peerTablePeersUnchanged;
+		std::atomic<uint64_t> _peerTableRequests;
+
+		/**
+		 * Returns the entry of the peer table.
+		 *
+		 * @return Returns false when the module doesn't have the peer.
+		 */
+		bool getPeerTableEntry(int32_t address, PeerInfo& peerInfo);
+		void setPeerTableEntry(const PeerInfo& peerInfo);
+		void removePeerTableEntry(int32_t address);
+		void clearPeerTable();
+	// }}}
+
+	// {{{ Dispatching of received packets
+		static const std::array<int64_t, 12> _dispatchLatencyBounds;
+
+		ReceiveRing _receiveRing;
+		std::thread _dispatchThread;
+		std::atomic_bool _stopDispatchThread;
+		std::atomic_bool _dispatchThreadWaiting;
+		std::mutex _dispatchMutex;
+		std::condition_variable _dispatchConditionVariable;
+		std::atomic<uint64_t> _packetsDispatched;
+		std::atomic<uint64_t> _dispatchOverflows;
+		std::atomic<uint64_t> _dispatchDrops;
+		std::mutex _dispatchLatencyMutex;
+		std::array<uint64_t, 13> _dispatchLatencies;
+		int64_t _maximumDispatchLatency = 0;
+
+		/**
+		 * Starts the thread passing received packets to the central. Until then packets are passed on the receiving thread.
+		 */
+		void startDispatching();
+		void stopDispatching();
+		void dispatchThread();
+		void notifyDispatchThread();
+
+		/**
+		 * Passes a received packet to the central. Call this instead of raisePacketReceived() on the receiving thread, so slow processing
+		 * (database, RPC events) doesn't delay reception of the next packets.
+		 */
+		void dispatchPacket(std::shared_ptr<BidCoSPacket> packet);
+	// }}}
+
+	// {{{ Command latency
+		static const std::array<int64_t, 12> _commandLatencyBounds;
+
+		std::mutex _commandLatencyMutex;
+		std::array<uint64_t, 13> _commandLatencies;
+		int64_t _maximumCommandLatency = 0;
+		uint64_t _commandsSent = 0;
+
+		/**
+		 * Adds the time since setValue() was called to the histogram, when the packet is the first transmission of a command.
+		 */
+		void addCommandLatency(std::shared_ptr<BidCoSPacket>& packet);
+	// }}}
+
 	virtual void forceSendPacket(std::shared_ptr<BidCoSPacket> packet) {};
 	virtual void processQueueEntry(int32_t index, int64_t id, std::shared_ptr<BaseLib::ITimedQueueEntry>& entry);
 	void queuePacket(std::shared_ptr<BidCoSPacket> packet, int64_t sendingTime = 0);
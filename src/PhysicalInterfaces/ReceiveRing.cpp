@@ -0,0 +1,97 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Homegear.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+
+
+#include "ReceiveRing.h"
+
+namespace BidCoS
+{
+
+ReceiveRing::ReceiveRing(uint32_t capacity)
+{
+	uint64_t size = 2;
+	while(size < capacity) size <<= 1;
+	_mask = size - 1;
+	_cells.reset(new Cell[size]);
+	for(uint64_t i = 0; i < size; i++)
+	{
+		_cells[i].sequence.store(i, std::memory_order_relaxed);
+	}
+	_enqueuePosition.store(0, std::memory_order_relaxed);
+	_dequeuePosition.store(0, std::memory_order_relaxed);
+}
+
+ReceiveRing::~ReceiveRing()
+{
+}
+
+uint32_t ReceiveRing::size()
+{
+	uint64_t enqueuePosition = _enqueuePosition.load(std::memory_order_relaxed);
+	uint64_t dequeuePosition = _dequeuePosition.load(std::memory_order_relaxed);
+	return enqueuePosition > dequeuePosition ? enqueuePosition - dequeuePosition : 0;
+}
+
+bool ReceiveRing::enqueue(const std::shared_ptr<BidCoSPacket>& packet)
+{
+	//Every cell has a sequence number. A cell is free for position "p" when its sequence is "p" and filled when its sequence is "p + 1".
+	Cell* cell = nullptr;
+	uint64_t position = _enqueuePosition.load(std::memory_order_relaxed);
+	while(true)
+	{
+		cell = &_cells[position & _mask];
+		uint64_t sequence = cell->sequence.load(std::memory_order_acquire);
+		int64_t difference = (int64_t)sequence - (int64_t)position;
+		if(difference == 0)
+		{
+			if(_enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) break;
+		}
+		else if(difference < 0) return false; //Full
+		else position = _enqueuePosition.load(std::memory_order_relaxed);
+	}
+	cell->packet = packet;
+	cell->timeEnqueued = std::chrono::steady_clock::now();
+	cell->sequence.store(position + 1, std::memory_order_release);
+	return true;
+}
+
+bool ReceiveRing::dequeue(std::shared_ptr<BidCoSPacket>& packet, std::chrono::steady_clock::time_point& timeEnqueued)
+{
+	uint64_t position = _dequeuePosition.load(std::memory_order_relaxed);
+	Cell* cell = &_cells[position & _mask];
+	if(cell->sequence.load(std::memory_order_acquire) != position + 1) return false;
+	packet = std::move(cell->packet);
+	cell->packet.reset();
+	timeEnqueued = cell->timeEnqueued;
+	cell->sequence.store(position + _mask + 1, std::memory_order_release);
+	_dequeuePosition.store(position + 1, std::memory_order_relaxed);
+	return true;
+}
+
+}
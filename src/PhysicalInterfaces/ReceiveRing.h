@@ -0,0 +1,94 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Homegear.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+
+
+#ifndef RECEIVERING_H_
+#define RECEIVERING_H_
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+
+namespace BidCoS
+{
+
+class BidCoSPacket;
+
+/**
+ * Bounded lock-free queue for received packets. Any number of threads can enqueue packets, but only one thread is allowed to dequeue them.
+ * The capacity is rounded up to the next power of two.
+ */
+class ReceiveRing
+{
+public:
+	ReceiveRing(uint32_t capacity);
+	virtual ~ReceiveRing();
+
+	uint32_t capacity() { return _mask + 1; }
+
+	/**
+	 * Returns the number of queued packets. The value is only a snapshot when other threads are enqueuing or dequeuing at the same time.
+	 */
+	uint32_t size();
+
+	/**
+	 * Adds a packet to the queue without blocking.
+	 *
+	 * @return Returns false when the queue is full.
+	 */
+	bool enqueue(const std::shared_ptr<BidCoSPacket>& packet);
+
+	/**
+	 * Removes the oldest packet from the queue. Must only be called by the consuming thread.
+	 *
+	 * @param[out] packet The dequeued packet.
+	 * @param[out] timeEnqueued The time the packet was enqueued.
+	 * @return Returns false when the queue is empty.
+	 */
+	bool dequeue(std::shared_ptr<BidCoSPacket>& packet, std::chrono::steady_clock::time_point& timeEnqueued);
+private:
+	class Cell
+	{
+	public:
+		std::atomic<uint64_t> sequence;
+		std::shared_ptr<BidCoSPacket> packet;
+		std::chrono::steady_clock::time_point timeEnqueued;
+	};
+
+	uint64_t _mask = 0;
+	std::unique_ptr<Cell[]> _cells;
+
+	std::atomic<uint64_t> _enqueuePosition;
+	char _padding[64]; //Producers and the consumer work on different cache lines
+	std::atomic<uint64_t> _dequeuePosition;
+};
+
+}
+
+#endif
@@ -0,0 +1,882 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Homegear.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+
+
+#include "Simulator.h"
+#include "../BidCoSPacket.h"
+#include "../GD.h"
+
+using namespace BaseLib::DeviceDescription;
+
+namespace BidCoS
+{
+
+Simulator::Simulator(std::shared_ptr<BaseLib::Systems::PhysicalInterfaceSettings> settings) : IBidCoSInterface(settings)
+{
+	_settings = settings;
+	_out.init(GD::bl);
+	_out.setPrefix(GD::out.getPrefix() + "Simulator \"" + settings->id + "\": ");
+
+	_stopped = true;
+	_wakeUps = 0;
+	_packetsToDevices = 0;
+	_packetsToCentral = 0;
+	_bytesToCentral = 0;
+	_packetsLost = 0;
+	_dutyCycleDrops = 0;
+	_aesHandshakes = 0;
+
+	readSettings();
+	_initComplete = true;
+}
+
+Simulator::~Simulator()
+{
+	stopListening();
+}
+
+void Simulator::readSettings()
+{
+	try
+	{
+		std::string setting = GD::settings ? GD::settings->getString("simulatordevices") : "";
+		if(!setting.empty())
+		{
+			int32_t deviceCount = BaseLib::Math::getNumber(setting);
+			_deviceCount = deviceCount < 0 ? 0 : (deviceCount > 65535 ? 65535 : deviceCount);
+		}
+
+		setting = GD::settings ? GD::settings->getString("simulatorstartaddress") : "";
+		if(!setting.empty()) _startAddress = BaseLib::Math::getNumber(setting) & 0xFFFFFF;
+		if(_startAddress + (int32_t)_deviceCount > 0xFFFFFF) _startAddress = 0xFFFFFF - (int32_t)_deviceCount;
+
+		setting = GD::settings ? GD::settings->getString("simulatordevicetype") : "";
+		if(!setting.empty()) _deviceType = BaseLib::Math::getNumber(setting) & 0xFFFF;
+
+		setting = GD::settings ? GD::settings->getString("simulatorfirmwareversion") : "";
+		if(!setting.empty()) _firmwareVersion = BaseLib::Math::getNumber(setting) & 0xFF;
+
+		setting = GD::settings ? GD::settings->getString("simulatorstatusinterval") : "";
+		if(!setting.empty()) _statusInterval = BaseLib::Math::getNumber(setting);
+		if(_statusInterval < 100) _statusInterval = 100;
+
+		setting = GD::settings ? GD::settings->getString("simulatorlatency") : "";
+		if(!setting.empty()) _latency = BaseLib::Math::getNumber(setting);
+		if(_latency < 0) _latency = 0;
+		else if(_latency > 500) _latency = 500;
+
+		setting = GD::settings ? GD::settings->getString("simulatorloss") : "";
+		if(!setting.empty()) _loss = BaseLib::Math::getNumber(setting);
+		if(_loss < 0) _loss = 0;
+		else if(_loss > 100) _loss = 100;
+
+		setting = GD::settings ? GD::settings->getString("simulatordutycycle") : "";
+		if(!setting.empty()) _dutyCycle = BaseLib::Math::getNumber(setting);
+		if(_dutyCycle < 0) _dutyCycle = 0;
+		else if(_dutyCycle > 100) _dutyCycle = 100;
+
+		_aesAlways = GD::settings && GD::settings->getString("simulatoraes") == "true";
+
+		setting = GD::settings ? GD::settings->getString("simulatorseed") : "";
+		if(!setting.empty()) _seed = BaseLib::Math::getNumber(setting);
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+}
+
+void Simulator::startListening()
+{
+	try
+	{
+		stopListening();
+
+		if(!_aesHandshake) return; //AES is not initialized
+
+		if(!GD::family->getCentral())
+		{
+			_out.printError("Error: Could not get central address. Stopping listening.");
+			return;
+		}
+		_myAddress = GD::family->getCentral()->getAddress();
+		_aesHandshake->setMyAddress(_myAddress);
+
+		_rpcDevice = GD::family->getRpcDevices()->find(_deviceType, _firmwareVersion);
+		if(!_rpcDevice)
+		{
+			_out.printError("Error: No device description found for device type 0x" + BaseLib::HelperFunctions::getHexString(_deviceType, 4) + " with firmware version 0x" + BaseLib::HelperFunctions::getHexString(_firmwareVersion, 2) + ".");
+			return;
+		}
+
+		IBidCoSInterface::startListening();
+
+		createDevices();
+		_stopped = false;
+		_stopCallbackThread = false;
+		if(_settings->listenThreadPriority > -1) _bl->threadManager.start(_listenThread, true, _settings->listenThreadPriority, _settings->listenThreadPolicy, &Simulator::simulate, this);
+		else _bl->threadManager.start(_listenThread, true, &Simulator::simulate, this);
+		_out.printInfo("Info: Simulating " + std::to_string(_devices.size()) + " devices of type 0x" + BaseLib::HelperFunctions::getHexString(_deviceType, 4) + " starting at address 0x" + BaseLib::HelperFunctions::getHexString(_startAddress, 6) + ".");
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+}
+
+void Simulator::stopListening()
+{
+	try
+	{
+		IBidCoSInterface::stopListening();
+		{
+			std::lock_guard<std::mutex> eventsGuard(_eventsMutex);
+			_stopCallbackThread = true;
+		}
+		_eventsConditionVariable.notify_all();
+		_bl->threadManager.join(_listenThread);
+		if(!_stopped) _out.printInfo("Info: Simulation stopped. Packets to devices: " + std::to_string(_packetsToDevices) + ", packets to central: " + std::to_string(_packetsToCentral) + ", lost: " + std::to_string(_packetsLost) + ", dropped by duty cycle: " + std::to_string(_dutyCycleDrops) + ", AES handshakes: " + std::to_string(_aesHandshakes));
+		_stopped = true;
+		{
+			std::lock_guard<std::mutex> eventsGuard(_eventsMutex);
+			_events.clear();
+		}
+		_devices.clear();
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+}
+
+void Simulator::enableUpdateMode()
+{
+	_out.printWarning("Warning: Firmware updates are not supported by the simulator.");
+}
+
+void Simulator::disableUpdateMode()
+{
+	_updateMode = false;
+}
+
+IBidCoSInterface::ReadStatistics Simulator::getReadStatistics()
+{
+	ReadStatistics statistics;
+	statistics.enabled = true;
+	statistics.pollCalls = _wakeUps;
+	statistics.readCalls = _packetsToCentral;
+	statistics.bytesRead = _bytesToCentral;
+	statistics.packetsReceived = _packetsToCentral;
+	return statistics;
+}
+
+void Simulator::createDevices()
+{
+	try
+	{
+		_devices.clear();
+		_random.seed(_seed);
+		std::uniform_int_distribution<int32_t> rssiDistribution(-90, -50);
+		std::uniform_int_distribution<int64_t> statusDistribution(0, _statusInterval);
+		int64_t time = BaseLib::HelperFunctions::getTime();
+		for(uint32_t i = 0; i < _deviceCount; i++)
+		{
+			Device& device = _devices[_startAddress + i];
+			device.address = _startAddress + i;
+			std::string number = std::to_string(i + 1);
+			device.serialNumber = "SIM" + std::string(number.size() < 7 ? 7 - number.size() : 0, '0') + number;
+			device.rssi = rssiDistribution(_random);
+			for(Functions::iterator j = _rpcDevice->functions.begin(); j != _rpcDevice->functions.end(); ++j)
+			{
+				if(j->first == 0) continue;
+				device.levels[j->first] = 0;
+			}
+
+			//Spread the status packets over the whole interval
+			Event event(Event::Type::status, device.address);
+			addEvent(time + statusDistribution(_random), event);
+		}
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+}
+
+void Simulator::addEvent(int64_t time, Event& event)
+{
+	try
+	{
+		bool notify = false;
+		{
+			std::lock_guard<std::mutex> eventsGuard(_eventsMutex);
+			notify = _events.empty() || time < _events.begin()->first;
+			_events.emplace(time, std::move(event));
+		}
+		if(notify) _eventsConditionVariable.notify_one();
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+}
+
+void Simulator::simulate()
+{
+	while(!_stopCallbackThread)
+	{
+		try
+		{
+			Event event;
+			{
+				std::unique_lock<std::mutex> eventsGuard(_eventsMutex);
+				int64_t waitTime = _events.empty() ? 1000 : _events.begin()->first - BaseLib::HelperFunctions::getTime();
+				if(waitTime > 0) _eventsConditionVariable.wait_for(eventsGuard, std::chrono::milliseconds(waitTime > 1000 ? 1000 : waitTime));
+				_wakeUps++;
+				if(_stopCallbackThread) return;
+				if(_events.empty() || _events.begin()->first > BaseLib::HelperFunctions::getTime()) continue;
+				event = std::move(_events.begin()->second);
+				_events.erase(_events.begin());
+			}
+			//Events are only processed on this thread, so the device state needs no locking.
+			processEvent(event);
+		}
+		catch(const std::exception& ex)
+		{
+			_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+		}
+		catch(BaseLib::Exception& ex)
+		{
+			_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+		}
+		catch(...)
+		{
+			_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+		}
+	}
+}
+
+void Simulator::processEvent(Event& event)
+{
+	try
+	{
+		std::uniform_int_distribution<int32_t> lossDistribution(0, 99);
+		if(event.type == Event::Type::toCentral)
+		{
+			if(_loss > 0 && lossDistribution(_random) < _loss)
+			{
+				_packetsLost++;
+				return;
+			}
+			std::shared_ptr<BidCoSPacket> packet(new BidCoSPacket(event.data, true, BaseLib::HelperFunctions::getTime()));
+			_packetsToCentral++;
+			_bytesToCentral += event.data.size();
+			if(_bl->debugLevel >= 5) _out.printDebug("Debug: Packet of simulated device: " + packet->hexString());
+			processReceivedPacket(packet);
+		}
+		else if(event.type == Event::Type::toDevice)
+		{
+			std::unordered_map<int32_t, Device>::iterator deviceIterator = _devices.find(event.address);
+			if(deviceIterator == _devices.end()) return;
+			if(_loss > 0 && lossDistribution(_random) < _loss)
+			{
+				_packetsLost++;
+				return;
+			}
+			std::shared_ptr<BidCoSPacket> packet(new BidCoSPacket(event.data, false, BaseLib::HelperFunctions::getTime()));
+			_packetsToDevices++;
+			handlePacket(deviceIterator->second, packet);
+		}
+		else
+		{
+			std::unordered_map<int32_t, Device>::iterator deviceIterator = _devices.find(event.address);
+			if(deviceIterator == _devices.end()) return;
+			if(isPaired(event.address)) sendStatus(deviceIterator->second);
+			else sendPairingRequest(deviceIterator->second);
+
+			//Jitter of +/- 10 %, so the devices don't synchronize
+			std::uniform_int_distribution<int64_t> jitterDistribution(-_statusInterval / 10, _statusInterval / 10);
+			Event nextEvent(Event::Type::status, event.address);
+			addEvent(BaseLib::HelperFunctions::getTime() + _statusInterval + jitterDistribution(_random), nextEvent);
+		}
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+}
+
+void Simulator::forceSendPacket(std::shared_ptr<BidCoSPacket> packet)
+{
+	try
+	{
+		if(_stopped || !packet) return;
+		if(_bl->debugLevel > 3) _out.printInfo("Info: Sending (" + _settings->id + "): " + packet->hexString());
+		int64_t time = BaseLib::HelperFunctions::getTime();
+		_lastPacketSent = time;
+		Event event(Event::Type::toDevice, packet->destinationAddress());
+		event.data = packet->byteArray();
+		addEvent(time + getAirtime(packet) + _latency, event);
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+}
+
+bool Simulator::isPaired(int32_t address)
+{
+	std::lock_guard<std::mutex> peersGuard(_peersMutex);
+	return _peers.find(address) != _peers.end();
+}
+
+bool Simulator::aesActive(Device& device, int32_t channel)
+{
+	try
+	{
+		if(_aesAlways) return true;
+		Functions::iterator functionIterator = _rpcDevice->functions.find(channel);
+		if(functionIterator == _rpcDevice->functions.end() || !functionIterator->second->configParameters) return false;
+		PParameter parameter = functionIterator->second->configParameters->getParameter("AES_ACTIVE");
+		if(!parameter || !parameter->physical) return false;
+		int32_t list = parameter->physical->list == -1 ? 0 : parameter->physical->list;
+		std::map<int32_t, uint8_t>& config = getConfig(device, channel, 0, 0, list);
+		std::map<int32_t, uint8_t>::iterator indexIterator = config.find((int32_t)parameter->physical->index);
+		if(indexIterator == config.end()) return false;
+		std::vector<uint8_t> mask{ 1 };
+		parameter->adjustBitPosition(mask);
+		return !mask.empty() && (indexIterator->second & mask.back());
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+	return false;
+}
+
+std::map<int32_t, uint8_t>& Simulator::getConfig(Device& device, int32_t channel, int32_t remoteAddress, int32_t remoteChannel, int32_t list)
+{
+	std::tuple<int32_t, int32_t, int32_t, int32_t> key(channel, remoteAddress, remoteChannel, list);
+	std::map<std::tuple<int32_t, int32_t, int32_t, int32_t>, std::map<int32_t, uint8_t>>::iterator configIterator = device.config.find(key);
+	if(configIterator != device.config.end()) return configIterator->second;
+	std::map<int32_t, uint8_t>& config = device.config[key];
+	try
+	{
+		Functions::iterator functionIterator = _rpcDevice->functions.find(channel);
+		if(functionIterator == _rpcDevice->functions.end()) return config;
+		PParameterGroup parameterGroup;
+		if(remoteAddress == 0) parameterGroup = functionIterator->second->configParameters;
+		else parameterGroup = functionIterator->second->linkParameters;
+		if(!parameterGroup) return config;
+		for(Parameters::iterator i = parameterGroup->parameters.begin(); i != parameterGroup->parameters.end(); ++i)
+		{
+			if(!i->second || !i->second->physical) continue;
+			if(i->second->physical->operationType != IPhysical::OperationType::Enum::config && i->second->physical->operationType != IPhysical::OperationType::Enum::configString) continue;
+			int32_t parameterList = i->second->physical->list == -1 ? 0 : i->second->physical->list;
+			if(parameterList != list) continue;
+			std::vector<uint8_t> value;
+			i->second->convertToPacket(i->second->logical->getDefaultValue(), value);
+			i->second->adjustBitPosition(value);
+			int32_t index = (int32_t)i->second->physical->index;
+			for(std::vector<uint8_t>::iterator j = value.begin(); j != value.end(); ++j)
+			{
+				config[index] |= *j;
+				index++;
+			}
+		}
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+	return config;
+}
+
+void Simulator::sendToCentral(Device& device, std::shared_ptr<BidCoSPacket> packet)
+{
+	try
+	{
+		if(!packet) return;
+		int64_t time = BaseLib::HelperFunctions::getTime();
+		uint32_t airtime = getAirtime(packet);
+		if(_dutyCycle > 0)
+		{
+			int64_t hour = time / 3600000;
+			if(hour != device.airtimeHour)
+			{
+				device.airtimeHour = hour;
+				device.airtimeUsed = 0;
+			}
+			if(device.airtimeUsed + airtime > (uint32_t)(36000 * _dutyCycle))
+			{
+				_dutyCycleDrops++;
+				return;
+			}
+			device.airtimeUsed += airtime;
+		}
+		packet->setTimeSending(time);
+		device.lastPacketSent = packet;
+
+		Event event(Event::Type::toCentral, device.address);
+		event.data = packet->byteArray();
+		//RSSI byte as appended by the CC1101
+		int32_t rssi = (device.rssi + 74) * 2;
+		if(rssi < 0) rssi += 256;
+		event.data.push_back((uint8_t)rssi);
+		addEvent(time + airtime + _latency, event);
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+}
+
+void Simulator::sendAck(Device& device, std::shared_ptr<BidCoSPacket>& packet, std::vector<uint8_t>& authentication)
+{
+	try
+	{
+		std::vector<uint8_t> payload{ 0 };
+		payload.insert(payload.end(), authentication.begin(), authentication.end());
+		std::shared_ptr<BidCoSPacket> ack(new BidCoSPacket(packet->messageCounter(), 0x80, 0x02, device.address, packet->senderAddress(), payload));
+		sendToCentral(device, ack);
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+}
+
+void Simulator::sendStatus(Device& device)
+{
+	try
+	{
+		if(device.levels.empty()) return;
+		std::uniform_int_distribution<uint32_t> channelDistribution(0, device.levels.size() - 1);
+		std::map<int32_t, uint8_t>::iterator levelIterator = device.levels.begin();
+		std::advance(levelIterator, channelDistribution(_random));
+		device.messageCounter++;
+		std::vector<uint8_t> payload{ 0x06, (uint8_t)levelIterator->first, levelIterator->second, 0x00, (uint8_t)-device.rssi };
+		std::shared_ptr<BidCoSPacket> packet(new BidCoSPacket(device.messageCounter, 0xA0, 0x10, device.address, _myAddress, payload));
+		sendToCentral(device, packet);
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+}
+
+void Simulator::sendPairingRequest(Device& device)
+{
+	try
+	{
+		std::vector<uint8_t> payload;
+		payload.reserve(17);
+		payload.push_back(_firmwareVersion);
+		payload.push_back(_deviceType >> 8);
+		payload.push_back(_deviceType & 0xFF);
+		payload.insert(payload.end(), device.serialNumber.begin(), device.serialNumber.end());
+		payload.push_back(0x00); //Device class
+		payload.push_back(0x01); //Peer channels
+		payload.push_back(0x00);
+		payload.push_back(0x00);
+		device.messageCounter++;
+		std::shared_ptr<BidCoSPacket> packet(new BidCoSPacket(device.messageCounter, 0x84, 0x00, device.address, 0, payload));
+		sendToCentral(device, packet);
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+}
+
+void Simulator::handlePacket(Device& device, std::shared_ptr<BidCoSPacket>& packet)
+{
+	try
+	{
+		std::vector<uint8_t>& payload = *packet->payload();
+		if(packet->messageType() == 0x02)
+		{
+			if(payload.size() == 8 && payload.at(0) == 0x04)
+			{
+				//c-Frame: The central authenticates the last packet of the device
+				if(!device.lastPacketSent) return;
+				std::shared_ptr<AesHandshake> aesHandshake(new AesHandshake(_bl, _out, device.address, _rfKey, _oldRfKey, _currentRfKeyIndex));
+				aesHandshake->setMFrame(device.lastPacketSent);
+				std::shared_ptr<BidCoSPacket> mFrame;
+				std::shared_ptr<BidCoSPacket> rFrame = aesHandshake->getRFrame(packet, mFrame, payload.back() / 2);
+				if(!rFrame)
+				{
+					_out.printWarning("Warning: Simulated device 0x" + BaseLib::HelperFunctions::getHexString(device.address, 6) + " could not answer AES challenge.");
+					return;
+				}
+				_aesHandshakes++;
+				sendToCentral(device, rFrame);
+				return;
+			}
+
+			//ACK of the central: Send the next packet of a multi packet response
+			if(device.pendingResponses.empty()) return;
+			std::shared_ptr<BidCoSPacket> response = device.pendingResponses.front();
+			device.pendingResponses.pop_front();
+			sendToCentral(device, response);
+			return;
+		}
+		else if(packet->messageType() == 0x03)
+		{
+			//r-Frame: The central answered the challenge of the device
+			if(!device.aesHandshake) return;
+			std::shared_ptr<BidCoSPacket> mFrame;
+			std::shared_ptr<BidCoSPacket> aFrame = device.aesHandshake->getAFrame(packet, mFrame, device.keyIndex, false);
+			device.aesHandshake.reset();
+			if(!aFrame || !mFrame)
+			{
+				_out.printWarning("Warning: AES handshake of simulated device 0x" + BaseLib::HelperFunctions::getHexString(device.address, 6) + " failed.");
+				return;
+			}
+			_aesHandshakes++;
+			std::vector<uint8_t> authentication(aFrame->payload()->begin() + 1, aFrame->payload()->end());
+			handleCommand(device, mFrame, authentication);
+			return;
+		}
+
+		device.pendingResponses.clear();
+		bool aesRequired = false;
+		if(packet->controlByte() & 0x20)
+		{
+			if(packet->messageType() == 0x04) aesRequired = true;
+			else if(packet->messageType() == 0x11 && payload.size() > 1) aesRequired = aesActive(device, payload.at(1));
+			else if(packet->messageType() == 0x01 && !payload.empty() && payload.at(0) != 0) aesRequired = aesActive(device, payload.at(0));
+		}
+		if(aesRequired)
+		{
+			device.aesHandshake.reset(new AesHandshake(_bl, _out, device.address, _rfKey, _oldRfKey, _currentRfKeyIndex));
+			std::shared_ptr<BidCoSPacket> cFrame = device.aesHandshake->getCFrame(packet);
+			if(!cFrame || cFrame->payload()->empty())
+			{
+				device.aesHandshake.reset();
+				return;
+			}
+			cFrame->payload()->back() = device.keyIndex * 2;
+			sendToCentral(device, cFrame);
+			return;
+		}
+
+		std::vector<uint8_t> authentication;
+		handleCommand(device, packet, authentication);
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+}
+
+void Simulator::handleCommand(Device& device, std::shared_ptr<BidCoSPacket>& packet, std::vector<uint8_t>& authentication)
+{
+	try
+	{
+		std::vector<uint8_t>& payload = *packet->payload();
+		if(packet->messageType() == 0x01)
+		{
+			handleConfig(device, packet, authentication);
+			return;
+		}
+		else if(packet->messageType() == 0x11 && payload.size() >= 3 && payload.at(0) == 0x02)
+		{
+			std::map<int32_t, uint8_t>::iterator levelIterator = device.levels.find(payload.at(1));
+			if(levelIterator != device.levels.end()) levelIterator->second = payload.at(2);
+			if(!(packet->controlByte() & 0x20)) return;
+			std::vector<uint8_t> responsePayload{ 0x01, payload.at(1), payload.at(2), 0x00, (uint8_t)-device.rssi };
+			responsePayload.insert(responsePayload.end(), authentication.begin(), authentication.end());
+			std::shared_ptr<BidCoSPacket> response(new BidCoSPacket(packet->messageCounter(), 0x80, 0x02, device.address, packet->senderAddress(), responsePayload));
+			sendToCentral(device, response);
+			return;
+		}
+		else if(packet->messageType() == 0x04)
+		{
+			//The new key is encrypted with the old one. It isn't decrypted. The device just uses the key index of the central after
+			//receiving both parts.
+			device.keyChangePackets++;
+			if(device.keyChangePackets % 2 == 0) device.keyIndex = _currentRfKeyIndex;
+		}
+
+		if(packet->controlByte() & 0x20) sendAck(device, packet, authentication);
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+}
+
+void Simulator::handleConfig(Device& device, std::shared_ptr<BidCoSPacket>& packet, std::vector<uint8_t>& authentication)
+{
+	try
+	{
+		std::vector<uint8_t>& payload = *packet->payload();
+		if(payload.size() < 2)
+		{
+			if(packet->controlByte() & 0x20) sendAck(device, packet, authentication);
+			return;
+		}
+		int32_t channel = payload.at(0);
+		uint8_t subtype = payload.at(1);
+		if(subtype == 0x01 && payload.size() >= 6) //Add peer
+		{
+			int32_t remoteAddress = (payload.at(2) << 16) + (payload.at(3) << 8) + payload.at(4);
+			device.links[channel].insert(std::make_pair(remoteAddress, (int32_t)payload.at(5)));
+			if(payload.size() >= 7 && payload.at(6) != 0 && payload.at(6) != payload.at(5)) device.links[channel].insert(std::make_pair(remoteAddress, (int32_t)payload.at(6)));
+		}
+		else if(subtype == 0x02 && payload.size() >= 6) //Remove peer
+		{
+			int32_t remoteAddress = (payload.at(2) << 16) + (payload.at(3) << 8) + payload.at(4);
+			device.links[channel].erase(std::make_pair(remoteAddress, (int32_t)payload.at(5)));
+			if(payload.size() >= 7) device.links[channel].erase(std::make_pair(remoteAddress, (int32_t)payload.at(6)));
+			for(std::map<std::tuple<int32_t, int32_t, int32_t, int32_t>, std::map<int32_t, uint8_t>>::iterator i = device.config.begin(); i != device.config.end();)
+			{
+				if(std::get<0>(i->first) == channel && std::get<1>(i->first) == remoteAddress) i = device.config.erase(i);
+				else ++i;
+			}
+		}
+		else if(subtype == 0x03) //Peer list request
+		{
+			std::vector<uint8_t> responsePayload{ 0x01 };
+			std::set<std::pair<int32_t, int32_t>>& links = device.links[channel];
+			for(std::set<std::pair<int32_t, int32_t>>::iterator i = links.begin(); i != links.end(); ++i)
+			{
+				responsePayload.push_back(i->first >> 16);
+				responsePayload.push_back((i->first >> 8) & 0xFF);
+				responsePayload.push_back(i->first & 0xFF);
+				responsePayload.push_back(i->second);
+			}
+			responsePayload.insert(responsePayload.end(), 4, 0);
+			std::shared_ptr<BidCoSPacket> response(new BidCoSPacket(packet->messageCounter(), 0x80, 0x10, device.address, packet->senderAddress(), responsePayload));
+			sendToCentral(device, response);
+			return;
+		}
+		else if(subtype == 0x04 && payload.size() >= 7) //Config request
+		{
+			int32_t remoteAddress = (payload.at(2) << 16) + (payload.at(3) << 8) + payload.at(4);
+			std::map<int32_t, uint8_t>& config = getConfig(device, channel, remoteAddress, remoteAddress == 0 ? 0 : payload.at(5), payload.at(6));
+
+			//Eight index/value pairs per packet. All packets but the last one need to be acknowledged by the central.
+			uint8_t messageCounter = packet->messageCounter();
+			std::vector<uint8_t> responsePayload{ 0x02 };
+			for(std::map<int32_t, uint8_t>::iterator i = config.begin(); i != config.end(); ++i)
+			{
+				responsePayload.push_back(i->first);
+				responsePayload.push_back(i->second);
+				if(responsePayload.size() == 17)
+				{
+					device.pendingResponses.push_back(std::shared_ptr<BidCoSPacket>(new BidCoSPacket(messageCounter++, 0xA0, 0x10, device.address, packet->senderAddress(), responsePayload)));
+					responsePayload.resize(1);
+				}
+			}
+			responsePayload.push_back(0);
+			responsePayload.push_back(0);
+			device.pendingResponses.push_back(std::shared_ptr<BidCoSPacket>(new BidCoSPacket(messageCounter, 0x80, 0x10, device.address, packet->senderAddress(), responsePayload)));
+
+			std::shared_ptr<BidCoSPacket> response = device.pendingResponses.front();
+			device.pendingResponses.pop_front();
+			sendToCentral(device, response);
+			return;
+		}
+		else if(subtype == 0x05 && payload.size() >= 7) //Config start
+		{
+			int32_t remoteAddress = (payload.at(2) << 16) + (payload.at(3) << 8) + payload.at(4);
+			device.configWriteList = std::make_tuple(channel, remoteAddress, remoteAddress == 0 ? 0 : (int32_t)payload.at(5), (int32_t)payload.at(6));
+			getConfig(device, channel, std::get<1>(device.configWriteList), std::get<2>(device.configWriteList), std::get<3>(device.configWriteList));
+		}
+		else if(subtype == 0x08) //Config write index
+		{
+			if(std::get<0>(device.configWriteList) != -1)
+			{
+				std::map<int32_t, uint8_t>& config = device.config[device.configWriteList];
+				for(uint32_t i = 2; i + 1 < payload.size(); i += 2)
+				{
+					config[payload.at(i)] = payload.at(i + 1);
+				}
+			}
+		}
+		else if(subtype == 0x06) //Config end
+		{
+			device.configWriteList = std::make_tuple(-1, 0, 0, 0);
+		}
+		else if(subtype == 0x0E) //Status request
+		{
+			std::map<int32_t, uint8_t>::iterator levelIterator = device.levels.find(channel);
+			std::vector<uint8_t> responsePayload{ 0x06, (uint8_t)channel, levelIterator == device.levels.end() ? (uint8_t)0 : levelIterator->second, 0x00, (uint8_t)-device.rssi };
+			std::shared_ptr<BidCoSPacket> response(new BidCoSPacket(packet->messageCounter(), 0x80, 0x10, device.address, packet->senderAddress(), responsePayload));
+			sendToCentral(device, response);
+			return;
+		}
+		else if(subtype == 0x09) //Serial number request
+		{
+			std::vector<uint8_t> responsePayload{ 0x00 };
+			responsePayload.insert(responsePayload.end(), device.serialNumber.begin(), device.serialNumber.end());
+			std::shared_ptr<BidCoSPacket> response(new BidCoSPacket(packet->messageCounter(), 0x80, 0x10, device.address, packet->senderAddress(), responsePayload));
+			sendToCentral(device, response);
+			return;
+		}
+
+		if(packet->controlByte() & 0x20) sendAck(device, packet, authentication);
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(BaseLib::Exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	catch(...)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+	}
+}
+
+}
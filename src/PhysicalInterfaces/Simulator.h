@@ -0,0 +1,221 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Homegear.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+
+#ifndef SIMULATOR_H_
+#define SIMULATOR_H_
+
+#include "IBidCoSInterface.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <list>
+#include <map>
+#include <random>
+#include <set>
+#include <tuple>
+#include <unordered_map>
+
+namespace BidCoS
+{
+
+/**
+ * Simulates BidCoS devices in-process instead of talking to a communication module. Packets sent by the central are passed to the simulated
+ * devices and their responses are passed back through processReceivedPacket(), so the central, the queues and the AES handshake are
+ * exercised like with real hardware. Meant for load tests and benchmarks.
+ *
+ * The devices behave like switch actuators: They acknowledge commands, answer "LEVEL_SET" with "ACK_STATUS", answer config and peer
+ * requests, store written config and periodically send "INFO_LEVEL". Config not written by the central is answered with the default
+ * values of the device description. Until the central knows a device, it sends pairing packets instead.
+ */
+class Simulator : public IBidCoSInterface
+{
+public:
+	Simulator(std::shared_ptr<BaseLib::Systems::PhysicalInterfaceSettings> settings);
+	virtual ~Simulator();
+
+	virtual void startListening();
+	virtual void stopListening();
+	virtual void enableUpdateMode();
+	virtual void disableUpdateMode();
+	virtual bool isOpen() { return !_stopped; }
+	virtual bool firmwareUpdatesSupported() { return false; }
+	virtual ReadStatistics getReadStatistics();
+protected:
+	class Device
+	{
+	public:
+		Device() {}
+		virtual ~Device() {}
+
+		int32_t address = 0;
+		std::string serialNumber;
+		uint8_t messageCounter = 0;
+
+		/**
+		 * The RSSI of the device in dBm.
+		 */
+		int32_t rssi = -60;
+		std::map<int32_t, uint8_t> levels;
+		uint32_t keyIndex = 0;
+		uint32_t keyChangePackets = 0;
+
+		/**
+		 * Config by channel, remote address, remote channel and list. Lists are filled with the defaults of the device description on first
+		 * access.
+		 */
+		std::map<std::tuple<int32_t, int32_t, int32_t, int32_t>, std::map<int32_t, uint8_t>> config;
+
+		/**
+		 * The list written by the current config session.
+		 */
+		std::tuple<int32_t, int32_t, int32_t, int32_t> configWriteList{ -1, 0, 0, 0 };
+
+		/**
+		 * Peers by local channel. The elements are the remote address and the remote channel.
+		 */
+		std::map<int32_t, std::set<std::pair<int32_t, int32_t>>> links;
+
+		/**
+		 * Config response packets waiting for the ACK of the previous packet.
+		 */
+		std::list<std::shared_ptr<BidCoSPacket>> pendingResponses;
+		std::shared_ptr<BidCoSPacket> lastPacketSent;
+
+		/**
+		 * Only exists while an AES handshake is running.
+		 */
+		std::shared_ptr<AesHandshake> aesHandshake;
+		int64_t airtimeHour = 0;
+		uint32_t airtimeUsed = 0;
+	};
+
+	class Event
+	{
+	public:
+		enum class Type
+		{
+			toCentral,
+			toDevice,
+			status
+		};
+
+		Event() {}
+		Event(Type type, int32_t address) { this->type = type; this->address = address; }
+		virtual ~Event() {}
+
+		Type type = Type::status;
+		int32_t address = 0;
+
+		/**
+		 * The packet as sent over the air. Packets to the central have the RSSI byte appended.
+		 */
+		std::vector<uint8_t> data;
+	};
+
+	// {{{ Settings
+		uint32_t _deviceCount = 10;
+		int32_t _startAddress = 0x5A0000;
+		uint32_t _deviceType = 0x00A1;
+		uint8_t _firmwareVersion = 0x26;
+
+		/**
+		 * Time between two status packets of one device in milliseconds.
+		 */
+		int64_t _statusInterval = 60000;
+		int64_t _latency = 20;
+
+		/**
+		 * Percentage of packets lost in each direction.
+		 */
+		int32_t _loss = 0;
+
+		/**
+		 * Percentage of one hour each device is allowed to send. 0 disables the limit.
+		 */
+		int32_t _dutyCycle = 1;
+		bool _aesAlways = false;
+		uint32_t _seed = 1;
+	// }}}
+
+	BaseLib::DeviceDescription::PHomegearDevice _rpcDevice;
+	std::mt19937 _random;
+	std::unordered_map<int32_t, Device> _devices;
+
+	std::mutex _eventsMutex;
+	std::condition_variable _eventsConditionVariable;
+	std::multimap<int64_t, Event> _events;
+
+	std::atomic<uint64_t> _wakeUps;
+	std::atomic<uint64_t> _packetsToDevices;
+	std::atomic<uint64_t> _packetsToCentral;
+	std::atomic<uint64_t> _bytesToCentral;
+	std::atomic<uint64_t> _packetsLost;
+	std::atomic<uint64_t> _dutyCycleDrops;
+	std::atomic<uint64_t> _aesHandshakes;
+
+	void readSettings();
+	void createDevices();
+	void addEvent(int64_t time, Event& event);
+	void simulate();
+	void processEvent(Event& event);
+	void forceSendPacket(std::shared_ptr<BidCoSPacket> packet);
+
+	/**
+	 * Returns true when the central added the device to this interface, i. e. when it is paired.
+	 */
+	bool isPaired(int32_t address);
+	bool aesActive(Device& device, int32_t channel);
+
+	/**
+	 * Returns a config list of the device. The list is created from the default values of the device description on first access.
+	 */
+	std::map<int32_t, uint8_t>& getConfig(Device& device, int32_t channel, int32_t remoteAddress, int32_t remoteChannel, int32_t list);
+
+	/**
+	 * Sends a packet from a device to the central. The packet is dropped, when it's lost or the duty cycle limit of the device is reached.
+	 */
+	void sendToCentral(Device& device, std::shared_ptr<BidCoSPacket> packet);
+	void sendAck(Device& device, std::shared_ptr<BidCoSPacket>& packet, std::vector<uint8_t>& authentication);
+	void sendStatus(Device& device);
+	void sendPairingRequest(Device& device);
+
+	void handlePacket(Device& device, std::shared_ptr<BidCoSPacket>& packet);
+
+	/**
+	 * Executes a command after it was authenticated (if necessary).
+	 *
+	 * @param authentication The four bytes of the AES signature to append to the response. Empty if no AES handshake was done.
+	 */
+	void handleCommand(Device& device, std::shared_ptr<BidCoSPacket>& packet, std::vector<uint8_t>& authentication);
+	void handleConfig(Device& device, std::shared_ptr<BidCoSPacket>& packet, std::vector<uint8_t>& authentication);
+};
+
+}
+
+#endif
@@ -0,0 +1,125 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Homegear.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+
+
+#include "SpiTransaction.h"
+
+#include <cstring>
+
+#ifdef SPIINTERFACES
+#include <sys/ioctl.h>
+#include <linux/spi/spidev.h>
+#endif
+
+namespace BidCoS
+{
+
+uint32_t SpiTransaction::addSegment(uint8_t header, const uint8_t* data, uint32_t size, uint16_t delay)
+{
+	if(_segmentCount >= maxSegments || _length + size + 1 > bufferSize) throw BaseLib::Exception("SPI transaction is full.");
+	Segment& segment = _segments[_segmentCount];
+	segment.offset = _length;
+	segment.length = size + 1;
+	segment.delay = delay;
+	_tx[_length] = header;
+	if(data) std::memcpy(_tx.data() + _length + 1, data, size);
+	else std::memset(_tx.data() + _length + 1, 0, size);
+	_length += size + 1;
+	return _segmentCount++;
+}
+
+uint32_t SpiTransaction::addCommandStrobe(uint8_t strobe, uint16_t delay)
+{
+	return addSegment(strobe, nullptr, 0, delay);
+}
+
+uint32_t SpiTransaction::addReadRegister(uint8_t address)
+{
+	return addSegment(address | 0x80, nullptr, 1, 0);
+}
+
+uint32_t SpiTransaction::addReadStatusRegister(uint8_t address)
+{
+	return addSegment(address | 0xC0, nullptr, 1, 0);
+}
+
+uint32_t SpiTransaction::addReadBurst(uint8_t address, uint32_t count)
+{
+	return addSegment(address | 0xC0, nullptr, count, 0);
+}
+
+uint32_t SpiTransaction::addWriteBurst(uint8_t address, const uint8_t* data, uint32_t size)
+{
+	return addSegment(address | 0x40, data, size, 0);
+}
+
+uint32_t SpiTransaction::addRaw(const uint8_t* data, uint32_t size)
+{
+	if(size == 0) throw BaseLib::Exception("SPI segment is empty.");
+	return addSegment(data[0], data + 1, size - 1, 0);
+}
+
+bool SpiTransaction::chipReady()
+{
+	for(uint32_t i = 0; i < _segmentCount; i++)
+	{
+		if(_rx[_segments[i].offset] & 0x80) return false;
+	}
+	return true;
+}
+
+#ifdef SPIINTERFACES
+SpidevTransport::SpidevTransport(std::shared_ptr<BaseLib::FileDescriptor> fileDescriptor, uint32_t speed)
+{
+	_fileDescriptor = fileDescriptor;
+	_speed = speed;
+}
+
+bool SpidevTransport::transfer(SpiTransaction& transaction)
+{
+	uint32_t count = transaction.segmentCount();
+	if(!_fileDescriptor || _fileDescriptor->descriptor == -1 || count == 0) return false;
+	std::array<spi_ioc_transfer, SpiTransaction::maxSegments> transfers;
+	std::memset(transfers.data(), 0, sizeof(spi_ioc_transfer) * transfers.size());
+	for(uint32_t i = 0; i < count; i++)
+	{
+		const SpiTransaction::Segment& segment = transaction.segment(i);
+		transfers[i].tx_buf = (uint64_t)(transaction.txBuffer() + segment.offset);
+		transfers[i].rx_buf = (uint64_t)(transaction.rxBuffer() + segment.offset);
+		transfers[i].len = segment.length;
+		transfers[i].speed_hz = _speed;
+		transfers[i].bits_per_word = 8;
+		transfers[i].delay_usecs = segment.delay;
+		transfers[i].cs_change = (i + 1 < count) ? 1 : 0; //Release chip select between the segments, but not after the last one
+	}
+	return ioctl(_fileDescriptor->descriptor, SPI_IOC_MESSAGE(count), transfers.data()) >= 0;
+}
+#endif
+
+}
@@ -0,0 +1,167 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Homegear.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+
+
+#ifndef SPITRANSACTION_H_
+#define SPITRANSACTION_H_
+
+#include "../../config.h"
+
+#include <homegear-base/BaseLib.h>
+
+#include <array>
+
+namespace BidCoS
+{
+
+/**
+ * A sequence of CC1101 SPI accesses (command strobes, register reads and writes) executed with one transfer. Chip select is released
+ * between the segments, so each segment is a separate access for the chip. The buffers have a fixed size, so building a transaction
+ * doesn't allocate memory.
+ */
+class SpiTransaction
+{
+public:
+	static const uint32_t maxSegments = 8;
+	static const uint32_t bufferSize = 128;
+
+	class Segment
+	{
+	public:
+		uint32_t offset = 0;
+		uint32_t length = 0;
+
+		/**
+		 * Time in microseconds to wait after the segment before the next one.
+		 */
+		uint16_t delay = 0;
+	};
+
+	SpiTransaction() {}
+	virtual ~SpiTransaction() {}
+
+	void clear() { _segmentCount = 0; _length = 0; }
+	uint32_t segmentCount() { return _segmentCount; }
+	uint32_t size() { return _length; }
+	const Segment& segment(uint32_t index) { return _segments.at(index); }
+	uint8_t* txBuffer() { return _tx.data(); }
+	uint8_t* rxBuffer() { return _rx.data(); }
+
+	/**
+	 * Adds a command strobe.
+	 *
+	 * @param delay Time in microseconds to wait before the next segment, e. g. until the chip reached the state requested by the strobe.
+	 * @return Returns the index of the segment.
+	 */
+	uint32_t addCommandStrobe(uint8_t strobe, uint16_t delay = 0);
+
+	/**
+	 * Adds a single read of a configuration register or of the FIFO.
+	 */
+	uint32_t addReadRegister(uint8_t address);
+
+	/**
+	 * Adds a read of a status register (0x30 to 0x3D). Status registers are read with the burst bit set.
+	 */
+	uint32_t addReadStatusRegister(uint8_t address);
+	uint32_t addReadBurst(uint8_t address, uint32_t count);
+	uint32_t addWriteBurst(uint8_t address, const uint8_t* data, uint32_t size);
+
+	/**
+	 * Adds a segment sending "data" as is. The first byte is the header byte.
+	 */
+	uint32_t addRaw(const uint8_t* data, uint32_t size);
+
+	/**
+	 * Returns the chip status byte received while sending the header byte of a segment.
+	 */
+	uint8_t status(uint32_t index) { return _rx.at(_segments.at(index).offset); }
+
+	/**
+	 * Returns the bytes received after the header byte of a segment.
+	 */
+	const uint8_t* data(uint32_t index) { return _rx.data() + _segments.at(index).offset + 1; }
+	uint32_t dataSize(uint32_t index) { return _segments.at(index).length - 1; }
+
+	/**
+	 * Returns false when the chip signaled in any segment, that it isn't ready (CHIP_RDYn set).
+	 */
+	bool chipReady();
+private:
+	std::array<Segment, maxSegments> _segments;
+	uint32_t _segmentCount = 0;
+	uint32_t _length = 0;
+	std::array<uint8_t, bufferSize> _tx;
+	std::array<uint8_t, bufferSize> _rx{};
+
+	/**
+	 * Throws an exception when the transaction is full.
+	 *
+	 * @param data The bytes to send after the header byte. Zeros are sent when "data" is a null pointer.
+	 */
+	uint32_t addSegment(uint8_t header, const uint8_t* data, uint32_t size, uint16_t delay);
+};
+
+/**
+ * Executes SPI transactions. Implementations other than SpidevTransport can execute transactions without hardware.
+ */
+class ISpiTransport
+{
+public:
+	ISpiTransport() {}
+	virtual ~ISpiTransport() {}
+
+	/**
+	 * Executes all segments of the transaction with one transfer and fills the receive buffer.
+	 *
+	 * @return Returns false on errors.
+	 */
+	virtual bool transfer(SpiTransaction& transaction) = 0;
+};
+
+#ifdef SPIINTERFACES
+/**
+ * Executes transactions on a spidev device with one SPI_IOC_MESSAGE ioctl each.
+ */
+class SpidevTransport : public ISpiTransport
+{
+public:
+	SpidevTransport(std::shared_ptr<BaseLib::FileDescriptor> fileDescriptor, uint32_t speed);
+	virtual ~SpidevTransport() {}
+
+	virtual bool transfer(SpiTransaction& transaction);
+private:
+	std::shared_ptr<BaseLib::FileDescriptor> _fileDescriptor;
+	uint32_t _speed = 4000000;
+};
+#endif
+
+}
+
+#endif
@@ -63,8 +63,6 @@ TICC1100::TICC1100(std::shared_ptr<BaseLib::Systems::PhysicalInterfaceSettings>
 			settings->interruptPin = 2;
 		}
 
-		_transfer =  { (uint64_t)0, (uint64_t)0, (uint32_t)0, (uint32_t)4000000, (uint16_t)0, (uint8_t)8, (uint8_t)0, (uint32_t)0 };
-
 		setConfig();
 	}
     catch(const std::exception& ex)
@@ -372,6 +370,7 @@ void TICC1100::openDevice()
 		close(lockfileDescriptor);
 
 		_fileDescriptor = _bl->fileDescriptorManager.add(open(_settings->device.c_str(), O_RDWR | O_NONBLOCK));
+		_transport.reset(new SpidevTransport(_fileDescriptor, _spiSpeed));
 		usleep(1000);
 
 		if(_fileDescriptor->descriptor == -1)
@@ -453,7 +452,7 @@ void TICC1100::setupDevice()
 
 		uint8_t mode = 0;
 		uint8_t bits = 8;
-		uint32_t speed = 4000000; //4MHz, see page 25 in datasheet
+		uint32_t speed = _spiSpeed;
 
 		if(ioctl(_fileDescriptor->descriptor, SPI_IOC_WR_MODE, &mode)) throw(BaseLib::Exception("Couldn't set spi mode on device " + _settings->device));
 		if(ioctl(_fileDescriptor->descriptor, SPI_IOC_RD_MODE, &mode)) throw(BaseLib::Exception("Couldn't get spi mode off device " + _settings->device));
@@ -530,7 +529,12 @@ void TICC1100::forceSendPacket(std::shared_ptr<BidCoSPacket> packet)
 		if(!packet) return;
         bool burst = packet->controlByte() & 0x10;
 		std::vector<uint8_t> decodedPacket = packet->byteArray();
-		std::vector<uint8_t> encodedPacket(decodedPacket.size());
+		if(decodedPacket.size() > 64)
+		{
+			_out.printError("Error: Packet is too large for the TX FIFO: " + packet->hexString());
+			return;
+		}
+		std::array<uint8_t, 64> encodedPacket;
 		encodedPacket[0] = decodedPacket[0];
 		encodedPacket[1] = (~decodedPacket[1]) ^ 0x89;
 		uint32_t i = 2;
@@ -559,42 +563,38 @@ void TICC1100::forceSendPacket(std::shared_ptr<BidCoSPacket> packet)
 			return;
 		}
 		_sending = true;
-		sendCommandStrobe(CommandStrobes::Enum::SIDLE);
-		sendCommandStrobe(CommandStrobes::Enum::SFTX);
 		_lastPacketSent = BaseLib::HelperFunctions::getTime();
 		if(_lastPacketSent - timeBeforeLock > 100)
 		{
 			_out.printWarning("Warning: Timing problem. Sending took more than 100ms. Do you have enough system resources?");
 		}
-		if(burst)
+
+		//Strobes and FIFO fill are sent with one transfer. For burst packets the wake up preamble is sent before filling the FIFO.
+		SpiTransaction transaction;
+		transaction.addCommandStrobe(CommandStrobes::Enum::SIDLE);
+		transaction.addCommandStrobe(CommandStrobes::Enum::SFTX);
+		if(burst) transaction.addCommandStrobe(CommandStrobes::Enum::STX);
+		else
+		{
+			transaction.addWriteBurst(Registers::Enum::FIFO, encodedPacket.data(), decodedPacket.size());
+			transaction.addCommandStrobe(CommandStrobes::Enum::STX);
+		}
+		//Only one attempt: Repeating the transaction could start sending twice when STX was already executed.
+		bool success = transfer(transaction, 1);
+		if(success && burst)
 		{
-			//int32_t waitIndex = 0;
-			//while(waitIndex < 200)
-			//{
-				sendCommandStrobe(CommandStrobes::Enum::STX);
-				//if(readRegister(Registers::MARCSTATE) == 0x13) break;
-				//std::this_thread::sleep_for(std::chrono::milliseconds(2));
-				//waitIndex++;
-			//}
-			//if(waitIndex == 200) _out.printError("Error sending BidCoS packet. No CCA within 400ms.");
 			usleep(360000);
+			transaction.clear();
+			transaction.addWriteBurst(Registers::Enum::FIFO, encodedPacket.data(), decodedPacket.size());
+			success = transfer(transaction, 1);
 		}
-		writeRegisters(Registers::Enum::FIFO, encodedPacket);
-		if(!burst)
+		if(!success)
 		{
-			//int32_t waitIndex = 0;
-			//while(waitIndex < 200)
-			//{
-				sendCommandStrobe(CommandStrobes::Enum::STX);
-				//if(readRegister(Registers::MARCSTATE) == 0x13) break;
-				//std::this_thread::sleep_for(std::chrono::milliseconds(2));
-				//waitIndex++;
-			//}
-			//if(waitIndex == 200)
-			//{
-				//_out.printError("Error sending BidCoS packet. No CCA within 400ms.");
-				//sendCommandStrobe(CommandStrobes::Enum::SFTX);
-			//}
+			_out.printError("Error: Could not send packet " + packet->hexString() + ". The chip is not ready.");
+			//No GDO interrupt will end sending, so return to RX here.
+			endSending();
+			_txMutex.unlock();
+			return;
 		}
 
 		if(_bl->debugLevel > 3)
@@ -629,16 +629,20 @@ void TICC1100::readwrite(std::vector<uint8_t>& data)
 {
 	try
 	{
+		if(data.empty()) return;
+		if(!_transport || _fileDescriptor->descriptor == -1) return;
+		SpiTransaction transaction;
+		transaction.addRaw(data.data(), data.size());
+		//Not using transfer(), as the caller checks the status byte itself and the transaction must not be repeated. "data" is only
+		//overwritten when the transfer succeeded.
 		std::lock_guard<std::mutex> sendGuard(_sendMutex);
-		_transfer.tx_buf = (uint64_t)&data[0];
-		_transfer.rx_buf = (uint64_t)&data[0];
-		_transfer.len = (uint32_t)data.size();
 		if(_bl->debugLevel >= 6) _out.printDebug("Debug: Sending: " + _bl->hf.getHexString(data));
-		if(!ioctl(_fileDescriptor->descriptor, SPI_IOC_MESSAGE(1), &_transfer))
+		if(!_transport->transfer(transaction))
 		{
 			_out.printError("Couldn't write to device " + _settings->device + ": " + std::string(strerror(errno)));
 			return;
 		}
+		std::copy(transaction.rxBuffer(), transaction.rxBuffer() + data.size(), data.begin());
 		if(_bl->debugLevel >= 6) _out.printDebug("Debug: Received: " + _bl->hf.getHexString(data));
 	}
 	catch(const std::exception& ex)
@@ -655,6 +659,42 @@ void TICC1100::readwrite(std::vector<uint8_t>& data)
     }
 }
 
+bool TICC1100::transfer(SpiTransaction& transaction, uint32_t attempts)
+{
+	try
+	{
+		if(!_transport || _fileDescriptor->descriptor == -1) return false;
+		for(uint32_t i = 0; i < attempts; i++)
+		{
+			{
+				std::lock_guard<std::mutex> sendGuard(_sendMutex);
+				if(_bl->debugLevel >= 6) _out.printDebug("Debug: Sending: " + _bl->hf.getHexString(std::vector<uint8_t>(transaction.txBuffer(), transaction.txBuffer() + transaction.size())));
+				if(!_transport->transfer(transaction))
+				{
+					_out.printError("Couldn't write to device " + _settings->device + ": " + std::string(strerror(errno)));
+					return false;
+				}
+				if(_bl->debugLevel >= 6) _out.printDebug("Debug: Received: " + _bl->hf.getHexString(std::vector<uint8_t>(transaction.rxBuffer(), transaction.rxBuffer() + transaction.size())));
+			}
+			if(transaction.chipReady()) return true;
+			if(i + 1 < attempts) usleep(20);
+		}
+	}
+	catch(const std::exception& ex)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(BaseLib::Exception& ex)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+    return false;
+}
+
 bool TICC1100::checkStatus(uint8_t statusByte, Status::Enum status)
 {
 	try
@@ -839,8 +879,10 @@ void TICC1100::enableRX(bool flushRXFIFO)
 	{
 		if(_fileDescriptor->descriptor == -1) return;
 		std::lock_guard<std::timed_mutex> txGuard(_txMutex);
-		if(flushRXFIFO) sendCommandStrobe(CommandStrobes::Enum::SFRX);
-		sendCommandStrobe(CommandStrobes::Enum::SRX);
+		SpiTransaction transaction;
+		if(flushRXFIFO) transaction.addCommandStrobe(CommandStrobes::Enum::SFRX);
+		transaction.addCommandStrobe(CommandStrobes::Enum::SRX);
+		transfer(transaction);
 	}
     catch(const std::exception& ex)
     {
@@ -939,29 +981,6 @@ void TICC1100::reset()
     }
 }
 
-bool TICC1100::crcOK()
-{
-	try
-	{
-		if(_fileDescriptor->descriptor == -1) return false;
-		std::vector<uint8_t> result = readRegisters(Registers::Enum::LQI, 1);
-		if((result.size() == 2) && (result.at(1) & 0x80)) return true;
-	}
-    catch(const std::exception& ex)
-    {
-        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
-    }
-    catch(BaseLib::Exception& ex)
-    {
-        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
-    }
-    catch(...)
-    {
-        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
-    }
-    return false;
-}
-
 void TICC1100::startListening()
 {
 	try
@@ -1075,9 +1094,11 @@ void TICC1100::endSending()
 {
 	try
 	{
-		sendCommandStrobe(CommandStrobes::Enum::SIDLE);
-		sendCommandStrobe(CommandStrobes::Enum::SFRX);
-		sendCommandStrobe(CommandStrobes::Enum::SRX);
+		SpiTransaction transaction;
+		transaction.addCommandStrobe(CommandStrobes::Enum::SIDLE);
+		transaction.addCommandStrobe(CommandStrobes::Enum::SFRX);
+		transaction.addCommandStrobe(CommandStrobes::Enum::SRX);
+		transfer(transaction);
 		_sending = false;
 		_lastPacketSent = BaseLib::HelperFunctions::getTime();
 	}
@@ -1165,23 +1186,47 @@ void TICC1100::mainThread()
 					{
 						//sendCommandStrobe(CommandStrobes::Enum::SIDLE);
 						std::shared_ptr<BidCoSPacket> packet;
-						if(crcOK())
+
+						//First transfer: CRC status and number of bytes in the RX FIFO
+						SpiTransaction statusTransaction;
+						uint32_t lqiSegment = statusTransaction.addReadStatusRegister(Registers::Enum::LQI);
+						uint32_t rxBytesSegment = statusTransaction.addReadStatusRegister(Registers::Enum::RXBYTES);
+						bool crcOK = transfer(statusTransaction) && (statusTransaction.data(lqiSegment)[0] & 0x80);
+						uint32_t rxBytes = statusTransaction.data(rxBytesSegment)[0];
+
+						//Second transfer: The whole FIFO (length byte, packet, RSSI and LQI) and restarting of RX. It is only done once, as
+						//reading the FIFO removes the bytes.
+						SpiTransaction fifoTransaction;
+						int32_t fifoSegment = -1;
+						if(!crcOK) _out.printDebug("Debug: BidCoS packet received, but CRC failed.");
+						else if((rxBytes & 0x80) || rxBytes > 64) _out.printWarning("Warning: RX FIFO overflow.");
+						else if(rxBytes > 0) fifoSegment = fifoTransaction.addReadBurst(Registers::Enum::FIFO, rxBytes);
+						if(!_sendingPending)
+						{
+							fifoTransaction.addCommandStrobe(CommandStrobes::Enum::SFRX);
+							fifoTransaction.addCommandStrobe(CommandStrobes::Enum::SRX);
+						}
+						if(fifoTransaction.segmentCount() > 0 && !transfer(fifoTransaction, 1)) fifoSegment = -1;
+
+						if(fifoSegment != -1)
 						{
-							uint8_t firstByte = readRegister(Registers::Enum::FIFO);
-							std::vector<uint8_t> encodedData = readRegisters(Registers::Enum::FIFO, firstByte + 1); //Read packet + RSSI
-							std::vector<uint8_t> decodedData(encodedData.size());
-							if(decodedData.size() > 200)
+							//Index 0 is the length byte, so the indexes match the decoded packet
+							const uint8_t* encodedData = fifoTransaction.data(fifoSegment);
+							uint32_t firstByte = encodedData[0];
+							if(firstByte + 2 > 200)
 							{
 								if(!_firstPacket)
 								{
-									_out.printWarning("Warning: Too large packet received: " + BaseLib::HelperFunctions::getHexString(encodedData));
+									_out.printWarning("Warning: Too large packet received: " + BaseLib::HelperFunctions::getHexString(std::vector<uint8_t>(encodedData, encodedData + rxBytes)));
 									closeDevice();
 									_txMutex.unlock();
 									continue;
 								}
 							}
-							else if(encodedData.size() >= 9)
+							else if(firstByte + 3 > rxBytes) _out.printInfo("Info: Ignoring incomplete packet: " + BaseLib::HelperFunctions::getHexString(std::vector<uint8_t>(encodedData, encodedData + rxBytes)));
+							else if(firstByte + 2 >= 9)
 							{
+								std::vector<uint8_t> decodedData(firstByte + 2);
 								decodedData[0] = firstByte;
 								decodedData[1] = (~encodedData[1]) ^ 0x89;
 								uint32_t i = 2;
@@ -1194,13 +1239,7 @@ void TICC1100::mainThread()
 
 								packet.reset(new BidCoSPacket(decodedData, true, BaseLib::HelperFunctions::getTime()));
 							}
-							else _out.printInfo("Info: Ignoring too small packet: " + BaseLib::HelperFunctions::getHexString(encodedData));
-						}
-						else _out.printDebug("Debug: BidCoS packet received, but CRC failed.");
-						if(!_sendingPending)
-						{
-							sendCommandStrobe(CommandStrobes::Enum::SFRX);
-							sendCommandStrobe(CommandStrobes::Enum::SRX);
+							else _out.printInfo("Info: Ignoring too small packet: " + BaseLib::HelperFunctions::getHexString(std::vector<uint8_t>(encodedData, encodedData + rxBytes)));
 						}
 						_txMutex.unlock();
 						if(packet)
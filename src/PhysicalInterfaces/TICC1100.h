@@ -35,6 +35,7 @@
 #ifdef SPIINTERFACES
 
 #include "IBidCoSInterface.h"
+#include "SpiTransaction.h"
 
 #include <thread>
 #include <iostream>
@@ -207,7 +208,9 @@ public:
 protected:
 	std::vector<uint8_t> _config;
 	std::vector<uint8_t> _patable;
-	struct spi_ioc_transfer _transfer;
+	static const uint32_t _spiSpeed = 4000000; //4MHz, see page 25 in datasheet
+
+	std::shared_ptr<ISpiTransport> _transport;
 	std::timed_mutex _txMutex;
 	std::atomic_bool _sending;
 	std::atomic_bool _sendingPending;
@@ -221,10 +224,17 @@ protected:
     void endSending();
     void mainThread();
     void readwrite(std::vector<uint8_t>& data);
+
+    /**
+     * Executes a transaction with one transfer. The transaction is repeated while the chip isn't ready.
+     *
+     * @param attempts The maximum number of transfers. Pass "1" for transactions reading the FIFO, as the bytes read are removed from the FIFO.
+     * @return Returns false when the transfer failed or the chip wasn't ready.
+     */
+    bool transfer(SpiTransaction& transaction, uint32_t attempts = 5);
     void reset();
     void initChip();
     void enableRX(bool flushRXFIFO);
-    bool crcOK();
     uint8_t sendCommandStrobe(CommandStrobes::Enum commandStrobe);
     uint8_t readRegister(Registers::Enum registerAddress);
     std::vector<uint8_t> readRegisters(Registers::Enum startAddress, uint8_t count);
@@ -54,7 +54,7 @@ void HmCcTc::init()
 {
 	try
 	{
-		_stopDutyCycleThread = false;
+		_stopDutyCycle = false;
 	}
 	catch(const std::exception& ex)
     {
@@ -75,9 +75,8 @@ void HmCcTc::dispose()
 {
 	try
 	{
-		_stopDutyCycleThread = true;
-		_bl->threadManager.join(_dutyCycleThread);
-		_bl->threadManager.join(_sendDutyCyclePacketThread);
+		_stopDutyCycle = true;
+		if(GD::dutyCycleTimer) GD::dutyCycleTimer->cancel(this);
 		BidCoSPeer::dispose();
 	}
 	catch(const std::exception& ex)
@@ -267,12 +266,15 @@ void HmCcTc::startDutyCycle(int64_t lastDutyCycleEvent)
 {
 	try
 	{
-		if(_dutyCycleThread.joinable())
+		if(!GD::dutyCycleTimer)
 		{
-			GD::out.printCritical("HomeMatic BidCoS peer " + std::to_string(_peerID) + ": Duty cycle thread already started. Something went very wrong.");
+			GD::out.printCritical("HomeMatic BidCoS peer " + std::to_string(_peerID) + ": Duty cycle timer is not initialized. Something went very wrong.");
 			return;
 		}
-		_bl->threadManager.start(_dutyCycleThread, true, 35, SCHED_FIFO, &HmCcTc::dutyCycleThread, this, lastDutyCycleEvent);
+		_lastDutyCycleEvent = (lastDutyCycleEvent < 0) ? std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count() : lastDutyCycleEvent;
+		//The calculation has to use the last message counter. Add offset every cycle. This is very important! Without it, 20% of the packets are sent too early.
+		_nextDutyCycleEvent = _lastDutyCycleEvent + ((int64_t)calculateCycleLength(_dutyCycleMessageCounter - 1) * 250000) + _dutyCycleTimeOffset;
+		scheduleDutyCyclePacket();
 	}
     catch(const std::exception& ex)
     {
@@ -288,78 +290,28 @@ void HmCcTc::startDutyCycle(int64_t lastDutyCycleEvent)
     }
 }
 
-void HmCcTc::dutyCycleThread(int64_t lastDutyCycleEvent)
+void HmCcTc::scheduleDutyCyclePacket()
 {
 	try
 	{
-		int64_t nextDutyCycleEvent = (lastDutyCycleEvent < 0) ? std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count() : lastDutyCycleEvent;
-		_lastDutyCycleEvent = nextDutyCycleEvent;
-		int64_t timePoint;
-		int64_t cycleTime;
-		uint32_t cycleLength = calculateCycleLength(_dutyCycleMessageCounter - 1); //The calculation has to use the last message counter
-		_dutyCycleCounter = (std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count() - _lastDutyCycleEvent) / 250000;
-		if(_dutyCycleCounter < 0) _dutyCycleCounter = 0;
-		if(_dutyCycleCounter > 0) GD::out.printInfo("Info: Skipping " + std::to_string(_dutyCycleCounter * 250) + " ms of duty cycle.");
-		//_dutyCycleCounter = (_dutyCycleCounter % 8 > 3) ? _dutyCycleCounter + (8 - (_dutyCycleCounter % 8)) : _dutyCycleCounter - (_dutyCycleCounter % 8);
-
-		while(!_stopDutyCycleThread)
+		if(_stopDutyCycle) return;
+		//After downtime or a stalled send, cycles in the past are skipped instead of being sent back to back.
+		int64_t now = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+		int64_t skippedTime = 0;
+		while(_nextDutyCycleEvent <= now)
 		{
-			try
-			{
-				cycleTime = (int64_t)cycleLength * 250000;
-				nextDutyCycleEvent += cycleTime + _dutyCycleTimeOffset; //Add offset every cycle. This is very important! Without it, 20% of the packets are sent too early.
-				GD::out.printInfo("Info: Next duty cycle: " + std::to_string(nextDutyCycleEvent / 1000) + " (in " + std::to_string(cycleTime / 1000) + " ms) with message counter 0x" + BaseLib::HelperFunctions::getHexString(_dutyCycleMessageCounter));
-
-				std::chrono::milliseconds sleepingTime(250);
-				while(!_stopDutyCycleThread && _dutyCycleCounter < (signed)cycleLength - 80)
-				{
-					std::this_thread::sleep_for(sleepingTime);
-					_dutyCycleCounter += 1;
-				}
-				if(_stopDutyCycleThread) break;
-
-				while(!_stopDutyCycleThread && _dutyCycleCounter < (signed)cycleLength - 40)
-				{
-					std::this_thread::sleep_for(sleepingTime);
-					_dutyCycleCounter += 1;
-				}
-				if(_stopDutyCycleThread) break;
-
-				setDecalcification();
-
-				timePoint = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now().time_since_epoch()).count();
-				GD::out.printInfo("Info: Correcting time mismatch of " + std::to_string((nextDutyCycleEvent - 10000000 - timePoint) / 1000) + "ms.");
-				std::this_thread::sleep_for(std::chrono::microseconds(nextDutyCycleEvent - timePoint - 5000000));
-				if(_stopDutyCycleThread) break;
-
-				timePoint = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now().time_since_epoch()).count();
-				std::this_thread::sleep_for(std::chrono::microseconds(nextDutyCycleEvent - timePoint - 2000000));
-				if(_stopDutyCycleThread) break;
-
-				_bl->threadManager.join(_sendDutyCyclePacketThread);
-				_bl->threadManager.start(_sendDutyCyclePacketThread, false, 44, SCHED_FIFO, &HmCcTc::sendDutyCyclePacket, this, _dutyCycleMessageCounter, nextDutyCycleEvent);
-
-				_lastDutyCycleEvent = nextDutyCycleEvent;
-				cycleLength = calculateCycleLength(_dutyCycleMessageCounter);
-				_dutyCycleMessageCounter++;
-				saveVariable(1006, _lastDutyCycleEvent);
-				saveVariable(1007, (int64_t)_dutyCycleMessageCounter);
-
-				_dutyCycleCounter = 0;
-			}
-			catch(const std::exception& ex)
-			{
-				GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
-			}
-			catch(BaseLib::Exception& ex)
-			{
-				GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
-			}
-			catch(...)
-			{
-				GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
-			}
+			skippedTime += _nextDutyCycleEvent - _lastDutyCycleEvent;
+			_lastDutyCycleEvent = _nextDutyCycleEvent;
+			_nextDutyCycleEvent += ((int64_t)calculateCycleLength(_dutyCycleMessageCounter) * 250000) + _dutyCycleTimeOffset;
+			_dutyCycleMessageCounter++;
 		}
+		if(skippedTime > 0)
+		{
+			GD::out.printInfo("Info: Skipping " + std::to_string(skippedTime / 1000) + " ms of duty cycle.");
+			GD::dutyCycleTimer->save(this, std::bind(&HmCcTc::saveDutyCycleVariables, this));
+		}
+		GD::out.printInfo("Info: Next duty cycle: " + std::to_string(_nextDutyCycleEvent / 1000) + " (in " + std::to_string((_nextDutyCycleEvent - _lastDutyCycleEvent) / 1000) + " ms) with message counter 0x" + BaseLib::HelperFunctions::getHexString(_dutyCycleMessageCounter));
+		GD::dutyCycleTimer->schedule(this, _nextDutyCycleEvent - 2000000, std::bind(&HmCcTc::prepareDutyCyclePacket, this));
 	}
     catch(const std::exception& ex)
     {
@@ -419,59 +371,80 @@ void HmCcTc::setDecalcification()
 	}
 }
 
-void HmCcTc::sendDutyCyclePacket(uint8_t messageCounter, int64_t sendingTime)
+void HmCcTc::prepareDutyCyclePacket()
 {
 	try
 	{
-		if(sendingTime < 0) sendingTime = 2000000;
-		if(_stopDutyCycleThread) return;
+		if(_stopDutyCycle) return;
+		setDecalcification();
+		_dutyCyclePacket.reset();
 		int32_t address = getNextDutyCycleDeviceAddress();
 		GD::out.printDebug("Debug: HomeMatic BidCoS peer " + std::to_string(_peerID) + ": Next HM-CC-VD is 0x" + BaseLib::HelperFunctions::getHexString(address));
-		if(address < 1)
+		if(address < 1) GD::out.printDebug("Debug: Not sending duty cycle packet, because no valve drives are paired to me.");
+		else
 		{
-			GD::out.printDebug("Debug: Not sending duty cycle packet, because no valve drives are paired to me.");
-			return;
+			std::vector<uint8_t> payload;
+			payload.push_back(getAdjustmentCommand(address));
+			payload.push_back(_newValveState);
+			_dutyCyclePacket.reset(new BidCoSPacket(_dutyCycleMessageCounter, 0xA2, 0x58, _address, address, payload));
 		}
-		std::vector<uint8_t> payload;
-		payload.push_back(getAdjustmentCommand(address));
-		payload.push_back(_newValveState);
-		std::shared_ptr<BidCoSPacket> packet(new BidCoSPacket(messageCounter, 0xA2, 0x58, _address, address, payload));
-
-		int64_t nanoseconds = (sendingTime - std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now().time_since_epoch()).count() - 1000000) * 1000;
-		int32_t seconds = nanoseconds / 1000000000;
-		nanoseconds -= seconds * 1000000000;
-		struct timespec timeToSleep;
-		timeToSleep.tv_sec = seconds;
-		timeToSleep.tv_nsec = nanoseconds;
-		nanosleep(&timeToSleep, NULL);
-		if(_stopDutyCycleThread) return;
-
-		nanoseconds = (sendingTime - std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now().time_since_epoch()).count() - 500000) * 1000;
-		timeToSleep.tv_sec = 0;
-		timeToSleep.tv_nsec = nanoseconds;
-		nanosleep(&timeToSleep, NULL);
-		if(_stopDutyCycleThread) return;
-
-		nanoseconds = (sendingTime - std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now().time_since_epoch()).count() - 100000) * 1000;
-		timeToSleep.tv_nsec = nanoseconds;
-		nanosleep(&timeToSleep, NULL);
-
-		nanoseconds = (sendingTime - std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now().time_since_epoch()).count() - 30000) * 1000;
-		timeToSleep.tv_nsec = nanoseconds;
-		nanosleep(&timeToSleep, NULL);
+		//Also scheduled without packet, so the cycle continues.
+		GD::dutyCycleTimer->schedule(this, _nextDutyCycleEvent, std::bind(&HmCcTc::sendDutyCyclePacket, this));
+	}
+    catch(const std::exception& ex)
+    {
+    	GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(BaseLib::Exception& ex)
+    {
+    	GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+    	GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+}
 
-		nanoseconds = (sendingTime - std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now().time_since_epoch()).count()) * 1000;
-		timeToSleep.tv_nsec = nanoseconds;
-		nanosleep(&timeToSleep, NULL);
-		if(_stopDutyCycleThread) return;
+void HmCcTc::sendDutyCyclePacket()
+{
+	try
+	{
+		if(_stopDutyCycle) return;
+		if(_dutyCyclePacket)
+		{
+			_physicalInterface->sendPacket(_dutyCyclePacket);
+			_valveState = _newValveState;
+			_dutyCyclePacket.reset();
+		}
 
-		int64_t timePoint = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now().time_since_epoch()).count();
+		_lastDutyCycleEvent = _nextDutyCycleEvent;
+		_nextDutyCycleEvent += ((int64_t)calculateCycleLength(_dutyCycleMessageCounter) * 250000) + _dutyCycleTimeOffset;
+		_dutyCycleMessageCounter++;
+		GD::dutyCycleTimer->save(this, std::bind(&HmCcTc::saveDutyCycleVariables, this));
+		scheduleDutyCyclePacket();
+	}
+    catch(const std::exception& ex)
+    {
+    	GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(BaseLib::Exception& ex)
+    {
+    	GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    catch(...)
+    {
+    	GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+}
 
-		_physicalInterface->sendPacket(packet);
-		_valveState = _newValveState;
-		int64_t timePassed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now().time_since_epoch()).count() - timePoint;
-		GD::out.printDebug("Debug: HomeMatic BidCoS peer " + std::to_string(_peerID) + ": Sending took " + std::to_string(timePassed) + "ms.");
+void HmCcTc::saveDutyCycleVariables()
+{
+	try
+	{
+		saveVariable(1000, _currentDutyCycleDeviceAddress);
 		saveVariable(1004, _valveState);
+		saveVariable(1006, _lastDutyCycleEvent);
+		saveVariable(1007, (int64_t)_dutyCycleMessageCounter);
 	}
     catch(const std::exception& ex)
     {
@@ -540,7 +513,6 @@ int32_t HmCcTc::getNextDutyCycleDeviceAddress()
 				break;
 			}
 		}
-		saveVariable(1000, _currentDutyCycleDeviceAddress);
 		return _currentDutyCycleDeviceAddress;
 	}
     catch(const std::exception& ex)
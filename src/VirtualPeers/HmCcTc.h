@@ -58,14 +58,18 @@ class HmCcTc : public BidCoSPeer
         std::unordered_map<int32_t, bool> _decalcification;
 
         const int32_t _dutyCycleTimeOffset = 3000;
-        std::atomic_bool _stopDutyCycleThread;
-        std::thread _dutyCycleThread;
-        int32_t _dutyCycleCounter  = 0;
-        std::thread _sendDutyCyclePacketThread;
+        std::atomic_bool _stopDutyCycle;
+        int64_t _nextDutyCycleEvent = 0;
         uint8_t _dutyCycleMessageCounter = 0;
 
+        /**
+         * The packet to send at _nextDutyCycleEvent. Created shortly before, so the send task only needs to pass it to the interface.
+         */
+        std::shared_ptr<BidCoSPacket> _dutyCyclePacket;
+
         void init();
         void worker();
+        virtual int64_t getNextWorkerTime(int64_t time) { return std::numeric_limits<int64_t>::max(); }
         virtual bool load(BaseLib::Systems::ICentral* device);
         virtual void loadVariables(BaseLib::Systems::ICentral* device, std::shared_ptr<BaseLib::Database::DataTable>& rows);
         virtual void saveVariables();
@@ -76,9 +80,19 @@ class HmCcTc : public BidCoSPeer
         int32_t getAdjustmentCommand(int32_t peerAddress);
 
         void sendDutyCycleBroadcast();
-        void sendDutyCyclePacket(uint8_t messageCounter, int64_t sendingTime);
         void startDutyCycle(int64_t lastDutyCycleEvent);
-        void dutyCycleThread(int64_t lastDutyCycleEvent);
+
+        /**
+         * Schedules creating the packet for _nextDutyCycleEvent on the duty cycle timer.
+         */
+        void scheduleDutyCyclePacket();
+        void prepareDutyCyclePacket();
+        void sendDutyCyclePacket();
+
+        /**
+         * Saves the variables changed every duty cycle. Called by the duty cycle timer in batches.
+         */
+        void saveDutyCycleVariables();
         void setDecalcification();
 
         /**